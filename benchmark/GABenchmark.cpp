@@ -0,0 +1,79 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+
+#include <cstdio>
+#include <exception>
+
+namespace gameanalytics
+{
+    namespace benchmark
+    {
+        namespace
+        {
+            struct Entry
+            {
+                std::string       name;
+                BenchmarkFunction fn;
+            };
+
+            std::vector<Entry>& registry()
+            {
+                static std::vector<Entry> entries;
+                return entries;
+            }
+        }
+
+        BenchmarkRegistrar::BenchmarkRegistrar(std::string const& name, BenchmarkFunction fn)
+        {
+            registry().push_back({name, std::move(fn)});
+        }
+
+        void BenchmarkContext::report(std::string const& label, int64_t operations, Clock::duration elapsed)
+        {
+            const double seconds = std::chrono::duration<double>(elapsed).count();
+            const double opsPerSec = seconds > 0.0 ? static_cast<double>(operations) / seconds : 0.0;
+            const double nsPerOp = operations > 0 ? std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(operations) : 0.0;
+
+            std::printf("  %-48s %12.0f ops/s %10.1f ns/op  (%lld ops, %.3f s)\n", label.c_str(), opsPerSec, nsPerOp, static_cast<long long>(operations), seconds);
+        }
+
+        void BenchmarkContext::report(std::string const& label, double value, std::string const& unit)
+        {
+            std::printf("  %-48s %12.2f %s\n", label.c_str(), value, unit.c_str());
+        }
+
+        int runBenchmarks(std::string const& filter)
+        {
+            int failed = 0;
+
+            for (Entry const& e : registry())
+            {
+                if (!filter.empty() && e.name.find(filter) == std::string::npos)
+                {
+                    continue;
+                }
+
+                std::printf("[ %s ]\n", e.name.c_str());
+
+                try
+                {
+                    BenchmarkContext ctx;
+                    e.fn(ctx);
+                }
+                catch (std::exception const& ex)
+                {
+                    std::printf("  failed: %s\n", ex.what());
+                    ++failed;
+                }
+
+                std::fflush(stdout);
+            }
+
+            return failed;
+        }
+    }
+}
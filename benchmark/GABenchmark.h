@@ -0,0 +1,59 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gameanalytics
+{
+    namespace benchmark
+    {
+        // collects the figures reported by one benchmark
+        class BenchmarkContext
+        {
+         public:
+
+            using Clock = std::chrono::steady_clock;
+
+            // records 'operations' done in 'elapsed', printed as ops/sec and ns/op
+            void report(std::string const& label, int64_t operations, Clock::duration elapsed);
+
+            // records a free form value (sizes, ratios, counters)
+            void report(std::string const& label, double value, std::string const& unit);
+
+            template<typename Fn>
+            Clock::duration measure(Fn&& fn)
+            {
+                const auto start = Clock::now();
+                fn();
+                return Clock::now() - start;
+            }
+        };
+
+        using BenchmarkFunction = std::function<void(BenchmarkContext&)>;
+
+        struct BenchmarkRegistrar
+        {
+            BenchmarkRegistrar(std::string const& name, BenchmarkFunction fn);
+        };
+
+        // runs every registered benchmark whose name contains 'filter'
+        int runBenchmarks(std::string const& filter);
+    }
+}
+
+#define GA_BENCHMARK_CONCAT_(a, b) a##b
+#define GA_BENCHMARK_CONCAT(a, b) GA_BENCHMARK_CONCAT_(a, b)
+
+// GA_BENCHMARK(name) { ... ctx.report(...); }
+#define GA_BENCHMARK(name)                                                                                  \
+    static void name(gameanalytics::benchmark::BenchmarkContext& ctx);                                      \
+    static gameanalytics::benchmark::BenchmarkRegistrar GA_BENCHMARK_CONCAT(name, _registrar)(#name, name); \
+    static void name(gameanalytics::benchmark::BenchmarkContext& ctx)
@@ -0,0 +1,64 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmarkHelpers.h"
+
+#include "GAThreading.h"
+#include "GameAnalytics/GameAnalytics.h"
+
+#include <filesystem>
+#include <future>
+
+namespace gameanalytics
+{
+    namespace benchmark
+    {
+        std::string makeWritablePath(std::string const& name)
+        {
+            std::filesystem::path p = std::filesystem::temp_directory_path() / "ga_benchmarks" / name;
+
+            std::error_code err;
+            std::filesystem::remove_all(p, err);
+            std::filesystem::create_directories(p, err);
+
+            return p.string();
+        }
+
+        void waitForGAThread()
+        {
+            // the worker runs blocks in order, so this one runs last
+            std::promise<void> done;
+            threading::GAThreading::performTaskOnGAThread([&done]()
+            {
+                done.set_value();
+            });
+
+            done.get_future().wait();
+        }
+
+        void initializeDefaultInstance(std::string const& name)
+        {
+            static std::once_flag initialized;
+            std::call_once(initialized, [&name]()
+            {
+                GameAnalytics::configureWritablePath(makeWritablePath(name));
+                GameAnalytics::initialize(BenchmarkGameKey, BenchmarkGameSecret);
+                waitForGAThread();
+            });
+        }
+
+        void runOnGAThread(std::function<void()> fn)
+        {
+            std::promise<void> done;
+            threading::GAThreading::performTaskOnGAThread([&done, &fn]()
+            {
+                fn();
+                done.set_value();
+            });
+
+            done.get_future().wait();
+        }
+    }
+}
@@ -0,0 +1,31 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+#include <functional>
+
+namespace gameanalytics
+{
+    namespace benchmark
+    {
+        // well formed keys, the collector rejects them (or is unreachable) so nothing leaves the machine
+        constexpr const char* BenchmarkGameKey    = "bd624ee6f8e6efb32a054f8d7ba11618";
+        constexpr const char* BenchmarkGameSecret = "7f5c3f682cbd217841efba92e92ffb1b3b6612a6";
+
+        // fresh writable directory for one benchmark run
+        std::string makeWritablePath(std::string const& name);
+
+        // blocks until everything queued on the GA thread so far has run
+        void waitForGAThread();
+
+        // initializes the default instance (static GameAnalytics API) once, with its files under 'name'
+        void initializeDefaultInstance(std::string const& name);
+
+        // runs 'fn' on the GA thread for the default instance and waits for it
+        void runOnGAThread(std::function<void()> fn);
+    }
+}
@@ -0,0 +1,59 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+
+#include "GAEventCodec.h"
+
+using gameanalytics::store::GAEventCodec;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int64_t Events = 100000;
+
+    // as the SDK serializes them, ids and timestamps vary per event
+    const std::string Samples[] =
+    {
+        R"({"category":"design","client_ts":1792357418,"connection_type":"wifi","current_session_length":36,"device":"unknown","event_id":"combat:kill:goblin","event_uuid":"aa2127a7-cb0a-4ff4-a9e1-063e33784068","lifetime_session_length":1346,"manufacturer":"unknown","os_version":"linux 6.18.44","platform":"linux","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2,"value":12.5})",
+        R"({"category":"session_end","client_ts":1792357418,"connection_type":"offline","current_session_length":36,"device":"unknown","event_uuid":"5150858b-e039-4beb-b5b6-108ec5cffb50","length":36,"lifetime_session_length":1346,"manufacturer":"unknown","os_version":"linux 6.18.44","platform":"linux","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2})",
+        R"({"amount":99,"build":"1.4.2","cart_type":"shop","category":"business","client_ts":1792357511,"connection_type":"wifi","currency":"USD","current_session_length":129,"custom_01":"ninja","device":"Pixel 7","engine_version":"unity 2022.3.1","event_id":"boost:super_boost","event_uuid":"0f3a6c1e-58d2-4c1b-9a57-3be1d0c4e2aa","lifetime_session_length":1439,"manufacturer":"Google","os_version":"android 14","platform":"android","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"transaction_num":3,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2})"
+    };
+}
+
+GA_BENCHMARK(EventCodec)
+{
+    std::vector<std::string> encoded;
+    encoded.reserve(Events);
+
+    int64_t jsonBytes   = 0;
+    int64_t storedBytes = 0;
+
+    auto encodes = ctx.measure([&]()
+    {
+        for (int64_t i = 0; i < Events; ++i)
+        {
+            std::string const& json = Samples[i % 3];
+            encoded.push_back(GAEventCodec::encode(json));
+            jsonBytes   += static_cast<int64_t>(json.size());
+            storedBytes += static_cast<int64_t>(encoded.back().size());
+        }
+    });
+    ctx.report("encode", Events, encodes);
+
+    std::string decoded;
+    auto decodes = ctx.measure([&]()
+    {
+        for (std::string const& stored : encoded)
+        {
+            GAEventCodec::decode(stored, decoded);
+        }
+    });
+    ctx.report("decode", Events, decodes);
+
+    ctx.report("json bytes per event", static_cast<double>(jsonBytes) / Events, "B");
+    ctx.report("stored bytes per event", static_cast<double>(storedBytes) / Events, "B");
+    ctx.report("compression ratio", static_cast<double>(jsonBytes) / static_cast<double>(storedBytes), "x");
+}
@@ -0,0 +1,246 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+#include "GABenchmarkHelpers.h"
+
+#include "GASqliteStore.h"
+#include "GAMemoryStore.h"
+#include "GASegmentStore.h"
+#include "GAStoreWriter.h"
+
+using namespace gameanalytics;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int64_t Events        = 20000;
+    constexpr int64_t StateWrites   = 5000;
+    constexpr int     BatchSize     = 500;
+    constexpr int     EventsPerPass = 100;
+
+    json makeEvent(int64_t n)
+    {
+        json ev;
+        ev["category"]                = "design";
+        ev["event_id"]                = "combat:kill:goblin";
+        ev["value"]                   = static_cast<double>(n % 100);
+        ev["client_ts"]               = 1792357418 + n;
+        ev["event_uuid"]              = "aa2127a7-cb0a-4ff4-a9e1-" + std::to_string(100000000000 + n);
+        ev["session_id"]              = "1292b594-ee05-4df2-ba52-22ae45cc9a00";
+        ev["user_id"]                 = "62376336-6335-3938-2d61-3463622d3638";
+        ev["session_num"]             = 15;
+        ev["sdk_version"]             = "cpp 5.1.0";
+        ev["os_version"]              = "linux 6.18.44";
+        ev["platform"]                = "linux";
+        ev["device"]                  = "unknown";
+        ev["manufacturer"]            = "unknown";
+        ev["connection_type"]         = "wifi";
+        ev["current_session_length"]  = n / 100;
+        ev["v"]                       = 2;
+        return ev;
+    }
+
+    // the same workload for every IEventStore: queue events the way the GA thread does (grouped per pass),
+    // drain them in request sized batches, then persist state
+    void runEventStore(BenchmarkContext& ctx, store::IEventStore& store)
+    {
+        std::vector<json> events;
+        events.reserve(Events);
+        for (int64_t i = 0; i < Events; ++i)
+        {
+            events.push_back(makeEvent(i));
+        }
+
+        auto appends = ctx.measure([&]()
+        {
+            for (int64_t i = 0; i < Events; i += EventsPerPass)
+            {
+                store.beginWrites();
+                for (int64_t j = i; j < i + EventsPerPass && j < Events; ++j)
+                {
+                    store.append("design", "1292b594-ee05-4df2-ba52-22ae45cc9a00", 1792357418 + j, events[j]);
+                }
+                store.endWrites();
+            }
+        });
+        ctx.report("append", Events, appends);
+        ctx.report("bytes per queued event", static_cast<double>(store.getStats().sizeBytes) / Events, "B");
+
+        int64_t drained = 0;
+        auto drains = ctx.measure([&]()
+        {
+            StringVector batch;
+            for (int request = 0; ; ++request)
+            {
+                batch.clear();
+                const std::string requestId = "req" + std::to_string(request);
+                if (!store.claimBatch(requestId, "", BatchSize, batch))
+                {
+                    break;
+                }
+
+                drained += static_cast<int64_t>(batch.size());
+                store.ackBatch(requestId);
+            }
+        });
+        ctx.report("claim + ack", drained, drains);
+
+        auto states = ctx.measure([&]()
+        {
+            for (int64_t i = 0; i < StateWrites; ++i)
+            {
+                store.setState("transaction_num", std::to_string(i));
+            }
+        });
+        ctx.report("state write", StateWrites, states);
+    }
+}
+
+GA_BENCHMARK(EventStoreSqlite)
+{
+    store::GASqliteStore store;
+    if (!store.open(makeWritablePath("EventStoreSqlite") + "/ga.sqlite3"))
+    {
+        return;
+    }
+
+    runEventStore(ctx, store);
+}
+
+GA_BENCHMARK(EventStoreMemory)
+{
+    store::GAMemoryStore store(static_cast<std::size_t>(Events));
+
+    runEventStore(ctx, store);
+}
+
+GA_BENCHMARK(EventStoreSegmentLog)
+{
+    // raw JSON takes more room than the compressed rows, the whole run has to fit
+    GAStoreSettings settings;
+    settings.maxSizeBytes = 64 * 1024 * 1024;
+
+    store::GASegmentStore store;
+    store.setSettings(settings);
+    if (!store.open(makeWritablePath("EventStoreSegmentLog")))
+    {
+        return;
+    }
+
+    runEventStore(ctx, store);
+}
+
+// the segment log with every pass of the GA thread flushed to the device
+GA_BENCHMARK(EventStoreSegmentLogSynced)
+{
+    GAStoreSettings settings;
+    settings.maxSizeBytes = 64 * 1024 * 1024;
+    settings.syncPolicy   = EGAStoreSyncPolicy::PerPass;
+
+    store::GASegmentStore store;
+    store.setSettings(settings);
+    if (!store.open(makeWritablePath("EventStoreSegmentLogSynced")))
+    {
+        return;
+    }
+
+    runEventStore(ctx, store);
+}
+
+// the insert path alone: already serialized events into ga_events and into the segment log
+GA_BENCHMARK(EventStoreTextInserts)
+{
+    std::vector<std::string> texts;
+    texts.reserve(Events);
+    for (int64_t i = 0; i < Events; ++i)
+    {
+        texts.push_back(makeEvent(i).dump());
+    }
+
+    GAStoreSettings settings;
+    settings.maxSizeBytes = 64 * 1024 * 1024;
+
+    store::GASqliteStore sqlite;
+    sqlite.setSettings(settings);
+    store::GASegmentStore log;
+    log.setSettings(settings);
+    if (!sqlite.open(makeWritablePath("EventStoreTextInserts") + "/ga.sqlite3") || !log.open(makeWritablePath("EventStoreTextInsertsLog")))
+    {
+        return;
+    }
+
+    auto insertAll = [&texts](auto& store)
+    {
+        for (int64_t i = 0; i < Events; i += EventsPerPass)
+        {
+            store.beginWrites();
+            for (int64_t j = i; j < i + EventsPerPass && j < Events; ++j)
+            {
+                store.appendText("design", "1292b594-ee05-4df2-ba52-22ae45cc9a00", 1792357418 + j, texts[j]);
+            }
+            store.endWrites();
+        }
+    };
+
+    auto sqliteInserts = ctx.measure([&]() { insertAll(sqlite); });
+    ctx.report("INSERT INTO ga_events", Events, sqliteInserts);
+
+    auto logInserts = ctx.measure([&]() { insertAll(log); });
+    ctx.report("segment log append", Events, logInserts);
+
+    ctx.report("segment log speedup", static_cast<double>(sqliteInserts.count()) / static_cast<double>(std::max<int64_t>(logInserts.count(), 1)), "x");
+}
+
+// events the GA thread builds one at a time: appended in passes as before, and through the store writer
+// (multi-row INSERTs, one transaction per batch)
+GA_BENCHMARK(EventStoreBatchedWrites)
+{
+    std::vector<json> events;
+    events.reserve(Events);
+    for (int64_t i = 0; i < Events; ++i)
+    {
+        events.push_back(makeEvent(i));
+    }
+
+    store::GASqliteStore direct;
+    store::GASqliteStore batched;
+    if (!direct.open(makeWritablePath("EventStoreDirectWrites") + "/ga.sqlite3") || !batched.open(makeWritablePath("EventStoreBatchedWrites") + "/ga.sqlite3"))
+    {
+        return;
+    }
+
+    auto directWrites = ctx.measure([&]()
+    {
+        for (int64_t i = 0; i < Events; i += EventsPerPass)
+        {
+            direct.beginWrites();
+            for (int64_t j = i; j < i + EventsPerPass && j < Events; ++j)
+            {
+                direct.append("design", "1292b594-ee05-4df2-ba52-22ae45cc9a00", 1792357418 + j, events[j]);
+            }
+            direct.endWrites();
+        }
+    });
+    ctx.report("append per event", Events, directWrites);
+
+    int64_t persisted = 0;
+    store::GAStoreWriter writer;
+    auto batchedWrites = ctx.measure([&]()
+    {
+        for (int64_t i = 0; i < Events; ++i)
+        {
+            if (writer.add({ "design", "1292b594-ee05-4df2-ba52-22ae45cc9a00", 1792357418 + i, events[i] }, [&persisted](bool stored) { persisted += stored ? 1 : 0; }))
+            {
+                writer.flush(batched);
+            }
+        }
+        writer.flush(batched);
+    });
+    ctx.report("store writer", Events, batchedWrites);
+    ctx.report("persisted callbacks", static_cast<double>(persisted), "events");
+
+    ctx.report("store writer speedup", static_cast<double>(directWrites.count()) / static_cast<double>(std::max<int64_t>(batchedWrites.count(), 1)), "x");
+}
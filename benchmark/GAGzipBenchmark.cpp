@@ -0,0 +1,70 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+
+#include "GAGzipEncoder.h"
+
+#include <chrono>
+
+using gameanalytics::utilities::GAGzipEncoder;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int Batches     = 200;
+    constexpr int BatchEvents = 100;
+
+    // as the SDK serializes them, ids and timestamps vary per event
+    const std::string Samples[] =
+    {
+        R"({"category":"design","client_ts":17923574%02d,"connection_type":"wifi","current_session_length":36,"device":"unknown","event_id":"combat:kill:goblin","event_uuid":"aa2127a7-cb0a-4ff4-a9e1-063e337840%02d","lifetime_session_length":1346,"manufacturer":"unknown","os_version":"linux 6.18.44","platform":"linux","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2,"value":12.5})",
+        R"({"category":"progression","client_ts":17923574%02d,"connection_type":"wifi","current_session_length":36,"device":"unknown","event_id":"Complete:world_01:stage_02","event_uuid":"5150858b-e039-4beb-b5b6-108ec5cffb%02d","lifetime_session_length":1346,"manufacturer":"unknown","os_version":"linux 6.18.44","platform":"linux","score":1200,"sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2})",
+        R"({"amount":99,"build":"1.4.2","cart_type":"shop","category":"business","client_ts":17923575%02d,"connection_type":"wifi","currency":"USD","current_session_length":129,"custom_01":"ninja","device":"Pixel 7","engine_version":"unity 2022.3.1","event_id":"boost:super_boost","event_uuid":"0f3a6c1e-58d2-4c1b-9a57-3be1d0c4e2%02d","lifetime_session_length":1439,"manufacturer":"Google","os_version":"android 14","platform":"android","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"transaction_num":3,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2})"
+    };
+
+    std::string eventBatch()
+    {
+        std::string batch = "[";
+        char event[1024];
+        for (int i = 0; i < BatchEvents; ++i)
+        {
+            std::snprintf(event, sizeof(event), Samples[i % 3].c_str(), i, (i * 37) % 100);
+            batch += (i ? "," : "");
+            batch += event;
+        }
+        batch += "]";
+        return batch;
+    }
+}
+
+// what gzipping an upload of 100 events costs and saves at each level, one encoder and output buffer
+// reused across batches as the SDK does
+GA_BENCHMARK(GzipLevels)
+{
+    const std::string batch = eventBatch();
+
+    GAGzipEncoder        encoder;
+    std::vector<uint8_t> out;
+
+    for (int level = 1; level <= 9; ++level)
+    {
+        encoder.setLevel(level);
+
+        auto elapsed = ctx.measure([&]()
+        {
+            for (int i = 0; i < Batches; ++i)
+            {
+                encoder.encode(batch.data(), batch.size(), out);
+            }
+        });
+
+        const std::string name = "level " + std::to_string(level);
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        ctx.report(name + ", batch of 100 events", Batches, elapsed);
+        ctx.report(name + ", throughput", static_cast<double>(batch.size()) * Batches / seconds / (1024.0 * 1024.0), "MB/s");
+        ctx.report(name + ", compression ratio", static_cast<double>(batch.size()) / static_cast<double>(out.size()), "x");
+    }
+}
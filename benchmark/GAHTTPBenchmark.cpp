@@ -0,0 +1,348 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+
+#if !defined(_WIN32)
+
+#include "GAHTTPClient.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using gameanalytics::http::GAHTTPClient;
+using gameanalytics::GAHTTPResponse;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int         Requests    = 300;
+    constexpr std::size_t PayloadSize = 1500;    // a gzipped batch of a few dozen events
+
+    constexpr const char* Response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}";
+
+    // a stand-in for the collector on 127.0.0.1: TLS with a throwaway self-signed certificate, keep-alive
+    // HTTP/1.1 and a fixed answer, so a request costs what the client spends on connections and handshakes
+    class LocalTLSServer
+    {
+     public:
+
+        LocalTLSServer()
+        {
+            EVP_PKEY_CTX* keyCtx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+            EVP_PKEY_keygen_init(keyCtx);
+            EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyCtx, NID_X9_62_prime256v1);
+            EVP_PKEY* key = nullptr;
+            EVP_PKEY_keygen(keyCtx, &key);
+            EVP_PKEY_CTX_free(keyCtx);
+
+            X509* cert = X509_new();
+            X509_set_version(cert, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+            X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+            X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+            X509_set_pubkey(cert, key);
+
+            X509_NAME* name = X509_get_subject_name(cert);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+            X509_set_issuer_name(cert, name);
+
+            char altName[] = "IP:127.0.0.1";
+            X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, nullptr, NID_subject_alt_name, altName);
+            X509_add_ext(cert, ext, -1);
+            X509_EXTENSION_free(ext);
+            X509_sign(cert, key, EVP_sha256());
+
+            _ctx = SSL_CTX_new(TLS_server_method());
+            SSL_CTX_use_certificate(_ctx, cert);
+            SSL_CTX_use_PrivateKey(_ctx, key);
+            X509_free(cert);
+            EVP_PKEY_free(key);
+
+            _listener = socket(AF_INET, SOCK_STREAM, 0);
+            const int yes = 1;
+            setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+            sockaddr_in addr = {};
+            addr.sin_family      = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port        = 0;
+            bind(_listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            listen(_listener, 64);
+
+            socklen_t length = sizeof(addr);
+            getsockname(_listener, reinterpret_cast<sockaddr*>(&addr), &length);
+            _port = ntohs(addr.sin_port);
+
+            _acceptor = std::thread([this]() { acceptLoop(); });
+        }
+
+        ~LocalTLSServer()
+        {
+            _stopping = true;
+            shutdown(_listener, SHUT_RDWR);
+            close(_listener);
+            _acceptor.join();
+
+            {
+                std::lock_guard<std::mutex> lock(_connectionsMutex);
+                for (int fd : _sockets)
+                {
+                    shutdown(fd, SHUT_RDWR);
+                }
+            }
+
+            for (std::thread& connection : _connections)
+            {
+                connection.join();
+            }
+
+            SSL_CTX_free(_ctx);
+        }
+
+        std::string url() const
+        {
+            return "https://127.0.0.1:" + std::to_string(_port) + "/v2/events";
+        }
+
+        // TCP connections (and full TLS handshakes or resumptions) served so far
+        int64_t connections() const
+        {
+            return _accepted;
+        }
+
+     private:
+
+        void acceptLoop()
+        {
+            while (!_stopping)
+            {
+                const int fd = accept(_listener, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    continue;
+                }
+
+                ++_accepted;
+
+                // as a collector would, or small writes wait out delayed acks
+                const int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                std::lock_guard<std::mutex> lock(_connectionsMutex);
+                _sockets.push_back(fd);
+                _connections.emplace_back([this, fd]() { serve(fd); });
+            }
+        }
+
+        void serve(int fd)
+        {
+            SSL* ssl = SSL_new(_ctx);
+            SSL_set_fd(ssl, fd);
+
+            if (SSL_accept(ssl) == 1)
+            {
+                std::string buffer;
+                char        chunk[16384];
+
+                for (bool open = true; open;)
+                {
+                    std::size_t headerEnd = std::string::npos;
+                    while (open && (headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+                    {
+                        open = read(ssl, chunk, sizeof(chunk), buffer);
+                    }
+
+                    if (!open)
+                    {
+                        break;
+                    }
+
+                    const std::string head = buffer.substr(0, headerEnd);
+                    if (head.find("Expect: 100-continue") != std::string::npos)
+                    {
+                        const char continued[] = "HTTP/1.1 100 Continue\r\n\r\n";
+                        SSL_write(ssl, continued, static_cast<int>(sizeof(continued) - 1));
+                    }
+
+                    std::size_t bodyLength = 0;
+                    const std::size_t field = head.find("Content-Length:");
+                    if (field != std::string::npos)
+                    {
+                        bodyLength = static_cast<std::size_t>(std::strtoull(head.c_str() + field + std::strlen("Content-Length:"), nullptr, 10));
+                    }
+
+                    const std::size_t requestEnd = headerEnd + 4 + bodyLength;
+                    while (open && buffer.size() < requestEnd)
+                    {
+                        open = read(ssl, chunk, sizeof(chunk), buffer);
+                    }
+
+                    if (open)
+                    {
+                        buffer.erase(0, requestEnd);
+                        open = SSL_write(ssl, Response, static_cast<int>(std::strlen(Response))) > 0;
+                    }
+                }
+            }
+
+            SSL_free(ssl);
+            close(fd);
+        }
+
+        static bool read(SSL* ssl, char* chunk, int size, std::string& buffer)
+        {
+            const int n = SSL_read(ssl, chunk, size);
+            if (n <= 0)
+            {
+                return false;
+            }
+
+            buffer.append(chunk, static_cast<std::size_t>(n));
+            return true;
+        }
+
+        SSL_CTX*          _ctx      = nullptr;
+        int               _listener = -1;
+        int               _port     = 0;
+        std::atomic<bool> _stopping{false};
+        std::atomic<int64_t> _accepted{0};
+        std::thread       _acceptor;
+
+        std::mutex               _connectionsMutex;
+        std::vector<int>         _sockets;
+        std::vector<std::thread> _connections;
+    };
+
+    std::vector<std::string> requestHeaders()
+    {
+        return { "Content-Encoding: gzip", "Authorization: 0123456789abcdef0123456789abcdef0123456789a=", "Content-Type: application/json" };
+    }
+
+    size_t discard(void*, size_t size, size_t nmemb, void*)
+    {
+        return size * nmemb;
+    }
+
+    // what every upload did before: a handle of its own, set up and torn down around the request
+    long postWithFreshHandle(std::string const& url, std::vector<uint8_t> const& payload)
+    {
+        CURL* curl = curl_easy_init();
+
+        curl_slist* header = nullptr;
+        for (std::string const& line : requestHeaders())
+        {
+            header = curl_slist_append(header, line.c_str());
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.data());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload.size()));
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+
+        long statusCode = 0;
+        if (curl_easy_perform(curl) == CURLE_OK)
+        {
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+        }
+
+        curl_easy_cleanup(curl);
+        curl_slist_free_all(header);
+        return statusCode;
+    }
+
+    void reportRequests(BenchmarkContext& ctx, std::string const& label, LocalTLSServer const& server, BenchmarkContext::Clock::duration elapsed, int ok)
+    {
+        ctx.report(label, Requests, elapsed);
+        ctx.report(label + ", answered", static_cast<double>(ok), "requests");
+        ctx.report(label + ", connections", static_cast<double>(server.connections()), "connections");
+    }
+}
+
+// one upload after another to a TLS collector on the loopback interface
+GA_BENCHMARK(HTTPFreshHandlePerRequest)
+{
+    LocalTLSServer server;
+    const std::string          url = server.url();
+    const std::vector<uint8_t> payload(PayloadSize, 'x');
+
+    int ok = 0;
+    auto elapsed = ctx.measure([&]()
+    {
+        for (int i = 0; i < Requests; ++i)
+        {
+            ok += postWithFreshHandle(url, payload) == 200 ? 1 : 0;
+        }
+    });
+
+    reportRequests(ctx, "POST, new handle per request", server, elapsed, ok);
+}
+
+GA_BENCHMARK(HTTPPersistentClient)
+{
+    LocalTLSServer server;
+    const std::string          url = server.url();
+    const auto                 payload = std::make_shared<const std::vector<uint8_t>>(PayloadSize, 'x');
+
+    int ok = 0;
+    {
+        GAHTTPClient client;
+        auto elapsed = ctx.measure([&]()
+        {
+            for (int i = 0; i < Requests; ++i)
+            {
+                ok += client.post(url, requestHeaders(), payload).statusCode == 200 ? 1 : 0;
+            }
+        });
+
+        reportRequests(ctx, "POST, GAHTTPClient", server, elapsed, ok);
+    }
+}
+
+// the same uploads all handed to the engine at once, they share up to MaxHostConnections connections
+GA_BENCHMARK(HTTPEngineConcurrentRequests)
+{
+    LocalTLSServer server;
+    const std::string          url = server.url();
+    const auto                 payload = std::make_shared<const std::vector<uint8_t>>(PayloadSize, 'x');
+
+    int ok = 0;
+    {
+        GAHTTPClient client;
+        auto elapsed = ctx.measure([&]()
+        {
+            std::vector<std::future<GAHTTPResponse>> pending;
+            pending.reserve(Requests);
+            for (int i = 0; i < Requests; ++i)
+            {
+                pending.push_back(client.postAsync(url, requestHeaders(), payload));
+            }
+
+            for (auto& result : pending)
+            {
+                ok += result.get().statusCode == 200 ? 1 : 0;
+            }
+        });
+
+        reportRequests(ctx, "POST, all submitted at once", server, elapsed, ok);
+    }
+}
+
+#endif
@@ -0,0 +1,125 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+#include "GABenchmarkHelpers.h"
+
+#include "GameAnalytics/GameAnalyticsInstance.h"
+
+using gameanalytics::EGAStoreBackend;
+using gameanalytics::GAUser;
+using gameanalytics::GameAnalyticsInstance;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr std::size_t Users  = 5000;
+    constexpr int64_t     Events = 200000;
+
+    std::vector<GAUser> makeUsers(std::size_t count)
+    {
+        std::vector<GAUser> users;
+        users.reserve(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            users.emplace_back("player_" + std::to_string(i));
+        }
+
+        return users;
+    }
+
+    // the memory store shows the cost of building events, the default SQLite store what a server gets
+    void setupServer(GameAnalyticsInstance& ga, std::size_t maxResidentUsers, EGAStoreBackend backend)
+    {
+        ga.configureWritablePath(makeWritablePath(ga.getName()));
+        ga.configureStoreBackend(backend);
+        if (backend == EGAStoreBackend::Memory)
+        {
+            ga.configureMemoryStoreCapacity(static_cast<std::size_t>(Events) + Users * 4);
+        }
+        ga.configureServerMode(true);
+        ga.configureMaxResidentUsers(maxResidentUsers);
+        ga.initialize(BenchmarkGameKey, BenchmarkGameSecret);
+
+        waitForGAThread();
+    }
+
+    // 5k players, all sessions resident: events are enqueued from the game thread and
+    // built/stored on the GA thread, the figure covers both ends
+    void runResidentPlayers(BenchmarkContext& ctx, std::string const& name, EGAStoreBackend backend, std::string const& store)
+    {
+        GameAnalyticsInstance ga(name);
+        setupServer(ga, Users, backend);
+
+        const std::vector<GAUser> users = makeUsers(Users);
+
+        auto sessions = ctx.measure([&]()
+        {
+            for (GAUser const& user : users)
+            {
+                ga.startUserSession(user);
+            }
+            waitForGAThread();
+        });
+        ctx.report("start user sessions, " + store, static_cast<int64_t>(Users), sessions);
+
+        auto events = ctx.measure([&]()
+        {
+            for (int64_t i = 0; i < Events; ++i)
+            {
+                ga.addDesignEvent(users[static_cast<std::size_t>(i) % Users], "combat:kill:goblin", static_cast<double>(i));
+            }
+            waitForGAThread();
+        });
+        ctx.report("design events, 5k resident players, " + store, Events, events);
+
+        auto ends = ctx.measure([&]()
+        {
+            for (GAUser const& user : users)
+            {
+                ga.endUserSession(user);
+            }
+            waitForGAThread();
+        });
+        ctx.report("end user sessions, " + store, static_cast<int64_t>(Users), ends);
+    }
+}
+
+GA_BENCHMARK(ServerModeDesignEvents)
+{
+    runResidentPlayers(ctx, "bench_server_resident", EGAStoreBackend::Memory, "memory store");
+}
+
+GA_BENCHMARK(ServerModeDesignEventsSqlite)
+{
+    runResidentPlayers(ctx, "bench_server_resident_sqlite", EGAStoreBackend::Sqlite, "sqlite store");
+}
+
+// only 1k sessions fit in memory: round robin over 5k players misses the LRU on every event
+GA_BENCHMARK(ServerModeDesignEventsWithSpill)
+{
+    GameAnalyticsInstance ga("bench_server_spill");
+    setupServer(ga, 1000, EGAStoreBackend::Memory);
+
+    const std::vector<GAUser> users = makeUsers(Users);
+    for (GAUser const& user : users)
+    {
+        ga.startUserSession(user);
+    }
+    waitForGAThread();
+
+    constexpr int64_t SpillEvents = Events / 10;
+
+    auto events = ctx.measure([&]()
+    {
+        for (int64_t i = 0; i < SpillEvents; ++i)
+        {
+            ga.addDesignEvent(users[static_cast<std::size_t>(i) % Users], "combat:kill:goblin", static_cast<double>(i));
+        }
+        waitForGAThread();
+    });
+    ctx.report("design events, 1k of 5k players resident, memory store", SpillEvents, events);
+}
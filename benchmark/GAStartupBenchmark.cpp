@@ -0,0 +1,64 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+#include "GABenchmarkHelpers.h"
+
+#include "GameAnalytics/GameAnalyticsInstance.h"
+
+using gameanalytics::GameAnalyticsInstance;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int64_t Backlog = 20000;
+
+    // from initialize() until the first event is in the store (or its writer): everything initialize
+    // queues on the GA thread runs before the event
+    void reportFirstEvent(BenchmarkContext& ctx, GameAnalyticsInstance& ga, std::string const& label)
+    {
+        auto firstEvent = ctx.measure([&ga]()
+        {
+            ga.initialize(BenchmarkGameKey, BenchmarkGameSecret);
+            ga.addDesignEvent("startup:first_event");
+            waitForGAThread();
+        });
+        ctx.report(label, 1, firstEvent);
+
+        // the session start event and the design event
+        const gameanalytics::GAQueueStats stats = ga.getQueueStats();
+        ctx.report(label + ", events accepted", static_cast<double>(stats.queuedEvents + stats.pendingWrites), "events");
+    }
+}
+
+// a first run: the database is created, no config is cached
+GA_BENCHMARK(StartupColdFirstEvent)
+{
+    GameAnalyticsInstance ga("bench_startup_cold");
+    ga.configureWritablePath(makeWritablePath(ga.getName()));
+
+    reportFirstEvent(ctx, ga, "time to first accepted event, new database");
+}
+
+// a later run: the database is at the current schema version and holds an offline backlog
+GA_BENCHMARK(StartupWarmFirstEvent)
+{
+    const std::string path = makeWritablePath("bench_startup_warm");
+    {
+        GameAnalyticsInstance ga("bench_startup_warm");
+        ga.configureWritablePath(path);
+        ga.initialize(BenchmarkGameKey, BenchmarkGameSecret);
+        for (int64_t i = 0; i < Backlog; ++i)
+        {
+            ga.addDesignEvent("startup:backlog", static_cast<double>(i));
+        }
+        waitForGAThread();
+    }
+
+    GameAnalyticsInstance ga("bench_startup_warm");
+    ga.configureWritablePath(path);
+
+    reportFirstEvent(ctx, ga, "time to first accepted event, 20k events queued");
+}
@@ -0,0 +1,221 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+#include "GABenchmarkHelpers.h"
+
+#include "GAStore.h"
+#include "GameAnalytics/GameAnalytics.h"
+
+using namespace gameanalytics;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int64_t Inserts = 5000;
+
+    const std::string EventPayload = R"({"category":"design","event_id":"combat:kill:goblin","value":1,"v":2,"user_id":"bench","session_num":1})";
+}
+
+// sqlite backend, every statement goes through executeQuerySync like the SDK does
+GA_BENCHMARK(StoreInserts)
+{
+    initializeDefaultInstance("bench_store");
+
+    runOnGAThread([&ctx]()
+    {
+        // blocks on the GA thread group their writes, close that group to time single commits
+        store::GAStore::endGroupCommit();
+
+        auto inserts = ctx.measure([]()
+        {
+            for (int64_t i = 0; i < Inserts; ++i)
+            {
+                store::GAStore::addEvent("design", "bench-session", i, EventPayload);
+            }
+        });
+        ctx.report("ga_events inserts, one commit each", Inserts, inserts);
+
+        auto grouped = ctx.measure([]()
+        {
+            store::GAStore::beginGroupCommit();
+            for (int64_t i = 0; i < Inserts; ++i)
+            {
+                store::GAStore::addEvent("design", "bench-session", i, EventPayload);
+            }
+            store::GAStore::endGroupCommit();
+        });
+        ctx.report("ga_events inserts, group commit", Inserts, grouped);
+
+        // runs once for every event that is added
+        bool tooLarge = false;
+        auto sizeChecks = ctx.measure([&tooLarge]()
+        {
+            for (int64_t i = 0; i < Inserts * 100; ++i)
+            {
+                tooLarge = store::GAStore::isDbTooLargeForEvents() || tooLarge;
+            }
+        });
+        ctx.report("database size checks", Inserts * 100, sizeChecks);
+
+        auto upserts = ctx.measure([]()
+        {
+            for (int64_t i = 0; i < Inserts; ++i)
+            {
+                store::GAStore::setState("bench_key", std::to_string(i));
+            }
+        });
+        ctx.report("ga_state upserts", Inserts, upserts);
+
+        auto selects = ctx.measure([]()
+        {
+            for (int64_t i = 0; i < Inserts; ++i)
+            {
+                json result;
+                store::GAStore::executeQuerySync("SELECT value FROM ga_state WHERE key = ?;", { "bench_key" }, result);
+            }
+        });
+        ctx.report("ga_state point selects (json rows)", Inserts, selects);
+
+        auto typedSelects = ctx.measure([]()
+        {
+            for (int64_t i = 0; i < Inserts; ++i)
+            {
+                int64_t value = 0;
+                store::GAStore::executeQuery("SELECT value FROM ga_state WHERE key = ?;", { "bench_key" },
+                    [&value](store::GAStore::Row const& row)
+                    {
+                        value = row.getInt64(0);
+                    });
+            }
+        });
+        ctx.report("ga_state point selects (typed rows)", Inserts, typedSelects);
+
+        store::GAStore::executeQuerySync("DELETE FROM ga_events;");
+    });
+}
+
+// a device that stayed offline for a while: 100k queued rows, drained in batches of 500
+// (the claim, the batch select and the delete each have to find their rows through an index)
+GA_BENCHMARK(StoreBacklog)
+{
+    constexpr int64_t Backlog   = 100000;
+    constexpr int     BatchSize = 500;
+
+    initializeDefaultInstance("bench_store");
+
+    runOnGAThread([&ctx]()
+    {
+        store::GAStore::endGroupCommit();
+
+        // the whole backlog has to fit, the default quota would evict most of it
+        GAStoreSettings settings;
+        settings.maxSizeBytes = 64 * 1024 * 1024;
+        store::GAStore::setSettings(settings);
+
+        auto fill = ctx.measure([]()
+        {
+            store::GAStore::beginGroupCommit();
+            for (int64_t i = 0; i < Backlog; ++i)
+            {
+                store::GAStore::addEvent(i % 10 == 0 ? "business" : "design", "bench-session-" + std::to_string(i / 1000), 1700000000 + i, EventPayload);
+            }
+            store::GAStore::endGroupCommit();
+        });
+        ctx.report("backlog inserts, group commit", Backlog, fill);
+
+        auto categoryClaims = ctx.measure([]()
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                StringVector out;
+                store::GAStore::claimEvents("bench-category-" + std::to_string(i), "business", BatchSize, out);
+                store::GAStore::putBackEvents("bench-category-" + std::to_string(i));
+            }
+        });
+        ctx.report("claim + put back 500 business events of the backlog", 20, categoryClaims);
+
+        int64_t drained = 0;
+        auto drain = ctx.measure([&drained]()
+        {
+            for (int i = 0; ; ++i)
+            {
+                StringVector out;
+                const std::string requestId = "bench-request-" + std::to_string(i);
+                if (!store::GAStore::claimEvents(requestId, "", BatchSize, out))
+                {
+                    break;
+                }
+
+                store::GAStore::deleteEvents(requestId);
+                drained += static_cast<int64_t>(out.size());
+            }
+        });
+        ctx.report("drain backlog, claim + delete per event", drained, drain);
+
+        store::GAStore::setSettings(GAStoreSettings());
+
+        // give the pages back so later runs start below the size limit
+        store::GAStore::executeQuerySync("VACUUM");
+    });
+}
+
+// an offline device at its quota: every insert past it is paid for by evicting older design events
+GA_BENCHMARK(StoreEviction)
+{
+    constexpr int64_t Events = 50000;
+
+    initializeDefaultInstance("bench_store");
+
+    runOnGAThread([&ctx]()
+    {
+        auto inserts = ctx.measure([]()
+        {
+            store::GAStore::beginGroupCommit();
+            for (int64_t i = 0; i < Events; ++i)
+            {
+                store::GAStore::addEvent("design", "bench-session", 1700000000 + i, EventPayload);
+            }
+            store::GAStore::endGroupCommit();
+        });
+        ctx.report("inserts at a 6MB quota, evicting", Events, inserts);
+
+        store::GAStore::executeQuerySync("DELETE FROM ga_events;");
+        store::GAStore::runMaintenance();
+    });
+}
+
+// the public API end to end with the sqlite backend: queue, build, insert
+// (kept below the database size limit, past it events are dropped)
+GA_BENCHMARK(StoreDesignEvents)
+{
+    constexpr int64_t Events = 5000;
+
+    initializeDefaultInstance("bench_store");
+
+    auto events = ctx.measure([]()
+    {
+        for (int64_t i = 0; i < Events; ++i)
+        {
+            GameAnalytics::addDesignEvent("combat:kill:goblin", static_cast<double>(i));
+        }
+        waitForGAThread();
+    });
+    ctx.report("design events, sqlite store", Events, events);
+
+    runOnGAThread([&ctx]()
+    {
+        // the event column only, the session annotations are stored once per session
+        double stored = 0;
+        store::GAStore::executeQuery("SELECT AVG(LENGTH(event)) FROM ga_events;", {},
+            [&stored](store::GAStore::Row const& row)
+            {
+                stored = row.getDouble(0);
+            });
+        ctx.report("stored bytes per design event", stored, "B");
+
+        store::GAStore::executeQuerySync("DELETE FROM ga_events;");
+    });
+}
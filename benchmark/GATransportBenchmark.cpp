@@ -0,0 +1,116 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+
+#include "GAHTTPClient.h"
+#include "GALoopbackTransport.h"
+#include "GAPayloadWriter.h"
+#include "GAUtilities.h"
+
+using gameanalytics::GAHTTPResponse;
+using gameanalytics::http::GAHTTPClient;
+using gameanalytics::http::GALoopbackTransport;
+using gameanalytics::http::GAPayload;
+using gameanalytics::http::GAPayloadWriter;
+using gameanalytics::utilities::GAUtilities;
+using gameanalytics::json;
+using namespace gameanalytics::benchmark;
+
+namespace
+{
+    constexpr int         Requests     = 2000;
+    constexpr int         BatchEvents  = 100;
+    constexpr const char* SecretKey    = "7f5c3f682cbd217841efba92e92ffb1b3b6612a6";
+
+    constexpr const char* Event = R"({"category":"design","client_ts":1792357418,"connection_type":"wifi","event_id":"combat:kill:goblin","platform":"linux","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2,"value":12.5})";
+}
+
+// what an upload costs in the SDK with the network taken out: the events serialized, gzipped and signed in one
+// pass, then a trip through the client to a loopback transport that answers like the collector
+GA_BENCHMARK(TransportLoopbackUploads)
+{
+    const json event = json::parse(Event);
+
+    auto transport = std::make_shared<GALoopbackTransport>();
+    GAHTTPClient client;
+    client.setTransport(transport);
+
+    int ok = 0;
+    auto elapsed = ctx.measure([&]()
+    {
+        for (int i = 0; i < Requests; ++i)
+        {
+            GAPayloadWriter writer(true, SecretKey);
+            writer.write("[", 1);
+            for (int e = 0; e < BatchEvents; ++e)
+            {
+                if (e > 0)
+                {
+                    writer.write(",", 1);
+                }
+                writer.write(event);
+            }
+            writer.write("]", 1);
+
+            GAPayload payload;
+            writer.finish(payload);
+
+            std::vector<std::string> headers = { "Content-Encoding: gzip", "Authorization: " + payload.authorization, "Content-Type: application/json" };
+            ok += client.post("https://api.gameanalytics.com/v2/bd624ee6f8e6efb32a054f8d7ba11618/events", headers, payload.body).statusCode == 200 ? 1 : 0;
+        }
+    });
+
+    ctx.report("upload of 100 events, loopback transport", Requests, elapsed);
+    ctx.report("upload of 100 events, answered", static_cast<double>(ok), "requests");
+    ctx.report("upload of 100 events, bytes sent", static_cast<double>(transport->bytesSent()) / Requests, "bytes/request");
+}
+
+// building the body of a batch of 100 events: the whole JSON text, then a gzipped copy, then the HMAC over it,
+// against serializing, compressing and signing in one pass
+GA_BENCHMARK(TransportPayloadBuild)
+{
+    json batch = json::array();
+    for (int i = 0; i < BatchEvents; ++i)
+    {
+        batch.push_back(json::parse(Event));
+    }
+
+    std::size_t held = 0;
+    auto separate = ctx.measure([&]()
+    {
+        for (int i = 0; i < Requests; ++i)
+        {
+            const std::string text = batch.dump();
+            std::vector<uint8_t> compressed;
+            GAUtilities::gzipCompress(text.data(), text.size(), compressed);
+
+            std::vector<uint8_t> authorization;
+            GAUtilities::hmacWithKey(SecretKey, compressed, authorization);
+
+            // and the copy handed to the transport
+            const std::vector<uint8_t> body = compressed;
+            held = text.size() + compressed.size() + body.size();
+        }
+    });
+    ctx.report("dump, gzip, sign", Requests, separate);
+    ctx.report("dump, gzip, sign, bytes held", static_cast<double>(held), "bytes");
+
+    std::size_t compressed = 0;
+    auto streamed = ctx.measure([&]()
+    {
+        for (int i = 0; i < Requests; ++i)
+        {
+            GAPayloadWriter writer(true, SecretKey);
+            writer.write(batch);
+
+            GAPayload payload;
+            writer.finish(payload);
+            compressed = payload.body->size();
+        }
+    });
+    ctx.report("one pass", Requests, streamed);
+    ctx.report("one pass, bytes held", static_cast<double>(compressed), "bytes");
+}
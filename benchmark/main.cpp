@@ -0,0 +1,13 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GABenchmark.h"
+
+// usage: GameAnalyticsBenchmarks [name filter]
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+    return gameanalytics::benchmark::runBenchmarks(filter);
+}
@@ -8,6 +8,7 @@
 #include <utility>
 #include <cstring>
 #include <array>
+#include <map>
 #include <functional>
 
 namespace gameanalytics
@@ -73,6 +74,156 @@ namespace gameanalytics
         LogVerbose  = 4
     };
 
+    /*!
+     @enum
+     @discussion
+     this enum is used to select where queued events are kept until they are sent
+     @constant Sqlite
+     Events are persisted in a SQLite database inside the writable path (default)
+     @constant Memory
+     Events are kept in a fixed capacity in-memory ring buffer, nothing is written to disk
+     @constant SegmentLog
+     Events are appended to memory mapped segment files inside the writable path, whole segments are deleted once sent
+     */
+    enum class EGAStoreBackend
+    {
+        Sqlite = 0,
+        Memory = 1,
+        SegmentLog = 2
+    };
+
+    /*!
+     @enum
+     @discussion
+     this enum is used to choose when the segment log store forces its writes to the device
+     @constant None
+     Writes are left to the operating system, they survive a crash of the process but not of the device (default)
+     @constant PerPass
+     Writes are flushed once per pass of the SDK thread
+     @constant Always
+     Every stored event is flushed before the call returns
+     */
+    enum class EGAStoreSyncPolicy
+    {
+        None = 0,
+        PerPass = 1,
+        Always = 2
+    };
+
+    /*!
+     @enum
+     @discussion
+     this enum is used to choose where SQLite keeps temporary tables and indices
+     @constant Default
+     SQLite's compile time default
+     @constant File
+     Temporary data goes to files
+     @constant Memory
+     Temporary data stays in memory
+     */
+    enum class EGAStoreTempStore
+    {
+        Default = 0,
+        File = 1,
+        Memory = 2
+    };
+
+    /*!
+     @struct
+     @discussion
+     tuning of the event store, applied when the store is opened
+     */
+    struct GAStoreSettings
+    {
+        // page cache of the connection in KiB (PRAGMA cache_size)
+        int64_t cacheSizeKiB = 2000;
+
+        // bytes of the database file accessed through memory mapped I/O, 0 turns it off (PRAGMA mmap_size)
+        int64_t mmapSizeBytes = 0;
+
+        EGAStoreTempStore tempStore = EGAStoreTempStore::Default;
+
+        // byte quota of the database, past it the oldest queued events are evicted
+        // (lowest retention categories first, session and business events last)
+        int64_t maxSizeBytes = 6291456;
+
+        // size of one file of the segment log store, events larger than a segment are dropped
+        int64_t segmentSizeBytes = 1048576;
+
+        EGAStoreSyncPolicy syncPolicy = EGAStoreSyncPolicy::None;
+
+        // built events are written in batches: a batch goes to the store once it holds writeBatchEvents
+        // events or about writeBatchBytes bytes of JSON, or its oldest event has waited writeDelayMs;
+        // 1 event writes every event right away
+        int     writeBatchEvents = 100;
+        int64_t writeBatchBytes  = 65536;
+        int     writeDelayMs     = 250;
+    };
+
+    /*!
+     @struct
+     @discussion
+     where requests are sent, e.g. an ingestion proxy or a local collector (see mock_collector/)
+     */
+    struct GAEndpointSettings
+    {
+        // scheme and host, with a port if needed ("http://127.0.0.1:8080"); the paths below are appended to it
+        std::string baseUrl = "https://api.gameanalytics.com";
+
+        // path of the init call, its query parameters are appended
+        std::string initPath = "/remote_configs/v1/init";
+
+        // path events are posted to, "{game_key}" is replaced with the game key
+        std::string eventsPath = "/v2/{game_key}/events";
+    };
+
+    /*!
+     @struct
+     @discussion
+     state of the event queue as returned by GameAnalytics::getQueueStats, kept in memory by the store
+     (reading it runs no query)
+     */
+    struct GAQueueStats
+    {
+        // stored and waiting to be sent
+        int64_t queuedEvents = 0;
+
+        // claimed by requests that were not answered yet
+        int64_t inFlightEvents = 0;
+
+        // built but still held by the store writer
+        int64_t pendingWrites = 0;
+
+        // bytes used by the store (queued events and state)
+        int64_t sizeBytes = 0;
+
+        // seconds since the client_ts of the oldest event not sent yet, 0 if there is none
+        int64_t oldestEventAgeSeconds = 0;
+
+        // evicted to keep the store within GAStoreSettings::maxSizeBytes
+        int64_t evictedEvents = 0;
+
+        // lost before they were stored: blocked while the store was too large, too large for
+        // the store or in a batch the store failed to write
+        int64_t droppedEvents = 0;
+
+        // stored events (queued and in flight) and their bytes on disk (or in memory) by category
+        std::map<std::string, int64_t> eventsByCategory;
+        std::map<std::string, int64_t> bytesByCategory;
+    };
+
+    /*!
+     @struct
+     @discussion
+     identifies the player an event is sent for when the SDK runs in server mode
+     */
+    struct GAUser
+    {
+        explicit GAUser(std::string userId): id(std::move(userId)) {}
+
+        std::string id;
+    };
+
     using StringVector = std::vector<std::string>;
 
     using LogHandler = std::function<void(std::string const&, EGALoggerMessageType)>;
@@ -82,4 +233,52 @@ namespace gameanalytics
     {
         virtual void onRemoteConfigsUpdated(std::string const& remoteConfigs) = 0;
     };
+
+    /*!
+     @discussion
+     the body of a request, shared rather than copied: the SDK keeps an upload that got no answer to send it again
+     */
+    using GAHTTPBody = std::shared_ptr<const std::vector<uint8_t>>;
+
+    /*!
+     @struct
+     @discussion
+     a POST the SDK wants sent, see ITransport
+     */
+    struct GAHTTPRequest
+    {
+        std::string              url;
+        std::vector<std::string> headers;    // "Name: value"
+        GAHTTPBody               body;       // sent as is (gzipped JSON in release builds), never null
+    };
+
+    /*!
+     @struct
+     @discussion
+     the outcome of a GAHTTPRequest: the status code and body of the answer, or status code 0 and
+     the reason in error when there was none (no connection, timeout)
+     */
+    struct GAHTTPResponse
+    {
+        long        statusCode = 0;
+        std::string body;
+        std::string error;
+        bool        truncated  = false;     // body holds only the start of the answer
+    };
+
+    using GAHTTPCompletion = std::function<void(GAHTTPResponse&&)>;
+
+    /*!
+     @discussion
+     sends the requests of the SDK, libcurl unless another transport is set with GameAnalytics::configureTransport
+     (e.g. the HTTP stack of an engine)
+     */
+    struct ITransport
+    {
+        virtual ~ITransport() = default;
+
+        // sends 'request' and calls 'onDone' exactly once with the outcome, from any thread (also from
+        // within send); several requests may be in flight at once
+        virtual void send(GAHTTPRequest&& request, GAHTTPCompletion&& onDone) = 0;
+    };
 }
@@ -44,6 +44,64 @@ namespace gameanalytics
 
          static void configureBuild(std::string const& build);
          static void configureWritablePath(std::string const& writablePath);
+
+         /**
+          * @brief: selects where queued events are kept, needs to be called before initialization
+          *
+          * @param backend: EGAStoreBackend::Memory keeps events in a fixed capacity ring buffer and never touches the disk
+          *                 EGAStoreBackend::SegmentLog appends events to memory mapped segment files instead of the SQLite database
+          */
+         static void configureStoreBackend(EGAStoreBackend backend);
+
+         /**
+          * @brief: max number of events held by the memory store backend, the oldest events are evicted once it is full
+          *
+          * @param maxEvents: ring buffer capacity
+          */
+         static void configureMemoryStoreCapacity(std::size_t maxEvents);
+
+         /**
+          * @brief: tunes the event store (SQLite page cache, memory mapping, temp storage, segment log size and sync policy, write batching), needs to be called before initialization
+          *
+          * @param settings: values applied when the database is opened
+          */
+         static void configureStoreSettings(GAStoreSettings const& settings);
+
+         /**
+          * @brief: sends requests to another collector than api.gameanalytics.com (an ingestion proxy, a local mock collector), needs to be called before initialization
+          *
+          * @param endpoints: base URL and the paths of the init call and of the events
+          */
+         static void configureEndpoints(GAEndpointSettings const& endpoints);
+
+         /**
+          * @brief: sends the requests of the SDK through 'transport' instead of libcurl, needs to be called before initialization
+          *
+          * @param transport: kept for as long as the instance lives, nullptr goes back to libcurl
+          */
+         static void configureTransport(std::shared_ptr<ITransport> transport);
+
+         /**
+          * @brief: deflate level of the gzipped request bodies (release builds), applies from the next request
+          *
+          * @param level: 1 is the fastest, 9 the smallest, 6 by default
+          */
+         static void configureGzipLevel(int level);
+
+         /**
+          * @brief: attributes events to the player passed with each call instead of the device user, needs to be called before initialization.
+          *         Every player gets its own session, counters and custom dimensions; the process itself no longer starts a session.
+          *
+          * @param enabled: enables server mode
+          */
+         static void configureServerMode(bool enabled);
+
+         /**
+          * @brief: max number of player sessions kept in memory in server mode, the least recently used ones are spilled to the store
+          *
+          * @param maxUsers: resident player sessions
+          */
+         static void configureMaxResidentUsers(std::size_t maxUsers);
          static void configureBuildPlatform(std::string const& platform);
          static void configureCustomLogHandler(const LogHandler &logHandler);
          static void disableDeviceInfo();
@@ -77,6 +135,22 @@ namespace gameanalytics
 
          static void addErrorEvent(EGAErrorSeverity severity, std::string const& message, std::string const& customFields = "", bool mergeFields = false);
 
+         // server mode, events for one player
+         static void startUserSession(GAUser const& user);
+         static void endUserSession(GAUser const& user);
+
+         static void setUserCustomDimension01(GAUser const& user, std::string const& dimension01);
+         static void setUserCustomDimension02(GAUser const& user, std::string const& dimension02);
+         static void setUserCustomDimension03(GAUser const& user, std::string const& dimension03);
+
+         static void addBusinessEvent(GAUser const& user, std::string const& currency, int amount, std::string const& itemType, std::string const& itemId, std::string const& cartType, std::string const& customFields = "", bool mergeFields = false);
+         static void addResourceEvent(GAUser const& user, EGAResourceFlowType flowType, std::string const& currency, float amount, std::string const& itemType, std::string const& itemId, std::string const& customFields = "", bool mergeFields = false);
+         static void addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, std::string const& progression01, std::string const& progression02 = "", std::string const& progression03 = "", std::string const& customFields = "", bool mergeFields = false);
+         static void addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, int score, std::string const& progression01, std::string const& progression02 = "", std::string const& progression03 = "", std::string const& customFields = "", bool mergeFields = false);
+         static void addDesignEvent(GAUser const& user, std::string const& eventId, std::string const& customFields = "", bool mergeFields = false);
+         static void addDesignEvent(GAUser const& user, std::string const& eventId, double value, std::string const& customFields = "", bool mergeFields = false);
+         static void addErrorEvent(GAUser const& user, EGAErrorSeverity severity, std::string const& message, std::string const& customFields = "", bool mergeFields = false);
+
          // set calls can be changed at any time (pre- and post-initialize)
          // some calls only work after a configure is called (setCustomDimension)
          static void setEnabledInfoLog(bool flag);
@@ -95,6 +169,11 @@ namespace gameanalytics
          static void enableFPSHistogram(FPSTracker fpsTracker, bool value = true);
          static void enableHardwareTracking(bool value = true);
 
+         /**
+          * @brief: adds the numbers of getQueueStats to every health event (as custom fields), turns health events on
+          */
+         static void enableQueueStatsInHealthEvent(bool value = true);
+
          ///////////
 
          static void setGlobalCustomEventFields(std::string const& customFields);
@@ -122,6 +201,12 @@ namespace gameanalytics
          static int64_t getElapsedTimeFromAllSessions();
          static int64_t getElapsedTimeForPreviousSession();
 
+         /**
+          * @brief: depth and age of the event queue, its bytes by category and the events evicted or dropped so far;
+          *         read from counters the store keeps as it writes, cheap enough to call every frame
+          */
+         static GAQueueStats getQueueStats();
+
          // game state changes
          // will affect how session is started / ended
          static void onResume();
@@ -134,6 +219,7 @@ namespace gameanalytics
 
         static bool _endThread;
         static bool isSdkReady(bool needsInitialized, bool warn = true, std::string const& message = "");
+        static bool isUserReady(GAUser const& user, std::string const& message);
     };
 
 } // namespace gameanalytics
@@ -0,0 +1,145 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include "GameAnalytics/GATypes.h"
+
+namespace gameanalytics
+{
+    namespace state
+    {
+        class GAState;
+    }
+
+    /**
+     * @brief: an independent SDK instance with its own game key, user, session, event store and HTTP client.
+     *         All instances share one worker thread and one connection pool. The static GameAnalytics API
+     *         keeps working as the default instance next to them.
+     */
+    class GameAnalyticsInstance
+    {
+     public:
+
+         /**
+          * @brief: creates a new instance
+          *
+          * @param name: keeps the event database and log file of this instance apart from the others,
+          *              required when several instances use the same game key
+          */
+         explicit GameAnalyticsInstance(std::string const& name = "");
+
+         /**
+          * @brief: ends the session of this instance (unless manual session handling is on)
+          *         and waits for its pending work; the shared worker keeps running
+          */
+         ~GameAnalyticsInstance();
+
+         GameAnalyticsInstance(const GameAnalyticsInstance&) = delete;
+         GameAnalyticsInstance& operator=(const GameAnalyticsInstance&) = delete;
+
+         std::string const& getName() const;
+
+         void configureAvailableCustomDimensions01(const StringVector &customDimensions);
+         void configureAvailableCustomDimensions02(const StringVector &customDimensions);
+         void configureAvailableCustomDimensions03(const StringVector &customDimensions);
+         void configureAvailableResourceCurrencies(const StringVector &resourceCurrencies);
+         void configureAvailableResourceItemTypes(const StringVector &resourceItemTypes);
+
+         void configureBuild(std::string const& build);
+         void configureWritablePath(std::string const& writablePath);
+         void configureStoreBackend(EGAStoreBackend backend);
+         void configureMemoryStoreCapacity(std::size_t maxEvents);
+         void configureStoreSettings(GAStoreSettings const& settings);
+         void configureEndpoints(GAEndpointSettings const& endpoints);
+         void configureTransport(std::shared_ptr<ITransport> transport);
+         void configureGzipLevel(int level);
+         void configureServerMode(bool enabled);
+         void configureMaxResidentUsers(std::size_t maxUsers);
+         void configureBuildPlatform(std::string const& platform);
+         void configureCustomLogHandler(const LogHandler &logHandler);
+         void disableDeviceInfo();
+         void configureDeviceModel(std::string const& deviceModel);
+         void configureDeviceManufacturer(std::string const& deviceManufacturer);
+         void configureSdkGameEngineVersion(std::string const& sdkGameEngineVersion);
+         void configureGameEngineVersion(std::string const& engineVersion);
+         void configureUserId(std::string const& uId);
+         void configureExternalUserId(std::string const& extId);
+
+         void initialize(std::string const& gameKey, std::string const& gameSecret);
+
+         void addBusinessEvent(std::string const& currency, int amount, std::string const& itemType, std::string const& itemId, std::string const& cartType, std::string const& customFields = "", bool mergeFields = false);
+         void addResourceEvent(EGAResourceFlowType flowType, std::string const& currency, float amount, std::string const& itemType, std::string const& itemId, std::string const& customFields = "", bool mergeFields = false);
+         void addProgressionEvent(EGAProgressionStatus progressionStatus, std::string const& progression01, std::string const& progression02 = "", std::string const& progression03 = "", std::string const& customFields = "", bool mergeFields = false);
+         void addProgressionEvent(EGAProgressionStatus progressionStatus, int score, std::string const& progression01, std::string const& progression02 = "", std::string const& progression03 = "", std::string const& customFields = "", bool mergeFields = false);
+         void addDesignEvent(std::string const& eventId, std::string const& customFields = "", bool mergeFields = false);
+         void addDesignEvent(std::string const& eventId, double value, std::string const& customFields = "", bool mergeFields = false);
+         void addErrorEvent(EGAErrorSeverity severity, std::string const& message, std::string const& customFields = "", bool mergeFields = false);
+
+         void startUserSession(GAUser const& user);
+         void endUserSession(GAUser const& user);
+         void setUserCustomDimension01(GAUser const& user, std::string const& dimension01);
+         void setUserCustomDimension02(GAUser const& user, std::string const& dimension02);
+         void setUserCustomDimension03(GAUser const& user, std::string const& dimension03);
+         void addBusinessEvent(GAUser const& user, std::string const& currency, int amount, std::string const& itemType, std::string const& itemId, std::string const& cartType, std::string const& customFields = "", bool mergeFields = false);
+         void addResourceEvent(GAUser const& user, EGAResourceFlowType flowType, std::string const& currency, float amount, std::string const& itemType, std::string const& itemId, std::string const& customFields = "", bool mergeFields = false);
+         void addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, std::string const& progression01, std::string const& progression02 = "", std::string const& progression03 = "", std::string const& customFields = "", bool mergeFields = false);
+         void addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, int score, std::string const& progression01, std::string const& progression02 = "", std::string const& progression03 = "", std::string const& customFields = "", bool mergeFields = false);
+         void addDesignEvent(GAUser const& user, std::string const& eventId, std::string const& customFields = "", bool mergeFields = false);
+         void addDesignEvent(GAUser const& user, std::string const& eventId, double value, std::string const& customFields = "", bool mergeFields = false);
+         void addErrorEvent(GAUser const& user, EGAErrorSeverity severity, std::string const& message, std::string const& customFields = "", bool mergeFields = false);
+
+         void setEnabledInfoLog(bool flag);
+         void setEnabledVerboseLog(bool flag);
+         void setEnabledManualSessionHandling(bool flag);
+         void setEnabledErrorReporting(bool flag);
+         void setEnabledEventSubmission(bool flag);
+         void setCustomDimension01(std::string const& dimension01);
+         void setCustomDimension02(std::string const& dimension02);
+         void setCustomDimension03(std::string const& dimension03);
+         void setGlobalCustomEventFields(std::string const& customFields);
+
+         void enableSDKInitEvent(bool value = true);
+         void enableMemoryHistogram(bool value = true);
+         void enableFPSHistogram(FPSTracker fpsTracker, bool value = true);
+         void enableHardwareTracking(bool value = true);
+         void enableQueueStatsInHealthEvent(bool value = true);
+
+         void startSession();
+         void endSession();
+
+         std::string getRemoteConfigsValueAsString(std::string const& key, std::string const& defaultValue = "");
+         std::string getRemoteConfigsValueAsJson(std::string const& key);
+         bool        isRemoteConfigsReady();
+         void        addRemoteConfigsListener(const std::shared_ptr<IRemoteConfigsListener> &listener);
+         void        removeRemoteConfigsListener(const std::shared_ptr<IRemoteConfigsListener> &listener);
+         std::string getRemoteConfigsContentAsString();
+
+         std::string getUserId();
+         std::string getExternalUserId();
+         std::string getABTestingId();
+         std::string getABTestingVariantId();
+
+         int64_t getElapsedSessionTime();
+         int64_t getElapsedTimeFromAllSessions();
+         int64_t getElapsedTimeForPreviousSession();
+
+         GAQueueStats getQueueStats();
+
+         void onResume();
+         void onSuspend();
+
+         /**
+          * @brief: ends the session of this instance and blocks until its queued work is done,
+          *         the instance stops sending events for good (other instances are not affected)
+          */
+         void onQuit();
+
+     private:
+
+         std::string      _name;
+         state::GAState*  _state;
+    };
+}
@@ -0,0 +1,546 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAMockCollector.h"
+
+#if !defined(_WIN32)
+
+#include "GACommon.h"
+#include "GAUtilities.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "GA_Zip.cpp"
+
+namespace gameanalytics
+{
+    namespace mock
+    {
+        namespace
+        {
+            constexpr const char* InitPath     = "/remote_configs/v1/init";
+            constexpr const char* EventsPrefix = "/v2/";
+            constexpr const char* EventsSuffix = "/events";
+
+            const char* reasonPhrase(int status)
+            {
+                switch (status)
+                {
+                    case 200: return "OK";
+                    case 201: return "Created";
+                    case 400: return "Bad Request";
+                    case 401: return "Unauthorized";
+                    case 404: return "Not Found";
+                    case 405: return "Method Not Allowed";
+                    case 408: return "Request Timeout";
+                    case 429: return "Too Many Requests";
+                    case 500: return "Internal Server Error";
+                    case 502: return "Bad Gateway";
+                    case 503: return "Service Unavailable";
+                    default:  return "Error";
+                }
+            }
+
+            // the value of header 'name' in 'head', header names are matched case-insensitively
+            std::string headerValue(std::string const& head, std::string const& name)
+            {
+                std::size_t lineStart = head.find("\r\n");
+                while (lineStart != std::string::npos)
+                {
+                    lineStart += 2;
+                    const std::size_t lineEnd = std::min(head.find("\r\n", lineStart), head.size());
+                    const std::size_t colon   = head.find(':', lineStart);
+
+                    if (colon < lineEnd && colon - lineStart == name.size() &&
+                        std::equal(name.begin(), name.end(), head.begin() + static_cast<std::ptrdiff_t>(lineStart),
+                            [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); }))
+                    {
+                        std::size_t valueStart = colon + 1;
+                        while (valueStart < lineEnd && head[valueStart] == ' ')
+                        {
+                            ++valueStart;
+                        }
+                        std::size_t valueEnd = lineEnd;
+                        while (valueEnd > valueStart && (head[valueEnd - 1] == ' ' || head[valueEnd - 1] == '\t'))
+                        {
+                            --valueEnd;
+                        }
+                        return head.substr(valueStart, valueEnd - valueStart);
+                    }
+
+                    lineStart = lineEnd < head.size() ? lineEnd : std::string::npos;
+                }
+
+                return "";
+            }
+
+            std::string queryValue(std::string const& query, std::string const& name)
+            {
+                std::size_t start = 0;
+                while (start < query.size())
+                {
+                    std::size_t end = query.find('&', start);
+                    if (end == std::string::npos)
+                    {
+                        end = query.size();
+                    }
+
+                    if (query.compare(start, name.size() + 1, name + "=") == 0)
+                    {
+                        return query.substr(start + name.size() + 1, end - start - name.size() - 1);
+                    }
+
+                    start = end + 1;
+                }
+
+                return "";
+            }
+
+            bool sendAll(int fd, std::string const& data)
+            {
+                std::size_t sent = 0;
+                while (sent < data.size())
+                {
+                    const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                    if (n <= 0)
+                    {
+                        return false;
+                    }
+                    sent += static_cast<std::size_t>(n);
+                }
+                return true;
+            }
+
+            bool readMore(int fd, std::string& buffer)
+            {
+                char chunk[16384];
+                const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0)
+                {
+                    return false;
+                }
+
+                buffer.append(chunk, static_cast<std::size_t>(n));
+                return true;
+            }
+
+            uint32_t readLittleEndian32(const uint8_t* p)
+            {
+                return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+            }
+        }
+
+        GAMockCollector::GAMockCollector(Settings const& settings):
+            _settings(settings),
+            _random(settings.seed)
+        {
+        }
+
+        GAMockCollector::~GAMockCollector()
+        {
+            stop();
+        }
+
+        bool GAMockCollector::start()
+        {
+            _listener = socket(AF_INET, SOCK_STREAM, 0);
+            if (_listener < 0)
+            {
+                return false;
+            }
+
+            const int yes = 1;
+            setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port   = htons(_settings.port);
+            if (inet_pton(AF_INET, _settings.bindAddress.c_str(), &addr.sin_addr) != 1 ||
+                bind(_listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                listen(_listener, 128) != 0)
+            {
+                close(_listener);
+                _listener = -1;
+                return false;
+            }
+
+            socklen_t length = sizeof(addr);
+            getsockname(_listener, reinterpret_cast<sockaddr*>(&addr), &length);
+            _port = ntohs(addr.sin_port);
+
+            _acceptor = std::thread([this]() { acceptLoop(); });
+            return true;
+        }
+
+        void GAMockCollector::stop()
+        {
+            if (_listener < 0)
+            {
+                return;
+            }
+
+            _stopping = true;
+            shutdown(_listener, SHUT_RDWR);
+            close(_listener);
+            _acceptor.join();
+            _listener = -1;
+
+            {
+                std::lock_guard<std::mutex> lock(_connectionsMutex);
+                for (int fd : _sockets)
+                {
+                    shutdown(fd, SHUT_RDWR);
+                }
+            }
+
+            for (std::thread& connection : _connections)
+            {
+                connection.join();
+            }
+            _connections.clear();
+            _sockets.clear();
+        }
+
+        uint16_t GAMockCollector::port() const
+        {
+            return _port;
+        }
+
+        std::string GAMockCollector::baseUrl() const
+        {
+            const std::string host = _settings.bindAddress == "0.0.0.0" ? "127.0.0.1" : _settings.bindAddress;
+            return "http://" + host + ":" + std::to_string(_port);
+        }
+
+        GAMockCollector::Stats GAMockCollector::stats() const
+        {
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            return _stats;
+        }
+
+        void GAMockCollector::acceptLoop()
+        {
+            while (!_stopping)
+            {
+                const int fd = accept(_listener, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    continue;
+                }
+
+                const int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                {
+                    std::lock_guard<std::mutex> lock(_statsMutex);
+                    ++_stats.connections;
+                }
+
+                std::lock_guard<std::mutex> lock(_connectionsMutex);
+                _sockets.push_back(fd);
+                _connections.emplace_back([this, fd]() { serve(fd); });
+            }
+        }
+
+        void GAMockCollector::serve(int fd)
+        {
+            std::string buffer;
+
+            for (bool open = true; open;)
+            {
+                std::size_t headerEnd = std::string::npos;
+                while (open && (headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+                {
+                    open = readMore(fd, buffer);
+                }
+
+                if (!open)
+                {
+                    break;
+                }
+
+                const std::string head = buffer.substr(0, headerEnd);
+                if (headerValue(head, "Expect") == "100-continue")
+                {
+                    sendAll(fd, "HTTP/1.1 100 Continue\r\n\r\n");
+                }
+
+                const std::size_t bodyLength = static_cast<std::size_t>(std::strtoull(headerValue(head, "Content-Length").c_str(), nullptr, 10));
+                const std::size_t requestEnd = headerEnd + 4 + bodyLength;
+                while (open && buffer.size() < requestEnd)
+                {
+                    open = readMore(fd, buffer);
+                }
+
+                if (!open)
+                {
+                    break;
+                }
+
+                const std::vector<uint8_t> body(buffer.begin() + static_cast<std::ptrdiff_t>(headerEnd + 4), buffer.begin() + static_cast<std::ptrdiff_t>(requestEnd));
+                buffer.erase(0, requestEnd);
+
+                if (_settings.latencyMs > 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(_settings.latencyMs));
+                }
+
+                Answer answer = handle(head, body);
+                if (answer.status == 0)
+                {
+                    // an injected drop: the client sees the connection go without an answer
+                    break;
+                }
+
+                const std::string response = "HTTP/1.1 " + std::to_string(answer.status) + " " + reasonPhrase(answer.status) +
+                    "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(answer.body.size()) + "\r\n\r\n" + answer.body;
+                open = sendAll(fd, response);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_connectionsMutex);
+                _sockets.erase(std::remove(_sockets.begin(), _sockets.end(), fd), _sockets.end());
+            }
+            close(fd);
+        }
+
+        GAMockCollector::Answer GAMockCollector::handle(std::string const& head, std::vector<uint8_t> const& body)
+        {
+            // request line: METHOD target HTTP/1.1
+            const std::size_t methodEnd = head.find(' ');
+            const std::size_t targetEnd = head.find(' ', methodEnd + 1);
+            if (methodEnd == std::string::npos || targetEnd == std::string::npos)
+            {
+                return { 400, "{\"error\":\"malformed request\"}" };
+            }
+
+            const std::string target = head.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+            const std::size_t queryStart = target.find('?');
+            const std::string path  = target.substr(0, queryStart);
+            const std::string query = queryStart == std::string::npos ? "" : target.substr(queryStart + 1);
+
+            const bool isInit   = path == InitPath;
+            const bool isEvents = path.size() > std::strlen(EventsPrefix) + std::strlen(EventsSuffix) &&
+                path.compare(0, std::strlen(EventsPrefix), EventsPrefix) == 0 &&
+                path.compare(path.size() - std::strlen(EventsSuffix), std::string::npos, EventsSuffix) == 0;
+
+            if (!isInit && !isEvents)
+            {
+                return { 404, "{\"error\":\"not found\"}" };
+            }
+
+            if (head.compare(0, methodEnd, "POST") != 0)
+            {
+                return { 405, "{\"error\":\"method not allowed\"}" };
+            }
+
+            if (injectError())
+            {
+                return { _settings.errorStatus, _settings.errorStatus == 0 ? "" : "{\"error\":\"injected\"}" };
+            }
+
+            if (isInit)
+            {
+                return handleInit(queryValue(query, "game_key"), head, body);
+            }
+
+            const std::size_t keyStart = std::strlen(EventsPrefix);
+            return handleEvents(path.substr(keyStart, path.size() - keyStart - std::strlen(EventsSuffix)), head, body);
+        }
+
+        GAMockCollector::Answer GAMockCollector::handleInit(std::string const& gameKey, std::string const& head, std::vector<uint8_t> const& body)
+        {
+            if (!authorized(gameKey, head, body))
+            {
+                return { 401, "{\"error\":\"unauthorized\"}" };
+            }
+
+            std::string jsonString;
+            if (!decodeBody(head, body, jsonString))
+            {
+                return { 400, "{\"error\":\"bad body\"}" };
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                ++_stats.initRequests;
+            }
+
+            json response;
+            response["server_ts"]    = utilities::GAUtilities::timeIntervalSince1970();
+            response["configs"]      = json::array();
+            response["configs_hash"] = "";
+            return { 201, response.dump() };
+        }
+
+        GAMockCollector::Answer GAMockCollector::handleEvents(std::string const& gameKey, std::string const& head, std::vector<uint8_t> const& body)
+        {
+            if (!authorized(gameKey, head, body))
+            {
+                return { 401, "{\"error\":\"unauthorized\"}" };
+            }
+
+            std::string jsonString;
+            if (!decodeBody(head, body, jsonString))
+            {
+                return { 400, "{\"error\":\"bad body\"}" };
+            }
+
+            json events = json::parse(jsonString, nullptr, false);
+            if (!events.is_array())
+            {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                ++_stats.badRequests;
+                return { 400, "{\"error\":\"expected an array of events\"}" };
+            }
+
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            ++_stats.eventRequests;
+            _stats.events += static_cast<int64_t>(events.size());
+            for (json const& event : events)
+            {
+                const std::string category = event.is_object() && event.contains("category") && event["category"].is_string() ? event["category"].get<std::string>() : "";
+                ++_stats.eventsByCategory[category];
+            }
+
+            return { 200, "{}" };
+        }
+
+        bool GAMockCollector::authorized(std::string const& gameKey, std::string const& head, std::vector<uint8_t> const& body)
+        {
+            const auto key = _settings.keys.find(gameKey);
+
+            bool matches = false;
+            if (key != _settings.keys.end())
+            {
+                std::vector<uint8_t> expected;
+                utilities::GAUtilities::hmacWithKey(key->second.c_str(), body, expected);
+                matches = headerValue(head, "Authorization") == reinterpret_cast<const char*>(expected.data());
+            }
+
+            if (!matches)
+            {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                ++_stats.unauthorized;
+            }
+
+            return matches;
+        }
+
+        bool GAMockCollector::decodeBody(std::string const& head, std::vector<uint8_t> const& body, std::string& text)
+        {
+            bool trailerMatches = true;
+            bool decoded        = true;
+
+            if (headerValue(head, "Content-Encoding") == "gzip")
+            {
+                decoded = gunzip(body, text, trailerMatches);
+            }
+            else
+            {
+                text.assign(body.begin(), body.end());
+            }
+
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            _stats.bytesReceived += static_cast<int64_t>(body.size());
+            _stats.bytesInflated += static_cast<int64_t>(text.size());
+            _stats.gzipTrailerMismatches += trailerMatches ? 0 : 1;
+            _stats.badRequests += decoded ? 0 : 1;
+            return decoded;
+        }
+
+        bool GAMockCollector::injectError()
+        {
+            if (_settings.errorRate <= 0.0)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            if (std::uniform_real_distribution<double>(0.0, 1.0)(_random) >= _settings.errorRate)
+            {
+                return false;
+            }
+
+            ++_stats.injectedErrors;
+            return true;
+        }
+
+        bool GAMockCollector::gunzip(std::vector<uint8_t> const& body, std::string& out, bool& trailerMatches)
+        {
+            // https://tools.ietf.org/html/rfc1952
+            constexpr uint8_t FlagHeaderCrc = 0x02;
+            constexpr uint8_t FlagExtra     = 0x04;
+            constexpr uint8_t FlagName      = 0x08;
+            constexpr uint8_t FlagComment   = 0x10;
+
+            trailerMatches = false;
+            if (body.size() < 18 || body[0] != 0x1f || body[1] != 0x8b || body[2] != 8)
+            {
+                return false;
+            }
+
+            const uint8_t flags = body[3];
+            std::size_t   pos   = 10;
+
+            if (flags & FlagExtra)
+            {
+                if (pos + 2 > body.size())
+                {
+                    return false;
+                }
+                pos += 2 + (static_cast<std::size_t>(body[pos]) | (static_cast<std::size_t>(body[pos + 1]) << 8));
+            }
+            for (const uint8_t flag : { FlagName, FlagComment })
+            {
+                if (flags & flag)
+                {
+                    while (pos < body.size() && body[pos] != 0)
+                    {
+                        ++pos;
+                    }
+                    ++pos;
+                }
+            }
+            if (flags & FlagHeaderCrc)
+            {
+                pos += 2;
+            }
+
+            if (pos + 8 > body.size())
+            {
+                return false;
+            }
+
+            std::size_t inflatedSize = 0;
+            void* inflated = utilities::zip::tinfl_decompress_mem_to_heap(body.data() + pos, body.size() - pos - 8, &inflatedSize, 0);
+            if (!inflated)
+            {
+                return false;
+            }
+
+            out.assign(static_cast<const char*>(inflated), inflatedSize);
+            utilities::zip::mz_free(inflated);
+
+            const uint8_t* trailer = body.data() + body.size() - 8;
+            const uint32_t crc     = static_cast<uint32_t>(utilities::zip::mz_crc32(0, reinterpret_cast<const uint8_t*>(out.data()), out.size()));
+            trailerMatches = readLittleEndian32(trailer) == crc && readLittleEndian32(trailer + 4) == static_cast<uint32_t>(out.size());
+            return true;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,121 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#if !defined(_WIN32)
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gameanalytics
+{
+    namespace mock
+    {
+        // a stand-in for the collector: plain HTTP/1.1 with keep-alive on the default paths
+        // (GAEndpointSettings), checks the Authorization HMAC of every request against the secret key
+        // of its game, gunzips and parses the body and counts what came in; answers can be delayed
+        // and a share of them replaced by an error status or a dropped connection
+        class GAMockCollector
+        {
+         public:
+
+            struct Settings
+            {
+                std::string bindAddress = "127.0.0.1";
+
+                // 0 picks a free port, see port()
+                uint16_t port = 0;
+
+                // game key -> secret key, requests for other games are answered 401
+                std::map<std::string, std::string> keys;
+
+                // every answer waits this long
+                int latencyMs = 0;
+
+                // share of the requests (0 to 1) answered with errorStatus instead, 0 closes the
+                // connection without an answer
+                double   errorRate   = 0.0;
+                int      errorStatus = 500;
+                uint32_t seed        = 1;
+            };
+
+            struct Stats
+            {
+                int64_t connections    = 0;
+                int64_t initRequests   = 0;
+                int64_t eventRequests  = 0;
+                int64_t events         = 0;
+                int64_t unauthorized   = 0;     // unknown game key or HMAC mismatch
+                int64_t badRequests    = 0;     // body that does not gunzip or parse
+                int64_t injectedErrors = 0;
+                int64_t bytesReceived  = 0;     // request bodies as sent
+                int64_t bytesInflated  = 0;     // the same after gunzip
+
+                // gzip bodies whose CRC32 or size trailer does not match what they inflate to
+                // (the collector does not check them, so they are only counted)
+                int64_t gzipTrailerMismatches = 0;
+
+                std::map<std::string, int64_t> eventsByCategory;
+            };
+
+            explicit GAMockCollector(Settings const& settings);
+            ~GAMockCollector();
+            GAMockCollector(const GAMockCollector&) = delete;
+            GAMockCollector& operator=(const GAMockCollector&) = delete;
+
+            // binds and starts accepting, false if the address cannot be bound
+            bool start();
+            void stop();
+
+            uint16_t    port() const;
+            std::string baseUrl() const;
+            Stats       stats() const;
+
+            // inflates a gzip member into 'out', 'trailerMatches' tells whether its CRC32 and size agree
+            static bool gunzip(std::vector<uint8_t> const& body, std::string& out, bool& trailerMatches);
+
+         private:
+
+            struct Answer
+            {
+                int         status = 200;
+                std::string body;
+            };
+
+            void   acceptLoop();
+            void   serve(int fd);
+            Answer handle(std::string const& head, std::vector<uint8_t> const& body);
+            Answer handleInit(std::string const& gameKey, std::string const& head, std::vector<uint8_t> const& body);
+            Answer handleEvents(std::string const& gameKey, std::string const& head, std::vector<uint8_t> const& body);
+            bool   authorized(std::string const& gameKey, std::string const& head, std::vector<uint8_t> const& body);
+            bool   decodeBody(std::string const& head, std::vector<uint8_t> const& body, std::string& text);
+            bool   injectError();
+
+            Settings _settings;
+            int      _listener = -1;
+            uint16_t _port     = 0;
+
+            std::atomic<bool> _stopping{false};
+            std::thread       _acceptor;
+
+            std::mutex               _connectionsMutex;
+            std::vector<int>         _sockets;
+            std::vector<std::thread> _connections;
+
+            mutable std::mutex _statsMutex;
+            Stats              _stats;
+            std::mt19937       _random;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,177 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAMockCollector.h"
+
+#if !defined(_WIN32)
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using gameanalytics::mock::GAMockCollector;
+
+namespace
+{
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void onSignal(int)
+    {
+        stopRequested = 1;
+    }
+
+    void printUsage(const char* program)
+    {
+        std::printf(
+            "usage: %s --key <game key>:<secret key> [options]\n"
+            "\n"
+            "  --key <game>:<secret>   game accepted by the collector, can be repeated\n"
+            "  --bind <address>        address to listen on (127.0.0.1)\n"
+            "  --port <port>           port to listen on, 0 picks a free one (8080)\n"
+            "  --latency-ms <ms>       delay of every answer (0)\n"
+            "  --error-rate <0..1>     share of requests answered with --error-status (0)\n"
+            "  --error-status <code>   status of those answers, 0 drops the connection instead (500)\n"
+            "  --seed <n>              seed of the error injection (1)\n"
+            "  --interval <seconds>    how often the counters are printed (5)\n"
+            "\n"
+            "Point the SDK at it with GameAnalytics::configureEndpoints, baseUrl http://<address>:<port>.\n",
+            program);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    GAMockCollector::Settings settings;
+    settings.port = 8080;
+    int interval  = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        if (option == "--help" || option == "-h")
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "missing value of %s\n", option.c_str());
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        if (option == "--key")
+        {
+            const std::size_t colon = value.find(':');
+            if (colon == std::string::npos)
+            {
+                std::fprintf(stderr, "--key expects <game key>:<secret key>\n");
+                return 1;
+            }
+            settings.keys[value.substr(0, colon)] = value.substr(colon + 1);
+        }
+        else if (option == "--bind")
+        {
+            settings.bindAddress = value;
+        }
+        else if (option == "--port")
+        {
+            settings.port = static_cast<uint16_t>(std::atoi(value.c_str()));
+        }
+        else if (option == "--latency-ms")
+        {
+            settings.latencyMs = std::atoi(value.c_str());
+        }
+        else if (option == "--error-rate")
+        {
+            settings.errorRate = std::atof(value.c_str());
+        }
+        else if (option == "--error-status")
+        {
+            settings.errorStatus = std::atoi(value.c_str());
+        }
+        else if (option == "--seed")
+        {
+            settings.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (option == "--interval")
+        {
+            interval = std::max(1, std::atoi(value.c_str()));
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", option.c_str());
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (settings.keys.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    GAMockCollector collector(settings);
+    if (!collector.start())
+    {
+        std::fprintf(stderr, "cannot listen on %s:%d: %s\n", settings.bindAddress.c_str(), settings.port, std::strerror(errno));
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::printf("listening on %s\n", collector.baseUrl().c_str());
+    std::fflush(stdout);
+
+    GAMockCollector::Stats last;
+    auto lastTime = std::chrono::steady_clock::now();
+    while (!stopRequested)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastTime < std::chrono::seconds(interval))
+        {
+            continue;
+        }
+
+        const GAMockCollector::Stats stats = collector.stats();
+        const double seconds = std::chrono::duration<double>(now - lastTime).count();
+        std::printf("%.0f events/s, %.0f requests/s, %.1f KB/s in | events %lld, init %lld, unauthorized %lld, bad %lld, injected %lld, connections %lld\n",
+            static_cast<double>(stats.events - last.events) / seconds,
+            static_cast<double>(stats.eventRequests + stats.initRequests - last.eventRequests - last.initRequests) / seconds,
+            static_cast<double>(stats.bytesReceived - last.bytesReceived) / seconds / 1024.0,
+            static_cast<long long>(stats.events), static_cast<long long>(stats.initRequests), static_cast<long long>(stats.unauthorized),
+            static_cast<long long>(stats.badRequests), static_cast<long long>(stats.injectedErrors), static_cast<long long>(stats.connections));
+        std::fflush(stdout);
+
+        last     = stats;
+        lastTime = now;
+    }
+
+    collector.stop();
+    return 0;
+}
+
+#else
+
+#include <cstdio>
+
+int main()
+{
+    std::fprintf(stderr, "the mock collector needs POSIX sockets\n");
+    return 1;
+}
+
+#endif
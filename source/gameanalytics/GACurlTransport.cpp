@@ -0,0 +1,58 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GACurlTransport.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        GACurlTransport::GACurlTransport():
+            _engine(GAHTTPEngine::shared())
+        {
+        }
+
+        GACurlTransport::~GACurlTransport()
+        {
+            cancel();
+        }
+
+        void GACurlTransport::send(GAHTTPRequest&& request, GAHTTPCompletion&& onDone)
+        {
+            HTTPRequest transfer;
+            transfer.url     = std::move(request.url);
+            transfer.headers = std::move(request.headers);
+            transfer.payload = std::move(request.body);
+
+            _engine->submit(this, std::move(transfer),
+                [onDone = std::move(onDone)](HTTPResult&& result)
+                {
+                    GAHTTPResponse response;
+                    if (result.code == CURLE_OK)
+                    {
+                        response.statusCode = result.statusCode;
+                        response.body       = std::move(result.body);
+                        response.truncated  = result.truncated;
+                    }
+                    else
+                    {
+                        response.error = curl_easy_strerror(result.code);
+                    }
+
+                    onDone(std::move(response));
+                });
+        }
+
+        void GACurlTransport::cancel()
+        {
+            _engine->cancel(this);
+        }
+
+        GAHTTPEngine& GACurlTransport::engine()
+        {
+            return *_engine;
+        }
+    }
+}
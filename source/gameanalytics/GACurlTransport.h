@@ -0,0 +1,39 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <memory>
+#include "GACommon.h"
+#include "GAHTTPEngine.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        // the default transport: requests go through the curl_multi engine shared by every instance
+        // (GAHTTPEngine), each instance has a transport of its own so its requests can be ended on their own
+        class GACurlTransport : public ITransport
+        {
+         public:
+
+            GACurlTransport();
+            ~GACurlTransport() override;
+            GACurlTransport(const GACurlTransport&) = delete;
+            GACurlTransport& operator=(const GACurlTransport&) = delete;
+
+            void send(GAHTTPRequest&& request, GAHTTPCompletion&& onDone) override;
+
+            // ends the requests sent through this transport that have not finished yet
+            void cancel();
+
+            GAHTTPEngine& engine();
+
+         private:
+
+            std::shared_ptr<GAHTTPEngine> _engine;
+        };
+    }
+}
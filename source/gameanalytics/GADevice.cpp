@@ -41,7 +41,12 @@ namespace gameanalytics
                 getInstance()._platform->onInit();
                 if(state::GAState::useErrorReporting())
                 {
-                    getInstance()._platform->setupUncaughtExceptionHandler();
+                    // signal handlers are process wide, the first instance to initialize installs them
+                    static std::once_flag handlerInstalled;
+                    std::call_once(handlerInstalled, []()
+                    {
+                        getInstance()._platform->setupUncaughtExceptionHandler();
+                    });
                 }
             }
         }
@@ -73,8 +78,20 @@ namespace gameanalytics
 
         std::string GADevice::getConnectionType()
         {
-            if(getInstance()._platform)
-                return getInstance()._platform->getConnectionType();
+            constexpr std::chrono::seconds refreshInterval(1);
+
+            GADevice& device = getInstance();
+            if(device._platform)
+            {
+                const auto now = std::chrono::steady_clock::now();
+                if(device._detectedConnectionType.empty() || now - device._connectionTypeCheckedAt >= refreshInterval)
+                {
+                    device._detectedConnectionType  = device._platform->getConnectionType();
+                    device._connectionTypeCheckedAt = now;
+                }
+
+                return device._detectedConnectionType;
+            }
 
             return "";
         }
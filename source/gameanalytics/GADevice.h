@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <chrono>
 #include "GACommon.h"
 #include "GAHealth.h"
 #include "Platform/GAPlatform.h"
@@ -87,6 +88,10 @@ namespace gameanalytics
                 std::string _gameEngineVersion;
                 std::string _connectionType;
                 std::string _sdkWrapperVersion;
+
+                // probing the network interfaces costs several syscalls, every event asks for it
+                std::string _detectedConnectionType;
+                std::chrono::steady_clock::time_point _connectionTypeCheckedAt;
         };
     }
 }
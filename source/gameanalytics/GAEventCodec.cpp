@@ -0,0 +1,236 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAEventCodec.h"
+#include "GALogger.h"
+#include <memory>
+#include <cstring>
+#include <cstddef>
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "GA_Zip.cpp"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        using namespace utilities::zip;
+
+        namespace
+        {
+            // what every event repeats: the keys, the common values and the annotation prefixes, followed
+            // by a whole event as serialized (keys sorted). Deflate codes nearby matches cheaper, so the
+            // parts found in every event come last. Never edit it, add a new format instead.
+            constexpr std::string_view DictionaryV1 =
+                "\"amount\":\"currency\":\"cart_type\":\"item_id\":\"item_type\":\"receipt_info\":{\"receipt\":\"store\":\"signature\":"
+                "\"attempt_num\":\"score\":\"flow_type\":\"Source\"\"Sink\"\"severity\":\"message\":\"error\"\"warning\"\"info\"\"debug\"\"critical\""
+                "\"custom_fields\":{\"custom_01\":\"custom_02\":\"custom_03\":\"build\":\"engine_version\":\"unity \"unreal \"cocos2d \""
+                "\"configurations_v3\":[]\"ab_id\":\"ab_variant_id\":\"event_id\":\"Start:\"Complete:\"Fail:\"value\":\"length\":"
+                "{\"category\":\"health\",{\"category\":\"sdk_error\",{\"category\":\"error\",{\"category\":\"resource\",{\"category\":\"progression\","
+                "{\"category\":\"business\",{\"category\":\"session_end\",{\"category\":\"user\",{\"category\":\"design\",\"client_ts\":17"
+                ",\"connection_type\":\"offline\",\"connection_type\":\"lan\",\"connection_type\":\"wwan\",\"connection_type\":\"wifi\""
+                ",\"current_session_length\":,\"device\":\"unknown\",\"event_uuid\":\"-4"
+                ",\"lifetime_session_length\":,\"manufacturer\":\"unknown\",\"os_version\":\"android \",\"os_version\":\"ios \""
+                ",\"os_version\":\"windows \",\"os_version\":\"mac_osx \",\"os_version\":\"linux \""
+                ",\"platform\":\"android\",\"platform\":\"ios\",\"platform\":\"windows\",\"platform\":\"mac_osx\",\"platform\":\"linux\""
+                ",\"sdk_version\":\"cpp 5.\",\"session_id\":\"-4\",\"session_num\":,\"user_id\":\"-\",\"v\":2}"
+                "{\"category\":\"design\",\"client_ts\":1700000000,\"connection_type\":\"wifi\",\"current_session_length\":0"
+                ",\"device\":\"unknown\",\"event_id\":\"\",\"event_uuid\":\"-4-\",\"lifetime_session_length\":0,\"manufacturer\":\"unknown\""
+                ",\"os_version\":\"linux \",\"platform\":\"linux\",\"sdk_version\":\"cpp 5.1.0\",\"session_id\":\"-4-\",\"session_num\":1"
+                ",\"user_id\":\"-\",\"v\":2,\"value\":0}";
+
+            // room for the LEB128 length of any event
+            constexpr std::size_t MaxLengthBytes = 5;
+
+            // raw deflate (no zlib header), level 6
+            int compressorFlags()
+            {
+                return static_cast<int>(tdefl_create_comp_flags_from_zip_params(6, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+            }
+
+            mz_bool appendOutput(const void* buffer, int length, void* user)
+            {
+                static_cast<std::string*>(user)->append(static_cast<const char*>(buffer), static_cast<std::size_t>(length));
+                return MZ_TRUE;
+            }
+
+            // runs the dictionary through a fresh compressor and flushes to a byte boundary,
+            // whatever follows can refer back to it; 'out' receives the dictionary's own blocks
+            bool primeCompressor(tdefl_compressor& compressor, std::string& out)
+            {
+                if (tdefl_init(&compressor, appendOutput, &out, compressorFlags()) != TDEFL_STATUS_OKAY)
+                {
+                    return false;
+                }
+
+                return tdefl_compress_buffer(&compressor, DictionaryV1.data(), DictionaryV1.size(), TDEFL_SYNC_FLUSH) == TDEFL_STATUS_OKAY;
+            }
+
+            // the dictionary blocks are the same for every event, the decoder puts them back in front
+            // (never destroyed: the session end event is stored while statics are torn down)
+            std::string const& dictionaryBlocks()
+            {
+                static const std::string* blocks = []()
+                {
+                    std::string* out = new std::string;
+                    std::unique_ptr<tdefl_compressor> compressor(new tdefl_compressor);
+                    primeCompressor(*compressor, *out);
+                    return out;
+                }();
+
+                return *blocks;
+            }
+
+            // puts back the state 'primed' was copied from, but for the code and output buffers: the last flush
+            // left those empty, they are written from their start
+            void restorePrimed(tdefl_compressor& compressor, tdefl_compressor const& primed)
+            {
+                std::memcpy(&compressor, &primed, offsetof(tdefl_compressor, m_lz_code_buf));
+                std::memcpy(&compressor.m_next, &primed.m_next, offsetof(tdefl_compressor, m_output_buf) - offsetof(tdefl_compressor, m_next));
+            }
+
+            // the stored form of 'json' from its deflate stream past the dictionary blocks
+            // ('compressed' is false if compressing failed)
+            std::string storedForm(std::string_view json, bool compressed, std::string_view payload)
+            {
+                std::string encoded;
+                if (compressed && payload.size() + MaxLengthBytes < json.size())
+                {
+                    encoded.reserve(1 + MaxLengthBytes + payload.size());
+                    encoded.push_back(static_cast<char>(GAEventCodec::FormatDeflateV1));
+                    for (uint64_t length = json.size(); ; length >>= 7)
+                    {
+                        const char low = static_cast<char>(length & 0x7f);
+                        if (length < 0x80)
+                        {
+                            encoded.push_back(low);
+                            break;
+                        }
+                        encoded.push_back(static_cast<char>(low | 0x80));
+                    }
+                    encoded.append(payload.data(), payload.size());
+                }
+                else
+                {
+                    encoded.reserve(1 + json.size());
+                    encoded.push_back(static_cast<char>(GAEventCodec::FormatRaw));
+                    encoded.append(json.data(), json.size());
+                }
+
+                return encoded;
+            }
+        }
+
+        std::string GAEventCodec::encode(std::string_view json)
+        {
+            // a few hundred KB of tables, tdefl_init only clears the hash heads
+            std::unique_ptr<tdefl_compressor> compressor(new tdefl_compressor);
+            std::string stream;
+
+            const bool ok = primeCompressor(*compressor, stream)
+                && stream.size() == dictionaryBlocks().size()
+                && tdefl_compress_buffer(compressor.get(), json.data(), json.size(), TDEFL_FINISH) == TDEFL_STATUS_DONE;
+
+            return storedForm(json, ok, ok ? std::string_view(stream).substr(dictionaryBlocks().size()) : std::string_view());
+        }
+
+        std::vector<std::string> GAEventCodec::encode(std::vector<std::string> const& jsons)
+        {
+            std::vector<std::string> encoded;
+            encoded.reserve(jsons.size());
+
+            // priming costs several times more than compressing an event: the batch primes once and every
+            // event starts from a copy of that state. The copy has to go back into the compressor it was
+            // taken from, the state points into its own buffers.
+            std::unique_ptr<tdefl_compressor> compressor(new tdefl_compressor);
+            std::unique_ptr<tdefl_compressor> primed(new tdefl_compressor);
+            std::string dictionary;
+
+            const bool ok = primeCompressor(*compressor, dictionary) && dictionary.size() == dictionaryBlocks().size();
+            if (ok)
+            {
+                *primed = *compressor;
+            }
+
+            for (std::string const& json : jsons)
+            {
+                std::string stream;
+                bool compressed = false;
+                if (ok)
+                {
+                    restorePrimed(*compressor, *primed);
+                    compressor->m_pPut_buf_user = &stream;
+                    compressed = tdefl_compress_buffer(compressor.get(), json.data(), json.size(), TDEFL_FINISH) == TDEFL_STATUS_DONE;
+                }
+
+                encoded.push_back(storedForm(json, compressed, stream));
+            }
+
+            return encoded;
+        }
+
+        bool GAEventCodec::decode(std::string_view stored, std::string& out)
+        {
+            if (stored.empty())
+            {
+                return false;
+            }
+
+            const uint8_t format = static_cast<uint8_t>(stored[0]);
+
+            if (format == FormatRaw)
+            {
+                out.assign(stored.data() + 1, stored.size() - 1);
+                return true;
+            }
+
+            if (format == FormatDeflateV1)
+            {
+                // the length bounds the output, a damaged stream cannot inflate past it
+                uint64_t length = 0;
+                std::size_t offset = 1;
+                for (int shift = 0; ; shift += 7)
+                {
+                    if (offset >= stored.size() || shift > 28)
+                    {
+                        return false;
+                    }
+
+                    const uint8_t byte = static_cast<uint8_t>(stored[offset++]);
+                    length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if ((byte & 0x80) == 0)
+                    {
+                        break;
+                    }
+                }
+
+                std::string const& blocks = dictionaryBlocks();
+                std::string stream(blocks);
+                std::string inflated;
+                stream.append(stored.data() + offset, stored.size() - offset);
+                inflated.resize(DictionaryV1.size() + length);
+
+                const std::size_t written = tinfl_decompress_mem_to_mem(&inflated[0], inflated.size(), stream.data(), stream.size(), 0);
+                if (written != inflated.size() || inflated.compare(0, DictionaryV1.size(), DictionaryV1.data(), DictionaryV1.size()) != 0)
+                {
+                    return false;
+                }
+
+                out.assign(inflated, DictionaryV1.size(), std::string::npos);
+                return true;
+            }
+
+            // rows from before the format byte
+            if (stored[0] == '{')
+            {
+                out.assign(stored.data(), stored.size());
+                return true;
+            }
+
+            logging::GALogger::w("Unknown stored event format: %d", static_cast<int>(format));
+            return false;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // storage format of the event column of ga_events: one format byte followed by the payload.
+        // Rows written before the format byte existed hold the JSON text itself and start with '{'.
+        class GAEventCodec
+        {
+         public:
+
+            // the JSON text as is (when compressing does not pay off)
+            static constexpr uint8_t FormatRaw = 0x00;
+
+            // the JSON length (LEB128) and a raw deflate stream primed with dictionary v1, the dictionary part
+            // of the stream is not stored; a new dictionary needs a new format byte, the old one has to stay
+            // for rows already written
+            static constexpr uint8_t FormatDeflateV1 = 0x01;
+
+            // returns the stored form of 'json'
+            static std::string encode(std::string_view json);
+
+            // the stored form of each of 'jsons', one compressor serves the whole batch
+            static std::vector<std::string> encode(std::vector<std::string> const& jsons);
+
+            // restores the JSON text of a stored event, false if it is damaged
+            static bool decode(std::string_view stored, std::string& out);
+        };
+    }
+}
@@ -0,0 +1,220 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <array>
+#include <atomic>
+#include "GACommon.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // the category of a queued event is kept as a small integer, the position in this table is part of
+        // stored data (append new categories, never reorder); unknown categories are 0
+        //
+        // retention: when a store is over its quota, queued events of the lowest retention
+        // are evicted first (oldest first within a level)
+        struct EventCategory
+        {
+            std::string_view name;
+            int              retention;
+        };
+
+        constexpr EventCategory EventCategories[] =
+        {
+            { "", 0 },
+            { "user", 2 },
+            { "session_end", 2 },
+            { "design", 1 },
+            { "business", 2 },
+            { "progression", 1 },
+            { "resource", 1 },
+            { "error", 1 },
+            { "sdk_init", 0 },
+            { "health", 0 },
+            { "sdk_error", 0 }
+        };
+
+        constexpr int MaxEventRetention = 2;
+
+        constexpr std::size_t EventCategoryCount = sizeof(EventCategories) / sizeof(EventCategories[0]);
+
+        constexpr int64_t eventCategoryId(std::string_view category)
+        {
+            for (std::size_t i = 1; i < EventCategoryCount; ++i)
+            {
+                if (EventCategories[i].name == category)
+                {
+                    return static_cast<int64_t>(i);
+                }
+            }
+
+            return 0;
+        }
+
+        // position of a stored category id in EventCategories, ids this build does not know count as 0
+        constexpr std::size_t eventCategoryIndex(int64_t category)
+        {
+            return category > 0 && static_cast<std::size_t>(category) < EventCategoryCount ? static_cast<std::size_t>(category) : 0;
+        }
+
+        // annotations that stay the same for a whole session of one user, a store may keep them once
+        // per session as long as claimed events get them back
+        constexpr std::string_view SessionAnnotationKeys[] =
+        {
+            "v", "user_id", "user_id_ext", "session_id", "session_num", "sdk_version", "os_version", "manufacturer",
+            "device", "platform", "build", "engine_version", "ab_id", "ab_variant_id", "configurations_v3"
+        };
+
+        constexpr bool isSessionAnnotation(std::string_view key)
+        {
+            for (std::string_view annotation : SessionAnnotationKeys)
+            {
+                if (annotation == key)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // kept up to date by the store as it goes, reading them costs no query
+        struct EventStoreStats
+        {
+            int64_t queuedEvents   = 0;   // waiting to be claimed
+            int64_t claimedEvents  = 0;   // claimed by requests in flight
+            int64_t sizeBytes      = 0;
+            int64_t evictedEvents  = 0;
+            int64_t droppedEvents  = 0;   // refused by the store (too large for it)
+            int64_t oldestClientTs = 0;   // of the oldest event held (queued or claimed), 0 if there is none
+
+            // events held (queued or claimed) and the bytes of their rows or records, by category id
+            std::array<int64_t, EventCategoryCount> eventsByCategory{};
+            std::array<int64_t, EventCategoryCount> bytesByCategory{};
+        };
+
+        // the per category part of EventStoreStats as a store maintains it on its write path
+        class EventCategoryCounters
+        {
+         public:
+
+            void add(int64_t category, int64_t events, int64_t bytes)
+            {
+                const std::size_t i = eventCategoryIndex(category);
+                _events[i].fetch_add(events, std::memory_order_relaxed);
+                _bytes[i].fetch_add(bytes, std::memory_order_relaxed);
+            }
+
+            void reset()
+            {
+                for (std::size_t i = 0; i < EventCategoryCount; ++i)
+                {
+                    _events[i].store(0, std::memory_order_relaxed);
+                    _bytes[i].store(0, std::memory_order_relaxed);
+                }
+            }
+
+            void copyTo(EventStoreStats& stats) const
+            {
+                for (std::size_t i = 0; i < EventCategoryCount; ++i)
+                {
+                    stats.eventsByCategory[i] = _events[i].load(std::memory_order_relaxed);
+                    stats.bytesByCategory[i]  = _bytes[i].load(std::memory_order_relaxed);
+                }
+            }
+
+         private:
+
+            std::atomic<int64_t> _events[EventCategoryCount]{};
+            std::atomic<int64_t> _bytes[EventCategoryCount]{};
+        };
+
+        // a running session as last written, a crash leaves it behind without its session_end event
+        struct SessionCheckpoint
+        {
+            std::string sessionId;
+            int64_t     startTs = 0;
+            std::string event;           // the annotations of its latest event
+        };
+
+        // an event waiting to be written, see IEventStore::appendBatch
+        struct EventRecord
+        {
+            std::string category;
+            std::string sessionId;
+            int64_t     clientTs = 0;
+            json        event;
+        };
+
+        // where the queued events and the persisted SDK state live; GAStore forwards to the backend
+        // selected with EGAStoreBackend. Every backend has to pass the conformance suite
+        // (test/GAEventStoreTests.cpp) and gets measured by benchmark/GAEventStoreBenchmark.cpp.
+        //
+        // A request claims a batch of queued events, the batch is acked (deleted) once it was delivered
+        // or put back to be claimed again. Claimed events are never evicted.
+        class IEventStore
+        {
+         public:
+
+            virtual ~IEventStore() = default;
+
+            // queues 'event'; the event comes back from claimBatch as its JSON text
+            virtual void append(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event) = 0;
+
+            // queues 'records' in order as one write (one transaction where the store has them),
+            // true once all of them are persisted
+            virtual bool appendBatch(std::vector<EventRecord> const& records)
+            {
+                for (EventRecord const& record : records)
+                {
+                    append(record.category, record.sessionId, record.clientTs, record.event);
+                }
+
+                return true;
+            }
+
+            // claims up to 'limit' of the oldest queued events (of 'category' unless empty) for 'requestId'
+            // and appends them to 'out', false if there were none
+            virtual bool claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out) = 0;
+            virtual void ackBatch(std::string const& requestId) = 0;
+            virtual void putBackBatch(std::string const& requestId) = 0;
+
+            // puts back every claimed event (their requests did not survive)
+            virtual void putBackAll() = 0;
+
+            // housekeeping between sends: keeps the store within its quota
+            virtual void trim() = 0;
+
+            // true while events of the lowest retention levels have to be rejected
+            virtual bool isFull() = 0;
+
+            // persisted key/value state, an empty value removes the key
+            virtual std::string  getState(std::string const& key) = 0;
+            virtual void         setState(std::string const& key, std::string const& value) = 0;
+            virtual StringVector getStateKeys(std::string const& prefix) = 0;
+
+            // tries per progression, 0 removes it
+            virtual void setProgressionTries(std::string const& progression, int tries) = 0;
+            virtual std::vector<std::pair<std::string, int>> getProgressionTries() = 0;
+
+            virtual void checkpointSession(SessionCheckpoint const& session) = 0;
+            virtual void removeSession(std::string const& sessionId) = 0;
+            virtual std::vector<SessionCheckpoint> getSessions() = 0;
+
+            virtual EventStoreStats getStats() = 0;
+
+            // the writes of one worker pass, a store may make them durable together
+            virtual void beginWrites() {}
+            virtual void endWrites() {}
+        };
+    }
+}
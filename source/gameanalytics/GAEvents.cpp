@@ -4,6 +4,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include "GAEvents.h"
 #include "GAState.h"
 #include "GAUtilities.h"
@@ -45,6 +46,9 @@ namespace gameanalytics
 
         void GAEvents::ensureEventQueueIsRunning()
         {
+            // coming back (from the background or a stop) is a fresh look at the network
+            getInstance().uploadRetry.reset();
+
             getInstance().keepRunning = true;
             if (!getInstance().isRunning)
             {
@@ -56,6 +60,14 @@ namespace gameanalytics
                             return getInstance().processEventQueue();
                     }
                 );
+
+                // events held by the store writer past their delay are written between passes too
+                threading::GAThreading::scheduleTimer(GAEvents::STORE_WRITE_INTERVAL,
+                    []()
+                    {
+                        store::GAStore::flushDueWrites();
+                    }
+                );
             }
         }
  
@@ -79,8 +91,11 @@ namespace gameanalytics
                 eventDict["category"]       = CategorySessionStart;
                 eventDict["session_num"]    = sessionNum;
 
-                StringVector parameters = {"session_num", std::to_string(sessionNum)};
-                store::GAStore::executeQuerySync("INSERT OR REPLACE INTO ga_state (key, value) VALUES(?, ?);", parameters);
+                // player counters are persisted with their session record
+                if (!state::GAState::hasBoundUser())
+                {
+                    store::GAStore::setState("session_num", std::to_string(sessionNum));
+                }
 
                 // Add custom dimensions
                 getInstance().addDimensionsToEvent(eventDict);
@@ -95,8 +110,11 @@ namespace gameanalytics
                 // Log
                 logging::GALogger::i("Add SESSION START event");
 
-                // Send event right away
-                GAEvents::processEvents(CategorySessionStart, false);
+                // Send event right away (server mode batches them with everything else)
+                if (!state::GAState::isServerMode())
+                {
+                    GAEvents::processEvents(CategorySessionStart, false);
+                }
             }
             catch(const std::exception& e)
             {
@@ -146,7 +164,10 @@ namespace gameanalytics
                 logging::GALogger::i("Add SESSION END event.");
 
                 // Send all event right away
-                GAEvents::processEvents("", false);
+                if (!state::GAState::isServerMode())
+                {
+                    GAEvents::processEvents("", false);
+                }
             }
             catch(const std::exception& e)
             {
@@ -182,8 +203,10 @@ namespace gameanalytics
 
                 const int64_t transactionNum = state::GAState::getTransactionNum();
 
-                StringVector params = {"transaction_num", std::to_string(transactionNum)};
-                store::GAStore::executeQuerySync("INSERT OR REPLACE INTO ga_state (key, value) VALUES(?, ?);", params);
+                if (!state::GAState::hasBoundUser())
+                {
+                    store::GAStore::setState("transaction_num", std::to_string(transactionNum));
+                }
 
                 eventDict["category"] = GAEvents::CategoryBusiness;
                 eventDict["event_id"] = itemType + ':' + itemId;
@@ -478,12 +501,61 @@ namespace gameanalytics
         {
             processEvents("", true);
 
+            // eviction and vacuum steps run between sends, never while an event is being stored
+            store::GAStore::runMaintenance();
+            getInstance().sendRecoveryReports();
+
             if (!getInstance().keepRunning)
             {
                 getInstance().isRunning = false;
             }
         }
 
+        void GAEvents::sendRecoveryReports()
+        {
+            for (store::GASqliteStore::RecoveryReport const& report : store::GAStore::takeRecoveryReports())
+            {
+                http::EGASdkErrorAction action = http::EGASdkErrorAction::DatabaseRecoveryFailed;
+                switch (report.kind)
+                {
+                    case store::GASqliteStore::RecoveryReport::Kind::Damaged:
+                        action = http::EGASdkErrorAction::DatabaseCorrupt;
+                        break;
+                    case store::GASqliteStore::RecoveryReport::Kind::Salvaged:
+                        action = http::EGASdkErrorAction::DatabaseRecovered;
+                        break;
+                    default:
+                        break;
+                }
+
+                http::GAHTTPApi& httpInstance = http::GAHTTPApi::getInstance();
+                httpInstance.sendSdkErrorEvent(http::EGASdkErrorCategory::Database, http::EGASdkErrorArea::RecoverDatabase, action, (http::EGASdkErrorParameter)0, report.reason, state::GAState::getGameKey(), state::GAState::getGameSecret());
+            }
+        }
+
+        bool GAEvents::parseClaimedEvent(std::string const& eventDict, json& out)
+        {
+            try
+            {
+                out = json::parse(eventDict);
+                if(out.contains("client_ts") && out["client_ts"].is_number_integer())
+                {
+                    if (!validators::GAValidator::validateClientTs(out["client_ts"].get<int64_t>()))
+                    {
+                        out.erase("client_ts");
+                    }
+                }
+
+                return true;
+            }
+            catch(const json::exception& e)
+            {
+                logging::GALogger::d("processEvents -- JSON error: %s", e.what());
+                logging::GALogger::d(eventDict.c_str());
+                return false;
+            }
+        }
+
         void GAEvents::processEvents(std::string const& category, bool performCleanup)
         {
             if(!state::GAState::isEventSubmissionEnabled())
@@ -491,15 +563,21 @@ namespace gameanalytics
                 return;
             }
 
-            // Request identifier
-            std::string requestIdentifier = utilities::GAUtilities::generateUUID();
+            GAEvents& instance = getInstance();
+            if (!instance.mayUpload())
+            {
+                return;
+            }
 
-            std::string andCategory = category.empty() ? "" : utilities::printString(" AND category='%s' ", category.c_str());
+            // a batch that got no answer goes out again before anything else is claimed
+            if (!instance.pendingUpload.requestId.empty())
+            {
+                instance.sendPendingUpload();
+                return;
+            }
 
-            std::string selectSql  = utilities::printString("SELECT event FROM ga_events WHERE status = 'new' %s;", andCategory.c_str());
-            std::string updateSql  = utilities::printString("UPDATE ga_events SET status = '%s' WHERE status = 'new' %s;", requestIdentifier.c_str(), andCategory.c_str());
-            std::string deleteSql  = utilities::printString("DELETE FROM ga_events WHERE status = '%s'", requestIdentifier.c_str());
-            std::string putbackSql = utilities::printString("UPDATE ga_events SET status = 'new' WHERE status = '%s';", requestIdentifier.c_str());
+            // Request identifier
+            std::string requestIdentifier = utilities::GAUtilities::generateUUID();
 
             // Cleanup
             if (performCleanup)
@@ -508,90 +586,37 @@ namespace gameanalytics
                 getInstance().fixMissingSessionEndEvents();
             }
 
-            // Get events to process
-            json events;
-            store::GAStore::executeQuerySync(selectSql, events);
-
-            // Check for errors or empty
-            if (events.is_null() || events.size() == 0)
+            // Get events to process and mark them as 'sending'
+            StringVector events;
+            if (!store::GAStore::claimEvents(requestIdentifier, category, GAEvents::MaxEventCount, events))
             {
                 logging::GALogger::i("Event queue: No events to send");
                 getInstance().updateSessionTime();
                 return;
             }
 
-            // Check number of events and take some action if there are too many?
-            if (events.size() > MaxEventCount)
-            {
-                // Make a limit request
-                selectSql = utilities::printString("SELECT client_ts FROM ga_events WHERE status = 'new' %s ORDER BY client_ts ASC LIMIT 0,%d;", andCategory.c_str(), GAEvents::MaxEventCount);
-                store::GAStore::executeQuerySync(selectSql, events);
-                if (events.is_null())
-                {
-                    return;
-                }
-
-                // Get last timestamp
-                const json& lastItem = events.back();
-                const std::string lastTimestamp = lastItem["client_ts"].get<std::string>();
-
-                // Select again
-                selectSql = utilities::printString("SELECT event FROM ga_events WHERE status = 'new' %s AND client_ts<='%s';", andCategory.c_str(), lastTimestamp.c_str());
-                store::GAStore::executeQuerySync(selectSql, events);
-                if (events.is_null())
-                {
-                    return;
-                }
-
-                // Update sql
-                updateSql = utilities::printString("UPDATE ga_events SET status='%s' WHERE status='new' %s AND client_ts<='%s';", requestIdentifier.c_str(), andCategory.c_str(), lastTimestamp.c_str());
-            }
+            // the claim (and anything stored earlier in this pass) must not wait for the request
+            store::GAStore::endGroupCommit();
 
             // Log
             logging::GALogger::i("Event queue: Sending %d events.", events.size());
 
-            // Set status of events to 'sending' (also check for error)
-            json updateResult;
-            store::GAStore::executeQuerySync(updateSql, updateResult);
-            if (updateResult.is_null())
-            {
-                return;
-            }
-
+            // send events
+#if USE_UWP && defined(USE_UWP_HTTP)
             // Create payload data from events
             json payloadArray;
-            for (auto& node : events)
+            for (std::string const& eventDict : events)
             {
-                const std::string eventDict = utilities::getOptionalValue<std::string>(node, "event");
-                if (!eventDict.empty())
+                json d;
+                if (parseClaimedEvent(eventDict, d))
                 {
-                    try
-                    {
-                        json d = json::parse(eventDict);
-                        if(d.contains("client_ts") && d["client_ts"].is_number_integer())
-                        {
-                            if (!validators::GAValidator::validateClientTs(d["client_ts"].get<int64_t>()))
-                            {
-                                d.erase("client_ts");
-                            }
-                        }
-
-                        payloadArray.push_back(std::move(d));
-                    }
-                    catch(const json::exception& e)
-                    {
-                        logging::GALogger::d("processEvents -- JSON error: %s", e.what());
-                        logging::GALogger::d(eventDict.c_str());
-                    }
+                    payloadArray.push_back(std::move(d));
                 }
             }
 
-            // send events
             json dataDict;
             http::EGAHTTPApiResponse responseEnum;
             http::GAHTTPApi& http = http::GAHTTPApi::getInstance();
-
-#if USE_UWP && defined(USE_UWP_HTTP)
             std::pair<http::EGAHTTPApiResponse, std::string> pair;
 
             try
@@ -617,44 +642,156 @@ namespace gameanalytics
                     logging::GALogger::d("%s", pair.second.c_str());
                 }
             }
+
+            if (responseEnum == http::NoResponse)
+            {
+                instance.uploadRetry.onFailure();
+                logging::GALogger::w("Event queue: Failed to send events to collector - Retrying later");
+                store::GAStore::putBackEvents(requestIdentifier);
+                return;
+            }
+
+            instance.uploadRetry.onSuccess();
+            if (responseEnum == http::Ok)
+            {
+                store::GAStore::deleteEvents(requestIdentifier);
+                logging::GALogger::i("Event queue: %d events sent.", events.size());
+            }
+            else
+            {
+                logging::GALogger::w("Event queue: Failed to send events.");
+                store::GAStore::deleteEvents(requestIdentifier);
+            }
 #else
-            responseEnum = http.sendEventsInArray(dataDict, payloadArray);
+            PendingUpload upload;
+            upload.requestId = requestIdentifier;
+            upload.events    = events.size();
+
+            // serialized, compressed and signed once, however many attempts it takes; the events go into the
+            // body one by one, neither the batch as JSON objects nor its JSON text is ever held whole
+            http::GAPayloadWriter writer = http::GAHTTPApi::getInstance().createPayloadWriter();
+            std::size_t written = 0;
+            writer.write("[", 1);
+            for (std::string const& eventDict : events)
+            {
+                json d;
+                if (!parseClaimedEvent(eventDict, d))
+                {
+                    continue;
+                }
+
+                try
+                {
+                    if (written++ > 0)
+                    {
+                        writer.write(",", 1);
+                    }
+                    writer.write(d);
+                }
+                catch(const json::exception& e)
+                {
+                    // the body is broken half way through
+                    logging::GALogger::e("processEvents -- JSON encoding failed: %s", e.what());
+                    written = 0;
+                    break;
+                }
+            }
+            writer.write("]", 1);
+
+            if (written == 0 || !writer.finish(upload.payload))
+            {
+                logging::GALogger::w("Event queue: Failed to send events.");
+                store::GAStore::deleteEvents(requestIdentifier);
+                return;
+            }
+
+            logging::GALogger::d("Gzip stats. Size: %zu, Compressed: %zu", upload.payload.jsonBytes, upload.payload.body->size());
+
+            instance.pendingUpload = std::move(upload);
+            instance.sendPendingUpload();
 #endif
+        }
+
+        bool GAEvents::mayUpload()
+        {
+            // a different network (offline to wifi, wifi to wwan, ...) may well reach the collector right away
+            const std::string connectionType = device::GADevice::getConnectionType();
+            if (connectionType != lastConnectionType)
+            {
+                if (!lastConnectionType.empty())
+                {
+                    uploadRetry.reset();
+                }
+                lastConnectionType = connectionType;
+            }
+
+            if (uploadRetry.allowAttempt())
+            {
+                return true;
+            }
+
+            const auto wait = std::chrono::duration_cast<std::chrono::seconds>(uploadRetry.getNextAttempt() - http::GARetryPolicy::Clock::now());
+            logging::GALogger::d("Event queue: collector unreachable, next attempt in %lld s", static_cast<long long>(wait.count()));
+            return false;
+        }
+
+        void GAEvents::sendPendingUpload()
+        {
+            json dataDict;
+            const http::EGAHTTPApiResponse responseEnum = http::GAHTTPApi::getInstance().sendEventsPayload(dataDict, pendingUpload.payload);
+
+            // Keep the events claimed (Only in case of no response)
+            if (responseEnum == http::NoResponse)
+            {
+                uploadRetry.onFailure();
+
+                if (uploadRetry.getState() == http::GARetryPolicy::State::Open)
+                {
+                    logging::GALogger::w("Event queue: Failed to send events to collector %d times in a row - pausing uploads", uploadRetry.getConsecutiveFailures());
+                }
+                else
+                {
+                    logging::GALogger::w("Event queue: Failed to send events to collector - Retrying later");
+                }
+                return;
+            }
+
+            uploadRetry.onSuccess();
+
+            const PendingUpload upload = std::move(pendingUpload);
+            pendingUpload = PendingUpload();
 
             if (responseEnum == http::Ok)
             {
                 // Delete events
-                store::GAStore::executeQuerySync(deleteSql);
+                store::GAStore::deleteEvents(upload.requestId);
 
-                logging::GALogger::i("Event queue: %d events sent.", events.size());
+                logging::GALogger::i("Event queue: %d events sent.", static_cast<int>(upload.events));
             }
             else
             {
-                // Put events back (Only in case of no response)
-                if (responseEnum == http::NoResponse)
+                if (responseEnum == http::BadRequest && dataDict.is_array())
                 {
-                    logging::GALogger::w("Event queue: Failed to send events to collector - Retrying next time");
-                    store::GAStore::executeQuerySync(putbackSql);
-                    // Delete events (When getting some anwser back always assume events are processed)
+                    logging::GALogger::w("Event queue: %d events sent. %d events failed GA server validation.", static_cast<int>(upload.events), static_cast<int>(dataDict.size()));
                 }
                 else
                 {
-                    if (responseEnum == http::BadRequest && dataDict.is_array())
-                    {
-                        logging::GALogger::w("Event queue: %d events sent. %d events failed GA server validation.", events.size(), dataDict.size());
-                    }
-                    else
-                    {
-                        logging::GALogger::w("Event queue: Failed to send events.");
-                    }
-
-                    store::GAStore::executeQuerySync(deleteSql);
+                    logging::GALogger::w("Event queue: Failed to send events.");
                 }
+
+                // Delete events (When getting some anwser back always assume events are processed)
+                store::GAStore::deleteEvents(upload.requestId);
             }
         }
 
         void GAEvents::updateSessionTime()
         {
+            // player sessions are ended explicitly, there is no crash recovery record for them
+            if(state::GAState::isServerMode())
+            {
+                return;
+            }
+
             if(state::GAState::sessionIsStarted())
             {
                 try
@@ -668,14 +805,12 @@ namespace gameanalytics
                     json cleanedFields = state::GAState::getValidatedCustomFields();
                     GAEvents::addCustomFieldsToEvent(ev, cleanedFields);
 
-                    std::string jsonDefaults = ev.dump();
-                    constexpr const char* sql = "INSERT OR REPLACE INTO ga_session(session_id, timestamp, event) VALUES(?, ?, ?);";
-                    state::GAState& state = state::GAState::getInstance();
+                    store::SessionCheckpoint session;
+                    session.sessionId = ev["session_id"].get<std::string>();
+                    session.startTs   = state::GAState::getInstance().getSessionStart();
+                    session.event     = ev.dump();
 
-                    const std::string sessionStart = std::to_string(state.getSessionStart());
-                    
-                    const StringVector parameters = { ev["session_id"].get<std::string>(), sessionStart, jsonDefaults};
-                    store::GAStore::executeQuerySync(sql, parameters);
+                    store::GAStore::checkpointSession(session);
                 }
                 catch(json::exception const& e)
                 {
@@ -690,7 +825,7 @@ namespace gameanalytics
 
         void GAEvents::cleanupEvents()
         {
-            store::GAStore::executeQuerySync("UPDATE ga_events SET status = 'new';");
+            store::GAStore::resetEventStatus();
         }
 
         void GAEvents::fixMissingSessionEndEvents()
@@ -701,14 +836,16 @@ namespace gameanalytics
             }
 
             // Get all sessions that are not current
-            StringVector const parameters = { state::GAState::getSessionId() };
-
-            constexpr const char* sql = "SELECT timestamp, event FROM ga_session WHERE session_id != ?;";
+            const std::string currentSessionId = state::GAState::getSessionId();
 
-            json sessions;
-            store::GAStore::executeQuerySync(sql, parameters, sessions);
+            std::vector<store::SessionCheckpoint> sessions = store::GAStore::getSessions();
+            sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                [&currentSessionId](store::SessionCheckpoint const& session)
+                {
+                    return session.sessionId == currentSessionId || session.event.empty();
+                }), sessions.end());
 
-            if (sessions.is_null() || sessions.empty())
+            if (sessions.empty())
             {
                 return;
             }
@@ -716,37 +853,33 @@ namespace gameanalytics
             logging::GALogger::i("%d session(s) located with missing session_end event.", sessions.size());
 
             // Add missing session_end events
-            for (json& session : sessions)
+            for (store::SessionCheckpoint const& session : sessions)
             {
-                if(session.contains("event"))
+                try
                 {
-                    try
-                    {
-                        json sessionEndEvent = json::parse(session["event"].get<std::string>());
+                    json sessionEndEvent = json::parse(session.event);
 
-                        int64_t event_ts = utilities::getOptionalValue<int64_t>(sessionEndEvent, "client_ts", 0);
-                        int64_t start_ts = std::stoll(utilities::getOptionalValue<std::string>(session, "timestamp", "0"));
+                    int64_t event_ts = utilities::getOptionalValue<int64_t>(sessionEndEvent, "client_ts", 0);
 
-                        int64_t length = event_ts - start_ts;
-                        length = static_cast<int64_t>(fmax(length, 0));
+                    int64_t length = event_ts - session.startTs;
+                    length = static_cast<int64_t>(fmax(length, 0));
 
-                        logging::GALogger::d("fixMissingSessionEndEvents length calculated: %lld", length);
+                    logging::GALogger::d("fixMissingSessionEndEvents length calculated: %lld", length);
 
-                        sessionEndEvent["category"] = GAEvents::CategorySessionEnd;
-                        sessionEndEvent["length"]   = length;
+                    sessionEndEvent["category"] = GAEvents::CategorySessionEnd;
+                    sessionEndEvent["length"]   = length;
 
-                        // Add to store
-                        addEventToStore(sessionEndEvent);
-                    }
-                    catch(json::exception const& e)
-                    {
-                        logging::GALogger::d("fixMissingSessionEndEvents -- JSON error: %s", e.what());
-                        logging::GALogger::d("%s", session["event"].dump(JSON_PRINT_INDENT).c_str());
-                    }
-                    catch(std::exception const& e)
-                    {
-                        logging::GALogger::e("fixMissingSessionEndEvents - Exception thrown: %s", e.what());
-                    }
+                    // Add to store
+                    addEventToStore(sessionEndEvent);
+                }
+                catch(json::exception const& e)
+                {
+                    logging::GALogger::d("fixMissingSessionEndEvents -- JSON error: %s", e.what());
+                    logging::GALogger::d("%s", session.event.c_str());
+                }
+                catch(std::exception const& e)
+                {
+                    logging::GALogger::e("fixMissingSessionEndEvents - Exception thrown: %s", e.what());
                 }
             }
         }
@@ -787,6 +920,7 @@ namespace gameanalytics
                 if (store::GAStore::isDbTooLargeForEvents() && !utilities::GAUtilities::stringMatch(eventData["category"].get<std::string>(), "^(user|session_end|business)$"))
                 {
                     logging::GALogger::w("Database too large. Event has been blocked.");
+                    store::GAStore::addBlockedEvent();
                     http::GAHTTPApi& httpInstance = http::GAHTTPApi::getInstance();
                     httpInstance.sendSdkErrorEvent(http::EGASdkErrorCategory::Database, http::EGASdkErrorArea::AddEventsToStore, http::EGASdkErrorAction::DatabaseTooLarge, (http::EGASdkErrorParameter)0, "", state::GAState::getGameKey(), state::GAState::getGameSecret());
                     return;
@@ -795,9 +929,7 @@ namespace gameanalytics
                 // Get default annotations
                 json ev;
                 state::GAState::getEventAnnotations(ev);
-                
-                logging::GALogger::i(ev.dump().c_str());
-                
+
                 ev.merge_patch(eventData);
 
                 const std::string jsonString = ev.dump();
@@ -806,20 +938,24 @@ namespace gameanalytics
                 logging::GALogger::v("Event added to queue: %s", jsonString.c_str());
 
                 // Add to store
-                std::string const clientTS = std::to_string(ev["client_ts"].get<int64_t>());
-                StringVector parameters = { "new", ev["category"].get<std::string>(), ev["session_id"].get<std::string>(), clientTS, jsonString };
-                constexpr const char* sql = "INSERT INTO ga_events (status, category, session_id, client_ts, event) VALUES(?, ?, ?, ?, ?);";
-
-                store::GAStore::executeQuerySync(sql, parameters);
-
-                // Add to session store if not last
+                const std::string sessionId = ev["session_id"].get<std::string>();
                 if (eventData["category"].get<std::string>() == GAEvents::CategorySessionEnd)
                 {
-                    StringVector params = { ev["session_id"].get<std::string>() };
-                    store::GAStore::executeQuerySync("DELETE FROM ga_session WHERE session_id = ?;", params);
+                    // the checkpoint stays until session_end is persisted, a crash before that gets it rebuilt
+                    store::GAStore::addEvent(ev["category"].get<std::string>(), sessionId, ev["client_ts"].get<int64_t>(), ev,
+                        [sessionId](bool persisted)
+                        {
+                            if (persisted)
+                            {
+                                store::GAStore::removeSession(sessionId);
+                            }
+                        });
                 }
                 else
                 {
+                    store::GAStore::addEvent(ev["category"].get<std::string>(), sessionId, ev["client_ts"].get<int64_t>(), ev);
+
+                    // Add to session store if not last
                     GAEvents::updateSessionTime();
                 }
             }
@@ -858,6 +994,27 @@ namespace gameanalytics
             }
         }
 
+        void GAEvents::addQueueStatsToEvent(json& eventData)
+        {
+            const GAQueueStats stats = store::GAStore::getQueueStats(state::GAState::getClientTsAdjusted());
+
+            json fields = json::object();
+            fields["queue_events"]          = stats.queuedEvents;
+            fields["queue_in_flight"]       = stats.inFlightEvents;
+            fields["queue_pending_writes"]  = stats.pendingWrites;
+            fields["queue_bytes"]           = stats.sizeBytes;
+            fields["queue_oldest_age"]      = stats.oldestEventAgeSeconds;
+            fields["queue_evicted"]         = stats.evictedEvents;
+            fields["queue_dropped"]         = stats.droppedEvents;
+
+            for (auto const& bytes : stats.bytesByCategory)
+            {
+                fields["queue_bytes_" + bytes.first] = bytes.second;
+            }
+
+            addCustomFieldsToEvent(eventData, fields);
+        }
+
         std::string GAEvents::progressionStatusString(EGAProgressionStatus progressionStatus)
         {
             switch (progressionStatus) 
@@ -973,7 +1130,7 @@ namespace gameanalytics
                 }
 
                 GAHealth* healthTracker = device::GADevice::getHealthTracker();
-                if(!healthTracker)
+                if(!healthTracker && !getInstance().enableQueueStatsInHealthEvent)
                 {
                     return;
                 }
@@ -984,8 +1141,16 @@ namespace gameanalytics
                 // insert event specific values
                 eventDict["category"] = GAEvents::CategoryHealth;
 
-                healthTracker->addHealthAnnotations(eventDict);
-                healthTracker->addPerformanceData(eventDict);
+                if(healthTracker)
+                {
+                    healthTracker->addHealthAnnotations(eventDict);
+                    healthTracker->addPerformanceData(eventDict);
+                }
+
+                if(getInstance().enableQueueStatsInHealthEvent)
+                {
+                    getInstance().addQueueStatsToEvent(eventDict);
+                }
 
                 // Add custom dimensions
                 getInstance().addDimensionsToEvent(eventDict);
@@ -6,6 +6,8 @@
 #pragma once
 
 #include "GACommon.h"
+#include "GARetryPolicy.h"
+#include "GAPayloadWriter.h"
 
 namespace gameanalytics
 {
@@ -39,6 +41,7 @@ namespace gameanalytics
 
             bool enableSDKInitEvent{false};
             bool enableHealthEvent{false};
+            bool enableQueueStatsInHealthEvent{false};
 
         private:
 
@@ -54,6 +57,7 @@ namespace gameanalytics
             static constexpr int         MaxEventCount                  = 500;
 
             static constexpr std::chrono::milliseconds PROCESS_EVENTS_INTERVAL{8000};
+            static constexpr std::chrono::milliseconds STORE_WRITE_INTERVAL{100};
 
             GAEvents();
             ~GAEvents();
@@ -66,10 +70,28 @@ namespace gameanalytics
             void addEventToStore(json& eventData);
             void addDimensionsToEvent(json& eventData);
             void addCustomFieldsToEvent(json& eventData, json& fields);
+            void addQueueStatsToEvent(json& eventData);
+            void sendRecoveryReports();
             void updateSessionTime();
+            bool mayUpload();
+            // an event claimed for upload, without a client_ts the collector would reject; false if it is damaged
+            static bool parseClaimedEvent(std::string const& eventDict, json& out);
+            void sendPendingUpload();
+
+            // a batch that got no answer: its events stay claimed and the same body goes out again
+            struct PendingUpload
+            {
+                std::string     requestId;
+                std::size_t     events = 0;
+                http::GAPayload payload;
+            };
 
             bool isRunning  {false};
             bool keepRunning{false};
+
+            http::GARetryPolicy uploadRetry;
+            PendingUpload       pendingUpload;
+            std::string         lastConnectionType;
         };
     }
 }
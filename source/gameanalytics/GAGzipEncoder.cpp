@@ -0,0 +1,144 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAGzipEncoder.h"
+#include "GALogger.h"
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "GA_Zip.cpp"
+
+namespace gameanalytics
+{
+    namespace utilities
+    {
+        using namespace zip;
+
+        namespace
+        {
+            // magic, deflate, no flags, no mtime, no extra flags, Unix
+            constexpr uint8_t Header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+
+            mz_bool appendOutput(const void* buffer, int length, void* user)
+            {
+                std::vector<uint8_t>& out = *static_cast<std::vector<uint8_t>*>(user);
+                const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+                out.insert(out.end(), bytes, bytes + length);
+                return MZ_TRUE;
+            }
+
+            void appendLittleEndian(std::vector<uint8_t>& out, uint32_t v)
+            {
+                out.push_back(static_cast<uint8_t>(v));
+                out.push_back(static_cast<uint8_t>(v >> 8));
+                out.push_back(static_cast<uint8_t>(v >> 16));
+                out.push_back(static_cast<uint8_t>(v >> 24));
+            }
+        }
+
+        struct GAGzipEncoder::State
+        {
+            tdefl_compressor compressor;
+        };
+
+        GAGzipEncoder::GAGzipEncoder(int level):
+            _state(new State),
+            _level(level)
+        {
+        }
+
+        GAGzipEncoder::~GAGzipEncoder() = default;
+
+        GAGzipEncoder& GAGzipEncoder::forThisThread()
+        {
+            thread_local GAGzipEncoder encoder;
+            return encoder;
+        }
+
+        void GAGzipEncoder::setLevel(int level)
+        {
+            _level = level;
+        }
+
+        int GAGzipEncoder::level() const
+        {
+            return _level;
+        }
+
+        bool GAGzipEncoder::begin(std::vector<uint8_t>& out)
+        {
+            out.assign(Header, Header + sizeof(Header));
+
+            _out  = &out;
+            _crc  = MZ_CRC32_INIT;
+            _size = 0;
+
+            // raw deflate, the gzip header and trailer are ours
+            const int flags = static_cast<int>(tdefl_create_comp_flags_from_zip_params(_level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+            if (tdefl_init(&_state->compressor, appendOutput, _out, flags) != TDEFL_STATUS_OKAY)
+            {
+                return fail("init");
+            }
+
+            return true;
+        }
+
+        bool GAGzipEncoder::write(const void* data, size_t size)
+        {
+            if (!_out)
+            {
+                return false;
+            }
+
+            if (size == 0)
+            {
+                return true;
+            }
+
+            _crc   = static_cast<uint32_t>(mz_crc32(_crc, static_cast<const unsigned char*>(data), size));
+            _size += static_cast<uint32_t>(size);
+
+            if (tdefl_compress_buffer(&_state->compressor, data, size, TDEFL_NO_FLUSH) != TDEFL_STATUS_OKAY)
+            {
+                return fail("write");
+            }
+
+            return true;
+        }
+
+        bool GAGzipEncoder::finish()
+        {
+            if (!_out)
+            {
+                return false;
+            }
+
+            if (tdefl_compress_buffer(&_state->compressor, nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+            {
+                return fail("finish");
+            }
+
+            // ISIZE is the input size modulo 2^32
+            appendLittleEndian(*_out, _crc);
+            appendLittleEndian(*_out, _size);
+
+            _out = nullptr;
+            return true;
+        }
+
+        bool GAGzipEncoder::encode(const void* data, size_t size, std::vector<uint8_t>& out)
+        {
+            return begin(out) && write(data, size) && finish();
+        }
+
+        bool GAGzipEncoder::fail(const char* step)
+        {
+            logging::GALogger::e("gzip compression failed (%s), level: %d", step, _level);
+
+            _out->clear();
+            _out = nullptr;
+            return false;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gameanalytics
+{
+    namespace utilities
+    {
+        // gzip (RFC 1952) in a single pass: the deflate blocks go straight into the caller's buffer while the
+        // CRC and the size of the input are taken as it goes by. The compressor state is large (about 300 KB),
+        // keep an encoder around and reuse it rather than making one per payload
+        class GAGzipEncoder
+        {
+         public:
+
+            // 1 is the fastest, 9 the smallest; 6 is where event payloads stop shrinking much for the time spent
+            static constexpr int DefaultLevel = 6;
+
+            explicit GAGzipEncoder(int level = DefaultLevel);
+            ~GAGzipEncoder();
+            GAGzipEncoder(const GAGzipEncoder&) = delete;
+            GAGzipEncoder& operator=(const GAGzipEncoder&) = delete;
+
+            // an encoder kept for the calling thread, it writes one gzip member at a time
+            static GAGzipEncoder& forThisThread();
+
+            // applies from the next begin()
+            void setLevel(int level);
+            int level() const;
+
+            // starts a gzip member in 'out', which is cleared first (its capacity is kept)
+            bool begin(std::vector<uint8_t>& out);
+
+            // compresses the next 'size' bytes of the input, any number of calls
+            bool write(const void* data, size_t size);
+
+            // flushes the last block and appends the CRC and size trailer
+            bool finish();
+
+            // begin(), write() and finish() for input that is at hand in one piece
+            bool encode(const void* data, size_t size, std::vector<uint8_t>& out);
+
+         private:
+
+            bool fail(const char* step);
+
+            struct State;
+
+            std::unique_ptr<State> _state;
+            std::vector<uint8_t>*  _out  = nullptr;
+            uint32_t               _crc  = 0;
+            uint32_t               _size = 0;
+            int                    _level;
+        };
+    }
+}
@@ -9,30 +9,15 @@
 #include "GALogger.h"
 #include "GAUtilities.h"
 #include "GAValidator.h"
+#include <cstring>
 
 namespace gameanalytics
 {
     namespace http
     {
-        size_t writefunc(void *ptr, size_t size, size_t nmemb, ResponseData *s)
-        {
-            const size_t new_len = s->packet.size() + size * nmemb + 1;
-            s->packet.reserve(new_len);
-
-            s->packet.insert(s->packet.end(), reinterpret_cast<char*>(ptr), reinterpret_cast<char*>(ptr) + size * nmemb);
-            s->packet.push_back('\0');
-
-            return size*nmemb;
-        }
-
         // Constructor - setup the basic information for HTTP
         GAHTTPApi::GAHTTPApi()
         {
-            curl_global_init(CURL_GLOBAL_DEFAULT);
-
-            baseUrl              = protocol + "://" + hostName + "/" + version;
-            remoteConfigsBaseUrl = protocol + "://" + hostName + "/remote_configs/" + remoteConfigsVersion;
-
             // use gzip compression on JSON body
 #if defined(_DEBUG)
             useGzip = false;
@@ -41,28 +26,69 @@ namespace gameanalytics
 #endif
         }
 
-        GAHTTPApi::~GAHTTPApi()
-        {
-            curl_global_cleanup();
-        }
+        GAHTTPApi::~GAHTTPApi() = default;
 
         GAHTTPApi& GAHTTPApi::getInstance()
         {
             return state::GAState::getInstance()._gaHttp;
         }
 
+        void GAHTTPApi::setEndpoints(GAEndpointSettings const& settings)
+        {
+            endpoints = settings;
+        }
+
+        GAEndpointSettings const& GAHTTPApi::getEndpoints() const
+        {
+            return endpoints;
+        }
+
+        void GAHTTPApi::setGzipLevel(int level)
+        {
+            gzipLevel = level;
+        }
+
+        int GAHTTPApi::getGzipLevel() const
+        {
+            return gzipLevel;
+        }
+
+        void GAHTTPApi::setTransport(std::shared_ptr<ITransport> transport)
+        {
+            client.setTransport(std::move(transport));
+        }
+
+        std::string GAHTTPApi::eventsUrl(std::string const& gameKey) const
+        {
+            static constexpr const char* GameKeyPlaceholder = "{game_key}";
+
+            std::string path = endpoints.eventsPath;
+            const std::size_t placeholder = path.find(GameKeyPlaceholder);
+            if (placeholder != std::string::npos)
+            {
+                path.replace(placeholder, std::strlen(GameKeyPlaceholder), gameKey);
+            }
+
+            return endpoints.baseUrl + path;
+        }
+
         EGAHTTPApiResponse GAHTTPApi::requestInitReturningDict(json& json_out, std::string const& configsHash)
+        {
+            json initAnnotations;
+            state::GAState::getInitAnnotations(initAnnotations);
+
+            return requestInitReturningDict(json_out, configsHash, initAnnotations);
+        }
+
+        EGAHTTPApiResponse GAHTTPApi::requestInitReturningDict(json& json_out, std::string const& configsHash, json const& initAnnotations)
         {
             std::string gameKey = state::GAState::getGameKey();
 
             // Generate URL
-            std::string url = remoteConfigsBaseUrl + "/" + initializeUrlPath + "?game_key=" + gameKey + "&interval_seconds=0&configs_hash=" + configsHash + "&config_vsn_supported=3";
+            std::string url = endpoints.baseUrl + endpoints.initPath + "?game_key=" + gameKey + "&interval_seconds=0&configs_hash=" + configsHash + "&config_vsn_supported=3";
 
             logging::GALogger::d("Sending 'init' URL: %s", url.c_str());
 
-            json initAnnotations;
-            state::GAState::getInitAnnotations(initAnnotations);
-            
             try
             {
                 std::string jsonString = initAnnotations.dump();
@@ -71,55 +97,41 @@ namespace gameanalytics
                     return JsonEncodeFailed;
                 }
 
-                std::vector<uint8_t> payloadData = createPayloadData(jsonString, useGzip);
-
-                CURL* curl = nullptr;
-                CURLcode res;
-                curl = curl_easy_init();
-                if (!curl)
+                GAPayload payload;
+                if (!createPayload(jsonString, payload))
                 {
-                    return NoResponse;
+                    return JsonEncodeFailed;
                 }
 
-                curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-
-                ResponseData s;
-
-                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
-                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
-
-                std::vector<uint8_t> authorization = createRequest(curl, url, payloadData, useGzip);
-
-                res = curl_easy_perform(curl);
-                if (res != CURLE_OK)
+                GAHTTPResponse const result = client.post(url, createHeaders(payload), payload.body);
+                if (result.statusCode == 0)
                 {
-                    logging::GALogger::d(curl_easy_strerror(res));
+                    logging::GALogger::d("%s", result.error.c_str());
                     return NoResponse;
                 }
 
-                long response_code{};
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-                curl_easy_cleanup(curl);
+                std::string const& s = result.body;
+                long const response_code = result.statusCode;
 
                 // process the response
-                logging::GALogger::d("init request content: %s, json: %s", s.toString().c_str(), jsonString.c_str());
+                logging::GALogger::d("init request content: %s, json: %s", s.c_str(), jsonString.c_str());
 
-                json requestJsonDict = json::parse(s.toString());
-
-                EGAHTTPApiResponse requestResponseEnum = processRequestResponse(response_code, s.packet.data(), "Init");
+                EGAHTTPApiResponse requestResponseEnum = processRequestResponse(response_code, s.c_str(), "Init");
 
                 // if not 200 result
                 if (requestResponseEnum != Ok && requestResponseEnum != Created && requestResponseEnum != BadRequest)
                 {
-                    logging::GALogger::d("Failed Init Call. URL: %s, JSONString: %s, Authorization: %s", url.c_str(), jsonString.c_str(), authorization.data());
+                    logging::GALogger::d("Failed Init Call. URL: %s, JSONString: %s, Authorization: %s", url.c_str(), jsonString.c_str(), payload.authorization.c_str());
 
                     return requestResponseEnum;
                 }
 
-                if (requestJsonDict.is_null())
+                // an error page from a proxy is not JSON, its status says enough
+                json requestJsonDict = json::parse(s, nullptr, false);
+                if (requestJsonDict.is_discarded() || requestJsonDict.is_null())
                 {
                     logging::GALogger::d("Failed Init Call. Json decoding failed");
-                    return JsonDecodeFailed;
+                    return requestResponseEnum == BadRequest ? BadRequest : JsonDecodeFailed;
                 }
 
                 // print reason if bad request
@@ -155,6 +167,18 @@ namespace gameanalytics
         }
 
         EGAHTTPApiResponse GAHTTPApi::sendEventsInArray(json& json_out, const json& eventArray)
+        {
+            GAPayload payload;
+            const EGAHTTPApiResponse encoded = encodeEvents(eventArray, payload);
+            if (encoded != Ok)
+            {
+                return encoded;
+            }
+
+            return sendEventsPayload(json_out, payload);
+        }
+
+        EGAHTTPApiResponse GAHTTPApi::encodeEvents(const json& eventArray, GAPayload& payload)
         {
             if (eventArray.empty())
             {
@@ -162,81 +186,78 @@ namespace gameanalytics
                 return JsonEncodeFailed;
             }
 
-            const std::string gameKey = state::GAState::getGameKey();
-
             try
             {
-                // Generate URL
-                const std::string url = baseUrl + '/' + gameKey + '/' + eventsUrlPath;
-                logging::GALogger::d("Sending 'events' URL: %s", url.c_str());
-
-                std::string const jsonString = eventArray.dump();
-                if (jsonString.empty())
+                GAPayloadWriter writer = createPayloadWriter();
+                writer.write(eventArray);
+                if (!writer.finish(payload))
                 {
                     logging::GALogger::d("sendEventsInArray JSON encoding failed of eventArray");
                     return JsonEncodeFailed;
                 }
 
-                std::vector<uint8_t> payloadData = createPayloadData(jsonString, useGzip);
-
-                CURL* curl = nullptr;
-                CURLcode res{};
-                curl = curl_easy_init();
-                if (!curl)
-                {
-                    return NoResponse;
-                }
-
-                curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+                logging::GALogger::d("Gzip stats. Size: %zu, Compressed: %zu", payload.jsonBytes, payload.body->size());
 
-                ResponseData s = {};
+                return Ok;
+            }
+            catch (json::exception& e)
+            {
+                logging::GALogger::e("Json exception: %s", e.what());
+                return JsonEncodeFailed;
+            }
+        }
 
-                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
-                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
+        EGAHTTPApiResponse GAHTTPApi::sendEventsPayload(json& json_out, GAPayload const& payload)
+        {
+            const std::string gameKey = state::GAState::getGameKey();
 
-                std::vector<uint8_t> authorization = createRequest(curl, url, payloadData, useGzip);
+            try
+            {
+                // Generate URL
+                const std::string url = eventsUrl(gameKey);
+                logging::GALogger::d("Sending 'events' URL: %s", url.c_str());
 
-                res = curl_easy_perform(curl);
-                if (res != CURLE_OK)
+                GAHTTPResponse const result = client.post(url, createHeaders(payload), payload.body);
+                if (result.statusCode == 0)
                 {
-                    logging::GALogger::d(curl_easy_strerror(res));
+                    logging::GALogger::d("%s", result.error.c_str());
                     return NoResponse;
                 }
 
-                long response_code{};
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-                curl_easy_cleanup(curl);
-
-                logging::GALogger::d("body: %s", s.toString().c_str());
+                std::string const& s = result.body;
+                long const response_code = result.statusCode;
 
-                EGAHTTPApiResponse requestResponseEnum = processRequestResponse(response_code, s.packet.data(), "Events");
+                EGAHTTPApiResponse requestResponseEnum = processRequestResponse(response_code, s.c_str(), "Events");
 
-                // if not 200 result
-                if (requestResponseEnum != Ok && requestResponseEnum != Created && requestResponseEnum != BadRequest)
+                // accepted batches carry nothing the SDK reads, only their status matters
+                if (requestResponseEnum == Ok || requestResponseEnum == Created)
                 {
-                    logging::GALogger::d("Failed Events Call. URL: %s, JSONString: %s, Authorization: %s", url.c_str(), jsonString.c_str(), authorization.data());
                     return requestResponseEnum;
                 }
 
-                // decode JSON
-                json requestJsonDict = json::parse(s.toString());
-                if (requestJsonDict.is_null())
+                if (requestResponseEnum != BadRequest)
                 {
-                    return JsonDecodeFailed;
+                    logging::GALogger::d("Failed Events Call. URL: %s, Payload: %zu bytes, Authorization: %s", url.c_str(), payload.body->size(), payload.authorization.c_str());
+                    return requestResponseEnum;
                 }
 
-                // print reason if bad request
-                if (requestResponseEnum == BadRequest)
+                if (result.truncated)
                 {
-                    logging::GALogger::d("Failed Events Call. Bad request. Response: %s", 
-                        requestJsonDict.dump(JSON_PRINT_INDENT).c_str());
+                    logging::GALogger::d("Failed Events Call. Bad request. Response truncated at %zu bytes", s.size());
+                    return requestResponseEnum;
+                }
 
+                // the events the collector rejected, unless a proxy answered with an error page
+                json requestJsonDict = json::parse(s, nullptr, false);
+                if (requestJsonDict.is_discarded() || requestJsonDict.is_null())
+                {
+                    logging::GALogger::d("Failed Events Call. Bad request. Response is not JSON");
                     return requestResponseEnum;
                 }
 
-                json_out.merge_patch(requestJsonDict);
+                logging::GALogger::d("Failed Events Call. Bad request. Response: %s", s.c_str());
 
-                // return response
+                json_out = std::move(requestJsonDict);
                 return requestResponseEnum;
             }
             catch (json::exception& e)
@@ -265,7 +286,7 @@ namespace gameanalytics
             }
 
             // Generate URL
-            const std::string url = baseUrl + "/" + gameKey + "/" + eventsUrlPath;
+            const std::string url = eventsUrl(gameKey);
 
             logging::GALogger::d("Sending 'events' URL: %s", url.c_str());
 
@@ -294,10 +315,9 @@ namespace gameanalytics
 #if !NO_ASYNC
             ErrorType errorType = std::make_tuple(category, area);
 
-            bool useGzip = this->useGzip;
-
-            auto task = std::async(std::launch::async, [=]() -> void
             {
+                std::lock_guard<std::mutex> lock(errorCountMutex);
+
                 int64_t now = utilities::GAUtilities::timeIntervalSince1970();
                 if(timestampMap.count(errorType) == 0)
                 {
@@ -307,7 +327,7 @@ namespace gameanalytics
                 {
                     countMap[errorType] = 0;
                 }
-                
+
                 constexpr int64_t FREQUENCY = 3600; // 1h
 
                 int64_t diff = now - timestampMap[errorType];
@@ -321,103 +341,86 @@ namespace gameanalytics
                 {
                     return;
                 }
+            }
 
-                std::vector<uint8_t> payloadData = getInstance().createPayloadData(payloadJSONString, useGzip);
-
-                CURL *curl = nullptr;
-                CURLcode res;
-                curl = curl_easy_init();
-                if(!curl)
-                {
-                    return;
-                }
-
-                curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-
-                ResponseData s = {};
-
-                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
-                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
-
-                getInstance().createRequest(curl, url.data(), payloadData, useGzip);
-
-                res = curl_easy_perform(curl);
-                if(res != CURLE_OK)
-                {
-                    logging::GALogger::d(curl_easy_strerror(res));
-                    return;
-                }
+            GAPayload payload;
+            if (!createPayload(payloadJSONString, payload))
+            {
+                return;
+            }
 
-                long statusCode{};
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
-                curl_easy_cleanup(curl);
+            std::vector<std::string> headers = createHeaders(payload);
 
-                // process the response
-                logging::GALogger::d("sdk error content : %s", s.toString().c_str());;
+            // the answer comes back on the HTTP engine's thread, keep it bound to the instance that reported the error
+            state::GAState* owner = &state::GAState::getInstance();
 
-                // if not 200 result
-                if (statusCode != 200)
+            client.postAsync(url, std::move(headers), std::move(payload.body),
+                [this, owner, errorType](GAHTTPResponse&& result)
                 {
-                    logging::GALogger::d("sdk error failed. response code not 200. status code: %u", CURLE_OK);
-                    return;
-                }
-
-                countMap[errorType] = countMap[errorType] + 1;
-            });
+                    if(client.isCancelled())
+                    {
+                        // the instance is going away
+                        return;
+                    }
+
+                    state::GAState::Scope scope(owner);
+
+                    if(result.statusCode == 0)
+                    {
+                        logging::GALogger::d("%s", result.error.c_str());
+                        return;
+                    }
+
+                    // process the response
+                    logging::GALogger::d("sdk error content : %s", result.body.c_str());
+
+                    // if not 200 result
+                    if (result.statusCode != 200)
+                    {
+                        logging::GALogger::d("sdk error failed. response code not 200. status code: %ld", result.statusCode);
+                        return;
+                    }
+
+                    std::lock_guard<std::mutex> lock(errorCountMutex);
+                    countMap[errorType] = countMap[errorType] + 1;
+                });
 #endif
         }
 
-        std::vector<uint8_t> GAHTTPApi::createPayloadData(std::string const& payload, bool gzip)
+        GAPayloadWriter GAHTTPApi::createPayloadWriter() const
         {
-            if (payload.empty())
-            {
-                return {};
-            }
-
-            std::vector<uint8_t> payloadData;
+            return GAPayloadWriter(useGzip, state::GAState::getGameSecret(), gzipLevel);
+        }
 
-            if (gzip)
-            {
-                payloadData = utilities::GAUtilities::gzipCompress(payload.c_str());
-                logging::GALogger::d("Gzip stats. Size: %lu, Compressed: %lu", payload.size(), payloadData.size());
-            }
-            else
+        bool GAHTTPApi::createPayload(std::string const& jsonString, GAPayload& payload) const
+        {
+            GAPayloadWriter writer = createPayloadWriter();
+            writer.write(jsonString.data(), jsonString.size());
+            if (!writer.finish(payload))
             {
-                payloadData = std::vector<uint8_t>(payload.begin(), payload.end());
+                return false;
             }
 
-            return payloadData;
+            logging::GALogger::d("Gzip stats. Size: %zu, Compressed: %zu", payload.jsonBytes, payload.body->size());
+            return true;
         }
 
-        std::vector<uint8_t> GAHTTPApi::createRequest(CURL *curl, std::string const& url, const std::vector<uint8_t>& payloadData, bool gzip)
+        std::vector<std::string> GAHTTPApi::createHeaders(GAPayload const& payload) const
         {
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_POST, 1L);
-            struct curl_slist *header = NULL;
+            std::vector<std::string> headers;
 
-            if (gzip)
+            if (payload.gzip)
             {
-                header = curl_slist_append(header, "Content-Encoding: gzip");
+                headers.push_back("Content-Encoding: gzip");
             }
 
-            // create authorization hash
-            std::string const key = state::GAState::getGameSecret();
-
-            std::vector<uint8_t> authorization;
-            utilities::GAUtilities::hmacWithKey(key.c_str(), payloadData, authorization);
-            std::string auth = "Authorization: " + std::string(reinterpret_cast<char*>(authorization.data()), authorization.size());
-
-            header = curl_slist_append(header, auth.c_str());
+            // signed while the body was written
+            headers.push_back("Authorization: " + payload.authorization);
 
             // always JSON
-            header = curl_slist_append(header, "Content-Type: application/json");
+            headers.push_back("Content-Type: application/json");
 
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payloadData.data());
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, payloadData.size());
-
-            return authorization;
+            return headers;
         }
 
         EGAHTTPApiResponse GAHTTPApi::processRequestResponse(long statusCode, const char* body, const char* requestId)
@@ -460,9 +463,5 @@ namespace gameanalytics
             return UnknownResponseCode;
         }
 
-        std::string ResponseData::toString() const
-        {
-            return std::string(packet.begin(), packet.end());
-        }
 }
 }
@@ -6,9 +6,11 @@
 #pragma once
 
 #include "GACommon.h"
-#include <curl/curl.h>
+#include "GAHTTPClient.h"
+#include "GAPayloadWriter.h"
 
 #include <vector>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <cstdlib>
@@ -56,7 +58,8 @@ namespace gameanalytics
             InitHttp = 9,
             EventsHttp = 10,
             ProcessEvents = 11,
-            AddEventsToStore = 12
+            AddEventsToStore = 12,
+            RecoverDatabase = 13
         };
 
         enum EGASdkErrorAction
@@ -79,6 +82,9 @@ namespace gameanalytics
             InvalidLongString = 17,
             DatabaseTooLarge = 18,
             DatabaseOpenOrCreate = 19,
+            DatabaseCorrupt = 20,
+            DatabaseRecovered = 21,
+            DatabaseRecoveryFailed = 22,
             JsonError = 25,
             FailHttpJsonDecode = 29,
             FailHttpJsonEncode = 30
@@ -102,24 +108,11 @@ namespace gameanalytics
             Message = 14
         };
 
-        struct ResponseData
-        {
-            std::vector<char> packet;
-            std::string toString() const;
-        };
-
         typedef std::tuple<EGASdkErrorCategory, EGASdkErrorArea> ErrorType;
 
         class GAHTTPApi
         {
             friend class state::GAState;
-            
-            static constexpr const char* PROTOCOL               = "https";
-            static constexpr const char* HOST_NAME              = "api.gameanalytics.com";
-            static constexpr const char* VERSION                = "v2";
-            static constexpr const char* REMOTE_CONFIG_VERSION  = "v1";
-            static constexpr const char* INIT_URL_PATH          = "init";
-            static constexpr const char* EVENT_URL_PATH         = "events";
 
         public:
 
@@ -131,37 +124,56 @@ namespace gameanalytics
             static GAHTTPApi& getInstance();
 
             EGAHTTPApiResponse requestInitReturningDict(json& json_out, std::string const& configsHash);
+            // with the annotations taken on the GA thread beforehand, runs on any thread
+            EGAHTTPApiResponse requestInitReturningDict(json& json_out, std::string const& configsHash, json const& initAnnotations);
             EGAHTTPApiResponse sendEventsInArray(json& json_out, const json& eventArray);
+            // the two halves of sendEventsInArray, a body that got no answer can go out again as it is
+            EGAHTTPApiResponse encodeEvents(const json& eventArray, GAPayload& payload);
+            EGAHTTPApiResponse sendEventsPayload(json& json_out, GAPayload const& payload);
+
+            // a writer for a request body as the collector takes it (gzipped in release builds, signed with the game secret)
+            GAPayloadWriter createPayloadWriter() const;
             void sendSdkErrorEvent(EGASdkErrorCategory category, EGASdkErrorArea area, EGASdkErrorAction action, EGASdkErrorParameter parameter, std::string const& reason, std::string const& gameKey, std::string const& secretKey);            
 
+            // where the init call and the events go, set before initializing
+            void setEndpoints(GAEndpointSettings const& settings);
+            GAEndpointSettings const& getEndpoints() const;
+
+            // deflate level of the request bodies, 1 (fastest) to 9 (smallest)
+            void setGzipLevel(int level);
+            int getGzipLevel() const;
+
+            // what the requests go through, nullptr for curl
+            void setTransport(std::shared_ptr<ITransport> transport);
+
         private:
 
             GAHTTPApi();
             ~GAHTTPApi();
             GAHTTPApi(const GAHTTPApi&) = delete;
             GAHTTPApi& operator=(const GAHTTPApi&) = delete;
-            std::vector<uint8_t> createPayloadData(std::string const& payload, bool gzip);
+            bool createPayload(std::string const& jsonString, GAPayload& payload) const;
 
-            std::vector<uint8_t> createRequest(CURL *curl, std::string const& url, const std::vector<uint8_t>& payloadData, bool gzip);
+            // the headers of a request carrying 'payload'
+            std::vector<std::string> createHeaders(GAPayload const& payload) const;
             EGAHTTPApiResponse processRequestResponse(long statusCode, const char* body, const char* requestId);
 
-            std::string protocol                = PROTOCOL;
-            std::string hostName                = HOST_NAME;
-            std::string version                 = VERSION;
-            std::string remoteConfigsVersion    = REMOTE_CONFIG_VERSION;
-
-            std::string initializeUrlPath = INIT_URL_PATH;
-            std::string eventsUrlPath     = EVENT_URL_PATH;
+            std::string eventsUrl(std::string const& gameKey) const;
 
-            std::string baseUrl;
-            std::string remoteConfigsBaseUrl;
+            GAEndpointSettings endpoints;
 
             bool useGzip;
+            // read by the threads that build request bodies
+            std::atomic<int> gzipLevel{utilities::GAGzipEncoder::DefaultLevel};
             
             static constexpr int MaxCount = 10;
+            std::mutex errorCountMutex;
             std::map<ErrorType, int> countMap;
             std::map<ErrorType, int64_t> timestampMap;
 
+            // last, so requests still running are cancelled before the members their callbacks use go
+            GAHTTPClient client;
+
 #if USE_UWP && defined(USE_UWP_HTTP)
             Windows::Web::Http::HttpClient^ httpClient;
 #endif
@@ -232,6 +244,9 @@ namespace gameanalytics
                 case AddEventsToStore:
                     return "add_events_to_store";
 
+                case RecoverDatabase:
+                    return "recover_database";
+
                 default:
                     return "";
             }
@@ -295,6 +310,15 @@ namespace gameanalytics
                 case DatabaseOpenOrCreate:
                     return "db_open_or_create";
 
+                case DatabaseCorrupt:
+                    return "db_corrupt";
+
+                case DatabaseRecovered:
+                    return "db_recovered";
+
+                case DatabaseRecoveryFailed:
+                    return "db_recovery_failed";
+
                 case JsonError:
                     return "json_error";
 
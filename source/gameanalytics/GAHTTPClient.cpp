@@ -0,0 +1,152 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAHTTPClient.h"
+#include <algorithm>
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        namespace
+        {
+            GAHTTPResponse cancelledResponse()
+            {
+                GAHTTPResponse response;
+                response.error = "Request cancelled";
+                return response;
+            }
+        }
+
+        GAHTTPClient::GAHTTPClient():
+            _pending(std::make_shared<Pending>()),
+            _curl(std::make_shared<GACurlTransport>()),
+            _transport(_curl)
+        {
+        }
+
+        GAHTTPClient::~GAHTTPClient()
+        {
+            cancel();
+        }
+
+        GAHTTPResponse GAHTTPClient::post(std::string const& url, std::vector<std::string> const& headers, GAHTTPBody const& payload)
+        {
+            return postAsync(url, headers, payload).get();
+        }
+
+        void GAHTTPClient::postAsync(std::string const& url, std::vector<std::string> headers, GAHTTPBody payload, GAHTTPCompletion onDone)
+        {
+            std::shared_ptr<ITransport> transport;
+            uint64_t                    id = 0;
+            {
+                std::lock_guard<std::mutex> lock(_pending->mutex);
+                if (!_pending->cancelled)
+                {
+                    id = _pending->nextId++;
+                    _pending->completions[id] = std::move(onDone);
+                    transport = _transport;
+                }
+            }
+
+            if (!transport)
+            {
+                onDone(cancelledResponse());
+                return;
+            }
+
+            GAHTTPRequest request;
+            request.url     = url;
+            request.headers = std::move(headers);
+            request.body    = payload ? std::move(payload) : std::make_shared<const std::vector<uint8_t>>();
+
+            std::shared_ptr<Pending> pending = _pending;
+            transport->send(std::move(request),
+                [pending, id](GAHTTPResponse&& response)
+                {
+                    finish(pending, id, std::move(response));
+                });
+        }
+
+        std::future<GAHTTPResponse> GAHTTPClient::postAsync(std::string const& url, std::vector<std::string> headers, GAHTTPBody payload)
+        {
+            auto done = std::make_shared<std::promise<GAHTTPResponse>>();
+            std::future<GAHTTPResponse> result = done->get_future();
+
+            postAsync(url, std::move(headers), std::move(payload),
+                [done](GAHTTPResponse&& outcome)
+                {
+                    done->set_value(std::move(outcome));
+                });
+
+            return result;
+        }
+
+        void GAHTTPClient::setTransport(std::shared_ptr<ITransport> transport)
+        {
+            std::lock_guard<std::mutex> lock(_pending->mutex);
+            _transport = transport ? std::move(transport) : _curl;
+        }
+
+        void GAHTTPClient::cancel()
+        {
+            std::map<uint64_t, GAHTTPCompletion> left;
+            {
+                std::lock_guard<std::mutex> lock(_pending->mutex);
+                _pending->cancelled = true;
+                left.swap(_pending->completions);
+            }
+
+            // frees the connections of what curl still runs for us, its outcomes find nothing to complete
+            _curl->cancel();
+
+            for (auto& entry : left)
+            {
+                entry.second(cancelledResponse());
+            }
+
+            // completions the transport started before are waited for, unless we are inside one of them
+            std::unique_lock<std::mutex> lock(_pending->mutex);
+            const std::thread::id self = std::this_thread::get_id();
+            _pending->idle.wait(lock, [this, self]()
+            {
+                return std::all_of(_pending->running.begin(), _pending->running.end(), [self](std::thread::id id) { return id == self; });
+            });
+        }
+
+        bool GAHTTPClient::isCancelled() const
+        {
+            std::lock_guard<std::mutex> lock(_pending->mutex);
+            return _pending->cancelled;
+        }
+
+        void GAHTTPClient::finish(std::shared_ptr<Pending> const& pending, uint64_t id, GAHTTPResponse&& response)
+        {
+            GAHTTPCompletion onDone;
+            const std::thread::id self = std::this_thread::get_id();
+            {
+                std::lock_guard<std::mutex> lock(pending->mutex);
+                auto it = pending->completions.find(id);
+                if (it == pending->completions.end())
+                {
+                    // cancelled, completed already
+                    return;
+                }
+
+                onDone = std::move(it->second);
+                pending->completions.erase(it);
+                pending->running.push_back(self);
+            }
+
+            onDone(std::move(response));
+
+            {
+                std::lock_guard<std::mutex> lock(pending->mutex);
+                pending->running.erase(std::find(pending->running.begin(), pending->running.end(), self));
+            }
+            pending->idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GACommon.h"
+#include "GACurlTransport.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        // the HTTP client of an SDK instance: its requests go through the instance's transport, by default
+        // the curl engine shared by every instance (GACurlTransport); requests still running when the
+        // client is cancelled or goes are completed right away as cancelled and whatever the transport
+        // reports for them later is dropped
+        class GAHTTPClient
+        {
+         public:
+
+            GAHTTPClient();
+            ~GAHTTPClient();
+            GAHTTPClient(const GAHTTPClient&) = delete;
+            GAHTTPClient& operator=(const GAHTTPClient&) = delete;
+
+            // POSTs 'payload' (null for none) to 'url' with 'headers' ("Name: value") and waits for the outcome,
+            // safe to call from several threads; the transport shares the payload, it is not copied
+            GAHTTPResponse post(std::string const& url, std::vector<std::string> const& headers, GAHTTPBody const& payload);
+
+            // the same without waiting, 'onDone' is called on whatever thread the transport completes on
+            void postAsync(std::string const& url, std::vector<std::string> headers, GAHTTPBody payload, GAHTTPCompletion onDone);
+            std::future<GAHTTPResponse> postAsync(std::string const& url, std::vector<std::string> headers, GAHTTPBody payload);
+
+            // requests go through 'transport' from now on, nullptr goes back to curl
+            void setTransport(std::shared_ptr<ITransport> transport);
+
+            // completes the requests that have not finished yet with status code 0 and isCancelled() set,
+            // their callbacks have run on return; later requests are completed the same way right away
+            void cancel();
+            bool isCancelled() const;
+
+         private:
+
+            // shared with the completions handed to the transport, which may outlive the client
+            struct Pending
+            {
+                std::mutex                         mutex;
+                std::condition_variable            idle;
+                std::map<uint64_t, GAHTTPCompletion> completions;
+                std::vector<std::thread::id>       running;      // threads inside a completion
+                uint64_t                           nextId    = 0;
+                bool                               cancelled = false;
+            };
+
+            static void finish(std::shared_ptr<Pending> const& pending, uint64_t id, GAHTTPResponse&& response);
+
+            std::shared_ptr<Pending>         _pending;
+            std::shared_ptr<GACurlTransport> _curl;
+            std::shared_ptr<ITransport>      _transport;
+        };
+    }
+}
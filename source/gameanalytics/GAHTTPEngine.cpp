@@ -0,0 +1,517 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAHTTPEngine.h"
+#include "GALogger.h"
+#include <algorithm>
+#include <array>
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        namespace
+        {
+            // DNS and TLS session caches shared by every easy handle; connections live in the multi handle
+            class SharedConnections
+            {
+             public:
+
+                static CURLSH* handle()
+                {
+                    static SharedConnections instance;
+                    return instance._share;
+                }
+
+             private:
+
+                SharedConnections()
+                {
+                    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+                    _share = curl_share_init();
+                    if (_share)
+                    {
+                        curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, lock);
+                        curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, unlock);
+                        curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+                        curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+                        curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+                    }
+                }
+
+                ~SharedConnections()
+                {
+                    if (_share)
+                    {
+                        curl_share_cleanup(_share);
+                    }
+
+                    curl_global_cleanup();
+                }
+
+                static void lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+                {
+                    static_cast<SharedConnections*>(userptr)->_locks[data].lock();
+                }
+
+                static void unlock(CURL*, curl_lock_data data, void* userptr)
+                {
+                    static_cast<SharedConnections*>(userptr)->_locks[data].unlock();
+                }
+
+                CURLSH* _share = nullptr;
+                std::array<std::mutex, CURL_LOCK_DATA_LAST> _locks;
+            };
+
+            using HeaderList = std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)>;
+        }
+
+        struct GAHTTPEngine::Transfer
+        {
+            const void*    owner = nullptr;
+            HTTPRequest    request;
+            HTTPCompletion onDone;
+            HeaderList     header{nullptr, curl_slist_free_all};
+            CURL*          curl = nullptr;
+            std::string    received;        // a buffer kept between requests, the body is copied out once done
+            HTTPResult     result;
+        };
+
+        std::shared_ptr<GAHTTPEngine> GAHTTPEngine::shared()
+        {
+            // the share outlives the engine (and every handle attached to it)
+            SharedConnections::handle();
+
+            static std::mutex                  sharedMutex;
+            static std::weak_ptr<GAHTTPEngine> current;
+
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            std::shared_ptr<GAHTTPEngine> engine = current.lock();
+            if (!engine)
+            {
+                engine  = std::make_shared<GAHTTPEngine>();
+                current = engine;
+            }
+
+            return engine;
+        }
+
+        GAHTTPEngine::GAHTTPEngine()
+        {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            SharedConnections::handle();
+
+            multi = curl_multi_init();
+            if (multi)
+            {
+                curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+                curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, MaxHostConnections);
+            }
+
+            if (multi)
+            {
+                ioThread = std::thread([this]() { run(); });
+            }
+        }
+
+        GAHTTPEngine::~GAHTTPEngine()
+        {
+            stopping = true;
+            if (ioThread.joinable())
+            {
+                curl_multi_wakeup(multi);
+                ioThread.join();
+            }
+
+            for (CURL* curl : idle)
+            {
+                curl_easy_cleanup(curl);
+            }
+            spareBuffers.clear();
+
+            if (multi)
+            {
+                curl_multi_cleanup(multi);
+            }
+
+            curl_global_cleanup();
+        }
+
+        void GAHTTPEngine::submit(const void* owner, HTTPRequest&& request, HTTPCompletion&& onDone)
+        {
+            std::unique_ptr<Transfer> transfer(new Transfer);
+            transfer->owner   = owner;
+            transfer->request = std::move(request);
+            transfer->onDone  = std::move(onDone);
+
+            ++active;
+
+            if (!multi)
+            {
+                transfer->result.code = CURLE_FAILED_INIT;
+                complete(std::move(transfer));
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                queued.push_back(std::move(transfer));
+            }
+
+            curl_multi_wakeup(multi);
+        }
+
+        void GAHTTPEngine::cancel(const void* owner)
+        {
+            std::vector<std::unique_ptr<Transfer>> dropped;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+
+                // not handed to curl yet
+                for (auto it = queued.begin(); it != queued.end();)
+                {
+                    if ((*it)->owner == owner)
+                    {
+                        dropped.push_back(std::move(*it));
+                        it = queued.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+
+            for (auto& transfer : dropped)
+            {
+                transfer->result.code = CURLE_ABORTED_BY_CALLBACK;
+                complete(std::move(transfer));
+            }
+
+            if (!multi)
+            {
+                return;
+            }
+
+            if (std::this_thread::get_id() == ioThread.get_id())
+            {
+                // from a completion callback, the running requests are ours to end right here
+                std::unique_lock<std::mutex> lock(queueMutex);
+                cancelling.push_back(owner);
+                lock.unlock();
+                cancelRequested();
+                return;
+            }
+
+            // the first round to start after this one is queued takes it along
+            std::unique_lock<std::mutex> lock(queueMutex);
+            cancelling.push_back(owner);
+            const uint64_t round = cancelRoundsStarted + 1;
+            curl_multi_wakeup(multi);
+            cancelled.wait(lock, [this, round]() { return cancelRoundsDone >= round; });
+        }
+
+        std::size_t GAHTTPEngine::activeRequests() const
+        {
+            return active;
+        }
+
+        std::size_t GAHTTPEngine::idleHandles() const
+        {
+            return idleCount;
+        }
+
+        void GAHTTPEngine::run()
+        {
+            while (!stopping)
+            {
+                startQueued();
+                cancelRequested();
+
+                int stillRunning = 0;
+                curl_multi_perform(multi, &stillRunning);
+                finishDone();
+
+                // woken by submit(), cancel() and the destructor
+                curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+            }
+
+            // the engine goes once its last client did, so nobody waits for what is left
+            std::vector<std::unique_ptr<Transfer>> left;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                left.swap(queued);
+            }
+
+            for (auto& entry : running)
+            {
+                curl_multi_remove_handle(multi, entry.first);
+                releaseHandle(entry.first);
+                left.push_back(std::move(entry.second));
+            }
+            running.clear();
+
+            for (auto& transfer : left)
+            {
+                transfer->result.code = CURLE_ABORTED_BY_CALLBACK;
+                complete(std::move(transfer));
+            }
+        }
+
+        void GAHTTPEngine::startQueued()
+        {
+            std::vector<std::unique_ptr<Transfer>> starting;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                starting.swap(queued);
+            }
+
+            for (auto& transfer : starting)
+            {
+                CURL* curl = acquireHandle();
+                if (!curl)
+                {
+                    transfer->result.code = CURLE_FAILED_INIT;
+                    complete(std::move(transfer));
+                    continue;
+                }
+
+                // an empty Expect keeps libcurl from waiting a round trip for "100 Continue" before bodies over 1 KB
+                transfer->request.headers.push_back("Expect:");
+
+                bool headersOk = true;
+                for (std::string const& line : transfer->request.headers)
+                {
+                    curl_slist* appended = curl_slist_append(transfer->header.get(), line.c_str());
+                    if (!appended)
+                    {
+                        headersOk = false;
+                        break;
+                    }
+                    transfer->header.release();
+                    transfer->header.reset(appended);
+                }
+
+                if (!headersOk)
+                {
+                    releaseHandle(curl);
+                    transfer->result.code = CURLE_OUT_OF_MEMORY;
+                    complete(std::move(transfer));
+                    continue;
+                }
+
+                HTTPRequest const& request = transfer->request;
+                curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+                curl_easy_setopt(curl, CURLOPT_POST, 1L);
+                // the transfer holds on to the body until it is done, curl reads it in place
+                static const char NoPayload[] = "";
+                const bool hasPayload = request.payload && !request.payload->empty();
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, hasPayload ? static_cast<const void*>(request.payload->data()) : NoPayload);
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(hasPayload ? request.payload->size() : 0));
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->header.get());
+                transfer->received = acquireBuffer();
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, receive);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+
+                curl_easy_setopt(curl, CURLOPT_SHARE, SharedConnections::handle());
+                curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+                curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+                curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+                curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+                curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+
+                if (curl_multi_add_handle(multi, curl) != CURLM_OK)
+                {
+                    releaseHandle(curl);
+                    transfer->result.code = CURLE_FAILED_INIT;
+                    complete(std::move(transfer));
+                    continue;
+                }
+
+                transfer->curl = curl;
+                running[curl]  = std::move(transfer);
+            }
+        }
+
+        void GAHTTPEngine::finishDone()
+        {
+            int      left    = 0;
+            CURLMsg* message = nullptr;
+            while ((message = curl_multi_info_read(multi, &left)) != nullptr)
+            {
+                if (message->msg != CURLMSG_DONE)
+                {
+                    continue;
+                }
+
+                auto it = running.find(message->easy_handle);
+                if (it == running.end())
+                {
+                    continue;
+                }
+
+                std::unique_ptr<Transfer> transfer = std::move(it->second);
+                running.erase(it);
+
+                transfer->result.code = message->data.result;
+                if (transfer->result.code == CURLE_OK)
+                {
+                    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &transfer->result.statusCode);
+
+                    // one allocation of the exact size, none for the "{}" of an accepted batch
+                    transfer->result.body.assign(transfer->received);
+                }
+
+                curl_multi_remove_handle(multi, transfer->curl);
+                releaseHandle(transfer->curl);
+                releaseBuffer(std::move(transfer->received));
+                transfer->curl = nullptr;
+
+                complete(std::move(transfer));
+            }
+        }
+
+        void GAHTTPEngine::cancelRequested()
+        {
+            std::vector<const void*> owners;
+            uint64_t                 round = 0;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (cancelling.empty())
+                {
+                    return;
+                }
+                owners.swap(cancelling);
+                round = ++cancelRoundsStarted;
+            }
+
+            std::vector<std::unique_ptr<Transfer>> ended;
+            for (auto it = running.begin(); it != running.end();)
+            {
+                if (std::find(owners.begin(), owners.end(), it->second->owner) != owners.end())
+                {
+                    curl_multi_remove_handle(multi, it->first);
+                    releaseHandle(it->first);
+                    releaseBuffer(std::move(it->second->received));
+                    it->second->curl        = nullptr;
+                    it->second->result.code = CURLE_ABORTED_BY_CALLBACK;
+                    ended.push_back(std::move(it->second));
+                    it = running.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            for (auto& transfer : ended)
+            {
+                complete(std::move(transfer));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                cancelRoundsDone = round;
+            }
+            cancelled.notify_all();
+        }
+
+        void GAHTTPEngine::complete(std::unique_ptr<Transfer> transfer)
+        {
+            if (transfer->onDone)
+            {
+                try
+                {
+                    transfer->onDone(std::move(transfer->result));
+                }
+                catch (std::exception& e)
+                {
+                    logging::GALogger::e("HTTP completion threw: %s", e.what());
+                }
+            }
+
+            --active;
+        }
+
+        CURL* GAHTTPEngine::acquireHandle()
+        {
+            if (!idle.empty())
+            {
+                CURL* curl = idle.back();
+                idle.pop_back();
+                --idleCount;
+                return curl;
+            }
+
+            return curl_easy_init();
+        }
+
+        void GAHTTPEngine::releaseHandle(CURL* curl)
+        {
+            // forgets the options of the request (they point into it), keeps the caches
+            curl_easy_reset(curl);
+
+            if (idle.size() < MaxIdleHandles)
+            {
+                idle.push_back(curl);
+                ++idleCount;
+                return;
+            }
+
+            curl_easy_cleanup(curl);
+        }
+
+        std::string GAHTTPEngine::acquireBuffer()
+        {
+            if (spareBuffers.empty())
+            {
+                return std::string();
+            }
+
+            std::string buffer = std::move(spareBuffers.back());
+            spareBuffers.pop_back();
+            return buffer;
+        }
+
+        void GAHTTPEngine::releaseBuffer(std::string&& buffer)
+        {
+            // one large answer does not pin its memory for good
+            if (buffer.capacity() > KeptBufferBytes || spareBuffers.size() >= MaxIdleHandles)
+            {
+                return;
+            }
+
+            buffer.clear();
+            spareBuffers.push_back(std::move(buffer));
+        }
+
+        size_t GAHTTPEngine::receive(char* data, size_t size, size_t count, void* user)
+        {
+            Transfer& transfer = *static_cast<Transfer*>(user);
+            const size_t bytes = size * count;
+
+            // room for the whole body at once when its length is known
+            if (transfer.received.empty())
+            {
+                curl_off_t length = -1;
+                if (curl_easy_getinfo(transfer.curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK && length > 0)
+                {
+                    transfer.received.reserve(std::min(static_cast<size_t>(length), MaxResponseBytes));
+                }
+            }
+
+            // past the cap the rest is read and dropped, the connection stays usable
+            const size_t kept = std::min(bytes, MaxResponseBytes - transfer.received.size());
+            transfer.received.append(data, kept);
+            if (kept < bytes)
+            {
+                transfer.result.truncated = true;
+            }
+
+            return bytes;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <curl/curl.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GACommon.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        // what came back for a request: the transfer result, then the status code and body if it got an answer
+        struct HTTPResult
+        {
+            CURLcode    code       = CURLE_OK;
+            long        statusCode = 0;
+            std::string body;
+            bool        truncated  = false;     // the body was longer than MaxResponseBytes, the rest is dropped
+        };
+
+        // told the outcome of a request, on the I/O thread: it should hand real work on to another thread
+        using HTTPCompletion = std::function<void(HTTPResult&& result)>;
+
+        struct HTTPRequest
+        {
+            std::string              url;
+            std::vector<std::string> headers;    // "Name: value"
+            GAHTTPBody               payload;    // POSTed as is from the shared buffer, never copied
+        };
+
+        // the non-blocking HTTP engine shared by every SDK instance: requests from any thread are added to
+        // one curl_multi handle driven by an I/O thread of its own, so the init call, event uploads and sdk
+        // error reports go out side by side over the same connections (multiplexed on HTTP/2) while the
+        // threads that submitted them carry on; easy handles are reset and reused between requests
+        class GAHTTPEngine
+        {
+         public:
+
+            // easy handles kept for reuse once their request is done
+            static constexpr std::size_t MaxIdleHandles = 8;
+
+            // connections opened to one host at most, requests beyond that queue for one of them
+            static constexpr long MaxHostConnections = 4;
+
+            // what is kept of an answer; the collector answers "{}", or lists the events it rejected
+            static constexpr std::size_t MaxResponseBytes = 1024 * 1024;
+
+            // receive buffers are kept for the next request up to this capacity
+            static constexpr std::size_t KeptBufferBytes = 64 * 1024;
+
+            // the engine of the process, it lives as long as someone holds it
+            static std::shared_ptr<GAHTTPEngine> shared();
+
+            GAHTTPEngine();
+            ~GAHTTPEngine();
+            GAHTTPEngine(const GAHTTPEngine&) = delete;
+            GAHTTPEngine& operator=(const GAHTTPEngine&) = delete;
+
+            // queues 'request', 'onDone' is called once it finished, failed or was cancelled
+            // (CURLE_ABORTED_BY_CALLBACK); 'owner' only tags the request for cancel()
+            void submit(const void* owner, HTTPRequest&& request, HTTPCompletion&& onDone);
+
+            // ends the requests of 'owner' that have not finished yet, their callbacks have run on return
+            void cancel(const void* owner);
+
+            std::size_t activeRequests() const;
+            std::size_t idleHandles() const;
+
+         private:
+
+            struct Transfer;
+
+            void run();
+            void startQueued();
+            void finishDone();
+            void cancelRequested();
+            void complete(std::unique_ptr<Transfer> transfer);
+
+            CURL* acquireHandle();
+            void  releaseHandle(CURL* curl);
+
+            std::string acquireBuffer();
+            void        releaseBuffer(std::string&& buffer);
+
+            static size_t receive(char* data, size_t size, size_t count, void* user);
+
+            CURLM* multi = nullptr;
+
+            mutable std::mutex                         queueMutex;
+            std::vector<std::unique_ptr<Transfer>>     queued;
+            std::vector<const void*>                   cancelling;
+            std::condition_variable                    cancelled;
+            uint64_t                                   cancelRoundsStarted = 0;
+            uint64_t                                   cancelRoundsDone    = 0;
+
+            // touched by the I/O thread only
+            std::map<CURL*, std::unique_ptr<Transfer>> running;
+            std::vector<CURL*>                         idle;
+            std::vector<std::string>                   spareBuffers;
+
+            std::atomic<std::size_t> active{0};
+            std::atomic<std::size_t> idleCount{0};
+            std::atomic<bool>        stopping{false};
+            std::thread              ioThread;
+        };
+    }
+}
@@ -90,7 +90,13 @@ namespace gameanalytics
                 return;
             }
 
-             std::string logFilePath = writablepath + "/" + LOG_FILE_NAME;
+            std::string logFilePath = writablepath + "/" + LOG_FILE_NAME;
+
+            const std::string instanceName = state::GAState::getInstanceName();
+            if (!instanceName.empty())
+            {
+                logFilePath = writablepath + "/ga_log_" + instanceName + ".txt";
+            }
 
             logFile.open(logFilePath, std::ios::out | std::ios::trunc);
 
@@ -0,0 +1,79 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GALoopbackTransport.h"
+#include "GAUtilities.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        namespace
+        {
+            bool isInitCall(GAHTTPRequest const& request)
+            {
+                const std::size_t query = request.url.find('?');
+                const std::string path  = request.url.substr(0, query);
+                return path.size() >= 5 && path.compare(path.size() - 5, 5, "/init") == 0;
+            }
+        }
+
+        GALoopbackTransport::GALoopbackTransport():
+            GALoopbackTransport(collectorAnswer)
+        {
+        }
+
+        GALoopbackTransport::GALoopbackTransport(Handler handler):
+            _handler(std::move(handler))
+        {
+        }
+
+        void GALoopbackTransport::send(GAHTTPRequest&& request, GAHTTPCompletion&& onDone)
+        {
+            ++_requests;
+            _initRequests += isInitCall(request) ? 1 : 0;
+            _bytes += static_cast<int64_t>(request.body ? request.body->size() : 0);
+
+            onDone(_handler(request));
+        }
+
+        int64_t GALoopbackTransport::requests() const
+        {
+            return _requests;
+        }
+
+        int64_t GALoopbackTransport::initRequests() const
+        {
+            return _initRequests;
+        }
+
+        int64_t GALoopbackTransport::bytesSent() const
+        {
+            return _bytes;
+        }
+
+        GAHTTPResponse GALoopbackTransport::collectorAnswer(GAHTTPRequest const& request)
+        {
+            GAHTTPResponse response;
+            if (isInitCall(request))
+            {
+                json answer;
+                answer["server_ts"]    = utilities::GAUtilities::timeIntervalSince1970();
+                answer["configs"]      = json::array();
+                answer["configs_hash"] = "";
+
+                response.statusCode = 201;
+                response.body       = answer.dump();
+            }
+            else
+            {
+                response.statusCode = 200;
+                response.body       = "{}";
+            }
+
+            return response;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "GACommon.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        // an in-process transport for tests and benchmarks: every request is answered by a handler on the
+        // thread that sent it, so the whole pipeline (encoding, signing, the HTTP API) runs at memory speed
+        // and in a fixed order; set it with GameAnalytics::configureTransport
+        class GALoopbackTransport : public ITransport
+        {
+         public:
+
+            using Handler = std::function<GAHTTPResponse(GAHTTPRequest const& request)>;
+
+            // answers as the collector does when all is well: 201 with the server time to the init call,
+            // 200 with an empty object to everything else
+            GALoopbackTransport();
+            explicit GALoopbackTransport(Handler handler);
+
+            void send(GAHTTPRequest&& request, GAHTTPCompletion&& onDone) override;
+
+            int64_t requests() const;
+            int64_t initRequests() const;
+            int64_t bytesSent() const;
+
+            static GAHTTPResponse collectorAnswer(GAHTTPRequest const& request);
+
+         private:
+
+            Handler              _handler;
+            std::atomic<int64_t> _requests{0};
+            std::atomic<int64_t> _initRequests{0};
+            std::atomic<int64_t> _bytes{0};
+        };
+    }
+}
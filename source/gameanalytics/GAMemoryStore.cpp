@@ -0,0 +1,474 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAMemoryStore.h"
+#include "GALogger.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        GAMemoryStore::GAMemoryStore(std::size_t capacity):
+            _entries(std::max<std::size_t>(capacity, 1))
+        {
+        }
+
+        void GAMemoryStore::setCapacity(std::size_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            capacity = std::max<std::size_t>(capacity, 1);
+            if (capacity == _entries.size())
+            {
+                return;
+            }
+
+            // drop the oldest entries that no longer fit; claimed ones stay until their batch is done,
+            // the buffer keeps room for them until then
+            compactFront();
+            while (_live > capacity && evictOldest())
+            {
+                compactFront();
+            }
+
+            rebuild(std::max(capacity, _live));
+        }
+
+        std::size_t GAMemoryStore::getCapacity() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _entries.size();
+        }
+
+        void GAMemoryStore::add(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string event)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            compactFront();
+            if (_count == _entries.size() && _live < _count)
+            {
+                // reclaim the holes left by out of order acks before evicting anything
+                rebuild(_entries.size());
+            }
+
+            if (_count == _entries.size())
+            {
+                if (!evictOldest())
+                {
+                    ++_dropped;
+                    if (_dropped == 1 || (_dropped % 1000) == 0)
+                    {
+                        logging::GALogger::w("Memory store full of claimed events (%zu). Dropped %" PRId64 " new event(s) so far.", _entries.size(), _dropped);
+                    }
+                    return;
+                }
+                compactFront();
+
+                if (_evicted == 1 || (_evicted % 1000) == 0)
+                {
+                    logging::GALogger::w("Memory store full (%zu events). Evicted %" PRId64 " oldest event(s) so far.", _entries.size(), _evicted);
+                }
+            }
+
+            Entry& e    = _entries[(_head + _count) % _entries.size()];
+            e.category  = category;
+            e.sessionId = sessionId;
+            e.clientTs  = clientTs;
+            e.event     = std::move(event);
+            e.status    = StatusNew;
+            e.used      = true;
+
+            _bytes += static_cast<int64_t>(e.event.size());
+            _categories.add(eventCategoryId(category), 1, static_cast<int64_t>(e.event.size()));
+            ++_count;
+            ++_live;
+        }
+
+        std::size_t GAMemoryStore::claim(std::string const& requestId, std::string const& category, std::size_t limit, StringVector& out)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            uint32_t status = findStatus(requestId);
+            if (status == StatusNew)
+            {
+                status = _nextStatus++;
+                if (_nextStatus == StatusNew)
+                {
+                    _nextStatus = 1;
+                }
+            }
+
+            std::size_t claimed = 0;
+            for (std::size_t i = 0; i < _count && claimed < limit; ++i)
+            {
+                Entry& e = _entries[(_head + i) % _entries.size()];
+                if (!e.used || e.status != StatusNew)
+                {
+                    continue;
+                }
+
+                if (!category.empty() && e.category != category)
+                {
+                    continue;
+                }
+
+                e.status = status;
+                out.push_back(e.event);
+                ++claimed;
+            }
+
+            if (claimed > 0)
+            {
+                _claims[requestId] = status;
+                _claimed += claimed;
+            }
+
+            return claimed;
+        }
+
+        std::size_t GAMemoryStore::remove(std::string const& requestId)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            const uint32_t status = findStatus(requestId);
+            if (status == StatusNew)
+            {
+                return 0;
+            }
+
+            std::size_t removed = 0;
+            for (std::size_t i = 0; i < _count; ++i)
+            {
+                Entry& e = _entries[(_head + i) % _entries.size()];
+                if (e.used && e.status == status)
+                {
+                    releaseEntry(e);
+                    ++removed;
+                }
+            }
+
+            _claims.erase(requestId);
+            compactFront();
+
+            return removed;
+        }
+
+        std::size_t GAMemoryStore::putBack(std::string const& requestId)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            const uint32_t status = findStatus(requestId);
+            if (status == StatusNew)
+            {
+                return 0;
+            }
+
+            std::size_t restored = 0;
+            for (std::size_t i = 0; i < _count; ++i)
+            {
+                Entry& e = _entries[(_head + i) % _entries.size()];
+                if (e.used && e.status == status)
+                {
+                    e.status = StatusNew;
+                    ++restored;
+                }
+            }
+
+            _claims.erase(requestId);
+            _claimed -= restored;
+
+            return restored;
+        }
+
+        void GAMemoryStore::resetStatus()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            for (Entry& e : _entries)
+            {
+                e.status = StatusNew;
+            }
+
+            _claims.clear();
+            _claimed = 0;
+        }
+
+        void GAMemoryStore::clear()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            for (Entry& e : _entries)
+            {
+                e = Entry();
+            }
+
+            _claims.clear();
+            _categories.reset();
+            _head    = 0;
+            _count   = 0;
+            _live    = 0;
+            _claimed = 0;
+            _bytes   = 0;
+        }
+
+        std::size_t GAMemoryStore::size() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _live;
+        }
+
+        std::size_t GAMemoryStore::pendingCount() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _live - _claimed;
+        }
+
+        int64_t GAMemoryStore::sizeBytes() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _bytes;
+        }
+
+        int64_t GAMemoryStore::evictedCount() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _evicted;
+        }
+
+        int64_t GAMemoryStore::droppedCount() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _dropped;
+        }
+
+        void GAMemoryStore::append(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event)
+        {
+            add(category, sessionId, clientTs, event.dump());
+        }
+
+        bool GAMemoryStore::claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out)
+        {
+            return claim(requestId, category, static_cast<std::size_t>(std::max(limit, 0)), out) > 0;
+        }
+
+        void GAMemoryStore::ackBatch(std::string const& requestId)
+        {
+            remove(requestId);
+        }
+
+        void GAMemoryStore::putBackBatch(std::string const& requestId)
+        {
+            putBack(requestId);
+        }
+
+        void GAMemoryStore::putBackAll()
+        {
+            resetStatus();
+        }
+
+        void GAMemoryStore::trim()
+        {
+            // the ring buffer never grows past its capacity
+        }
+
+        bool GAMemoryStore::isFull()
+        {
+            // the oldest unclaimed events are evicted instead of rejecting new ones
+            return false;
+        }
+
+        std::string GAMemoryStore::getState(std::string const& key)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            auto it = _state.find(key);
+            return it != _state.end() ? it->second : std::string();
+        }
+
+        void GAMemoryStore::setState(std::string const& key, std::string const& value)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            if (value.empty())
+            {
+                _state.erase(key);
+            }
+            else
+            {
+                _state[key] = value;
+            }
+        }
+
+        StringVector GAMemoryStore::getStateKeys(std::string const& prefix)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            StringVector keys;
+            for (auto it = _state.lower_bound(prefix); it != _state.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+            {
+                keys.push_back(it->first);
+            }
+
+            return keys;
+        }
+
+        void GAMemoryStore::setProgressionTries(std::string const& progression, int tries)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            if (tries <= 0)
+            {
+                _progressionTries.erase(progression);
+            }
+            else
+            {
+                _progressionTries[progression] = tries;
+            }
+        }
+
+        std::vector<std::pair<std::string, int>> GAMemoryStore::getProgressionTries()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return std::vector<std::pair<std::string, int>>(_progressionTries.begin(), _progressionTries.end());
+        }
+
+        void GAMemoryStore::checkpointSession(SessionCheckpoint const& session)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _sessions[session.sessionId] = session;
+        }
+
+        void GAMemoryStore::removeSession(std::string const& sessionId)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _sessions.erase(sessionId);
+        }
+
+        std::vector<SessionCheckpoint> GAMemoryStore::getSessions()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            std::vector<SessionCheckpoint> sessions;
+            for (auto const& session : _sessions)
+            {
+                sessions.push_back(session.second);
+            }
+
+            return sessions;
+        }
+
+        EventStoreStats GAMemoryStore::getStats()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            EventStoreStats stats;
+            stats.queuedEvents  = static_cast<int64_t>(_live - _claimed);
+            stats.claimedEvents = static_cast<int64_t>(_claimed);
+            stats.sizeBytes     = _bytes;
+            stats.evictedEvents = _evicted;
+            stats.droppedEvents = _dropped;
+            _categories.copyTo(stats);
+
+            // compactFront keeps the head on a live entry
+            if (_count > 0 && _entries[_head].used)
+            {
+                stats.oldestClientTs = _entries[_head].clientTs;
+            }
+
+            return stats;
+        }
+
+        GAMemoryStore::Entry& GAMemoryStore::at(std::size_t i)
+        {
+            return _entries[(_head + i) % _entries.size()];
+        }
+
+        bool GAMemoryStore::evictOldest()
+        {
+            // claimed events are never evicted, their batch may still be acked or put back
+            std::size_t oldest = 0;
+            while (oldest < _count && (!at(oldest).used || at(oldest).status != StatusNew))
+            {
+                ++oldest;
+            }
+
+            if (oldest == _count)
+            {
+                return false;
+            }
+
+            releaseEntry(at(oldest));
+            ++_evicted;
+
+            // the claimed entries in front of it (the batches in flight, claims take the oldest) move up
+            // into its slot, which keeps the ring free of holes
+            for (std::size_t i = oldest; i > 0; --i)
+            {
+                at(i) = std::move(at(i - 1));
+            }
+            at(0) = Entry();
+
+            _head = (_head + 1) % _entries.size();
+            --_count;
+
+            return true;
+        }
+
+        void GAMemoryStore::compactFront()
+        {
+            // skip slots that were acked out of order
+            while (_count > 0 && !_entries[_head].used)
+            {
+                _head = (_head + 1) % _entries.size();
+                --_count;
+            }
+
+            if (_count == 0)
+            {
+                _head = 0;
+            }
+        }
+
+        void GAMemoryStore::rebuild(std::size_t capacity)
+        {
+            std::vector<Entry> entries(capacity);
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < _count && n < capacity; ++i)
+            {
+                Entry& e = _entries[(_head + i) % _entries.size()];
+                if (e.used)
+                {
+                    entries[n++] = std::move(e);
+                }
+            }
+
+            _entries = std::move(entries);
+            _head    = 0;
+            _count   = n;
+        }
+
+        void GAMemoryStore::releaseEntry(Entry& e)
+        {
+            _bytes -= static_cast<int64_t>(e.event.size());
+            _categories.add(eventCategoryId(e.category), -1, -static_cast<int64_t>(e.event.size()));
+            --_live;
+            if (e.status != StatusNew)
+            {
+                --_claimed;
+            }
+
+            e.used   = false;
+            e.status = StatusNew;
+            e.event.clear();
+            e.event.shrink_to_fit();
+        }
+
+        uint32_t GAMemoryStore::findStatus(std::string const& requestId) const
+        {
+            auto it = _claims.find(requestId);
+            return it != _claims.end() ? it->second : StatusNew;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <mutex>
+#include "GACommon.h"
+#include "GAEventStore.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // fixed capacity FIFO of serialized events, used instead of the sqlite store when the SDK runs
+        // with EGAStoreBackend::Memory (no durability, no file I/O); state, progression tries and
+        // sessions are kept in maps
+        class GAMemoryStore : public IEventStore
+        {
+         public:
+
+            static constexpr std::size_t DefaultCapacity = 10000;
+
+            explicit GAMemoryStore(std::size_t capacity = DefaultCapacity);
+
+            void setCapacity(std::size_t capacity);
+            std::size_t getCapacity() const;
+
+            // appends an event, evicting the oldest unclaimed one if the buffer is full; refused (and
+            // counted as dropped) when only claimed events are left
+            void add(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string event);
+
+            // marks up to 'limit' new events (optionally filtered by category) as owned by 'requestId'
+            // and copies their payloads into 'out', oldest first
+            std::size_t claim(std::string const& requestId, std::string const& category, std::size_t limit, StringVector& out);
+
+            // removes all events owned by 'requestId'
+            std::size_t remove(std::string const& requestId);
+
+            // returns all events owned by 'requestId' to the new state
+            std::size_t putBack(std::string const& requestId);
+
+            // returns every claimed event to the new state
+            void resetStatus();
+
+            void clear();
+
+            std::size_t size() const;
+            std::size_t pendingCount() const;
+            int64_t     sizeBytes() const;
+            int64_t     evictedCount() const;
+            int64_t     droppedCount() const;
+
+            // IEventStore
+            void append(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event) override;
+            bool claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out) override;
+            void ackBatch(std::string const& requestId) override;
+            void putBackBatch(std::string const& requestId) override;
+            void putBackAll() override;
+            void trim() override;
+            bool isFull() override;
+
+            std::string  getState(std::string const& key) override;
+            void         setState(std::string const& key, std::string const& value) override;
+            StringVector getStateKeys(std::string const& prefix) override;
+
+            void setProgressionTries(std::string const& progression, int tries) override;
+            std::vector<std::pair<std::string, int>> getProgressionTries() override;
+
+            void checkpointSession(SessionCheckpoint const& session) override;
+            void removeSession(std::string const& sessionId) override;
+            std::vector<SessionCheckpoint> getSessions() override;
+
+            EventStoreStats getStats() override;
+
+         private:
+
+            static constexpr uint32_t StatusNew = 0;
+
+            struct Entry
+            {
+                std::string category;
+                std::string sessionId;
+                std::string event;
+                int64_t     clientTs = 0;
+                uint32_t    status   = StatusNew;
+                bool        used     = false;
+            };
+
+            Entry& at(std::size_t i);
+            bool evictOldest();
+            void compactFront();
+            void rebuild(std::size_t capacity);
+            void releaseEntry(Entry& e);
+            uint32_t findStatus(std::string const& requestId) const;
+
+            mutable std::mutex  _mutex;
+            std::vector<Entry>  _entries;
+            std::size_t         _head  = 0;
+            std::size_t         _count = 0;
+            std::size_t         _live  = 0;
+            std::size_t         _claimed = 0;
+            int64_t             _bytes = 0;
+
+            EventCategoryCounters _categories;
+
+            uint32_t            _nextStatus = 1;
+            std::unordered_map<std::string, uint32_t> _claims;
+
+            int64_t             _evicted = 0;
+            int64_t             _dropped = 0;
+
+            // ordered, keys are listed by prefix
+            std::map<std::string, std::string>                _state;
+            std::unordered_map<std::string, int>              _progressionTries;
+            std::unordered_map<std::string, SessionCheckpoint> _sessions;
+        };
+    }
+}
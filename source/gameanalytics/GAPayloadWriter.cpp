@@ -0,0 +1,170 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAPayloadWriter.h"
+#include "GAGzipEncoder.h"
+#include "GAUtilities.h"
+#include <cstring>
+
+#include <hmac_sha2.h>
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        struct GAPayloadWriter::State
+        {
+            std::string     secretKey;
+            hmac_sha256_ctx hmac;
+            char            staging[StagingBytes];
+            std::size_t     staged = 0;
+        };
+
+        // where the JSON serializer writes to
+        class GAPayloadWriter::Output : public nlohmann::detail::output_adapter_protocol<char>
+        {
+         public:
+
+            explicit Output(GAPayloadWriter& writer):
+                _writer(writer)
+            {
+            }
+
+            void write_character(char c) override
+            {
+                State& state = *_writer._state;
+                if (state.staged == StagingBytes)
+                {
+                    _writer.flush();
+                }
+                state.staging[state.staged++] = c;
+            }
+
+            void write_characters(const char* s, std::size_t length) override
+            {
+                _writer.stage(s, length);
+            }
+
+         private:
+
+            GAPayloadWriter& _writer;
+        };
+
+        GAPayloadWriter::GAPayloadWriter(bool gzip, std::string const& secretKey, int gzipLevel):
+            _state(new State),
+            _body(std::make_shared<std::vector<uint8_t>>()),
+            _gzip(gzip)
+        {
+            _state->secretKey = secretKey;
+#if !USE_UWP
+            hmac_sha256_init2(&_state->hmac, reinterpret_cast<const unsigned char*>(secretKey.data()), static_cast<unsigned int>(secretKey.size()));
+#endif
+
+            if (_gzip)
+            {
+                utilities::GAGzipEncoder& encoder = utilities::GAGzipEncoder::forThisThread();
+                encoder.setLevel(gzipLevel);
+                _failed = !encoder.begin(*_body);
+            }
+        }
+
+        GAPayloadWriter::~GAPayloadWriter() = default;
+
+        void GAPayloadWriter::write(const char* text, std::size_t size)
+        {
+            stage(text, size);
+        }
+
+        void GAPayloadWriter::write(json const& value)
+        {
+            nlohmann::detail::serializer<json> serializer(std::make_shared<Output>(*this), ' ');
+            serializer.dump(value, false, false, 0);
+        }
+
+        bool GAPayloadWriter::finish(GAPayload& out)
+        {
+            flush();
+
+            if (_gzip && !_failed)
+            {
+                _failed = !utilities::GAGzipEncoder::forThisThread().finish();
+            }
+
+            if (_failed)
+            {
+                return false;
+            }
+
+#if USE_UWP
+            std::vector<uint8_t> authorization;
+            utilities::GAUtilities::hmacWithKey(_state->secretKey.c_str(), *_body, authorization);
+            out.authorization = reinterpret_cast<const char*>(authorization.data());
+#else
+            // the trailer, or what the last flush left
+            hmac_sha256_update(&_state->hmac, _body->data() + _signed, static_cast<unsigned int>(_body->size() - _signed));
+
+            unsigned char mac[SHA256_DIGEST_SIZE];
+            hmac_sha256_final(&_state->hmac, mac, SHA256_DIGEST_SIZE);
+
+            std::vector<unsigned char> authorization(static_cast<std::size_t>(utilities::GAUtilities::base64_needed_encoded_length(SHA256_DIGEST_SIZE)));
+            utilities::GAUtilities::base64_encode(mac, SHA256_DIGEST_SIZE, authorization.data());
+            out.authorization = reinterpret_cast<const char*>(authorization.data());
+#endif
+
+            out.body      = std::move(_body);
+            out.gzip      = _gzip;
+            out.jsonBytes = _jsonBytes;
+            return true;
+        }
+
+        void GAPayloadWriter::stage(const char* text, std::size_t size)
+        {
+            if (_state->staged + size > StagingBytes)
+            {
+                flush();
+
+                // no point copying what fills the buffer by itself
+                if (size > StagingBytes)
+                {
+                    append(text, size);
+                    return;
+                }
+            }
+
+            std::memcpy(_state->staging + _state->staged, text, size);
+            _state->staged += size;
+        }
+
+        void GAPayloadWriter::flush()
+        {
+            append(_state->staging, _state->staged);
+            _state->staged = 0;
+        }
+
+        void GAPayloadWriter::append(const char* text, std::size_t size)
+        {
+            _jsonBytes += size;
+            if (size == 0 || _failed)
+            {
+                return;
+            }
+
+            if (_gzip)
+            {
+                _failed = !utilities::GAGzipEncoder::forThisThread().write(text, size);
+            }
+            else
+            {
+                _body->insert(_body->end(), text, text + size);
+            }
+
+#if !USE_UWP
+            // what the encoder put out so far is final, it is signed while still in the cache
+            hmac_sha256_update(&_state->hmac, _body->data() + _signed, static_cast<unsigned int>(_body->size() - _signed));
+            _signed = _body->size();
+#endif
+        }
+    }
+}
@@ -0,0 +1,70 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GACommon.h"
+#include "GAGzipEncoder.h"
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        // a request body ready to go out: the bytes, shared with the transport, and their signature
+        struct GAPayload
+        {
+            GAHTTPBody  body;
+            std::string authorization;      // base64 HMAC-SHA256 of body, keyed with the game secret
+            bool        gzip      = false;
+            std::size_t jsonBytes = 0;      // before compression
+        };
+
+        // builds a request body in a single pass: the JSON text goes straight into the gzip encoder of the
+        // thread (or into the body as is) and the body is signed as it grows, so neither the JSON text of the
+        // whole body nor a second copy of the body is ever held. One writer per thread at a time, from
+        // construction to finish()
+        class GAPayloadWriter
+        {
+         public:
+
+            GAPayloadWriter(bool gzip, std::string const& secretKey, int gzipLevel = utilities::GAGzipEncoder::DefaultLevel);
+            ~GAPayloadWriter();
+            GAPayloadWriter(const GAPayloadWriter&) = delete;
+            GAPayloadWriter& operator=(const GAPayloadWriter&) = delete;
+
+            // appends JSON text as is
+            void write(const char* text, std::size_t size);
+
+            // appends 'value' serialized as json::dump() does, throws json::exception as it does
+            void write(json const& value);
+
+            // completes the body and hands it over, false if compressing failed
+            bool finish(GAPayload& out);
+
+         private:
+
+            // the serializer writes character by character, it goes through a small buffer
+            static constexpr std::size_t StagingBytes = 4096;
+
+            struct State;
+            class Output;
+
+            void stage(const char* text, std::size_t size);
+            void flush();
+            void append(const char* text, std::size_t size);
+
+            std::unique_ptr<State>                 _state;
+            std::shared_ptr<std::vector<uint8_t>> _body;
+            std::size_t                            _signed    = 0;     // bytes of the body the HMAC has seen
+            std::size_t                            _jsonBytes = 0;
+            bool                                   _gzip;
+            bool                                   _failed    = false;
+        };
+    }
+}
@@ -0,0 +1,109 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GARetryPolicy.h"
+#include <algorithm>
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        GARetryPolicy::GARetryPolicy():
+            GARetryPolicy(Settings(), std::random_device()())
+        {
+        }
+
+        GARetryPolicy::GARetryPolicy(Settings const& settings, uint32_t seed):
+            settings(settings),
+            random(seed)
+        {
+        }
+
+        bool GARetryPolicy::allowAttempt(Clock::time_point now)
+        {
+            if (now < nextAttempt)
+            {
+                return false;
+            }
+
+            if (state == State::Open)
+            {
+                state = State::HalfOpen;
+            }
+
+            return true;
+        }
+
+        void GARetryPolicy::onSuccess()
+        {
+            reset();
+        }
+
+        void GARetryPolicy::onFailure(Clock::time_point now)
+        {
+            ++failures;
+
+            if (state == State::HalfOpen || failures >= settings.failureThreshold)
+            {
+                // the open period is jittered as well, half of it at least
+                state       = State::Open;
+                nextAttempt = now + randomBetween(settings.openDuration / 2, settings.openDuration);
+                return;
+            }
+
+            nextAttempt = now + backoffDelay(failures);
+        }
+
+        void GARetryPolicy::reset()
+        {
+            state       = State::Closed;
+            failures    = 0;
+            nextAttempt = Clock::time_point();
+        }
+
+        GARetryPolicy::State GARetryPolicy::getState() const
+        {
+            return state;
+        }
+
+        int GARetryPolicy::getConsecutiveFailures() const
+        {
+            return failures;
+        }
+
+        GARetryPolicy::Clock::time_point GARetryPolicy::getNextAttempt() const
+        {
+            return nextAttempt;
+        }
+
+        std::chrono::milliseconds GARetryPolicy::backoffDelay(int failureCount)
+        {
+            if (failureCount <= 0)
+            {
+                return std::chrono::milliseconds(0);
+            }
+
+            // doubling past maxDelay changes nothing, and the shift stays well inside 64 bits
+            std::chrono::milliseconds ceiling = settings.baseDelay;
+            for (int i = 1; i < failureCount && ceiling < settings.maxDelay; ++i)
+            {
+                ceiling *= 2;
+            }
+
+            return randomBetween(std::chrono::milliseconds(0), std::min(ceiling, settings.maxDelay));
+        }
+
+        std::chrono::milliseconds GARetryPolicy::randomBetween(std::chrono::milliseconds low, std::chrono::milliseconds high)
+        {
+            if (high <= low)
+            {
+                return low;
+            }
+
+            std::uniform_int_distribution<int64_t> distribution(low.count(), high.count());
+            return std::chrono::milliseconds(distribution(random));
+        }
+    }
+}
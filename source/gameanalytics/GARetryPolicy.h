@@ -0,0 +1,75 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace gameanalytics
+{
+    namespace http
+    {
+        // when a request that got no answer may go out again: each failure in a row doubles the longest wait
+        // (baseDelay, 2 * baseDelay, ... up to maxDelay) and the actual wait is drawn anywhere below it (full
+        // jitter), so clients cut off by the same outage do not come back in lockstep; after failureThreshold
+        // failures in a row the breaker opens and nothing is tried for about openDuration, then a single
+        // attempt decides whether it closes again
+        class GARetryPolicy
+        {
+         public:
+
+            using Clock = std::chrono::steady_clock;
+
+            enum class State
+            {
+                Closed,     // requests go out, backing off after failures
+                Open,       // nothing goes out until the open period is over
+                HalfOpen    // one attempt is allowed, its outcome closes or reopens the breaker
+            };
+
+            struct Settings
+            {
+                std::chrono::milliseconds baseDelay{8000};
+                std::chrono::milliseconds maxDelay{600000};
+                int                       failureThreshold = 8;
+                std::chrono::milliseconds openDuration{1800000};
+            };
+
+            GARetryPolicy();
+            GARetryPolicy(Settings const& settings, uint32_t seed);
+
+            // true if a request may go out at 'now'; an open breaker whose period is over turns half open
+            bool allowAttempt(Clock::time_point now = Clock::now());
+
+            // the collector answered (whatever it said)
+            void onSuccess();
+
+            // no answer: schedules the next attempt, opens the breaker after too many in a row
+            void onFailure(Clock::time_point now = Clock::now());
+
+            // forgets the failures, for when the network changed and the next attempt may well work
+            void reset();
+
+            State             getState() const;
+            int               getConsecutiveFailures() const;
+            Clock::time_point getNextAttempt() const;
+
+            // the wait after 'failures' failures in a row, drawn from [0, min(maxDelay, baseDelay * 2^(failures - 1))]
+            std::chrono::milliseconds backoffDelay(int failures);
+
+         private:
+
+            std::chrono::milliseconds randomBetween(std::chrono::milliseconds low, std::chrono::milliseconds high);
+
+            Settings          settings;
+            std::mt19937      random;
+            State             state = State::Closed;
+            int               failures = 0;
+            Clock::time_point nextAttempt;
+        };
+    }
+}
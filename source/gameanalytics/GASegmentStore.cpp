@@ -0,0 +1,1256 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GASegmentStore.h"
+#include "GALogger.h"
+#include <algorithm>
+
+#if IS_WIN32 || IS_UWP
+    #include <io.h>
+#else
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        namespace
+        {
+            // segment file: magic and sequence number, then records until a zero length;
+            // record: length and CRC-32 of the body (host byte order), body: category byte and event text
+            constexpr char        SegmentMagic[8]    = { 'G', 'A', 'S', 'E', 'G', 'v', '1', '\0' };
+            constexpr uint32_t    SegmentHeaderBytes = 16;
+            constexpr uint32_t    RecordHeaderBytes  = 8;
+            constexpr const char* SegmentExtension   = ".seg";
+            constexpr const char* JournalName        = "journal.log";
+            constexpr const char* JournalTempName    = "journal.tmp";
+
+            enum JournalRecord : uint8_t
+            {
+                JournalState       = 1,
+                JournalProgression = 2,
+                JournalSession     = 3,
+                JournalSessionEnd  = 4,
+                JournalConsumed    = 5
+            };
+
+            // CRC-32 (zlib polynomial), eight bytes per step: the nibble table of miniz costs more than the rest of an append
+            struct Crc32Tables
+            {
+                uint32_t t[8][256];
+            };
+
+            constexpr Crc32Tables makeCrc32Tables()
+            {
+                Crc32Tables tables{};
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                    }
+                    tables.t[0][i] = c;
+                }
+
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    for (int slice = 1; slice < 8; ++slice)
+                    {
+                        const uint32_t prev = tables.t[slice - 1][i];
+                        tables.t[slice][i] = (prev >> 8) ^ tables.t[0][prev & 0xff];
+                    }
+                }
+
+                return tables;
+            }
+
+            constexpr Crc32Tables Crc32 = makeCrc32Tables();
+
+            // the words are read in host byte order, the checksums match zlib on little endian hosts
+            uint32_t crc(const char* data, std::size_t length)
+            {
+                const auto& t = Crc32.t;
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+
+                uint32_t c = 0xffffffffu;
+                for (; length >= 8; length -= 8, p += 8)
+                {
+                    uint32_t lo = 0;
+                    uint32_t hi = 0;
+                    std::memcpy(&lo, p, sizeof(lo));
+                    std::memcpy(&hi, p + 4, sizeof(hi));
+                    lo ^= c;
+
+                    c = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                      ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+                }
+
+                for (; length > 0; --length, ++p)
+                {
+                    c = t[0][(c ^ *p) & 0xff] ^ (c >> 8);
+                }
+
+                return ~c;
+            }
+
+            template<typename T>
+            void put(std::string& out, T value)
+            {
+                out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            void putString(std::string& out, std::string_view value)
+            {
+                put(out, static_cast<uint32_t>(value.size()));
+                out.append(value.data(), value.size());
+            }
+
+            // a journal record with its frame
+            class RecordWriter
+            {
+             public:
+
+                explicit RecordWriter(JournalRecord type)
+                {
+                    _body.push_back(static_cast<char>(type));
+                }
+
+                template<typename T>
+                RecordWriter& operator<<(T value)
+                {
+                    put(_body, value);
+                    return *this;
+                }
+
+                RecordWriter& operator<<(std::string_view value)
+                {
+                    putString(_body, value);
+                    return *this;
+                }
+
+                std::string framed() const
+                {
+                    std::string out;
+                    out.reserve(RecordHeaderBytes + _body.size());
+                    put(out, static_cast<uint32_t>(_body.size()));
+                    put(out, crc(_body.data(), _body.size()));
+                    out += _body;
+                    return out;
+                }
+
+             private:
+
+                std::string _body;
+            };
+
+            // reads the fields of a record body, 'ok' turns false past its end
+            struct RecordReader
+            {
+                const char* p;
+                const char* end;
+                bool        ok = true;
+
+                template<typename T>
+                T get()
+                {
+                    T value{};
+                    if (static_cast<std::size_t>(end - p) < sizeof(T))
+                    {
+                        ok = false;
+                        return value;
+                    }
+
+                    std::memcpy(&value, p, sizeof(T));
+                    p += sizeof(T);
+                    return value;
+                }
+
+                std::string getString()
+                {
+                    const uint32_t size = get<uint32_t>();
+                    if (!ok || static_cast<std::size_t>(end - p) < size)
+                    {
+                        ok = false;
+                        return {};
+                    }
+
+                    std::string value(p, size);
+                    p += size;
+                    return value;
+                }
+            };
+
+            // the length of the valid frame at 'offset', 0 at the end of the records or at a torn one
+            uint32_t validFrame(const char* data, std::size_t size, std::size_t offset)
+            {
+                if (size < offset + RecordHeaderBytes)
+                {
+                    return 0;
+                }
+
+                uint32_t length   = 0;
+                uint32_t checksum = 0;
+                std::memcpy(&length, data + offset, sizeof(length));
+                std::memcpy(&checksum, data + offset + 4, sizeof(checksum));
+
+                if (length == 0 || length > size - offset - RecordHeaderBytes || crc(data + offset + RecordHeaderBytes, length) != checksum)
+                {
+                    return 0;
+                }
+
+                return length;
+            }
+
+            void syncFile(std::FILE* file)
+            {
+#if IS_WIN32 || IS_UWP
+                _commit(_fileno(file));
+#else
+                fsync(fileno(file));
+#endif
+            }
+
+            // client_ts of an event as stored (records keep no timestamp of their own), 0 if it has none
+            int64_t findClientTs(std::string_view event)
+            {
+                constexpr std::string_view Key = "\"client_ts\":";
+
+                const std::size_t at = event.find(Key);
+                if (at == std::string_view::npos)
+                {
+                    return 0;
+                }
+
+                int64_t value = 0;
+                for (std::size_t i = at + Key.size(); i < event.size() && event[i] >= '0' && event[i] <= '9'; ++i)
+                {
+                    value = value * 10 + (event[i] - '0');
+                }
+
+                return value;
+            }
+
+            std::string segmentName(uint64_t seq)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016" PRIx64 "%s", seq, SegmentExtension);
+                return name;
+            }
+        }
+
+        GASegmentStore::GASegmentStore()
+        {
+        }
+
+        GASegmentStore::~GASegmentStore()
+        {
+            close();
+        }
+
+        bool GASegmentStore::mapFile(std::string const& path, std::size_t size, bool create, Mapping& map)
+        {
+#if IS_WIN32 || IS_UWP
+            const std::wstring widePath = std::filesystem::path(path).wstring();
+
+            HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            // mapping past the end of the file extends it with zeros
+            const uint64_t size64 = size;
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffff), nullptr);
+            if (!mapping)
+            {
+                CloseHandle(file);
+                return false;
+            }
+
+            void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+            if (!data)
+            {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                return false;
+            }
+
+            map.file    = file;
+            map.mapping = mapping;
+#else
+            const int fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT | O_TRUNC : 0), 0644);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            // the file is extended with zeros, a zero length marks the end of the records
+            if (create && ftruncate(fd, static_cast<off_t>(size)) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            map.fd = fd;
+#endif
+            map.data = static_cast<char*>(data);
+            map.size = size;
+            return true;
+        }
+
+        void GASegmentStore::unmapFile(Mapping& map)
+        {
+#if IS_WIN32 || IS_UWP
+            if (map.data)
+            {
+                UnmapViewOfFile(map.data);
+            }
+            if (map.mapping)
+            {
+                CloseHandle(map.mapping);
+            }
+            if (map.file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(map.file);
+            }
+#else
+            if (map.data)
+            {
+                munmap(map.data, map.size);
+            }
+            if (map.fd >= 0)
+            {
+                ::close(map.fd);
+            }
+#endif
+            map = Mapping();
+        }
+
+        void GASegmentStore::syncRange(Mapping const& map, uint32_t from, uint32_t to)
+        {
+            if (!map.data || to <= from)
+            {
+                return;
+            }
+
+#if IS_WIN32 || IS_UWP
+            FlushViewOfFile(map.data + from, to - from);
+            FlushFileBuffers(map.file);
+#else
+            // msync wants a page aligned start
+            const uint32_t page  = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+            const uint32_t start = from - from % page;
+            msync(map.data + start, to - start, MS_SYNC);
+#endif
+        }
+
+        void GASegmentStore::setSettings(GAStoreSettings const& settings)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            segmentSizeBytes = std::clamp(settings.segmentSizeBytes, MinSegmentSizeBytes, MaxSegmentSizeBytes);
+            maxSizeBytes     = settings.maxSizeBytes;
+            syncPolicy       = settings.syncPolicy;
+        }
+
+        bool GASegmentStore::isOpen() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return opened;
+        }
+
+        bool GASegmentStore::open(std::string const& path, bool dropDatabase)
+        {
+            close();
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            directory = path;
+
+            std::error_code err;
+            std::filesystem::create_directories(directory, err);
+
+            std::vector<std::pair<uint64_t, std::string>> files;
+            for (auto const& entry : std::filesystem::directory_iterator(directory, err))
+            {
+                const std::filesystem::path& p = entry.path();
+                if (p.extension() != SegmentExtension)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    files.emplace_back(std::stoull(p.stem().string(), nullptr, 16), p.string());
+                }
+                catch (std::exception const&)
+                {
+                    logging::GALogger::w("Event log: ignoring %s", p.string().c_str());
+                }
+            }
+
+            if (dropDatabase)
+            {
+                logging::GALogger::d("Drop event log");
+                for (auto const& file : files)
+                {
+                    std::filesystem::remove(file.second, err);
+                }
+                files.clear();
+                std::filesystem::remove(std::filesystem::path(directory) / JournalName, err);
+            }
+
+            if (!loadJournal())
+            {
+                logging::GALogger::w("Could not open event log: %s", directory.c_str());
+                return false;
+            }
+
+            std::sort(files.begin(), files.end());
+
+            uint64_t lastSeq = consumedSegment;
+            for (auto const& file : files)
+            {
+                lastSeq = std::max(lastSeq, file.first);
+
+                // consumed as a whole, the process ended before it was deleted
+                if (file.first < consumedSegment)
+                {
+                    std::filesystem::remove(file.second, err);
+                    continue;
+                }
+
+                loadSegment(file.second, file.first);
+            }
+
+            nextSeq       = lastSeq + 1;
+            queuedEvents  = static_cast<int64_t>(records.size());
+            claimedEvents = 0;
+            opened        = true;
+
+            logging::GALogger::i("Event log opened: %s (%zu events queued)", directory.c_str(), records.size());
+
+            evictToQuota();
+            flush(syncPolicy != EGAStoreSyncPolicy::None);
+            return true;
+        }
+
+        void GASegmentStore::close()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!opened)
+            {
+                return;
+            }
+
+            flush(syncPolicy != EGAStoreSyncPolicy::None);
+
+            for (Segment& segment : segments)
+            {
+                unmapFile(segment.map);
+            }
+
+            if (journalFile)
+            {
+                std::fclose(journalFile);
+                journalFile = nullptr;
+            }
+
+            segments.clear();
+            records.clear();
+            batches.clear();
+            state.clear();
+            progressionTries.clear();
+            sessions.clear();
+            journalBuffer.clear();
+            categoryCounters.reset();
+            journalBytes    = 0;
+            consumedSegment = 0;
+            consumedOffset  = 0;
+            queuedEvents    = 0;
+            claimedEvents   = 0;
+            opened          = false;
+        }
+
+        bool GASegmentStore::loadSegment(std::string const& path, uint64_t seq)
+        {
+            std::error_code err;
+            const uintmax_t size = std::filesystem::file_size(path, err);
+
+            Segment segment;
+            segment.seq  = seq;
+            segment.path = path;
+
+            if (err || size < SegmentHeaderBytes + RecordHeaderBytes || size > static_cast<uintmax_t>(MaxSegmentSizeBytes)
+                || !mapFile(path, static_cast<std::size_t>(size), false, segment.map))
+            {
+                logging::GALogger::w("Event log: dropping unreadable segment %s", path.c_str());
+                std::filesystem::remove(path, err);
+                return false;
+            }
+
+            char* data = segment.map.data;
+
+            uint64_t headerSeq = 0;
+            std::memcpy(&headerSeq, data + sizeof(SegmentMagic), sizeof(headerSeq));
+            if (std::memcmp(data, SegmentMagic, sizeof(SegmentMagic)) != 0 || headerSeq != seq)
+            {
+                logging::GALogger::w("Event log: dropping unreadable segment %s", path.c_str());
+                unmapFile(segment.map);
+                std::filesystem::remove(path, err);
+                return false;
+            }
+
+            std::size_t offset = SegmentHeaderBytes;
+            while (const uint32_t length = validFrame(data, segment.map.size, offset))
+            {
+                // records before the consumer offset were acked
+                if (seq > consumedSegment || offset >= consumedOffset)
+                {
+                    Record record;
+                    record.segment  = seq;
+                    record.offset   = static_cast<uint32_t>(offset);
+                    record.length   = length;
+                    record.category = static_cast<uint8_t>(data[offset + RecordHeaderBytes]);
+                    record.clientTs = findClientTs(std::string_view(data + offset + RecordHeaderBytes + 1, length - 1));
+                    records.push_back(record);
+                    categoryCounters.add(record.category, 1, RecordHeaderBytes + static_cast<int64_t>(length));
+                }
+
+                offset += RecordHeaderBytes + length;
+            }
+
+            // anything after the last valid record is a torn write: new records must not run into it
+            const char* tail = data + offset;
+            const char* end  = data + segment.map.size;
+            if (std::find_if(tail, end, [](char c) { return c != 0; }) != end)
+            {
+                logging::GALogger::w("Event log: truncating a damaged record in %s at offset %zu", path.c_str(), offset);
+                std::memset(data + offset, 0, segment.map.size - offset);
+                syncRange(segment.map, static_cast<uint32_t>(offset), static_cast<uint32_t>(segment.map.size));
+            }
+
+            segment.writeOffset  = static_cast<uint32_t>(offset);
+            segment.syncedOffset = segment.writeOffset;
+            segments.push_back(std::move(segment));
+            return true;
+        }
+
+        GASegmentStore::Segment* GASegmentStore::addSegment()
+        {
+            Segment segment;
+            segment.seq  = nextSeq;
+            segment.path = (std::filesystem::path(directory) / segmentName(segment.seq)).string();
+
+            if (!mapFile(segment.path, static_cast<std::size_t>(segmentSizeBytes), true, segment.map))
+            {
+                logging::GALogger::e("Event log: could not create segment %s", segment.path.c_str());
+                return nullptr;
+            }
+
+            ++nextSeq;
+
+            std::memcpy(segment.map.data, SegmentMagic, sizeof(SegmentMagic));
+            std::memcpy(segment.map.data + sizeof(SegmentMagic), &segment.seq, sizeof(segment.seq));
+            segment.writeOffset = SegmentHeaderBytes;
+
+            segments.push_back(std::move(segment));
+            return &segments.back();
+        }
+
+        void GASegmentStore::removeFrontSegment()
+        {
+            Segment& segment = segments.front();
+            unmapFile(segment.map);
+
+            std::error_code err;
+            std::filesystem::remove(segment.path, err);
+
+            segments.pop_front();
+        }
+
+        GASegmentStore::Segment* GASegmentStore::findSegment(uint64_t seq)
+        {
+            // sequence numbers are consecutive, a gap only follows a dropped segment
+            if (!segments.empty() && seq >= segments.front().seq)
+            {
+                const std::size_t index = static_cast<std::size_t>(seq - segments.front().seq);
+                if (index < segments.size() && segments[index].seq == seq)
+                {
+                    return &segments[index];
+                }
+            }
+
+            for (Segment& segment : segments)
+            {
+                if (segment.seq == seq)
+                {
+                    return &segment;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void GASegmentStore::insertRecord(uint8_t category, int64_t clientTs, std::string_view event)
+        {
+            if (!opened)
+            {
+                return;
+            }
+
+            const uint32_t length = static_cast<uint32_t>(1 + event.size());
+            const uint64_t frame  = RecordHeaderBytes + static_cast<uint64_t>(length);
+            if (frame > static_cast<uint64_t>(segmentSizeBytes) - SegmentHeaderBytes)
+            {
+                logging::GALogger::w("Event log: event of %zu bytes does not fit a segment, dropped.", event.size());
+                ++droppedEvents;
+                return;
+            }
+
+            Segment* segment = segments.empty() ? nullptr : &segments.back();
+            if (!segment || segment->writeOffset + frame > segment->map.size)
+            {
+                if (segment && syncPolicy != EGAStoreSyncPolicy::None)
+                {
+                    syncRange(segment->map, segment->syncedOffset, segment->writeOffset);
+                    segment->syncedOffset = segment->writeOffset;
+                }
+
+                if (!addSegment())
+                {
+                    return;
+                }
+
+                evictToQuota();
+                segment = &segments.back();
+            }
+
+            // body first, the frame only checks out once the body is complete
+            char* out = segment->map.data + segment->writeOffset;
+            out[RecordHeaderBytes] = static_cast<char>(category);
+            std::memcpy(out + RecordHeaderBytes + 1, event.data(), event.size());
+
+            const uint32_t checksum = crc(out + RecordHeaderBytes, length);
+            std::memcpy(out + 4, &checksum, sizeof(checksum));
+            std::memcpy(out, &length, sizeof(length));
+
+            Record record;
+            record.segment  = segment->seq;
+            record.offset   = segment->writeOffset;
+            record.length   = length;
+            record.category = category;
+            record.clientTs = clientTs;
+            records.push_back(record);
+
+            segment->writeOffset += static_cast<uint32_t>(frame);
+            ++queuedEvents;
+            categoryCounters.add(category, 1, static_cast<int64_t>(frame));
+        }
+
+        void GASegmentStore::appendText(std::string const& category, std::string const& /*sessionId*/, int64_t clientTs, std::string const& event)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            insertRecord(static_cast<uint8_t>(eventCategoryId(category)), clientTs, event);
+            endWrite();
+        }
+
+        void GASegmentStore::append(std::string const& category, std::string const& /*sessionId*/, int64_t clientTs, json const& event)
+        {
+            const std::string text = event.dump();
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            insertRecord(static_cast<uint8_t>(eventCategoryId(category)), clientTs, text);
+            endWrite();
+        }
+
+        bool GASegmentStore::claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!opened || limit <= 0)
+            {
+                return false;
+            }
+
+            const int64_t batch      = nextBatchId++;
+            const int64_t categoryId = eventCategoryId(category);
+
+            int64_t claimed = 0;
+            for (Record& record : records)
+            {
+                if (claimed >= limit)
+                {
+                    break;
+                }
+
+                if (record.batch != 0 || (!category.empty() && record.category != categoryId))
+                {
+                    continue;
+                }
+
+                Segment* segment = findSegment(record.segment);
+                if (!segment)
+                {
+                    continue;
+                }
+
+                out.emplace_back(segment->map.data + record.offset + RecordHeaderBytes + 1, record.length - 1);
+                record.batch = batch;
+                ++claimed;
+            }
+
+            if (claimed == 0)
+            {
+                return false;
+            }
+
+            batches[requestId] = { batch, claimed };
+            queuedEvents  -= claimed;
+            claimedEvents += claimed;
+            return true;
+        }
+
+        void GASegmentStore::ackBatch(std::string const& requestId)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = batches.find(requestId);
+            if (it == batches.end())
+            {
+                return;
+            }
+
+            for (Record& record : records)
+            {
+                if (record.batch == it->second.id)
+                {
+                    record.batch = Acked;
+                    categoryCounters.add(record.category, -1, -(RecordHeaderBytes + static_cast<int64_t>(record.length)));
+                }
+            }
+
+            claimedEvents -= it->second.events;
+            batches.erase(it);
+
+            advance();
+            endWrite();
+        }
+
+        void GASegmentStore::putBackBatch(std::string const& requestId)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = batches.find(requestId);
+            if (it == batches.end())
+            {
+                return;
+            }
+
+            for (Record& record : records)
+            {
+                if (record.batch == it->second.id)
+                {
+                    record.batch = 0;
+                }
+            }
+
+            queuedEvents  += it->second.events;
+            claimedEvents -= it->second.events;
+            batches.erase(it);
+        }
+
+        void GASegmentStore::putBackAll()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (Record& record : records)
+            {
+                if (record.batch > 0)
+                {
+                    record.batch = 0;
+                }
+            }
+
+            queuedEvents += claimedEvents;
+            claimedEvents = 0;
+            batches.clear();
+        }
+
+        void GASegmentStore::advance()
+        {
+            bool moved = false;
+            while (!records.empty() && records.front().batch == Acked)
+            {
+                records.pop_front();
+                moved = true;
+            }
+
+            if (!moved)
+            {
+                return;
+            }
+
+            if (!records.empty())
+            {
+                consumedSegment = records.front().segment;
+                consumedOffset  = records.front().offset;
+            }
+            else if (!segments.empty())
+            {
+                consumedSegment = segments.back().seq;
+                consumedOffset  = segments.back().writeOffset;
+            }
+
+            // the segment being written stays, even once everything in it was consumed
+            while (segments.size() > 1 && segments.front().seq < consumedSegment)
+            {
+                removeFrontSegment();
+            }
+
+            journal((RecordWriter(JournalConsumed) << consumedSegment << consumedOffset).framed());
+        }
+
+        int64_t GASegmentStore::evictToQuota()
+        {
+            int64_t evicted = 0;
+            bool    removed = false;
+
+            auto logBytes = [this]()
+            {
+                int64_t bytes = 0;
+                for (Segment const& segment : segments)
+                {
+                    bytes += static_cast<int64_t>(segment.map.size);
+                }
+                return bytes;
+            };
+
+            while (segments.size() > 1 && logBytes() > maxSizeBytes)
+            {
+                const uint64_t oldest = segments.front().seq;
+
+                // claimed events are never evicted, the log stays over its quota until their batch is done
+                bool inFlight = false;
+                for (auto it = records.begin(); it != records.end() && it->segment == oldest && !inFlight; ++it)
+                {
+                    inFlight = it->batch > 0;
+                }
+
+                if (inFlight)
+                {
+                    break;
+                }
+
+                while (!records.empty() && records.front().segment == oldest)
+                {
+                    Record const& record = records.front();
+                    if (record.batch == 0)
+                    {
+                        ++evicted;
+                        categoryCounters.add(record.category, -1, -(RecordHeaderBytes + static_cast<int64_t>(record.length)));
+                    }
+                    records.pop_front();
+                }
+
+                removeFrontSegment();
+                removed = true;
+
+                consumedSegment = segments.front().seq;
+                consumedOffset  = records.empty() || records.front().segment != consumedSegment ? SegmentHeaderBytes : records.front().offset;
+            }
+
+            if (removed)
+            {
+                journal((RecordWriter(JournalConsumed) << consumedSegment << consumedOffset).framed());
+            }
+
+            if (evicted > 0)
+            {
+                queuedEvents  -= evicted;
+                evictedEvents += evicted;
+
+                logging::GALogger::w("Event log over its quota, evicted the %" PRId64 " oldest events.", evicted);
+            }
+
+            return evicted;
+        }
+
+        void GASegmentStore::trim()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!opened)
+            {
+                return;
+            }
+
+            evictToQuota();
+            endWrite();
+        }
+
+        bool GASegmentStore::isFull()
+        {
+            // the oldest segments are evicted instead of rejecting new events
+            return false;
+        }
+
+        std::string GASegmentStore::getState(std::string const& key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = state.find(key);
+            return it != state.end() ? it->second : std::string();
+        }
+
+        void GASegmentStore::setState(std::string const& key, std::string const& value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (value.empty())
+            {
+                state.erase(key);
+            }
+            else
+            {
+                state[key] = value;
+            }
+
+            journal((RecordWriter(JournalState) << std::string_view(key) << std::string_view(value)).framed());
+            endWrite();
+        }
+
+        StringVector GASegmentStore::getStateKeys(std::string const& prefix)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            StringVector keys;
+            for (auto it = state.lower_bound(prefix); it != state.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+            {
+                keys.push_back(it->first);
+            }
+
+            return keys;
+        }
+
+        void GASegmentStore::setProgressionTries(std::string const& progression, int tries)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (tries <= 0)
+            {
+                tries = 0;
+                progressionTries.erase(progression);
+            }
+            else
+            {
+                progressionTries[progression] = tries;
+            }
+
+            journal((RecordWriter(JournalProgression) << std::string_view(progression) << static_cast<int32_t>(tries)).framed());
+            endWrite();
+        }
+
+        std::vector<std::pair<std::string, int>> GASegmentStore::getProgressionTries()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return std::vector<std::pair<std::string, int>>(progressionTries.begin(), progressionTries.end());
+        }
+
+        void GASegmentStore::checkpointSession(SessionCheckpoint const& session)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            sessions[session.sessionId] = session;
+
+            journal((RecordWriter(JournalSession) << std::string_view(session.sessionId) << session.startTs << std::string_view(session.event)).framed());
+            endWrite();
+        }
+
+        void GASegmentStore::removeSession(std::string const& sessionId)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (sessions.erase(sessionId) == 0)
+            {
+                return;
+            }
+
+            journal((RecordWriter(JournalSessionEnd) << std::string_view(sessionId)).framed());
+            endWrite();
+        }
+
+        std::vector<SessionCheckpoint> GASegmentStore::getSessions()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::vector<SessionCheckpoint> result;
+            for (auto const& session : sessions)
+            {
+                result.push_back(session.second);
+            }
+
+            return result;
+        }
+
+        EventStoreStats GASegmentStore::getStats()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            EventStoreStats stats;
+            stats.queuedEvents  = queuedEvents;
+            stats.claimedEvents = claimedEvents;
+            stats.evictedEvents = evictedEvents;
+            stats.droppedEvents = droppedEvents;
+            stats.sizeBytes     = journalBytes;
+            categoryCounters.copyTo(stats);
+
+            // records acked out of order stay in the deque until everything before them was acked
+            for (Record const& record : records)
+            {
+                if (record.batch != Acked)
+                {
+                    stats.oldestClientTs = record.clientTs;
+                    break;
+                }
+            }
+            for (Segment const& segment : segments)
+            {
+                stats.sizeBytes += static_cast<int64_t>(segment.map.size);
+            }
+
+            return stats;
+        }
+
+        void GASegmentStore::beginWrites()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            grouped = true;
+        }
+
+        void GASegmentStore::endWrites()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            grouped = false;
+            flush(syncPolicy != EGAStoreSyncPolicy::None);
+        }
+
+        void GASegmentStore::endWrite()
+        {
+            if (syncPolicy == EGAStoreSyncPolicy::Always)
+            {
+                flush(true);
+            }
+            else if (!grouped)
+            {
+                flush(syncPolicy == EGAStoreSyncPolicy::PerPass);
+            }
+        }
+
+        void GASegmentStore::flush(bool sync)
+        {
+            if (journalFile && !journalBuffer.empty())
+            {
+                std::fwrite(journalBuffer.data(), 1, journalBuffer.size(), journalFile);
+                std::fflush(journalFile);
+                journalBuffer.clear();
+            }
+
+            if (!sync)
+            {
+                return;
+            }
+
+            for (Segment& segment : segments)
+            {
+                syncRange(segment.map, segment.syncedOffset, segment.writeOffset);
+                segment.syncedOffset = segment.writeOffset;
+            }
+
+            if (journalFile)
+            {
+                syncFile(journalFile);
+            }
+        }
+
+        void GASegmentStore::journal(std::string const& record)
+        {
+            journalBuffer += record;
+            journalBytes  += static_cast<int64_t>(record.size());
+
+            if (journalBytes > CompactJournalBytes)
+            {
+                compactJournal();
+            }
+        }
+
+        bool GASegmentStore::loadJournal()
+        {
+            const std::filesystem::path path = std::filesystem::path(directory) / JournalName;
+
+            std::string data;
+            {
+                std::ifstream in(path, std::ios::binary);
+                if (in)
+                {
+                    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                }
+            }
+
+            std::size_t offset = 0;
+            while (const uint32_t length = validFrame(data.data(), data.size(), offset))
+            {
+                RecordReader reader{ data.data() + offset + RecordHeaderBytes, data.data() + offset + RecordHeaderBytes + length };
+
+                switch (reader.get<uint8_t>())
+                {
+                    case JournalState:
+                    {
+                        std::string key   = reader.getString();
+                        std::string value = reader.getString();
+                        if (value.empty())
+                        {
+                            state.erase(key);
+                        }
+                        else
+                        {
+                            state[key] = std::move(value);
+                        }
+                        break;
+                    }
+                    case JournalProgression:
+                    {
+                        std::string progression = reader.getString();
+                        const int32_t tries = reader.get<int32_t>();
+                        if (tries <= 0)
+                        {
+                            progressionTries.erase(progression);
+                        }
+                        else
+                        {
+                            progressionTries[progression] = tries;
+                        }
+                        break;
+                    }
+                    case JournalSession:
+                    {
+                        SessionCheckpoint session;
+                        session.sessionId = reader.getString();
+                        session.startTs   = reader.get<int64_t>();
+                        session.event     = reader.getString();
+                        sessions[session.sessionId] = std::move(session);
+                        break;
+                    }
+                    case JournalSessionEnd:
+                    {
+                        sessions.erase(reader.getString());
+                        break;
+                    }
+                    case JournalConsumed:
+                    {
+                        consumedSegment = reader.get<uint64_t>();
+                        consumedOffset  = reader.get<uint32_t>();
+                        break;
+                    }
+                    default:
+                        reader.ok = false;
+                        break;
+                }
+
+                if (!reader.ok)
+                {
+                    break;
+                }
+
+                offset += RecordHeaderBytes + length;
+            }
+
+            std::error_code err;
+            if (offset < data.size())
+            {
+                logging::GALogger::w("Event log: truncating a damaged journal record at offset %zu", offset);
+                std::filesystem::resize_file(path, offset, err);
+            }
+
+            journalBytes = static_cast<int64_t>(offset);
+            journalFile  = std::fopen(path.string().c_str(), "ab");
+            return journalFile != nullptr;
+        }
+
+        void GASegmentStore::compactJournal()
+        {
+            std::string snapshot;
+            for (auto const& entry : state)
+            {
+                snapshot += (RecordWriter(JournalState) << std::string_view(entry.first) << std::string_view(entry.second)).framed();
+            }
+            for (auto const& entry : progressionTries)
+            {
+                snapshot += (RecordWriter(JournalProgression) << std::string_view(entry.first) << static_cast<int32_t>(entry.second)).framed();
+            }
+            for (auto const& entry : sessions)
+            {
+                SessionCheckpoint const& session = entry.second;
+                snapshot += (RecordWriter(JournalSession) << std::string_view(session.sessionId) << session.startTs << std::string_view(session.event)).framed();
+            }
+            snapshot += (RecordWriter(JournalConsumed) << consumedSegment << consumedOffset).framed();
+
+            const std::filesystem::path path = std::filesystem::path(directory) / JournalName;
+            const std::filesystem::path temp = std::filesystem::path(directory) / JournalTempName;
+
+            // the snapshot replaces the journal in one rename, a crash leaves one of the two complete
+            std::FILE* out = std::fopen(temp.string().c_str(), "wb");
+            if (!out)
+            {
+                return;
+            }
+
+            const bool written = std::fwrite(snapshot.data(), 1, snapshot.size(), out) == snapshot.size() && std::fflush(out) == 0;
+            syncFile(out);
+            std::fclose(out);
+
+            std::error_code err;
+            if (!written)
+            {
+                std::filesystem::remove(temp, err);
+                return;
+            }
+
+            if (journalFile)
+            {
+                std::fclose(journalFile);
+            }
+
+            std::filesystem::rename(temp, path, err);
+
+            journalFile = std::fopen(path.string().c_str(), "ab");
+            if (err)
+            {
+                // the old journal stays in use, the buffered records still go to it
+                std::filesystem::remove(temp, err);
+                return;
+            }
+
+            journalBuffer.clear();
+            journalBytes = static_cast<int64_t>(snapshot.size());
+        }
+    }
+}
@@ -0,0 +1,187 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "GACommon.h"
+#include "GAEventStore.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // append-only event log for EGAStoreBackend::SegmentLog: events are appended to fixed size,
+        // memory mapped segment files and consumed in order, a segment file is deleted as a whole once
+        // every event in it was acked (or evicted when the log is over its quota, oldest segment first)
+        //
+        // every record is framed by its length and a CRC-32, opening the log truncates a torn tail
+        // record. State, progression tries, sessions and the consumer offset (everything before it was
+        // acked) go to a journal of the same records, compacted into a snapshot once it grows.
+        // Events acked out of order or still claimed when the process ends are sent again.
+        class GASegmentStore : public IEventStore
+        {
+         public:
+
+            GASegmentStore();
+            GASegmentStore(const GASegmentStore&) = delete;
+            GASegmentStore& operator=(const GASegmentStore&) = delete;
+            ~GASegmentStore() override;
+
+            // opens the log in the directory 'path' (created if missing), 'dropDatabase' starts it empty
+            bool open(std::string const& path, bool dropDatabase = false);
+            void close();
+            bool isOpen() const;
+
+            // segmentSizeBytes, maxSizeBytes and syncPolicy, must happen before open
+            void setSettings(GAStoreSettings const& settings);
+
+            // queues 'event' as it is
+            void appendText(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event);
+
+            // IEventStore
+            void append(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event) override;
+            bool claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out) override;
+            void ackBatch(std::string const& requestId) override;
+            void putBackBatch(std::string const& requestId) override;
+            void putBackAll() override;
+            void trim() override;
+            bool isFull() override;
+
+            std::string  getState(std::string const& key) override;
+            void         setState(std::string const& key, std::string const& value) override;
+            StringVector getStateKeys(std::string const& prefix) override;
+
+            void setProgressionTries(std::string const& progression, int tries) override;
+            std::vector<std::pair<std::string, int>> getProgressionTries() override;
+
+            void checkpointSession(SessionCheckpoint const& session) override;
+            void removeSession(std::string const& sessionId) override;
+            std::vector<SessionCheckpoint> getSessions() override;
+
+            EventStoreStats getStats() override;
+
+            // with EGAStoreSyncPolicy::PerPass the writes in between are flushed together
+            void beginWrites() override;
+            void endWrites() override;
+
+            // accepted range of GAStoreSettings::segmentSizeBytes (records are addressed by 32 bit offsets)
+            static constexpr int64_t MinSegmentSizeBytes = 4096;
+            static constexpr int64_t MaxSegmentSizeBytes = 1073741824;
+
+         private:
+
+            // a file mapped read/write for its whole size
+            struct Mapping
+            {
+                char*       data = nullptr;
+                std::size_t size = 0;
+#if IS_WIN32 || IS_UWP
+                HANDLE file    = INVALID_HANDLE_VALUE;
+                HANDLE mapping = nullptr;
+#else
+                int    fd      = -1;
+#endif
+            };
+
+            struct Segment
+            {
+                uint64_t    seq = 0;
+                std::string path;
+                Mapping     map;
+                uint32_t    writeOffset = 0;  // end of the valid records
+                uint32_t    syncedOffset = 0; // flushed up to here
+            };
+
+            // where a queued event lives, 'batch' is 0 while queued and the claiming batch after
+            struct Record
+            {
+                uint64_t segment  = 0;
+                uint32_t offset   = 0;
+                uint32_t length   = 0;
+                uint8_t  category = 0;
+                int64_t  batch    = 0;
+                int64_t  clientTs = 0;
+            };
+
+            static constexpr int64_t Acked = -1;
+
+            static bool mapFile(std::string const& path, std::size_t size, bool create, Mapping& map);
+            static void unmapFile(Mapping& map);
+            static void syncRange(Mapping const& map, uint32_t from, uint32_t to);
+
+            bool     loadSegment(std::string const& path, uint64_t seq);
+            Segment* addSegment();
+            void     removeFrontSegment();
+            Segment* findSegment(uint64_t seq);
+
+            void insertRecord(uint8_t category, int64_t clientTs, std::string_view event);
+
+            // drops acked records from the front, persists the new consumer offset and deletes consumed segments
+            void advance();
+            // evicts the oldest segments while the log is over its quota, returns the number of evicted events
+            int64_t evictToQuota();
+
+            // journal of state changes, replayed when opening
+            bool loadJournal();
+            void journal(std::string const& record);
+            void compactJournal();
+            void flush(bool sync);
+            void endWrite();
+
+            std::string directory;
+            bool        opened = false;
+
+            int64_t            segmentSizeBytes = 1048576;
+            int64_t            maxSizeBytes     = 6291456;
+            EGAStoreSyncPolicy syncPolicy       = EGAStoreSyncPolicy::None;
+
+            std::deque<Segment> segments;
+            std::deque<Record>  records;
+            uint64_t nextSeq = 1;
+
+            // everything before this position was acked
+            uint64_t consumedSegment = 0;
+            uint32_t consumedOffset  = 0;
+
+            struct Batch
+            {
+                int64_t id     = 0;
+                int64_t events = 0;
+            };
+
+            std::unordered_map<std::string, Batch> batches;
+            int64_t nextBatchId = 1;
+
+            std::map<std::string, std::string>                 state;
+            std::unordered_map<std::string, int>               progressionTries;
+            std::unordered_map<std::string, SessionCheckpoint> sessions;
+
+            std::FILE*  journalFile  = nullptr;
+            std::string journalBuffer;
+            int64_t     journalBytes = 0;
+
+            // the journal is rewritten as a snapshot past this size
+            static constexpr int64_t CompactJournalBytes = 262144;
+
+            int64_t queuedEvents  = 0;
+            int64_t claimedEvents = 0;
+            int64_t evictedEvents = 0;
+            int64_t droppedEvents = 0;
+
+            EventCategoryCounters categoryCounters;
+
+            bool grouped = false;
+
+            mutable std::mutex mutex;
+        };
+    }
+}
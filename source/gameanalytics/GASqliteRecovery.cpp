@@ -0,0 +1,298 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GASqliteRecovery.h"
+#include "GALogger.h"
+#include "GAUtilities.h"
+#include <cstring>
+#include <vector>
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        namespace
+        {
+            constexpr const char* Tables[] = { "ga_events", "ga_annotations", "ga_state", "ga_session", "ga_progression" };
+
+            // a read past a damaged page starts 1, 2, 4, ... rowids further on, up to this far
+            constexpr int64_t MaxSkipRowids = int64_t(1) << 40;
+
+            bool isDamageCode(int rc)
+            {
+                const int primary = rc & 0xff;
+                return primary == SQLITE_CORRUPT || primary == SQLITE_NOTADB;
+            }
+
+            // the columns read from a table and where they go, in the same order
+            struct TableCopy
+            {
+                const char* table;
+                const char* select;
+                const char* insert;
+                int         columns;
+            };
+
+            int64_t maxRowid(sqlite3* db, const char* table)
+            {
+                int64_t max = 0;
+                sqlite3_stmt* statement = nullptr;
+                if (sqlite3_prepare_v2(db, utilities::printString("SELECT MAX(rowid) FROM %s;", table).c_str(), -1, &statement, nullptr) == SQLITE_OK
+                    && sqlite3_step(statement) == SQLITE_ROW)
+                {
+                    max = sqlite3_column_int64(statement, 0);
+                }
+
+                sqlite3_finalize(statement);
+                return max;
+            }
+
+            // copies the rows of a table that can still be read in rowid order, CopyRowsPerStep rows per
+            // transaction of 'to'; returns false if the table cannot be read at all
+            bool copyRows(sqlite3* from, sqlite3* to, TableCopy const& copy, std::atomic<bool> const* cancel, int64_t& copied, int64_t& lost)
+            {
+                std::string placeholders = "?";
+                for (int i = 1; i < copy.columns; ++i)
+                {
+                    placeholders += ", ?";
+                }
+
+                const std::string selectSql = utilities::printString("SELECT rowid, %s FROM %s WHERE rowid > ? ORDER BY rowid LIMIT %d;", copy.select, copy.table, GASqliteRecovery::CopyRowsPerStep);
+                const std::string insertSql = utilities::printString("INSERT OR REPLACE INTO %s(%s) VALUES(%s);", copy.table, copy.insert, placeholders.c_str());
+
+                sqlite3_stmt* select = nullptr;
+                sqlite3_stmt* insert = nullptr;
+                if (sqlite3_prepare_v2(from, selectSql.c_str(), -1, &select, nullptr) != SQLITE_OK
+                    || sqlite3_prepare_v2(to, insertSql.c_str(), -1, &insert, nullptr) != SQLITE_OK)
+                {
+                    logging::GALogger::w("Database recovery: %s cannot be read (%s)", copy.table, sqlite3_errmsg(from));
+                    sqlite3_finalize(select);
+                    sqlite3_finalize(insert);
+                    return false;
+                }
+
+                // the rightmost page may be readable when pages before it are not
+                const int64_t max = maxRowid(from, copy.table);
+
+                int64_t last = 0;
+                int64_t skip = 0;
+                bool    more = true;
+                while (more && !(cancel && cancel->load(std::memory_order_relaxed)))
+                {
+                    sqlite3_exec(to, "BEGIN;", nullptr, nullptr, nullptr);
+                    sqlite3_bind_int64(select, 1, last + skip);
+
+                    int rows = 0;
+                    int rc   = SQLITE_OK;
+                    while ((rc = sqlite3_step(select)) == SQLITE_ROW)
+                    {
+                        const int64_t rowid = sqlite3_column_int64(select, 0);
+                        if (skip > 0)
+                        {
+                            // everything up to here was behind the damaged page (deleted rows included)
+                            lost += rowid - last - 1;
+                            skip  = 0;
+                        }
+
+                        for (int i = 0; i < copy.columns; ++i)
+                        {
+                            sqlite3_bind_value(insert, i + 1, sqlite3_column_value(select, i + 1));
+                        }
+
+                        if (sqlite3_step(insert) == SQLITE_DONE)
+                        {
+                            ++copied;
+                        }
+                        else
+                        {
+                            ++lost;
+                        }
+
+                        sqlite3_reset(insert);
+                        last = rowid;
+                        ++rows;
+                    }
+
+                    sqlite3_reset(select);
+                    sqlite3_exec(to, "COMMIT;", nullptr, nullptr, nullptr);
+
+                    if (rc == SQLITE_DONE)
+                    {
+                        // a short step reached the end of the table
+                        more = rows == GASqliteRecovery::CopyRowsPerStep;
+                    }
+                    else
+                    {
+                        skip = skip == 0 ? 1 : skip * 2;
+                        more = skip <= MaxSkipRowids;
+                    }
+                }
+
+                if (max > last)
+                {
+                    lost += max - last;
+                }
+
+                sqlite3_finalize(select);
+                sqlite3_finalize(insert);
+                return true;
+            }
+
+            bool prepares(sqlite3* db, const char* sql)
+            {
+                sqlite3_stmt* statement = nullptr;
+                const bool ok = sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) == SQLITE_OK;
+                sqlite3_finalize(statement);
+                return ok;
+            }
+        }
+
+        bool GASqliteRecovery::isDamaged(sqlite3* db, std::string& reason)
+        {
+            std::vector<std::string> probes = { "SELECT COUNT(*) FROM sqlite_master;" };
+            for (const char* table : Tables)
+            {
+                // the first and the last leaf, a truncated file loses its last pages
+                probes.push_back(utilities::printString("SELECT * FROM %s ORDER BY rowid LIMIT 1;", table));
+                probes.push_back(utilities::printString("SELECT * FROM %s ORDER BY rowid DESC LIMIT 1;", table));
+            }
+
+            for (std::string const& probe : probes)
+            {
+                if (isDamageCode(sqlite3_exec(db, probe.c_str(), nullptr, nullptr, nullptr)))
+                {
+                    reason = sqlite3_errmsg(db);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        int64_t GASqliteRecovery::quickCheck(std::string const& path, std::string& firstProblem, std::atomic<bool> const& cancel)
+        {
+            sqlite3* db = nullptr;
+            if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK)
+            {
+                logging::GALogger::w("Database recovery: could not open %s", path.c_str());
+                sqlite3_close(db);
+                return 0;
+            }
+
+            sqlite3_busy_timeout(db, 1000);
+
+            // the check reads every page, a store that closes does not wait for it
+            sqlite3_progress_handler(db, 1000,
+                [](void* flag) -> int
+                {
+                    return static_cast<std::atomic<bool> const*>(flag)->load(std::memory_order_relaxed) ? 1 : 0;
+                },
+                const_cast<std::atomic<bool>*>(&cancel));
+
+            int64_t       problems  = 0;
+            sqlite3_stmt* statement = nullptr;
+            int           rc        = sqlite3_prepare_v2(db, "PRAGMA quick_check(100);", -1, &statement, nullptr);
+            if (rc == SQLITE_OK)
+            {
+                while ((rc = sqlite3_step(statement)) == SQLITE_ROW)
+                {
+                    const char* line = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+                    if (line && std::strcmp(line, "ok") != 0)
+                    {
+                        if (problems == 0)
+                        {
+                            firstProblem = line;
+                        }
+                        ++problems;
+                    }
+                }
+            }
+
+            if (rc != SQLITE_DONE && problems == 0 && isDamageCode(rc))
+            {
+                firstProblem = sqlite3_errmsg(db);
+                problems     = 1;
+            }
+
+            sqlite3_finalize(statement);
+            sqlite3_close(db);
+            return problems;
+        }
+
+        void GASqliteRecovery::salvageState(sqlite3* from, sqlite3* to, SalvageStats& stats)
+        {
+            constexpr TableCopy tables[] =
+            {
+                { "ga_state", "key, value", "key, value", 2 },
+                { "ga_session", "session_id, timestamp, event", "session_id, timestamp, event", 3 },
+                { "ga_progression", "progression, tries", "progression, tries", 2 }
+            };
+
+            for (TableCopy const& table : tables)
+            {
+                copyRows(from, to, table, nullptr, stats.stateRows, stats.stateRowsLost);
+            }
+        }
+
+        bool GASqliteRecovery::salvageEvents(std::string const& from, std::string const& to, std::string const& schema, SalvageStats& stats, std::atomic<bool> const& cancel)
+        {
+            std::error_code err;
+            std::filesystem::remove(to, err);
+
+            sqlite3* source = nullptr;
+            sqlite3* target = nullptr;
+            if (sqlite3_open_v2(from.c_str(), &source, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK
+                || sqlite3_open_v2(to.c_str(), &target, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK)
+            {
+                logging::GALogger::w("Database recovery: could not open %s", source ? to.c_str() : from.c_str());
+                sqlite3_close(source);
+                sqlite3_close(target);
+                return false;
+            }
+
+            // the file only replaces the database once it is complete, a crash before that starts the copy over
+            const std::string script = "PRAGMA auto_vacuum=INCREMENTAL; PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF;" + schema;
+            if (sqlite3_exec(target, script.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+            {
+                logging::GALogger::w("Database recovery: could not create %s (%s)", to.c_str(), sqlite3_errmsg(target));
+                sqlite3_close(source);
+                sqlite3_close(target);
+                return false;
+            }
+
+            // databases of schema version 2 have no shared annotations, those of version 1 no usable ids
+            const bool annotated = prepares(source, "SELECT id, category, session_id, client_ts, event, annotations FROM ga_events LIMIT 0;");
+            if (annotated)
+            {
+                // annotations are only lost with their events, which are counted below
+                int64_t annotations     = 0;
+                int64_t annotationsLost = 0;
+                copyRows(source, target, { "ga_annotations", "id, annotations", "id, annotations", 2 }, &cancel, annotations, annotationsLost);
+                copyRows(source, target, { "ga_events", "id, category, session_id, client_ts, event, annotations", "id, category, session_id, client_ts, event, annotations", 6 }, &cancel, stats.events, stats.eventsLost);
+
+                // an event without its annotations has no user or session to be sent for
+                if (sqlite3_exec(target, "DELETE FROM ga_events WHERE annotations > 0 AND annotations NOT IN (SELECT id FROM ga_annotations);", nullptr, nullptr, nullptr) == SQLITE_OK)
+                {
+                    const int64_t orphans = sqlite3_changes(target);
+                    stats.events     -= orphans;
+                    stats.eventsLost += orphans;
+                }
+            }
+            else if (prepares(source, "SELECT id, category, session_id, client_ts, event FROM ga_events LIMIT 0;"))
+            {
+                copyRows(source, target, { "ga_events", "id, category, session_id, client_ts, event, 0", "id, category, session_id, client_ts, event, annotations", 6 }, &cancel, stats.events, stats.eventsLost);
+            }
+            else
+            {
+                logging::GALogger::w("Database recovery: the queued events of %s cannot be read", from.c_str());
+            }
+
+            sqlite3_close(source);
+            sqlite3_close(target);
+
+            return !cancel.load(std::memory_order_relaxed);
+        }
+    }
+}
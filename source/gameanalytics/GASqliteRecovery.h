@@ -0,0 +1,54 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <sqlite3.h>
+#include <atomic>
+#include <string>
+#include "GACommon.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // what a recovery read out of a damaged database and what it could not
+        struct SalvageStats
+        {
+            int64_t     problems = 0;        // reported by PRAGMA quick_check
+            std::string firstProblem;
+
+            int64_t stateRows     = 0;       // ga_state, ga_session and ga_progression rows copied
+            int64_t stateRowsLost = 0;
+            int64_t events        = 0;       // ga_events rows copied
+            int64_t eventsLost    = 0;       // an upper bound: unreadable ranges of ids and events whose annotations were lost
+        };
+
+        // salvage of a damaged GA database: readable rows are copied one at a time into another database,
+        // a read that fails skips ahead past the damaged page instead of giving up on the table
+        class GASqliteRecovery
+        {
+         public:
+
+            // true if a table of 'db' cannot be read at either end (SQLITE_CORRUPT or SQLITE_NOTADB),
+            // 'reason' gets the error; a missing table is not damage
+            static bool isDamaged(sqlite3* db, std::string& reason);
+
+            // the problems PRAGMA quick_check finds in the database at 'path' (0 for a sound one), run on a
+            // connection of its own; a check stopped by 'cancel' or kept out by a lock finds none
+            static int64_t quickCheck(std::string const& path, std::string& firstProblem, std::atomic<bool> const& cancel);
+
+            // the state tables of 'from' into 'to' (which has them), rows of 'to' with the same key are replaced
+            static void salvageState(sqlite3* from, sqlite3* to, SalvageStats& stats);
+
+            // builds the database 'to' from 'schema' (created anew) and the readable events of the damaged database
+            // 'from', stops early and returns false once 'cancel' is set
+            static bool salvageEvents(std::string const& from, std::string const& to, std::string const& schema, SalvageStats& stats, std::atomic<bool> const& cancel);
+
+            // rows read per transaction of the copy
+            static constexpr int CopyRowsPerStep = 500;
+        };
+    }
+}
@@ -0,0 +1,1686 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GASqliteStore.h"
+#include "GALogger.h"
+#include "GAUtilities.h"
+#include "GAEventCodec.h"
+#include <string.h>
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // eviction starts a little below the quota (the tracked size can lag behind the pages by a few rows)
+        // and frees a sixth of it, so it runs once per few hundred events instead of on every insert
+        constexpr int64_t evictAboveBytes(int64_t maxSizeBytes)
+        {
+            return maxSizeBytes - maxSizeBytes / 16;
+        }
+
+        constexpr int64_t evictToBytes(int64_t maxSizeBytes)
+        {
+            return maxSizeBytes - maxSizeBytes / 6;
+        }
+
+        // the write-ahead log counts against the quota as well: it is checkpointed once it holds a
+        // sixteenth of it and truncated back to that size (or to nothing after an eviction, or on a
+        // maintenance tick that finds it past that size)
+        constexpr int64_t walLimitBytes(int64_t maxSizeBytes)
+        {
+            return maxSizeBytes / 16;
+        }
+
+        // rows looked at per eviction query
+        constexpr int EvictRowsPerStep = 1000;
+
+        // id:        rowid, new rows always get a larger id than every row present (claim order)
+        // batch:     0 for queued events, otherwise the batch of the request that claimed them
+        // category:  index into EventCategories
+        // client_ts: seconds, compared as integers
+        // annotations: the ga_annotations row with the session annotations left out of 'event', 0 for none
+        //
+        // ga_events_batch serves the claim without category and the select/delete of a batch
+        // (rowid order within a batch), ga_events_category the claim of one category,
+        // ga_events_annotations the pruning of ga_annotations
+        constexpr const char* CreateEventTables =
+            "CREATE TABLE IF NOT EXISTS ga_events(id INTEGER PRIMARY KEY, batch INTEGER NOT NULL DEFAULT 0, category INTEGER NOT NULL, session_id TEXT NOT NULL, client_ts INTEGER NOT NULL, event TEXT NOT NULL, annotations INTEGER NOT NULL DEFAULT 0);"
+            "CREATE INDEX IF NOT EXISTS ga_events_batch ON ga_events(batch);"
+            "CREATE INDEX IF NOT EXISTS ga_events_category ON ga_events(batch, category);"
+            "CREATE INDEX IF NOT EXISTS ga_events_annotations ON ga_events(annotations);"
+            "CREATE TABLE IF NOT EXISTS ga_annotations(id INTEGER PRIMARY KEY, annotations TEXT NOT NULL UNIQUE);";
+
+        constexpr const char* CreateSessionTable     = "CREATE TABLE IF NOT EXISTS ga_session(session_id CHAR(50) PRIMARY KEY NOT NULL, timestamp CHAR(50) NOT NULL, event TEXT NOT NULL);";
+        constexpr const char* CreateStateTable       = "CREATE TABLE IF NOT EXISTS ga_state(key CHAR(255) PRIMARY KEY NOT NULL, value TEXT);";
+        constexpr const char* CreateProgressionTable = "CREATE TABLE IF NOT EXISTS ga_progression(progression CHAR(255) PRIMARY KEY NOT NULL, tries CHAR(255));";
+
+        // folds the events and state written since a damaged database was set aside into its salvage
+        // (attached as 'salvage'): events after the salvaged ones with their annotations mapped to the
+        // salvage's ids, state rows over the salvaged ones (they are the newer)
+        constexpr const char* MergeIntoSalvage =
+            "BEGIN;"
+            "INSERT OR IGNORE INTO salvage.ga_annotations(annotations) SELECT annotations FROM main.ga_annotations ORDER BY id;"
+            "INSERT INTO salvage.ga_events(category, session_id, client_ts, event, annotations) "
+                "SELECT e.category, e.session_id, e.client_ts, e.event, IFNULL(s.id, 0) FROM main.ga_events e "
+                "LEFT JOIN main.ga_annotations m ON m.id = e.annotations "
+                "LEFT JOIN salvage.ga_annotations s ON s.annotations = m.annotations ORDER BY e.id;"
+            "INSERT OR REPLACE INTO salvage.ga_state(key, value) SELECT key, value FROM main.ga_state;"
+            "INSERT OR REPLACE INTO salvage.ga_session(session_id, timestamp, event) SELECT session_id, timestamp, event FROM main.ga_session;"
+            "INSERT OR REPLACE INTO salvage.ga_progression(progression, tries) SELECT progression, tries FROM main.ga_progression;"
+            "COMMIT;";
+
+        // puts the shared session annotations (a JSON object, empty for none) back into a stored event;
+        // the keys of both objects never overlap, so their members are joined as text
+        static void addAnnotations(std::string_view annotations, std::string& event)
+        {
+            if (annotations.size() <= 2 || event.size() < 2 || event.front() != '{')
+            {
+                return;
+            }
+
+            std::string full;
+            full.reserve(annotations.size() + event.size());
+            full.append(annotations.data(), annotations.size() - 1);
+            if (event.size() > 2)
+            {
+                full.push_back(',');
+                full.append(event, 1, std::string::npos);
+            }
+            else
+            {
+                full.push_back('}');
+            }
+
+            event.swap(full);
+        }
+
+        GASqliteStore::GASqliteStore()
+        {
+        }
+
+        GASqliteStore::~GASqliteStore()
+        {
+            close();
+        }
+
+        GASqliteStore::Row::Row(sqlite3_stmt* statement):
+            _statement(statement)
+        {
+        }
+
+        int GASqliteStore::Row::columnCount() const
+        {
+            return sqlite3_column_count(_statement);
+        }
+
+        const char* GASqliteStore::Row::columnName(int column) const
+        {
+            return sqlite3_column_name(_statement, column);
+        }
+
+        int GASqliteStore::Row::columnType(int column) const
+        {
+            return sqlite3_column_type(_statement, column);
+        }
+
+        bool GASqliteStore::Row::isNull(int column) const
+        {
+            return sqlite3_column_type(_statement, column) == SQLITE_NULL;
+        }
+
+        int64_t GASqliteStore::Row::getInt64(int column, int64_t defValue) const
+        {
+            return isNull(column) ? defValue : static_cast<int64_t>(sqlite3_column_int64(_statement, column));
+        }
+
+        double GASqliteStore::Row::getDouble(int column, double defValue) const
+        {
+            return isNull(column) ? defValue : sqlite3_column_double(_statement, column);
+        }
+
+        std::string_view GASqliteStore::Row::getText(int column) const
+        {
+            const unsigned char* text = sqlite3_column_text(_statement, column);
+            if (!text)
+            {
+                return {};
+            }
+
+            // the length has to be read after the text conversion
+            return std::string_view(reinterpret_cast<const char*>(text), static_cast<std::size_t>(sqlite3_column_bytes(_statement, column)));
+        }
+
+        std::string GASqliteStore::Row::getString(int column) const
+        {
+            return std::string(getText(column));
+        }
+
+        std::string_view GASqliteStore::Row::getBlob(int column) const
+        {
+            const void* blob = sqlite3_column_blob(_statement, column);
+            if (!blob)
+            {
+                return {};
+            }
+
+            return std::string_view(static_cast<const char*>(blob), static_cast<std::size_t>(sqlite3_column_bytes(_statement, column)));
+        }
+
+        void GASqliteStore::queryJson(std::string const& sql, StringVector const& parameters, bool useTransaction, json& out)
+        {
+            json rows = json::array();
+
+            const bool ok = query(sql, parameters, useTransaction,
+                [&rows](Row const& r)
+                {
+                    json row;
+
+                    for (int i = 0; i < r.columnCount(); i++)
+                    {
+                        if (r.isNull(i))
+                        {
+                            continue;
+                        }
+
+                        const char *column = r.columnName(i);
+                        if (!column)
+                        {
+                            continue;
+                        }
+
+                        switch (r.columnType(i))
+                        {
+                            case SQLITE_INTEGER:
+                                row[column] = r.getInt64(i);
+                                break;
+
+                            case SQLITE_FLOAT:
+                                row[column] = r.getDouble(i);
+                                break;
+
+                            default:
+                                row[column] = r.getString(i);
+                        }
+                    }
+
+                    rows.push_back(std::move(row));
+                });
+
+            if (ok)
+            {
+                out = std::move(rows);
+            }
+            else
+            {
+                out = {};
+            }
+        }
+
+        bool GASqliteStore::query(std::string const& sql, StringVector const& parameters, RowCallback const& onRow)
+        {
+            return query(sql, parameters, false, onRow);
+        }
+
+        bool GASqliteStore::query(std::string const& sql, StringVector const& parameters, bool useTransaction, RowCallback const& onRow)
+        {
+            std::lock_guard<std::mutex> lock(queryMutex);
+
+            sqlite3 *sqlDatabasePtr = sqlDatabase;
+            bool inTransaction = false;
+
+            try
+            {
+                // Prepare statement (or reuse the one prepared by an earlier call)
+                CachedStatement* cached = prepareCached(sql);
+                if (!cached)
+                {
+                    // TODO(nikolaj): Should we do a db validation to see if the db is corrupt here?
+                    logging::GALogger::e("SQLITE3 PREPARE ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
+                    return false;
+                }
+
+                sqlite3_stmt *statement = cached->statement;
+
+                // schema changes and VACUUM run outside of the group transaction
+                if (!cached->isWrite && sqlite3_stmt_readonly(statement) == 0)
+                {
+                    commitGroup();
+                }
+
+                // writes join the group transaction (opening it if needed) instead of committing one by one
+                bool inOpenTransaction = sqlite3_get_autocommit(sqlDatabasePtr) == 0;
+                if (cached->isWrite && groupCommit && !inOpenTransaction)
+                {
+                    if (sqlite3_exec(sqlDatabasePtr, "BEGIN;", 0, 0, 0) == SQLITE_OK)
+                    {
+                        groupOpen   = true;
+                        inOpenTransaction = true;
+                    }
+                    else
+                    {
+                        logging::GALogger::e("SQLITE3 BEGIN ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
+                    }
+                }
+
+                // Force transaction if it is an update, insert or delete.
+                useTransaction = (useTransaction || cached->isWrite) && !inOpenTransaction;
+
+                if (useTransaction)
+                {
+                    if (sqlite3_exec(sqlDatabasePtr, "BEGIN;", 0, 0, 0) != SQLITE_OK)
+                    {
+                        logging::GALogger::e("SQLITE3 BEGIN ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
+                        releaseStatement(*cached);
+                        return false;
+                    }
+                    inTransaction = true;
+                }
+
+                // Bind parameters
+                for (size_t index = 0; index < parameters.size(); index++)
+                {
+                    // bound with their length, binary values (CAST(? AS BLOB)) may contain zero bytes
+                    sqlite3_bind_text(statement, static_cast<int>(index + 1), parameters[index].data(), static_cast<int>(parameters[index].size()), SQLITE_STATIC);
+                }
+
+                // Loop through results
+                const Row row(statement);
+                while (sqlite3_step(statement) == SQLITE_ROW)
+                {
+                    if (onRow)
+                    {
+                        onRow(row);
+                    }
+                }
+
+                // Reset the statement for the next call, this reports the error of the last step (if any)
+                const int result = releaseStatement(*cached);
+
+                if (result != SQLITE_OK)
+                {
+                    logging::GALogger::d("SQLITE3 STEP ERROR: %s", sqlite3_errstr(result));
+
+                    if (useTransaction && sqlite3_exec(sqlDatabasePtr, "ROLLBACK", 0, 0, 0) != SQLITE_OK)
+                    {
+                        logging::GALogger::e("SQLITE3 ROLLBACK ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
+                    }
+
+                    return false;
+                }
+
+                if (useTransaction && sqlite3_exec(sqlDatabasePtr, "COMMIT", 0, 0, 0) != SQLITE_OK)
+                {
+                    logging::GALogger::e("SQLITE3 COMMIT ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
+                    return false;
+                }
+
+                if (groupOpen && cached->isWrite && ++groupedWrites >= MaxGroupedWrites)
+                {
+                    commitGroup();
+                }
+
+                return true;
+            }
+            catch(std::exception& e)
+            {
+                logging::GALogger::e("Exception thrown: %s", e.what());
+
+                // a throwing callback leaves the statement mid-step
+                resetStatements();
+                if (inTransaction)
+                {
+                    sqlite3_exec(sqlDatabasePtr, "ROLLBACK", 0, 0, 0);
+                }
+
+                return false;
+            }
+        }
+
+        GASqliteStore::CachedStatement* GASqliteStore::prepareCached(std::string const& sql)
+        {
+            auto it = statementCache.find(sql);
+            if (it != statementCache.end())
+            {
+                return &it->second;
+            }
+
+            CachedStatement entry;
+            if (sqlite3_prepare_v2(sqlDatabase, sql.c_str(), -1, &entry.statement, nullptr) != SQLITE_OK)
+            {
+                sqlite3_finalize(entry.statement);
+                return nullptr;
+            }
+
+            // decided once per statement instead of on every call
+            entry.isWrite = isWriteStatement(sql);
+
+            // one-off statements (schema changes, trimming) are not worth keeping
+            if (statementCache.size() >= MaxCachedStatements || (!entry.isWrite && sqlite3_stmt_readonly(entry.statement) == 0))
+            {
+                uncachedStatement = entry;
+                return &uncachedStatement;
+            }
+
+            return &statementCache.emplace(sql, entry).first->second;
+        }
+
+        int GASqliteStore::releaseStatement(CachedStatement& entry)
+        {
+            const int result = sqlite3_reset(entry.statement);
+            sqlite3_clear_bindings(entry.statement);
+
+            if (entry.statement == uncachedStatement.statement)
+            {
+                sqlite3_finalize(uncachedStatement.statement);
+                uncachedStatement = {};
+            }
+
+            return result;
+        }
+
+        void GASqliteStore::resetStatements()
+        {
+            for (auto& entry : statementCache)
+            {
+                sqlite3_reset(entry.second.statement);
+                sqlite3_clear_bindings(entry.second.statement);
+            }
+
+            if (uncachedStatement.statement)
+            {
+                sqlite3_finalize(uncachedStatement.statement);
+                uncachedStatement = {};
+            }
+        }
+
+        void GASqliteStore::clearStatementCache()
+        {
+            for (auto& entry : statementCache)
+            {
+                sqlite3_finalize(entry.second.statement);
+            }
+
+            statementCache.clear();
+        }
+
+        void GASqliteStore::commitGroup()
+        {
+            if (!groupOpen)
+            {
+                return;
+            }
+
+            groupOpen     = false;
+            groupedWrites = 0;
+
+            // some errors (disk full, I/O) make sqlite roll the transaction back by itself
+            if (sqlite3_get_autocommit(sqlDatabase) != 0)
+            {
+                return;
+            }
+
+            if (sqlite3_exec(sqlDatabase, "COMMIT", 0, 0, 0) != SQLITE_OK)
+            {
+                logging::GALogger::e("SQLITE3 COMMIT ERROR: %s", sqlite3_errmsg(sqlDatabase));
+
+                if (sqlite3_exec(sqlDatabase, "ROLLBACK", 0, 0, 0) != SQLITE_OK)
+                {
+                    logging::GALogger::e("SQLITE3 ROLLBACK ERROR: %s", sqlite3_errmsg(sqlDatabase));
+                }
+            }
+        }
+
+        void GASqliteStore::beginWrites()
+        {
+            std::lock_guard<std::mutex> lock(queryMutex);
+
+            groupCommit = true;
+        }
+
+        void GASqliteStore::endWrites()
+        {
+            std::lock_guard<std::mutex> lock(queryMutex);
+
+            groupCommit = false;
+            commitGroup();
+        }
+
+        void GASqliteStore::setSettings(GAStoreSettings const& storeSettings)
+        {
+            settings = storeSettings;
+        }
+
+        GAStoreSettings const& GASqliteStore::getSettings() const
+        {
+            return settings;
+        }
+
+        void GASqliteStore::applySettings()
+        {
+            // a file database gets a write-ahead log: commits append to it instead of rewriting
+            // pages through a rollback journal, and with synchronous=NORMAL they skip the fsync
+            // (a power loss can drop the last commits but never corrupts the database)
+            if (dbPath != ":memory:")
+            {
+                // only takes effect on a new database (before the first table), see vacuumStep for older ones
+                sqlite3_exec(sqlDatabase, "PRAGMA auto_vacuum=INCREMENTAL;", 0, 0, 0);
+
+                if (sqlite3_exec(sqlDatabase, "PRAGMA journal_mode=WAL;", 0, 0, 0) != SQLITE_OK)
+                {
+                    logging::GALogger::w("Could not enable WAL journaling: %s", sqlite3_errmsg(sqlDatabase));
+                }
+
+                sqlite3_exec(sqlDatabase, "PRAGMA synchronous=NORMAL;", 0, 0, 0);
+
+                int64_t pageSize = 4096;
+                query("SELECT page_size FROM pragma_page_size();", {}, [&pageSize](Row const& row) { pageSize = row.getInt64(0, pageSize); });
+
+                const int64_t walLimit = walLimitBytes(settings.maxSizeBytes);
+                const std::string walPragmas = utilities::printString("PRAGMA journal_size_limit=%" PRId64 "; PRAGMA wal_autocheckpoint=%" PRId64 ";",
+                    walLimit, std::max<int64_t>(walLimit / pageSize, 1));
+
+                if (sqlite3_exec(sqlDatabase, walPragmas.c_str(), 0, 0, 0) != SQLITE_OK)
+                {
+                    logging::GALogger::w("Could not limit the WAL file: %s", sqlite3_errmsg(sqlDatabase));
+                }
+            }
+
+            const std::string pragmas = utilities::printString("PRAGMA cache_size=-%" PRId64 "; PRAGMA mmap_size=%" PRId64 "; PRAGMA temp_store=%d;",
+                settings.cacheSizeKiB, settings.mmapSizeBytes, static_cast<int>(settings.tempStore));
+
+            if (sqlite3_exec(sqlDatabase, pragmas.c_str(), 0, 0, 0) != SQLITE_OK)
+            {
+                logging::GALogger::w("Could not apply store settings: %s", sqlite3_errmsg(sqlDatabase));
+            }
+        }
+
+        void GASqliteStore::close()
+        {
+            stopRecovery();
+            commitGroup();
+            clearStatementCache();
+
+            if (sqlDatabase)
+            {
+                sqlite3_close(sqlDatabase);
+                sqlDatabase = nullptr;
+            }
+
+            tableReady = false;
+        }
+
+        bool GASqliteStore::isOpen() const
+        {
+            return tableReady;
+        }
+
+        sqlite3* GASqliteStore::getDatabase()
+        {
+            return sqlDatabase;
+        }
+
+        bool GASqliteStore::open(std::string const& path, bool dropDatabase)
+        {
+            // statements prepared against a previous connection cannot be reused
+            close();
+
+            dbPath = path;
+
+            if (!openConnection())
+            {
+                return false;
+            }
+
+            if (dropDatabase)
+            {
+                logging::GALogger::d("Drop tables");
+                query("DROP TABLE ga_events", {}, nullptr);
+                query("DROP TABLE ga_annotations", {}, nullptr);
+                query("DROP TABLE ga_state", {}, nullptr);
+                query("DROP TABLE ga_session", {}, nullptr);
+                query("DROP TABLE ga_progression", {}, nullptr);
+                query("VACUUM", {}, nullptr);
+                removeRecoveryFiles();
+            }
+            else if (dbPath != ":memory:")
+            {
+                // a damaged file is set aside instead of having its tables dropped, a new one takes its place
+                // and the rows that can still be read are salvaged from it (see startRecovery)
+                std::string reason;
+                if (GASqliteRecovery::isDamaged(sqlDatabase, reason))
+                {
+                    setAsideDamaged(reason);
+                    if (!openConnection())
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            // a database written at this schema version has every table and index, the checks and
+            // migrations only run for older files and new ones
+            int64_t version = 0;
+            query("PRAGMA user_version;", {}, [&version](Row const& row) { version = row.getInt64(0); });
+
+            if (dropDatabase || version != SchemaVersion)
+            {
+                if (!ensureEventTable(version))
+                {
+                    return false;
+                }
+
+                if (!ensureTable("ga_session", CreateSessionTable, "SELECT session_id FROM ga_session LIMIT 0,1")
+                    || !ensureTable("ga_state", CreateStateTable, "SELECT key FROM ga_state LIMIT 0,1")
+                    || !ensureTable("ga_progression", CreateProgressionTable, "SELECT progression FROM ga_progression LIMIT 0,1"))
+                {
+                    return false;
+                }
+            }
+
+            // batches of an earlier connection are not tracked anymore, never hand out their ids again
+            query("SELECT MAX(batch) FROM ga_events;", {}, [this](Row const& row) { nextBatchId = row.getInt64(0) + 1; });
+            batches.clear();
+            annotationIds.clear();
+
+            // the state is small and read while initializing, it is salvaged before anything reads it
+            if (stateSalvagePending)
+            {
+                salvageDamagedState();
+            }
+
+            // the queue counters start from the rows (on the batch index), from here on every write keeps them up to date
+            query("SELECT (SELECT COUNT(*) FROM ga_events WHERE batch = 0), (SELECT COUNT(*) FROM ga_events WHERE batch > 0);", {},
+                [this](Row const& row)
+                {
+                    queuedEvents.store(row.getInt64(0), std::memory_order_relaxed);
+                    claimedEvents.store(row.getInt64(1), std::memory_order_relaxed);
+                });
+            refreshOldestClientTs();
+
+            reconcileDbSize();
+
+            // the per category counters read every row and the quota may have to evict, both wait for a tick
+            categoryCounters.reset();
+            startupMaintenancePending = true;
+
+            tableReady = true;
+
+            logging::GALogger::d("Database tables ensured present");
+
+            startRecovery();
+
+            return true;
+        }
+
+        bool GASqliteStore::openConnection()
+        {
+            // Open database
+            if (sqlite3_open(dbPath.c_str(), &sqlDatabase) != SQLITE_OK)
+            {
+                logging::GALogger::w("Could not open database: %s", dbPath.c_str());
+                sqlite3_close(sqlDatabase);
+                sqlDatabase = nullptr;
+                return false;
+            }
+
+            logging::GALogger::i("Database opened: %s", dbPath.c_str());
+
+            applySettings();
+
+            return true;
+        }
+
+        std::string GASqliteStore::damagedPath() const
+        {
+            return dbPath + ".damaged";
+        }
+
+        std::string GASqliteStore::salvagePath() const
+        {
+            return dbPath + ".salvage";
+        }
+
+        void GASqliteStore::setAsideDamaged(std::string const& reason)
+        {
+            close();
+
+            logging::GALogger::w("Database damaged (%s), setting it aside: %s", reason.c_str(), damagedPath().c_str());
+
+            // the write-ahead log holds the last commits, it goes along with the file
+            std::error_code err;
+            std::filesystem::remove(damagedPath() + "-wal", err);
+            std::filesystem::remove(damagedPath() + "-shm", err);
+            std::filesystem::rename(dbPath, damagedPath(), err);
+            if (err)
+            {
+                logging::GALogger::w("Could not set the damaged database aside (%s), removing it.", err.message().c_str());
+                std::filesystem::remove(dbPath, err);
+            }
+            else
+            {
+                std::filesystem::rename(dbPath + "-wal", damagedPath() + "-wal", err);
+                stateSalvagePending = true;
+            }
+
+            std::filesystem::remove(dbPath + "-wal", err);
+            std::filesystem::remove(dbPath + "-shm", err);
+
+            addRecoveryReport(RecoveryReport::Kind::Damaged, reason);
+        }
+
+        void GASqliteStore::salvageDamagedState()
+        {
+            stateSalvagePending = false;
+
+            sqlite3* damaged = nullptr;
+            if (sqlite3_open_v2(damagedPath().c_str(), &damaged, SQLITE_OPEN_READWRITE, nullptr) == SQLITE_OK)
+            {
+                std::lock_guard<std::mutex> lock(queryMutex);
+                commitGroup();
+
+                GASqliteRecovery::salvageState(damaged, sqlDatabase, recoveryStats);
+                logging::GALogger::i("Database recovery: %" PRId64 " state rows salvaged, %" PRId64 " lost", recoveryStats.stateRows, recoveryStats.stateRowsLost);
+            }
+
+            sqlite3_close(damaged);
+        }
+
+        void GASqliteStore::startupMaintenance()
+        {
+            startupMaintenancePending = false;
+
+            // writes since opening were counted already, the rows have them too
+            categoryCounters.reset();
+            query("SELECT category, COUNT(*), SUM(LENGTH(event) + LENGTH(session_id)) FROM ga_events GROUP BY category;", {},
+                [this](Row const& row)
+                {
+                    categoryCounters.add(row.getInt64(0), row.getInt64(1), row.getInt64(2) + row.getInt64(1) * RowOverheadBytes);
+                });
+
+            // a database left over its quota by an earlier run, the freed pages go back to the file system
+            // on the following ticks
+            evictToQuota();
+        }
+
+        void GASqliteStore::startRecovery()
+        {
+            if (dbPath == ":memory:")
+            {
+                return;
+            }
+
+            std::error_code err;
+            const bool damaged = std::filesystem::exists(damagedPath(), err);
+
+            recoveryStage  = damaged ? RecoverySalvaging : RecoveryChecking;
+            recoveryThread = std::thread(
+                [this, damaged, path = dbPath, damagedFile = damagedPath(), salvageFile = salvagePath(), schema = std::string(CreateEventTables) + CreateSessionTable + CreateStateTable + CreateProgressionTable + utilities::printString("PRAGMA user_version = %d;", SchemaVersion)]()
+                {
+                    if (damaged)
+                    {
+                        // a damaged file left by an earlier run is salvaged by this one
+                        recoveryStats.problems = GASqliteRecovery::quickCheck(damagedFile, recoveryStats.firstProblem, recoveryCancel);
+                        const bool salvaged    = GASqliteRecovery::salvageEvents(damagedFile, salvageFile, schema, recoveryStats, recoveryCancel);
+                        recoveryStage = salvaged ? RecoverySalvaged : RecoveryFailed;
+                        return;
+                    }
+
+                    // damage the probes of open() did not reach
+                    std::string problem;
+                    if (GASqliteRecovery::quickCheck(path, problem, recoveryCancel) > 0)
+                    {
+                        damageReason  = problem;
+                        recoveryStage = RecoveryDamaged;
+                    }
+                    else
+                    {
+                        recoveryStage = RecoveryIdle;
+                    }
+                });
+        }
+
+        void GASqliteStore::stopRecovery()
+        {
+            recoveryCancel = true;
+            if (recoveryThread.joinable())
+            {
+                recoveryThread.join();
+            }
+            recoveryCancel = false;
+
+            // a damaged file is salvaged again by the next open
+            recoveryStage = RecoveryIdle;
+        }
+
+        void GASqliteStore::continueRecovery()
+        {
+            const int stage = recoveryStage.load();
+            if (stage == RecoveryIdle || stage == RecoveryChecking || stage == RecoverySalvaging)
+            {
+                return;
+            }
+
+            // the rows of a request in flight are acknowledged against this connection
+            if (!batches.empty())
+            {
+                return;
+            }
+
+            recoveryThread.join();
+            recoveryStage = RecoveryIdle;
+
+            switch (stage)
+            {
+                case RecoveryDamaged:
+                {
+                    const std::string path = dbPath;
+                    setAsideDamaged(damageReason);
+                    open(path);
+                    break;
+                }
+                case RecoverySalvaged:
+                    swapInSalvage();
+                    break;
+                default:
+                    addRecoveryReport(RecoveryReport::Kind::Failed, "nothing could be salvaged: " + (recoveryStats.firstProblem.empty() ? std::string("unreadable") : recoveryStats.firstProblem));
+                    removeRecoveryFiles();
+                    recoveryStats = SalvageStats();
+                    break;
+            }
+        }
+
+        void GASqliteStore::swapInSalvage()
+        {
+            const SalvageStats stats = recoveryStats;
+            recoveryStats = SalvageStats();
+
+            // the salvage becomes the database: what was written since the damaged file was set aside goes into it
+            const bool merged = query("ATTACH DATABASE ? AS salvage;", { salvagePath() }, nullptr) && runScript(MergeIntoSalvage);
+            query("DETACH DATABASE salvage;", {}, nullptr);
+
+            if (!merged)
+            {
+                addRecoveryReport(RecoveryReport::Kind::Failed, "the salvaged events could not be merged");
+                removeRecoveryFiles();
+                return;
+            }
+
+            const std::string path = dbPath;
+            close();
+
+            std::error_code err;
+            std::filesystem::remove(path + "-wal", err);
+            std::filesystem::remove(path + "-shm", err);
+            std::filesystem::rename(salvagePath(), path, err);
+            if (err)
+            {
+                logging::GALogger::w("Database recovery: could not replace %s (%s)", path.c_str(), err.message().c_str());
+            }
+
+            removeRecoveryFiles();
+            open(path);
+
+            if (err)
+            {
+                addRecoveryReport(RecoveryReport::Kind::Failed, "the salvaged database could not replace the new one");
+                return;
+            }
+
+            const std::string reason = utilities::printString("events salvaged: %" PRId64 ", lost: %" PRId64 "; state rows salvaged: %" PRId64 ", lost: %" PRId64 "; quick_check problems: %" PRId64,
+                stats.events, stats.eventsLost, stats.stateRows, stats.stateRowsLost, stats.problems);
+            logging::GALogger::i("Database recovered, %s", reason.c_str());
+            addRecoveryReport(RecoveryReport::Kind::Salvaged, reason);
+        }
+
+        void GASqliteStore::removeRecoveryFiles()
+        {
+            std::error_code err;
+            for (std::string const& file : { damagedPath(), damagedPath() + "-wal", damagedPath() + "-shm", salvagePath(), salvagePath() + "-journal" })
+            {
+                std::filesystem::remove(file, err);
+            }
+        }
+
+        void GASqliteStore::addRecoveryReport(RecoveryReport::Kind kind, std::string const& reason)
+        {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            recoveryReports.push_back({ kind, reason });
+        }
+
+        std::vector<GASqliteStore::RecoveryReport> GASqliteStore::takeRecoveryReports()
+        {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            std::vector<RecoveryReport> reports;
+            reports.swap(recoveryReports);
+            return reports;
+        }
+
+        bool GASqliteStore::isRecovering() const
+        {
+            return recoveryStage.load() != RecoveryIdle;
+        }
+
+        bool GASqliteStore::ensureTable(const char* name, const char* create, const char* probe)
+        {
+            if (!query(create, {}, nullptr))
+            {
+                return false;
+            }
+
+            if (!query(probe, {}, nullptr))
+            {
+                logging::GALogger::d("%s corrupt, recreating.", name);
+                query(std::string("DROP TABLE ") + name, {}, nullptr);
+                if (!query(create, {}, nullptr))
+                {
+                    logging::GALogger::w("%s corrupt, could not recreate it.", name);
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool GASqliteStore::runScript(const char* sql)
+        {
+            std::lock_guard<std::mutex> lock(queryMutex);
+
+            // a script may change the schema, it runs on its own
+            commitGroup();
+
+            char* error = nullptr;
+            if (sqlite3_exec(sqlDatabase, sql, 0, 0, &error) != SQLITE_OK)
+            {
+                logging::GALogger::w("SQLITE3 SCRIPT ERROR: %s", error ? error : sqlite3_errmsg(sqlDatabase));
+                sqlite3_free(error);
+
+                if (sqlite3_get_autocommit(sqlDatabase) == 0)
+                {
+                    sqlite3_exec(sqlDatabase, "ROLLBACK", 0, 0, 0);
+                }
+
+                return false;
+            }
+
+            return true;
+        }
+
+        bool GASqliteStore::ensureEventTable(int64_t version)
+        {
+            bool exists = false;
+            query("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'ga_events';", {}, [&exists](Row const&) { exists = true; });
+
+            if (exists && version < 2)
+            {
+                // the original table: text status/category/client_ts and no indexes, copied over in one
+                // transaction (claimed rows are queued again, their request did not survive the restart)
+                std::string categoryCase = "CASE category";
+                for (std::size_t i = 1; i < EventCategoryCount; ++i)
+                {
+                    categoryCase += utilities::printString(" WHEN '%s' THEN %d", std::string(EventCategories[i].name).c_str(), static_cast<int>(i));
+                }
+                categoryCase += " ELSE 0 END";
+
+                const std::string migrate =
+                    "BEGIN;"
+                    "ALTER TABLE ga_events RENAME TO ga_events_v1;" +
+                    std::string(CreateEventTables) +
+                    "INSERT INTO ga_events(batch, category, session_id, client_ts, event) SELECT 0, " + categoryCase +
+                        ", session_id, CAST(client_ts AS INTEGER), event FROM ga_events_v1 ORDER BY CAST(client_ts AS INTEGER), rowid;"
+                    "DROP TABLE ga_events_v1;" +
+                    utilities::printString("PRAGMA user_version = %d;", SchemaVersion) +
+                    "COMMIT;";
+
+                logging::GALogger::i("Migrating ga_events to schema version %d", SchemaVersion);
+                if (!runScript(migrate.c_str()))
+                {
+                    // start over rather than keep a table the queries below cannot use
+                    logging::GALogger::w("ga_events could not be migrated, recreating.");
+                    query("DROP TABLE ga_events", {}, nullptr);
+                }
+            }
+            else if (exists && version < SchemaVersion)
+            {
+                // version 2 rows hold whole events, they keep doing so
+                logging::GALogger::i("Migrating ga_events to schema version %d", SchemaVersion);
+                const std::string migrate =
+                    "BEGIN;"
+                    "ALTER TABLE ga_events ADD COLUMN annotations INTEGER NOT NULL DEFAULT 0;" +
+                    utilities::printString("PRAGMA user_version = %d;", SchemaVersion) +
+                    "COMMIT;";
+
+                if (!runScript(migrate.c_str()))
+                {
+                    logging::GALogger::w("ga_events could not be migrated, recreating.");
+                    query("DROP TABLE ga_events", {}, nullptr);
+                }
+            }
+
+            if (!runScript((std::string(CreateEventTables) + utilities::printString("PRAGMA user_version = %d;", SchemaVersion)).c_str()))
+            {
+                logging::GALogger::d("ensureDatabase failed: %s", CreateEventTables);
+                return false;
+            }
+
+            if (!query("SELECT batch, category, client_ts, annotations FROM ga_events LIMIT 0,1", {}, nullptr))
+            {
+                logging::GALogger::d("ga_events corrupt, recreating.");
+                query("DROP TABLE ga_events", {}, nullptr);
+                if (!runScript(CreateEventTables))
+                {
+                    logging::GALogger::w("ga_events corrupt, could not recreate it.");
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        std::string GASqliteStore::getState(std::string const& key)
+        {
+            std::string value;
+            query("SELECT value FROM ga_state WHERE key = ?;", { key },
+                [&value](Row const& row)
+                {
+                    value = row.getString(0);
+                });
+
+            return value;
+        }
+
+        void GASqliteStore::setState(std::string const& key, std::string const& value)
+        {
+            if (value.empty())
+            {
+                query("DELETE FROM ga_state WHERE key = ?;", { key }, nullptr);
+            }
+            else
+            {
+                query("INSERT OR REPLACE INTO ga_state (key, value) VALUES(?, ?);", { key, value }, true, nullptr);
+            }
+        }
+
+        StringVector GASqliteStore::getStateKeys(std::string const& prefix)
+        {
+            // a range of the primary key instead of LIKE (which would need escaping and scans the table):
+            // keys compare bytewise, those starting with 'prefix' sort from it up to the prefix with its
+            // last byte incremented (trailing 0xFF bytes dropped first)
+            std::string end = prefix;
+            while (!end.empty() && static_cast<unsigned char>(end.back()) == 0xFF)
+            {
+                end.pop_back();
+            }
+
+            StringVector keys;
+            auto collect = [&keys](Row const& row)
+            {
+                keys.push_back(row.getString(0));
+            };
+
+            if (end.empty())
+            {
+                // no bound above (an empty prefix, or only 0xFF bytes)
+                query("SELECT key FROM ga_state WHERE key >= ? ORDER BY key;", { prefix }, collect);
+            }
+            else
+            {
+                end.back() = static_cast<char>(static_cast<unsigned char>(end.back()) + 1);
+                query("SELECT key FROM ga_state WHERE key >= ? AND key < ? ORDER BY key;", { prefix, end }, collect);
+            }
+
+            return keys;
+        }
+
+        void GASqliteStore::setProgressionTries(std::string const& progression, int tries)
+        {
+            if (tries <= 0)
+            {
+                query("DELETE FROM ga_progression WHERE progression = ?;", { progression }, nullptr);
+            }
+            else
+            {
+                query("INSERT OR REPLACE INTO ga_progression (progression, tries) VALUES(?, ?);", { progression, std::to_string(tries) }, nullptr);
+            }
+        }
+
+        std::vector<std::pair<std::string, int>> GASqliteStore::getProgressionTries()
+        {
+            std::vector<std::pair<std::string, int>> tries;
+            query("SELECT progression, tries FROM ga_progression;", {},
+                [&tries](Row const& row)
+                {
+                    if (!row.isNull(0) && !row.isNull(1))
+                    {
+                        tries.emplace_back(row.getString(0), static_cast<int>(row.getInt64(1)));
+                    }
+                });
+
+            return tries;
+        }
+
+        void GASqliteStore::checkpointSession(SessionCheckpoint const& session)
+        {
+            query("INSERT OR REPLACE INTO ga_session(session_id, timestamp, event) VALUES(?, ?, ?);",
+                { session.sessionId, std::to_string(session.startTs), session.event }, nullptr);
+        }
+
+        void GASqliteStore::removeSession(std::string const& sessionId)
+        {
+            query("DELETE FROM ga_session WHERE session_id = ?;", { sessionId }, nullptr);
+        }
+
+        std::vector<SessionCheckpoint> GASqliteStore::getSessions()
+        {
+            std::vector<SessionCheckpoint> sessions;
+            query("SELECT session_id, timestamp, event FROM ga_session;", {},
+                [&sessions](Row const& row)
+                {
+                    if (!row.isNull(2))
+                    {
+                        sessions.push_back({ row.getString(0), row.getInt64(1), row.getString(2) });
+                    }
+                });
+
+            return sessions;
+        }
+
+        int64_t GASqliteStore::getDbSizeBytes() const
+        {
+            return dbSizeBytes.load(std::memory_order_relaxed);
+        }
+
+        void GASqliteStore::reconcileDbSize()
+        {
+            writesSinceReconcile = 0;
+
+            // free pages are reused before the file grows, they do not count against the limit;
+            // page_count covers pages that still live in the write-ahead log only
+            int64_t pagesBytes = 0;
+            query("SELECT page_count - freelist_count, page_size FROM pragma_page_count(), pragma_freelist_count(), pragma_page_size();", {},
+                [&pagesBytes](Row const& row)
+                {
+                    pagesBytes = row.getInt64(0) * row.getInt64(1);
+                });
+
+            // the log is on disk next to the file until a checkpoint truncates it (counting the pages
+            // it holds twice, the database is never smaller than this)
+            dbSizeBytes.store(pagesBytes + walFileBytes(), std::memory_order_relaxed);
+        }
+
+        void GASqliteStore::refreshOldestClientTs()
+        {
+            // the first row by id, one step down the primary key
+            int64_t oldest = 0;
+            query("SELECT client_ts FROM ga_events ORDER BY id LIMIT 1;", {}, [&oldest](Row const& row) { oldest = row.getInt64(0); });
+            oldestClientTs.store(oldest, std::memory_order_relaxed);
+        }
+
+        void GASqliteStore::trackEventBytes(int64_t bytes)
+        {
+            dbSizeBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+            if (++writesSinceReconcile >= ReconcileSizeEvery)
+            {
+                reconcileDbSize();
+            }
+        }
+
+        bool GASqliteStore::isFull()
+        {
+            // a database left over its quota is evicted before it refuses an event
+            if (startupMaintenancePending && dbSizeBytes.load(std::memory_order_relaxed) > settings.maxSizeBytes)
+            {
+                startupMaintenance();
+            }
+
+            return dbSizeBytes.load(std::memory_order_relaxed) > settings.maxSizeBytes;
+        }
+
+        EventStoreStats GASqliteStore::getStats()
+        {
+            EventStoreStats stats;
+            stats.queuedEvents  = queuedEvents.load(std::memory_order_relaxed);
+            stats.claimedEvents = claimedEvents.load(std::memory_order_relaxed);
+            stats.sizeBytes     = dbSizeBytes.load(std::memory_order_relaxed);
+            stats.evictedEvents = evictedEvents.load(std::memory_order_relaxed);
+            stats.oldestClientTs = oldestClientTs.load(std::memory_order_relaxed);
+            categoryCounters.copyTo(stats);
+            return stats;
+        }
+
+        void GASqliteStore::appendText(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event)
+        {
+            insertEvent(category, sessionId, clientTs, event, 0);
+        }
+
+        void GASqliteStore::append(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event)
+        {
+            int64_t annotations = 0;
+            const std::string text = splitAnnotations(event, annotations);
+
+            insertEvent(category, sessionId, clientTs, text, annotations);
+        }
+
+        std::string GASqliteStore::splitAnnotations(json const& event, int64_t& annotations)
+        {
+            json shared = json::object();
+            json fields = json::object();
+            for (auto it = event.begin(); it != event.end(); ++it)
+            {
+                (isSessionAnnotation(it.key()) ? shared : fields)[it.key()] = it.value();
+            }
+
+            annotations = shared.empty() ? 0 : annotationsId(shared.dump());
+            return annotations == 0 ? event.dump() : fields.dump();
+        }
+
+        void GASqliteStore::insertEvent(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event, int64_t annotations)
+        {
+            const int64_t categoryId = eventCategoryId(category);
+            StringVector parameters = { std::to_string(categoryId), sessionId, std::to_string(clientTs), GAEventCodec::encode(event), std::to_string(annotations) };
+            if (query("INSERT INTO ga_events (category, session_id, client_ts, event, annotations) VALUES(?, ?, ?, CAST(? AS BLOB), ?);", parameters, nullptr))
+            {
+                const int64_t bytes = static_cast<int64_t>(sessionId.size() + parameters[3].size()) + RowOverheadBytes;
+                trackEventBytes(bytes);
+                queuedEvents.fetch_add(1, std::memory_order_relaxed);
+                categoryCounters.add(categoryId, 1, bytes);
+
+                int64_t none = 0;
+                oldestClientTs.compare_exchange_strong(none, clientTs, std::memory_order_relaxed);
+            }
+
+            evictAfterWrites(1);
+        }
+
+        bool GASqliteStore::appendBatch(std::vector<EventRecord> const& records)
+        {
+            if (records.empty())
+            {
+                return true;
+            }
+
+            // annotations rows are looked up (or inserted) before the batch takes the connection
+            std::vector<EventRow> rows(records.size());
+            StringVector texts(records.size());
+            for (std::size_t i = 0; i < records.size(); ++i)
+            {
+                EventRow& row = rows[i];
+                row.category  = eventCategoryId(records[i].category);
+                row.sessionId = &records[i].sessionId;
+                row.clientTs  = records[i].clientTs;
+                texts[i]      = splitAnnotations(records[i].event, row.annotations);
+            }
+
+            StringVector encoded = GAEventCodec::encode(texts);
+            for (std::size_t i = 0; i < rows.size(); ++i)
+            {
+                rows[i].event = std::move(encoded[i]);
+            }
+
+            const bool stored = insertRows(rows);
+            if (stored)
+            {
+                trackInsertedRows(rows);
+            }
+
+            evictAfterWrites(static_cast<int>(rows.size()));
+
+            return stored;
+        }
+
+        bool GASqliteStore::insertRows(std::vector<EventRow> const& rows)
+        {
+            std::lock_guard<std::mutex> lock(queryMutex);
+
+            if (!sqlDatabase)
+            {
+                return false;
+            }
+
+            // the batch is its own durability point, writes grouped before it are committed first
+            commitGroup();
+
+            if (sqlite3_exec(sqlDatabase, "BEGIN;", 0, 0, 0) != SQLITE_OK)
+            {
+                logging::GALogger::e("SQLITE3 BEGIN ERROR: %s", sqlite3_errmsg(sqlDatabase));
+                return false;
+            }
+
+            std::size_t next = 0;
+            int rowsPerStatement = InsertRowsPerStatement;
+            while (next < rows.size())
+            {
+                while (static_cast<std::size_t>(rowsPerStatement) > rows.size() - next)
+                {
+                    rowsPerStatement /= 2;
+                }
+
+                std::string sql = "INSERT INTO ga_events (category, session_id, client_ts, event, annotations) VALUES (?, ?, ?, ?, ?)";
+                for (int i = 1; i < rowsPerStatement; ++i)
+                {
+                    sql += ", (?, ?, ?, ?, ?)";
+                }
+                sql += ";";
+
+                CachedStatement* cached = prepareCached(sql);
+                if (!cached)
+                {
+                    logging::GALogger::e("SQLITE3 PREPARE ERROR: %s", sqlite3_errmsg(sqlDatabase));
+                    sqlite3_exec(sqlDatabase, "ROLLBACK", 0, 0, 0);
+                    return false;
+                }
+
+                int parameter = 1;
+                for (int i = 0; i < rowsPerStatement; ++i)
+                {
+                    EventRow const& row = rows[next + i];
+                    sqlite3_bind_int64(cached->statement, parameter++, row.category);
+                    sqlite3_bind_text(cached->statement, parameter++, row.sessionId->data(), static_cast<int>(row.sessionId->size()), SQLITE_STATIC);
+                    sqlite3_bind_int64(cached->statement, parameter++, row.clientTs);
+                    sqlite3_bind_blob(cached->statement, parameter++, row.event.data(), static_cast<int>(row.event.size()), SQLITE_STATIC);
+                    sqlite3_bind_int64(cached->statement, parameter++, row.annotations);
+                }
+
+                sqlite3_step(cached->statement);
+                const int result = releaseStatement(*cached);
+                if (result != SQLITE_OK)
+                {
+                    logging::GALogger::e("SQLITE3 STEP ERROR: %s", sqlite3_errstr(result));
+                    if (sqlite3_get_autocommit(sqlDatabase) == 0)
+                    {
+                        sqlite3_exec(sqlDatabase, "ROLLBACK", 0, 0, 0);
+                    }
+                    return false;
+                }
+
+                next += rowsPerStatement;
+            }
+
+            if (sqlite3_exec(sqlDatabase, "COMMIT", 0, 0, 0) != SQLITE_OK)
+            {
+                logging::GALogger::e("SQLITE3 COMMIT ERROR: %s", sqlite3_errmsg(sqlDatabase));
+                if (sqlite3_get_autocommit(sqlDatabase) == 0)
+                {
+                    sqlite3_exec(sqlDatabase, "ROLLBACK", 0, 0, 0);
+                }
+                return false;
+            }
+
+            return true;
+        }
+
+        void GASqliteStore::trackInsertedRows(std::vector<EventRow> const& rows)
+        {
+            int64_t bytes = 0;
+            for (EventRow const& row : rows)
+            {
+                const int64_t rowBytes = static_cast<int64_t>(row.sessionId->size() + row.event.size()) + RowOverheadBytes;
+                categoryCounters.add(row.category, 1, rowBytes);
+                bytes += rowBytes;
+            }
+
+            int64_t none = 0;
+            oldestClientTs.compare_exchange_strong(none, rows.front().clientTs, std::memory_order_relaxed);
+
+            dbSizeBytes.fetch_add(bytes, std::memory_order_relaxed);
+            queuedEvents.fetch_add(static_cast<int64_t>(rows.size()), std::memory_order_relaxed);
+
+            writesSinceReconcile += static_cast<int>(rows.size());
+            if (writesSinceReconcile >= ReconcileSizeEvery)
+            {
+                reconcileDbSize();
+            }
+        }
+
+        int64_t GASqliteStore::annotationsId(std::string const& annotations)
+        {
+            auto cached = annotationIds.find(annotations);
+            if (cached != annotationIds.end())
+            {
+                return cached->second;
+            }
+
+            int64_t id = 0;
+            const auto readId = [&id](Row const& row) { id = row.getInt64(0); };
+
+            query("SELECT id FROM ga_annotations WHERE annotations = ?;", { annotations }, readId);
+            if (id == 0)
+            {
+                if (!query("INSERT INTO ga_annotations (annotations) VALUES(?);", { annotations }, nullptr))
+                {
+                    return 0;
+                }
+
+                trackEventBytes(static_cast<int64_t>(annotations.size()) + RowOverheadBytes);
+                query("SELECT id FROM ga_annotations WHERE annotations = ?;", { annotations }, readId);
+            }
+
+            if (annotationIds.size() >= MaxCachedAnnotations)
+            {
+                annotationIds.clear();
+            }
+            annotationIds.emplace(annotations, id);
+
+            return id;
+        }
+
+        void GASqliteStore::pruneAnnotations()
+        {
+            int64_t remaining = 0;
+            query("SELECT COUNT(*) FROM ga_annotations;", {}, [&remaining](Row const& row) { remaining = row.getInt64(0); });
+
+            // a single row belongs to the running session
+            if (remaining <= 1)
+            {
+                return;
+            }
+
+            if (query("DELETE FROM ga_annotations WHERE NOT EXISTS (SELECT 1 FROM ga_events WHERE ga_events.annotations = ga_annotations.id);", {}, nullptr))
+            {
+                annotationIds.clear();
+            }
+        }
+
+        bool GASqliteStore::claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out)
+        {
+            const int64_t batch = nextBatchId++;
+            StringVector parameters = { std::to_string(batch) };
+
+            // the oldest 'limit' queued rows, straight from the index
+            std::string claimSql = "UPDATE ga_events SET batch = ? WHERE id IN (SELECT id FROM ga_events WHERE batch = 0";
+            if (!category.empty())
+            {
+                claimSql += " AND category = ?";
+                parameters.push_back(std::to_string(eventCategoryId(category)));
+            }
+            claimSql += utilities::printString(" ORDER BY id LIMIT %d);", limit);
+
+            if (!query(claimSql, parameters, nullptr))
+            {
+                return false;
+            }
+
+            const std::size_t before = out.size();
+            Batch claimedBatch;
+            const bool claimed = query(
+                "SELECT e.event, LENGTH(e.event) + LENGTH(e.session_id), a.annotations, e.category FROM ga_events e LEFT JOIN ga_annotations a ON a.id = e.annotations WHERE e.batch = ? ORDER BY e.id;", { parameters[0] },
+                [&out, &claimedBatch](Row const& row)
+                {
+                    const int64_t     rowBytes = row.getInt64(1) + RowOverheadBytes;
+                    const std::size_t category = eventCategoryIndex(row.getInt64(3));
+                    claimedBatch.bytes += rowBytes;
+                    ++claimedBatch.events;
+                    ++claimedBatch.categoryEvents[category];
+                    claimedBatch.categoryBytes[category] += rowBytes;
+
+                    // a damaged row is dropped together with its batch
+                    std::string ev;
+                    if (GAEventCodec::decode(row.getBlob(0), ev) && !ev.empty())
+                    {
+                        addAnnotations(row.getText(2), ev);
+                        out.push_back(std::move(ev));
+                    }
+                });
+
+            if (!claimed || claimedBatch.events == 0)
+            {
+                // the rows were marked but not read (or nothing matched): back to the queue, or
+                // they stay claimed by a batch nobody knows of until the next start
+                out.resize(before);
+                query("UPDATE ga_events SET batch = 0 WHERE batch = ?;", { parameters[0] }, nullptr);
+                return false;
+            }
+
+            queuedEvents.fetch_sub(claimedBatch.events, std::memory_order_relaxed);
+            claimedEvents.fetch_add(claimedBatch.events, std::memory_order_relaxed);
+            claimedBatch.id = batch;
+            batches[requestId] = claimedBatch;
+
+            if (out.size() == before)
+            {
+                // nothing readable in it, the batch is dropped
+                ackBatch(requestId);
+                return false;
+            }
+
+            return true;
+        }
+
+        void GASqliteStore::ackBatch(std::string const& requestId)
+        {
+            auto it = batches.find(requestId);
+            if (it == batches.end())
+            {
+                return;
+            }
+
+            if (query("DELETE FROM ga_events WHERE batch = ?;", { std::to_string(it->second.id) }, nullptr))
+            {
+                trackEventBytes(-it->second.bytes);
+                claimedEvents.fetch_sub(it->second.events, std::memory_order_relaxed);
+                evictRetryIn = 0;
+                for (std::size_t i = 0; i < EventCategoryCount; ++i)
+                {
+                    categoryCounters.add(static_cast<int64_t>(i), -it->second.categoryEvents[i], -it->second.categoryBytes[i]);
+                }
+                refreshOldestClientTs();
+            }
+            batches.erase(it);
+        }
+
+        void GASqliteStore::putBackBatch(std::string const& requestId)
+        {
+            auto it = batches.find(requestId);
+            if (it == batches.end())
+            {
+                return;
+            }
+
+            if (query("UPDATE ga_events SET batch = 0 WHERE batch = ?;", { std::to_string(it->second.id) }, nullptr))
+            {
+                claimedEvents.fetch_sub(it->second.events, std::memory_order_relaxed);
+                queuedEvents.fetch_add(it->second.events, std::memory_order_relaxed);
+            }
+            batches.erase(it);
+        }
+
+        void GASqliteStore::putBackAll()
+        {
+            // only touches claimed rows (an index range), not the whole queue
+            if (query("UPDATE ga_events SET batch = 0 WHERE batch > 0;", {}, nullptr))
+            {
+                queuedEvents.fetch_add(claimedEvents.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            batches.clear();
+        }
+
+        int64_t GASqliteStore::evictToQuota()
+        {
+            // decide on the exact size, not on the estimate
+            reconcileDbSize();
+
+            int64_t excess = dbSizeBytes.load(std::memory_order_relaxed) - evictToBytes(settings.maxSizeBytes);
+            if (excess <= 0)
+            {
+                return 0;
+            }
+
+            int64_t evicted = 0;
+
+            for (int retention = 0; retention <= MaxEventRetention && excess > 0; ++retention)
+            {
+                std::string categories;
+                for (std::size_t i = 0; i < EventCategoryCount; ++i)
+                {
+                    if (EventCategories[i].retention == retention)
+                    {
+                        categories += (categories.empty() ? "" : ", ") + std::to_string(i);
+                    }
+                }
+
+                const std::string inLevel = "batch = 0 AND category IN (" + categories + ")";
+                const std::string selectSql = "SELECT id, LENGTH(event) + LENGTH(session_id), category FROM ga_events WHERE " + inLevel + utilities::printString(" ORDER BY id LIMIT %d;", EvictRowsPerStep);
+                const std::string deleteSql = "DELETE FROM ga_events WHERE " + inLevel + " AND id <= ?;";
+
+                while (excess > 0)
+                {
+                    // the oldest rows of this level until enough bytes are covered, they are exactly
+                    // the rows of the level up to the last id (claimed rows are never evicted)
+                    int64_t lastId = 0;
+                    int64_t freed  = 0;
+                    int64_t rows   = 0;
+                    std::array<int64_t, EventCategoryCount> freedEvents{};
+                    std::array<int64_t, EventCategoryCount> freedBytes{};
+                    query(selectSql, {},
+                        [&](Row const& row)
+                        {
+                            if (freed < excess)
+                            {
+                                const int64_t     rowBytes = row.getInt64(1) + RowOverheadBytes;
+                                const std::size_t i        = eventCategoryIndex(row.getInt64(2));
+
+                                lastId = row.getInt64(0);
+                                freed += rowBytes;
+                                ++rows;
+                                ++freedEvents[i];
+                                freedBytes[i] += rowBytes;
+                            }
+                        });
+
+                    if (rows == 0 || !query(deleteSql, { std::to_string(lastId) }, nullptr))
+                    {
+                        break;
+                    }
+
+                    for (std::size_t i = 0; i < EventCategoryCount; ++i)
+                    {
+                        categoryCounters.add(static_cast<int64_t>(i), -freedEvents[i], -freedBytes[i]);
+                    }
+
+                    dbSizeBytes.fetch_sub(freed, std::memory_order_relaxed);
+                    queuedEvents.fetch_sub(rows, std::memory_order_relaxed);
+                    excess  -= freed;
+                    evicted += rows;
+                }
+            }
+
+            if (evicted > 0)
+            {
+                evictedEvents.fetch_add(evicted, std::memory_order_relaxed);
+                logging::GALogger::w("Database over its quota, evicted the %" PRId64 " oldest events.", evicted);
+
+                // the deletes went to the log, which would keep the database over its quota until
+                // the next checkpoint
+                truncateWal();
+                refreshOldestClientTs();
+            }
+
+            return evicted;
+        }
+
+        void GASqliteStore::evictAfterWrites(int writes)
+        {
+            if (dbSizeBytes.load(std::memory_order_relaxed) <= evictAboveBytes(settings.maxSizeBytes))
+            {
+                return;
+            }
+
+            // an eviction reconciles the size (three pragmas and a stat) and may checkpoint, not
+            // something to repeat on every insert while it cannot get below the threshold
+            if (evictRetryIn > 0)
+            {
+                evictRetryIn -= writes;
+                return;
+            }
+
+            evictToQuota();
+            if (dbSizeBytes.load(std::memory_order_relaxed) > evictAboveBytes(settings.maxSizeBytes))
+            {
+                evictRetryIn = EvictRetryWrites;
+            }
+        }
+
+        void GASqliteStore::vacuumStep()
+        {
+            int64_t freePages  = 0;
+            int64_t autoVacuum = 0;
+            query("SELECT freelist_count, auto_vacuum FROM pragma_freelist_count(), pragma_auto_vacuum();", {},
+                [&](Row const& row)
+                {
+                    freePages  = row.getInt64(0);
+                    autoVacuum = row.getInt64(1);
+                });
+
+            // auto_vacuum can only be switched on by rebuilding the file, a full VACUUM that would hold
+            // the GA thread of every instance. Databases created before it was set keep their free pages
+            // (reused before the file grows, not counted against the quota) until a salvage rebuilds them
+            constexpr int IncrementalAutoVacuum = 2;
+            if (freePages == 0 || autoVacuum != IncrementalAutoVacuum)
+            {
+                return;
+            }
+
+            runScript(utilities::printString("PRAGMA incremental_vacuum(%d);", VacuumStepPages).c_str());
+            reconcileDbSize();
+        }
+
+        void GASqliteStore::trim()
+        {
+            if (!tableReady)
+            {
+                return;
+            }
+
+            // may swap the database, which fails to open again in the worst case
+            continueRecovery();
+            if (!tableReady)
+            {
+                return;
+            }
+
+            if (startupMaintenancePending)
+            {
+                startupMaintenance();
+            }
+            else if (dbSizeBytes.load(std::memory_order_relaxed) > evictAboveBytes(settings.maxSizeBytes))
+            {
+                evictToQuota();
+            }
+            pruneAnnotations();
+            vacuumStep();
+
+            // the log stays at its limit between checkpoints; only one that grew past it (a large
+            // transaction) is worth a checkpoint and fsync here, an eviction truncates it right away
+            if (walFileBytes() > walLimitBytes(settings.maxSizeBytes))
+            {
+                truncateWal();
+            }
+        }
+
+        int64_t GASqliteStore::walFileBytes() const
+        {
+            if (dbPath == ":memory:")
+            {
+                return 0;
+            }
+
+            std::error_code err;
+            const auto size = std::filesystem::file_size(dbPath + "-wal", err);
+            return err ? 0 : static_cast<int64_t>(size);
+        }
+
+        void GASqliteStore::truncateWal()
+        {
+            // copies the log into the file and empties it, runScript commits the open group first;
+            // a checkpoint blocked by a reader is tried again on the next tick
+            if (dbPath != ":memory:")
+            {
+                runScript("PRAGMA wal_checkpoint(TRUNCATE);");
+            }
+
+            reconcileDbSize();
+        }
+    }
+}
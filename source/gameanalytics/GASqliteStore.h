@@ -0,0 +1,344 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <sqlite3.h>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+#include <thread>
+#include "GACommon.h"
+#include "GAEventStore.h"
+#include "GASqliteRecovery.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // true for statements that modify the database, these always run inside a transaction
+        constexpr bool isWriteStatement(std::string_view sql)
+        {
+            constexpr std::string_view keywords[] = { "UPDATE", "INSERT", "DELETE" };
+
+            for (std::string_view keyword : keywords)
+            {
+                if (sql.size() < keyword.size())
+                {
+                    continue;
+                }
+
+                bool match = true;
+                for (std::size_t i = 0; i < keyword.size() && match; ++i)
+                {
+                    const char c = sql[i];
+                    match = (c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c) == keyword[i];
+                }
+
+                if (match)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // the default backend: one SQLite database file (ga_events, ga_annotations, ga_state,
+        // ga_session and ga_progression), queued events are stored compressed (see GAEventCodec)
+        class GASqliteStore : public IEventStore
+        {
+         public:
+
+            // one result row as seen by query callbacks, the text views are only valid inside the callback
+            class Row
+            {
+             public:
+
+                explicit Row(sqlite3_stmt* statement);
+
+                int         columnCount() const;
+                const char* columnName(int column) const;
+                int         columnType(int column) const;
+                bool        isNull(int column) const;
+
+                int64_t          getInt64(int column, int64_t defValue = 0) const;
+                double           getDouble(int column, double defValue = 0.0) const;
+                std::string_view getText(int column) const;
+                std::string      getString(int column) const;
+                std::string_view getBlob(int column) const;
+
+             private:
+
+                sqlite3_stmt* _statement;
+            };
+
+            using RowCallback = std::function<void(Row const&)>;
+
+            GASqliteStore();
+            GASqliteStore(const GASqliteStore&) = delete;
+            GASqliteStore& operator=(const GASqliteStore&) = delete;
+            ~GASqliteStore() override;
+
+            // opens the database at 'path' (":memory:" for a private one) and ensures its tables
+            bool open(std::string const& path, bool dropDatabase = false);
+            void close();
+            bool isOpen() const;
+
+            sqlite3* getDatabase();
+
+            // tuning, must happen before open
+            void setSettings(GAStoreSettings const& settings);
+            GAStoreSettings const& getSettings() const;
+
+            // runs 'sql' and hands every result row to 'onRow', columns are read straight from sqlite;
+            // 'onRow' must not query the store itself (collect what you need and act after the call)
+            // returns false if the statement failed (rows seen before the failure were still delivered)
+            bool query(std::string const& sql, StringVector const& parameters, RowCallback const& onRow);
+            bool query(std::string const& sql, StringVector const& parameters, bool useTransaction, RowCallback const& onRow);
+
+            // every row as a json object (column name to value), null if the statement failed
+            void queryJson(std::string const& sql, StringVector const& parameters, bool useTransaction, json& out);
+
+            // queues 'event' as it is, without sharing its session annotations
+            void appendText(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event);
+
+            // bytes used by the database (pages in use, the write-ahead log included), tracked in memory
+            int64_t getDbSizeBytes() const;
+
+            // a step of the recovery of a damaged database, the SDK sends them as SDK error events
+            struct RecoveryReport
+            {
+                enum class Kind
+                {
+                    Damaged,    // set aside, a new database took its place
+                    Salvaged,   // its readable events are queued again
+                    Failed      // nothing could be salvaged
+                };
+
+                Kind        kind = Kind::Damaged;
+                std::string reason;
+            };
+
+            // the reports since the last call, oldest first
+            std::vector<RecoveryReport> takeRecoveryReports();
+
+            // true while a damaged database waits to be salvaged or swapped in
+            bool isRecovering() const;
+
+            // IEventStore
+            void append(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event) override;
+            // one transaction of multi-row INSERTs
+            bool appendBatch(std::vector<EventRecord> const& records) override;
+            bool claimBatch(std::string const& requestId, std::string const& category, int limit, StringVector& out) override;
+            void ackBatch(std::string const& requestId) override;
+            void putBackBatch(std::string const& requestId) override;
+            void putBackAll() override;
+            void trim() override;
+            bool isFull() override;
+
+            std::string  getState(std::string const& key) override;
+            void         setState(std::string const& key, std::string const& value) override;
+            StringVector getStateKeys(std::string const& prefix) override;
+
+            void setProgressionTries(std::string const& progression, int tries) override;
+            std::vector<std::pair<std::string, int>> getProgressionTries() override;
+
+            void checkpointSession(SessionCheckpoint const& session) override;
+            void removeSession(std::string const& sessionId) override;
+            std::vector<SessionCheckpoint> getSessions() override;
+
+            EventStoreStats getStats() override;
+
+            // group commit: between begin and end every write joins one transaction
+            // (committed early after MaxGroupedWrites writes or before schema changes)
+            void beginWrites() override;
+            void endWrites() override;
+
+            // stored in PRAGMA user_version, databases without one hold the original ga_events table
+            static constexpr int SchemaVersion = 3;
+
+            // smallest accepted GAStoreSettings::maxSizeBytes
+            static constexpr int64_t MinDbSizeBytes = 65536;
+
+         private:
+
+            // deletes queued events until the database is back below its eviction target,
+            // returns the number of evicted events
+            int64_t evictToQuota();
+            // evictToQuota after 'writes' rows were added, if the tracked size is past the threshold and
+            // the last eviction did not leave the database stuck above it
+            void    evictAfterWrites(int writes);
+            void    vacuumStep();
+            void    truncateWal();
+            int64_t walFileBytes() const;
+
+            // creates ga_events or migrates an older layout in place
+            // creates or migrates the tables of a database at 'version' (PRAGMA user_version)
+            bool ensureEventTable(int64_t version);
+            // the per category counters and the quota of a database opened, on the first maintenance tick
+            void startupMaintenance();
+            bool ensureTable(const char* name, const char* create, const char* probe);
+            bool runScript(const char* sql);
+
+            // the ga_annotations row holding 'annotations' (a JSON object), added if there is none yet
+            int64_t annotationsId(std::string const& annotations);
+            // the text stored for 'event': its own fields if its session annotations went to ga_annotations
+            // ('annotations' is set to their row), the whole event otherwise
+            std::string splitAnnotations(json const& event, int64_t& annotations);
+            void    insertEvent(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event, int64_t annotations);
+            struct EventRow
+            {
+                int                category    = 0;
+                std::string const* sessionId   = nullptr;
+                int64_t            clientTs    = 0;
+                std::string        event;      // encoded
+                int64_t            annotations = 0;
+            };
+
+            // inserts 'rows' in one transaction, largest statements first (InsertRowsPerStatement rows,
+            // then halves of it for the rest); commits an open group transaction before
+            bool insertRows(std::vector<EventRow> const& rows);
+            void trackInsertedRows(std::vector<EventRow> const& rows);
+
+            // drops ga_annotations rows no queued event refers to anymore
+            void    pruneAnnotations();
+
+            struct CachedStatement
+            {
+                sqlite3_stmt* statement = nullptr;
+                bool          isWrite   = false;
+            };
+
+            // returns the prepared statement for 'sql', reset and with no bindings,
+            // or nullptr if it does not compile
+            CachedStatement* prepareCached(std::string const& sql);
+
+            // resets 'entry' after a run and returns the error of its last step, if any
+            int  releaseStatement(CachedStatement& entry);
+            void resetStatements();
+            void clearStatementCache();
+
+            bool openConnection();
+            void applySettings();
+            void commitGroup();
+
+            // recovery of a damaged database (see GASqliteRecovery): the damaged file is set aside and a new
+            // one takes its place right away; the state tables are copied over while opening, the queued events
+            // by a thread into a salvage file, which is merged with the events queued since and swapped in
+            // between sends. Without a damaged file the thread runs PRAGMA quick_check on the database.
+            enum RecoveryStage
+            {
+                RecoveryIdle,
+                RecoveryChecking,
+                RecoveryDamaged,     // quick_check found problems, the database is set aside on the next tick
+                RecoverySalvaging,
+                RecoverySalvaged,
+                RecoveryFailed
+            };
+
+            std::string damagedPath() const;
+            std::string salvagePath() const;
+
+            void setAsideDamaged(std::string const& reason);
+            void salvageDamagedState();
+            void startRecovery();
+            void stopRecovery();
+            // moves the recovery on once its thread is done, runs between sends
+            void continueRecovery();
+            void swapInSalvage();
+            void removeRecoveryFiles();
+            void addRecoveryReport(RecoveryReport::Kind kind, std::string const& reason);
+
+            // resets the tracked size from the page counts
+            void reconcileDbSize();
+            void refreshOldestClientTs();
+            void trackEventBytes(int64_t bytes);
+
+            std::string dbPath;
+            sqlite3*    sqlDatabase = nullptr;
+
+            // set once the tables are ensured
+            bool tableReady = false;
+
+            // the same handful of statements runs for every event, they are prepared once per connection
+            static constexpr std::size_t MaxCachedStatements = 64;
+
+            // 5 parameters per row, well below the bound parameter limit of any sqlite build (999)
+            static constexpr int InsertRowsPerStatement = 64;
+            std::unordered_map<std::string, CachedStatement> statementCache;
+            CachedStatement uncachedStatement;
+            std::mutex      queryMutex;
+
+            GAStoreSettings settings;
+
+            // claimed events carry a batch id instead of the request id, 0 means not claimed
+            struct Batch
+            {
+                int64_t id     = 0;
+                int64_t bytes  = 0;
+                int64_t events = 0;
+
+                // what acking the batch takes off the category counters
+                std::array<int64_t, EventCategoryCount> categoryEvents{};
+                std::array<int64_t, EventCategoryCount> categoryBytes{};
+            };
+
+            std::unordered_map<std::string, Batch> batches;
+            int64_t nextBatchId = 1;
+
+            // annotations recently stored, by their text (one entry per active session; cleared when full)
+            static constexpr std::size_t MaxCachedAnnotations = 256;
+            std::unordered_map<std::string, int64_t> annotationIds;
+
+            // inserts and deletes of events adjust the size by the bytes of their rows, anything else
+            // (state, sessions, page slack, indexes, the WAL file) is picked up when the size is reconciled
+            static constexpr int64_t RowOverheadBytes   = 32;
+            static constexpr int     ReconcileSizeEvery = 1000;
+            std::atomic<int64_t> dbSizeBytes{0};
+            int                  writesSinceReconcile = 0;
+
+            // counted once when opening, then kept up to date by every write to ga_events
+            std::atomic<int64_t> queuedEvents{0};
+            std::atomic<int64_t> claimedEvents{0};
+
+            // evicted to stay below the quota
+            std::atomic<int64_t> evictedEvents{0};
+
+            // claimed rows or the WAL file can keep the database past the eviction threshold with nothing
+            // left to evict; the writes that follow such an eviction skip it until an ack frees rows
+            static constexpr int EvictRetryWrites = 1000;
+            int                  evictRetryIn = 0;
+
+            EventCategoryCounters categoryCounters;
+
+            // client_ts of the first row, read again whenever rows are deleted
+            std::atomic<int64_t> oldestClientTs{0};
+
+            std::thread       recoveryThread;
+            std::atomic<int>  recoveryStage{RecoveryIdle};
+            std::atomic<bool> recoveryCancel{false};
+            std::string       damageReason;         // written by the thread before it moves to RecoveryDamaged
+            SalvageStats      recoveryStats;        // the thread's while it salvages
+            bool              startupMaintenancePending = false;
+            bool              stateSalvagePending = false;
+
+            std::mutex                  reportMutex;
+            std::vector<RecoveryReport> recoveryReports;
+
+            // pages handed back per maintenance tick (incremental vacuum)
+            static constexpr int VacuumStepPages = 128;
+
+            static constexpr int MaxGroupedWrites = 1000;
+            bool groupCommit   = false;
+            bool groupOpen     = false;
+            int  groupedWrites = 0;
+        };
+    }
+}
@@ -27,27 +27,172 @@ namespace gameanalytics
 
     namespace state
     {
+        static thread_local GAState* currentInstance = nullptr;
+
         GAState& GAState::getInstance()
         {
-            static GAState instance;
+            if (currentInstance)
+            {
+                return *currentInstance;
+            }
+
+            static GAState instance("", true);
             return instance;
         }
 
-        GAState::GAState()
+        GAState::Scope::Scope(GAState* state):
+            _previous(currentInstance)
+        {
+            currentInstance = state;
+        }
+
+        GAState::Scope::~Scope()
+        {
+            currentInstance = _previous;
+        }
+
+        std::string GAState::getInstanceName()
+        {
+            return getInstance()._instanceName;
+        }
+
+        GAState::UserScope::UserScope(std::string const& userId):
+            _previous(getInstance()._boundUser)
+        {
+            getInstance()._boundUser = &getInstance()._userSessions.acquire(userId);
+        }
+
+        GAState::UserScope::~UserScope()
+        {
+            // written through while still in the worker pass, so a killed process keeps the counters
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                getInstance()._userSessions.flush(*user);
+            }
+
+            getInstance()._boundUser = _previous;
+        }
+
+        void GAState::setServerMode(bool flag)
+        {
+            getInstance()._serverMode = flag;
+        }
+
+        bool GAState::isServerMode()
+        {
+            return getInstance()._serverMode;
+        }
+
+        void GAState::setMaxResidentUsers(std::size_t maxUsers)
+        {
+            getInstance()._userSessions.setMaxResident(maxUsers);
+        }
+
+        bool GAState::hasBoundUser()
+        {
+            return getInstance()._boundUser != nullptr;
+        }
+
+        void GAState::startUserSession()
+        {
+            UserSession* user = getInstance()._boundUser;
+            if (!user)
+            {
+                return;
+            }
+
+            if (user->sessionStart != 0)
+            {
+                endUserSession();
+            }
+
+            user->sessionId      = utilities::toLowerCase(utilities::GAUtilities::generateUUID());
+            user->sessionStart   = getClientTsAdjusted();
+            user->startTimepoint = std::chrono::high_resolution_clock::now();
+            user->dirty          = true;
+            getInstance()._userSessions.setOpen(user->userId, true);
+
+            events::GAEvents::addSessionStartEvent();
+        }
+
+        void GAState::endUserSession()
+        {
+            UserSession* user = getInstance()._boundUser;
+            if (!user || user->sessionStart == 0)
+            {
+                return;
+            }
+
+            events::GAEvents::addSessionEndEvent();
+
+            user->totalSessionLength += getInstance().calculateSessionLength<std::chrono::seconds>();
+            user->sessionStart = 0;
+            user->dirty = true;
+            getInstance()._userSessions.setOpen(user->userId, false);
+        }
+
+        void GAState::endAllUserSessions()
+        {
+            GAUserSessions& sessions = getInstance()._userSessions;
+
+            // only the players with a session open, loading every player ever seen would not scale
+            for (std::string const& id : sessions.openUserIds())
+            {
+                UserScope scope(id);
+                endUserSession();
+
+                // a marker whose session is gone (or was ended already) is dropped too
+                sessions.setOpen(id, false);
+            }
+
+            // keep the counters of every player for the next run
+            sessions.spillAll();
+        }
+
+        GAState::GAState(std::string const& instanceName, bool isDefault):
+            _gaThread(threading::GAThreading::getInstance()),
+            _instanceName(instanceName),
+            _isDefault(isDefault)
         {
         }
 
         GAState::~GAState()
         {
-            _gaThread.queueBlock(
-                [this]()
-                {
-                    if(!_useManualSessionHandling)
-                        endSessionAndStopQueue(true);
-                }
-            );
+            // calls out (the init call, sdk error reports) call back into this instance, which is going now;
+            // cancelled they complete at once instead of when a dead network times out, and whatever the
+            // drain below sends completes as cancelled too
+            _gaHttp.client.cancel();
+
+            // the init call out uses this instance
+            if (_initRequest.valid())
+            {
+                _initRequest.wait();
+            }
 
-            _gaThread.flush();
+            if (_isDefault)
+            {
+                Scope scope(this);
+                _gaThread.queueBlock(
+                    [this]()
+                    {
+                        if(!_useManualSessionHandling)
+                            endSessionAndStopQueue(true);
+                    }
+                );
+
+                _gaThread.flush();
+            }
+            else
+            {
+                // the worker is shared, only this instance's work is drained
+                _gaThread.releaseOwner(this,
+                    [this]()
+                    {
+                        if(!_useManualSessionHandling)
+                            endSessionAndStopQueue(false);
+                    }
+                );
+            }
         }
 
         void GAState::setUserId(std::string const& id)
@@ -63,6 +208,11 @@ namespace gameanalytics
 
         std::string GAState::getUserId()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->userId;
+            }
+
             return getInstance()._identifier;
         }
 
@@ -78,16 +228,31 @@ namespace gameanalytics
 
         int64_t GAState::getSessionStart()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->sessionStart;
+            }
+
             return getInstance()._sessionStart;
         }
 
         int64_t GAState::getSessionNum()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->sessionNum;
+            }
+
             return getInstance()._sessionNum;
         }
 
         int64_t GAState::getTransactionNum()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->transactionNum;
+            }
+
             return getInstance()._transactionNum;
         }
     
@@ -98,21 +263,41 @@ namespace gameanalytics
 
         std::string GAState::getSessionId()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->sessionId;
+            }
+
             return getInstance()._sessionId;
         }
 
         std::string GAState::getCurrentCustomDimension01()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->dimension01;
+            }
+
             return getInstance()._currentCustomDimension01;
         }
 
         std::string GAState::getCurrentCustomDimension02()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->dimension02;
+            }
+
             return getInstance()._currentCustomDimension02;
         }
 
         std::string GAState::getCurrentCustomDimension03()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                return user->dimension03;
+            }
+
             return getInstance()._currentCustomDimension03;
         }
 
@@ -221,6 +406,13 @@ namespace gameanalytics
 
         void GAState::setCustomDimension01(std::string const& dimension)
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                user->dimension01 = dimension;
+                user->dirty = true;
+                return;
+            }
+
             getInstance()._currentCustomDimension01 = dimension;
             if (store::GAStore::getTableReady())
             {
@@ -231,6 +423,13 @@ namespace gameanalytics
 
         void GAState::setCustomDimension02(std::string const& dimension)
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                user->dimension02 = dimension;
+                user->dirty = true;
+                return;
+            }
+
             getInstance()._currentCustomDimension02 = dimension;
             if (store::GAStore::getTableReady())
             {
@@ -241,6 +440,13 @@ namespace gameanalytics
 
         void GAState::setCustomDimension03(std::string const& dimension)
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                user->dimension03 = dimension;
+                user->dirty = true;
+                return;
+            }
+
             getInstance()._currentCustomDimension03 = dimension;
             if (store::GAStore::getTableReady())
             {
@@ -264,11 +470,25 @@ namespace gameanalytics
 
         void GAState::incrementSessionNum()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                user->sessionNum++;
+                user->dirty = true;
+                return;
+            }
+
             getInstance()._sessionNum++;
         }
 
         void GAState::incrementTransactionNum()
         {
+            if (UserSession* user = getInstance()._boundUser)
+            {
+                user->transactionNum++;
+                user->dirty = true;
+                return;
+            }
+
             getInstance()._transactionNum++;
         }
 
@@ -277,10 +497,7 @@ namespace gameanalytics
             int tries = getInstance()._progressionTries.incrementTries(progression);
 
             // Persist
-            std::string triesString = std::to_string(tries);
-
-            StringVector parms = {progression, triesString};
-            store::GAStore::executeQuerySync("INSERT OR REPLACE INTO ga_progression (progression, tries) VALUES(?, ?);", parms);
+            store::GAStore::setProgressionTries(progression, tries);
         }
 
         int GAState::getProgressionTries(std::string const& progression)
@@ -293,8 +510,7 @@ namespace gameanalytics
             getInstance()._progressionTries.remove(progression);
 
             // Delete
-            StringVector parms = {progression};
-            store::GAStore::executeQuerySync("DELETE FROM ga_progression WHERE progression = ?;", parms);
+            store::GAStore::setProgressionTries(progression, 0);
         }
 
         bool GAState::hasAvailableCustomDimensions01(std::string const& dimension1)
@@ -378,10 +594,20 @@ namespace gameanalytics
 
         void GAState::endSessionAndStopQueue(bool endThread)
         {
+            getInstance()._sessionWaitsForInit = false;
+
             if(GAState::isInitialized())
             {
                 logging::GALogger::i("Ending session.");
-                if (GAState::isEnabled() && GAState::sessionIsStarted())
+                if (GAState::isServerMode())
+                {
+                    if (GAState::isEnabled())
+                    {
+                        endAllUserSessions();
+                    }
+                    getInstance()._sessionStart = 0;
+                }
+                else if (GAState::isEnabled() && GAState::sessionIsStarted())
                 {
                     getInstance().updateTotalSessionTime();
                     events::GAEvents::addHealthEvent();
@@ -391,6 +617,9 @@ namespace gameanalytics
                 events::GAEvents::stopEventQueue();
             }
 
+            // the process may be gone before the writer's delay is over
+            store::GAStore::flushWrites();
+
             if(endThread)
             {
                 threading::GAThreading::endThread();
@@ -422,8 +651,8 @@ namespace gameanalytics
                 out["manufacturer"] = device::GADevice::getDeviceManufacturer();
                 out["device"] = device::GADevice::getDeviceModel();
                 out["platform"] = device::GADevice::getBuildPlatform();
-                out["session_id"] = getInstance()._sessionId;
-                out["session_num"] = getInstance()._sessionNum;
+                out["session_id"] = getSessionId();
+                out["session_num"] = getSessionNum();
                 out["connection_type"] = device::GADevice::getConnectionType();
 
                 // playtime metrics
@@ -546,6 +775,11 @@ namespace gameanalytics
 
         int64_t GAState::getTotalSessionLength() const
         {
+            if (_boundUser)
+            {
+                return _boundUser->totalSessionLength + calculateSessionLength<std::chrono::seconds>();
+            }
+
             return _totalElapsedSessionTime + calculateSessionLength<std::chrono::seconds>();
         }
 
@@ -553,20 +787,20 @@ namespace gameanalytics
         {
             try
             {
-                // get and extract stored states
-                json state_dict;
-                json results_ga_state;
-
-                store::GAStore::executeQuerySync("SELECT * FROM ga_state;", results_ga_state);
+                // get and extract stored states (spilled player sessions are loaded on demand)
+                constexpr const char* persistedKeys[] =
+                {
+                    "default_user_id", "session_num", "transaction_num", "dimension01", "dimension02", "dimension03",
+                    "last_session_time", "total_session_time", "sdk_config_cached", "last_used_identifier"
+                };
 
-                if (!results_ga_state.empty())
+                json state_dict = json::object();
+                for (const char* key : persistedKeys)
                 {
-                    for (auto it = results_ga_state.begin(); it != results_ga_state.end(); ++it)
+                    std::string value = store::GAStore::getState(key);
+                    if (!value.empty())
                     {
-                        if (it->contains("key") && it->contains("value"))
-                        {
-                            state_dict[(*it)["key"].get<std::string>()] = (*it)["value"];
-                        }
+                        state_dict[key] = std::move(value);
                     }
                 }
                 
@@ -647,21 +881,9 @@ namespace gameanalytics
                     _abVariantId = utilities::getOptionalValue<std::string>(currentSdkConfig, "ab_variant_id");
                 }
 
-                json gaProgression;
-                store::GAStore::executeQuerySync("SELECT * FROM ga_progression;", gaProgression);
-
-                if (!gaProgression.empty())
+                for (auto const& entry : store::GAStore::getProgressionTries())
                 {
-                    for (auto& node : gaProgression)
-                    {
-                        if (node.contains("progression") && node.contains("tries"))
-                        {
-                            std::string name = node["progression"].get<std::string>();
-
-                            int tries = utilities::getOptionalValue<int>(node, "tries", 0);
-                            _progressionTries.addOrUpdate(name, tries);
-                        }
-                    }
+                    _progressionTries.addOrUpdate(entry.first, entry.second);
                 }
             }
             catch (json::exception& e)
@@ -683,12 +905,67 @@ namespace gameanalytics
                 // make sure the current custom dimensions are valid
                 GAState::validateAndFixCurrentDimensions();
 
-                // call the init call
-                http::GAHTTPApi& httpApi = http::GAHTTPApi::getInstance();
+                // the init call runs alongside, the session starts on the config at hand: the answer of an earlier
+                // call, else the cached one, else the defaults (as when offline)
+                requestInit();
+
+                if (_sdkConfig.empty())
+                {
+                    _sdkConfig = _sdkConfigCached.empty() ? _sdkConfigDefault : _sdkConfigCached;
+                }
+
+                beginSession();
+            }
+            catch (json::exception& e)
+            {
+                logging::GALogger::e("startNewSession - Failed to parse json: %s", e.what());
+            }
+            catch (std::exception& e)
+            {
+                logging::GALogger::e("startNewSession - Exception thrown: %s", e.what());
+            }
+        }
+
+        void GAState::requestInit()
+        {
+            // one call at a time, a session started while one is out gets its answer
+            if (_initPending)
+            {
+                return;
+            }
+
+            // the previous call posted its answer already, its thread is done
+            if (_initRequest.valid())
+            {
+                _initRequest.wait();
+            }
+
+            json initAnnotations;
+            getInitAnnotations(initAnnotations);
+
+            GAState* owner = this;
+            _initRequest = std::async(std::launch::async, [owner, configsHash = _configsHash, initAnnotations]()
+            {
+                Scope scope(owner);
 
                 json initResponseDict;
-                http::EGAHTTPApiResponse initResponse = httpApi.requestInitReturningDict(initResponseDict, _configsHash);
+                const http::EGAHTTPApiResponse initResponse = http::GAHTTPApi::getInstance().requestInitReturningDict(initResponseDict, configsHash, initAnnotations);
+
+                threading::GAThreading::performTaskOnGAThread(
+                    [initResponse, initResponseDict]() mutable
+                    {
+                        getInstance().applyInitResponse(initResponse, initResponseDict);
+                    });
+            });
+            _initPending = true;
+        }
+
+        void GAState::applyInitResponse(http::EGAHTTPApiResponse initResponse, json& initResponseDict)
+        {
+            _initPending = false;
 
+            try
+            {
                 // init is ok
                 if ((initResponse == http::Ok || initResponse == http::Created) && !initResponseDict.empty())
                 {
@@ -785,65 +1062,94 @@ namespace gameanalytics
                     _initAuthorized = true;
                 }
 
-                json& currentSdkConfig = GAState::getSdkConfig();
+                if (sessionIsStarted())
                 {
-                    if (!utilities::getOptionalValue<bool>(currentSdkConfig, "enabled", true))
+                    if (!applySdkConfig())
                     {
-                        _enabled = false;
-                    }
-                    else if (!_initAuthorized)
-                    {
-                        _enabled = false;
-                    }
-                    else
-                    {
-                        _enabled = true;
+                        logging::GALogger::w("SDK disabled by the init call.");
+                        events::GAEvents::stopEventQueue();
                     }
                 }
+                else if (_sessionWaitsForInit)
+                {
+                    beginSession();
+                }
+            }
+            catch (json::exception& e)
+            {
+                logging::GALogger::e("applyInitResponse - Failed to parse json: %s", e.what());
+            }
+            catch (std::exception& e)
+            {
+                logging::GALogger::e("applyInitResponse - Exception thrown: %s", e.what());
+            }
+        }
 
-                // set offset in state (memory) from current config (config could be from cache etc.)
-                _clientServerTimeOffset = utilities::getOptionalValue(currentSdkConfig, "time_offset", 0ll);
-
-                // populate configurations
-                populateConfigurations(currentSdkConfig);
-
-                // if SDK is disabled in config
-                if (!GAState::isEnabled())
+        bool GAState::applySdkConfig()
+        {
+            json& currentSdkConfig = GAState::getSdkConfig();
+            {
+                if (!utilities::getOptionalValue<bool>(currentSdkConfig, "enabled", true))
+                {
+                    _enabled = false;
+                }
+                else if (!_initAuthorized)
                 {
-                    logging::GALogger::w("Could not start session: SDK is disabled.");
-                    // stop event queue
-                    // + make sure it's able to restart if another session detects it's enabled again
-                    events::GAEvents::stopEventQueue();
-                    return;
+                    _enabled = false;
                 }
                 else
                 {
-                    events::GAEvents::ensureEventQueueIsRunning();
+                    _enabled = true;
                 }
+            }
 
-                // generate the new session
-                std::string newSessionId = utilities::GAUtilities::generateUUID();
-
-                // Set session id
-                _sessionId = utilities::toLowerCase(newSessionId);
+            // set offset in state (memory) from current config (config could be from cache etc.)
+            _clientServerTimeOffset = utilities::getOptionalValue(currentSdkConfig, "time_offset", 0ll);
 
-                // Set session start
-                _sessionStart = getClientTsAdjusted();
+            // populate configurations
+            populateConfigurations(currentSdkConfig);
 
-                // to acurrately measure time
-                _startTimepoint = std::chrono::high_resolution_clock::now();
+            return _enabled;
+        }
 
-                // Add session start event
-                events::GAEvents::addSessionStartEvent();
+        void GAState::beginSession()
+        {
+            // if disabled, the answer of the init call still out may enable it
+            _sessionWaitsForInit = false;
+            if (!applySdkConfig())
+            {
+                logging::GALogger::w("Could not start session: SDK is disabled.");
+                // stop event queue
+                // + make sure it's able to restart if another session detects it's enabled again
+                events::GAEvents::stopEventQueue();
+                _sessionWaitsForInit = _initPending;
+                return;
             }
-            catch (json::exception& e)
+            else
             {
-                logging::GALogger::e("startNewSession - Failed to parse json: %s", e.what());
+                events::GAEvents::ensureEventQueueIsRunning();
             }
-            catch (std::exception& e)
+
+            // generate the new session
+            std::string newSessionId = utilities::GAUtilities::generateUUID();
+
+            // Set session id
+            _sessionId = utilities::toLowerCase(newSessionId);
+
+            // Set session start
+            _sessionStart = getClientTsAdjusted();
+
+            // to acurrately measure time
+            _startTimepoint = std::chrono::high_resolution_clock::now();
+
+            // in server mode sessions belong to the players, the process only keeps the config alive
+            if (_serverMode)
             {
-                logging::GALogger::e("startNewSession - Exception thrown: %s", e.what());
+                return;
             }
+
+            // Add session start event
+            events::GAEvents::addSessionStartEvent();
         }
 
         void GAState::validateAndFixCurrentDimensions()
@@ -872,7 +1178,7 @@ namespace gameanalytics
 
         bool GAState::sessionIsStarted()
         {
-            return getInstance()._sessionStart != 0;
+            return getSessionStart() != 0;
         }
 
         bool GAState::isRemoteConfigsReady()
@@ -1103,8 +1409,8 @@ namespace gameanalytics
             _lastSessionTime = calculateSessionLength();
             _totalElapsedSessionTime += _lastSessionTime;
             
-            _gaStore.setState("last_session_time",  std::to_string(_lastSessionTime));
-            _gaStore.setState("total_session_time", std::to_string(_totalElapsedSessionTime));
+            store::GAStore::setState("last_session_time",  std::to_string(_lastSessionTime));
+            store::GAStore::setState("total_session_time", std::to_string(_totalElapsedSessionTime));
         }
 
         std::string GAState::getBuild()
@@ -11,6 +11,7 @@
 #include <mutex>
 #include <cstdlib>
 #include <unordered_map>
+#include <future>
 
 #include "GACommon.h"
 #include "GAUtilities.h"
@@ -20,9 +21,12 @@
 #include "GAEvents.h"
 #include "GAHTTPApi.h"
 #include "GADevice.h"
+#include "GAUserSessions.h"
 
 namespace gameanalytics
 {
+    class GameAnalyticsInstance;
+
     namespace state
     {
         struct ProgressionTries
@@ -79,11 +83,53 @@ namespace gameanalytics
             friend class logging::GALogger;
             friend class store::GAStore;
             friend class http::GAHTTPApi;
+            friend class gameanalytics::GameAnalyticsInstance;
             
             public:
 
+                // binds an SDK instance to the calling thread, getInstance() resolves to it while the scope lives
+                class Scope
+                {
+                    public:
+
+                        explicit Scope(GAState* state);
+                        ~Scope();
+                        Scope(const Scope&) = delete;
+                        Scope& operator=(const Scope&) = delete;
+
+                    private:
+
+                        GAState* _previous;
+                };
+
+                // the instance bound to the calling thread, or the default one used by the static GameAnalytics API
                 static GAState& getInstance();
 
+                static std::string getInstanceName();
+
+                // server mode: binds the session state of one player while an event for it is built
+                class UserScope
+                {
+                    public:
+
+                        explicit UserScope(std::string const& userId);
+                        ~UserScope();
+                        UserScope(const UserScope&) = delete;
+                        UserScope& operator=(const UserScope&) = delete;
+
+                    private:
+
+                        UserSession* _previous;
+                };
+
+                static void setServerMode(bool flag);
+                static bool isServerMode();
+                static void setMaxResidentUsers(std::size_t maxUsers);
+                static bool hasBoundUser();
+                static void startUserSession();
+                static void endUserSession();
+                static void endAllUserSessions();
+
                 static bool isDestroyed();
                 static void setUserId(std::string const& id);
                 static void setExternalUserId(std::string const& id);
@@ -163,7 +209,8 @@ namespace gameanalytics
                 template<typename T = std::chrono::milliseconds>
                 inline int64_t calculateSessionLength() const
                 {
-                    auto len = std::chrono::high_resolution_clock::now() - _startTimepoint;
+                    const auto start = _boundUser ? _boundUser->startTimepoint : _startTimepoint;
+                    auto len = std::chrono::high_resolution_clock::now() - start;
                     return std::chrono::duration_cast<T>(len).count();
                 }
 
@@ -177,7 +224,7 @@ namespace gameanalytics
 
         private:
             
-            GAState();
+            explicit GAState(std::string const& instanceName = "", bool isDefault = false);
             ~GAState();
             GAState(const GAState&) = delete;
             GAState& operator=(const GAState&) = delete;
@@ -198,6 +245,13 @@ namespace gameanalytics
             void  ensurePersistedStates();
             void  startNewSession();
             void  validateAndFixCurrentDimensions();
+
+            // the init call runs off the GA thread, its answer is applied on it
+            void  requestInit();
+            void  applyInitResponse(http::EGAHTTPApiResponse initResponse, json& initResponseDict);
+            // enabled state, time offset and remote configs from the config at hand, returns the enabled state
+            bool  applySdkConfig();
+            void  beginSession();
             std::string getBuild();
 
             void updateTotalSessionTime();
@@ -214,13 +268,16 @@ namespace gameanalytics
 
             void buildRemoteConfigsJsons(const json& remoteCfgs);
             
-            threading::GAThreading  _gaThread;
+            threading::GAThreading& _gaThread;
             events::GAEvents        _gaEvents;
             device::GADevice        _gaDevice;
             logging::GALogger       _gaLogger;
             store::GAStore          _gaStore;
             http::GAHTTPApi         _gaHttp;
 
+            std::string _instanceName;
+            bool        _isDefault = false;
+
             std::string _customUserId;
             std::string _identifier;
 
@@ -254,7 +311,11 @@ namespace gameanalytics
 
             std::string _build;
 
-            bool _initAuthorized = false;
+            // until the init call says otherwise (the session starts while it is out)
+            bool _initAuthorized = true;
+            bool _initPending = false;
+            bool _sessionWaitsForInit = false;
+            std::future<void> _initRequest;
             bool _enabled = false;
 
             int64_t _clientServerTimeOffset = 0;
@@ -275,6 +336,10 @@ namespace gameanalytics
             bool _enableEventSubmission     = true;
 
             bool _enableIdTracking = true;
+
+            bool            _serverMode = false;
+            GAUserSessions  _userSessions;
+            UserSession*    _boundUser = nullptr;
             
             json _gameRemoteConfigsJson;
             json _trackingRemoteConfigsJson;
@@ -5,26 +5,25 @@
 
 #include "GAStore.h"
 #include "GADevice.h"
-#include "GAThreading.h"
 #include "GALogger.h"
-#include "GAUtilities.h"
-#include <fstream>
-#include <string.h>
 #include "GAState.h"
+#include <algorithm>
 
 namespace gameanalytics
 {
     namespace store
     {
-        constexpr int MaxDbSizeBytes            = 6291456;
-        constexpr int MaxDbSizeBytesBeforeTrim  = 5242880;
-
         GAStore::GAStore()
         {
         }
 
         GAStore::~GAStore()
         {
+            // the instance the callbacks belong to is being torn down
+            if (tableReady)
+            {
+                writer.flushQuietly(events());
+            }
         }
 
         GAStore& GAStore::getInstance()
@@ -32,6 +31,24 @@ namespace gameanalytics
             return state::GAState::getInstance()._gaStore;
         }
 
+        IEventStore& GAStore::events()
+        {
+            switch (backend)
+            {
+                case EGAStoreBackend::Memory:
+                    return memoryStore;
+                case EGAStoreBackend::SegmentLog:
+                    return segmentStore;
+                default:
+                    return sqliteStore;
+            }
+        }
+
+        sqlite3* GAStore::getDatabase()
+        {
+            return sqliteStore.getDatabase();
+        }
+
         bool GAStore::executeQuerySync(std::string const& sql)
         {
             json d;
@@ -41,10 +58,9 @@ namespace gameanalytics
 
         void GAStore::executeQuerySync(std::string const& sql, json& out)
         {
-            executeQuerySync(sql, {}, 0, out);
+            executeQuerySync(sql, {}, false, out);
         }
 
-
         void GAStore::executeQuerySync(std::string const& sql, StringVector const& parameters)
         {
             json d;
@@ -64,353 +80,314 @@ namespace gameanalytics
 
         void GAStore::executeQuerySync(std::string const& sql, StringVector const& parameters, bool useTransaction, json& out)
         {
-            try
-            {
-                // Force transaction if it is an update, insert or delete.
-                if (utilities::GAUtilities::stringMatch(utilities::toUpperCase(sql), "^(UPDATE|INSERT|DELETE)"))
-                {
-                    useTransaction = true;
-                }
-
-                // Get database connection from singelton getInstance
-                sqlite3 *sqlDatabasePtr = getInstance().getDatabase();
-
-                if (useTransaction)
-                {
-                    if (sqlite3_exec(sqlDatabasePtr, "BEGIN;", 0, 0, 0) != SQLITE_OK)
-                    {
-                        logging::GALogger::e("SQLITE3 BEGIN ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
-                        return;
-                    }
-                }
-
-                out = json::array();
-
-                // Create statement
-                sqlite3_stmt *statement = nullptr;
-
-                // Prepare statement
-                if (sqlite3_prepare_v2(sqlDatabasePtr, sql.c_str(), -1, &statement, nullptr) == SQLITE_OK)
-                {
-                    // Bind parameters
-                    if (!parameters.empty())
-                    {
-                        for (size_t index = 0; index < parameters.size(); index++)
-                        {
-                            sqlite3_bind_text(statement, static_cast<int>(index + 1), parameters[index].c_str(), -1, 0);
-                        }
-                    }
-
-                    // get columns count
-                    int columnCount = sqlite3_column_count(statement);
-
-                    // Loop through results
-                    while (sqlite3_step(statement) == SQLITE_ROW)
-                    {
-                        json row;
-                        for (int i = 0; i < columnCount; i++)
-                        {
-                            const char *column = sqlite3_column_name(statement, i);
-                            const char *value  = reinterpret_cast<const char*>(sqlite3_column_text(statement, i));
-
-                            if (!column || !value)
-                            {
-                                continue;
-                            }
-
-                            switch (sqlite3_column_type(statement, i))
-                            {
-                                case SQLITE_INTEGER:
-                                {
-                                    try
-                                    {
-                                        int64_t valInt = std::stoll(value);
-                                        row[column] = valInt;
-                                    }
-                                    catch(std::exception& e)
-                                    {
-                                        logging::GALogger::w("Failed to parse int: %s", e.what());
-                                    }
-
-                                    break;
-                                }
-                                case SQLITE_FLOAT:
-                                {
-                                    try
-                                    {
-                                        double valFloat = std::stod(value);
-                                        row[column] = valFloat;
-                                    }
-                                    catch(std::exception& e)
-                                    {
-                                        logging::GALogger::w("Failed to parse float: %s", e.what());
-                                    }
-                                    
-                                    break;
-                                }
-                                default:
-                                {
-                                    row[column] = value;
-                                }
-                            }
-                        }
-                        out.push_back(std::move(row));
-                    }
-                }
-                else
-                {
-                    // TODO(nikolaj): Should we do a db validation to see if the db is corrupt here?
-                    logging::GALogger::e("SQLITE3 PREPARE ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
-                    out = {};
-                    return;
-                }
-
-                // Destroy statement
-                if (sqlite3_finalize(statement) == SQLITE_OK)
-                {
-                    if (useTransaction)
-                    {
-                        if (sqlite3_exec(sqlDatabasePtr, "COMMIT", 0, 0, 0) != SQLITE_OK)
-                        {
-                            logging::GALogger::e("SQLITE3 COMMIT ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
-                            out = {};
-                            return;
-                        }
-                    }
-                }
-                else
-                {
-                    logging::GALogger::d("SQLITE3 FINALIZE ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
-
-                    if (useTransaction)
-                    {
-                        if (sqlite3_exec(sqlDatabasePtr, "ROLLBACK", 0, 0, 0) != SQLITE_OK)
-                        {
-                            logging::GALogger::e("SQLITE3 ROLLBACK ERROR: %s", sqlite3_errmsg(sqlDatabasePtr));
-                        }
-
-                        out = {};
-                    }
+            flushWrites();
+            getInstance().sqliteStore.queryJson(sql, parameters, useTransaction, out);
+        }
 
-                    return;
-                }
-            }
-            catch(std::exception& e)
-            {
-                logging::GALogger::e("Exception thrown: %s", e.what());
-                out = {};
-            }
+        bool GAStore::executeQuery(std::string const& sql, StringVector const& parameters, RowCallback const& onRow)
+        {
+            flushWrites();
+            return getInstance().sqliteStore.query(sql, parameters, false, onRow);
         }
 
-        sqlite3* GAStore::getDatabase()
+        bool GAStore::executeQuery(std::string const& sql, StringVector const& parameters, bool useTransaction, RowCallback const& onRow)
         {
-            return sqlDatabase;
+            flushWrites();
+            return getInstance().sqliteStore.query(sql, parameters, useTransaction, onRow);
         }
-    
+
         bool GAStore::initDatabaseLocation()
         {
             constexpr const char* DATABASE_NAME = "ga.sqlite3";
-            
+
             std::filesystem::path p = device::GADevice::getWritablePath();
-            
+
             p /= state::GAState::getGameKey();
-            
+
+            // named instances keep their own database next to the default one
+            const std::string instanceName = state::GAState::getInstanceName();
+            if (!instanceName.empty())
+            {
+                p /= instanceName;
+            }
+
             dbPath = (p / DATABASE_NAME).string();
             if(!std::filesystem::exists(p))
             {
-                if(!std::filesystem::create_directory(p))
+                std::error_code err;
+                if(!std::filesystem::create_directories(p, err))
                     return false;
             }
-            
+
             return true;
         }
 
         bool GAStore::ensureDatabase(bool dropDatabase, std::string const& key)
         {
-            getInstance().initDatabaseLocation();
-            
-            // Open database
-            if (sqlite3_open(getInstance().dbPath.c_str(), &getInstance().sqlDatabase) != SQLITE_OK)
-            {
-                getInstance().dbReady = false;
-                logging::GALogger::w("Could not open database: %s", getInstance().dbPath.c_str());
-                return false;
-            }
-            else
+            GAStore& store = getInstance();
+
+            // events still held belong to the store opened before
+            if (store.tableReady)
             {
-                getInstance().dbReady = true;
-                logging::GALogger::i("Database opened: %s", getInstance().dbPath.c_str());
+                store.writer.flushQuietly(store.events());
             }
-            
-            if (dropDatabase)
+
+            // events and state live in the memory store, nothing is opened
+            if (store.backend == EGAStoreBackend::Memory)
             {
-                logging::GALogger::d("Drop tables");
-                GAStore::executeQuerySync("DROP TABLE ga_events");
-                GAStore::executeQuerySync("DROP TABLE ga_state");
-                GAStore::executeQuerySync("DROP TABLE ga_session");
-                GAStore::executeQuerySync("DROP TABLE ga_progression");
-                GAStore::executeQuerySync("VACUUM");
+                store.tableReady = true;
+                return true;
             }
 
-            // Create statements
-            constexpr const char* sql_ga_events = "CREATE TABLE IF NOT EXISTS ga_events(status CHAR(50) NOT NULL, category CHAR(50) NOT NULL, session_id CHAR(50) NOT NULL, client_ts CHAR(50) NOT NULL, event TEXT NOT NULL);";
-            constexpr const char* sql_ga_session = "CREATE TABLE IF NOT EXISTS ga_session(session_id CHAR(50) PRIMARY KEY NOT NULL, timestamp CHAR(50) NOT NULL, event TEXT NOT NULL);";
-            constexpr const char* sql_ga_state = "CREATE TABLE IF NOT EXISTS ga_state(key CHAR(255) PRIMARY KEY NOT NULL, value TEXT);";
-            constexpr const char* sql_ga_progression = "CREATE TABLE IF NOT EXISTS ga_progression(progression CHAR(255) PRIMARY KEY NOT NULL, tries CHAR(255));";
+            store.initDatabaseLocation();
 
-            if (!GAStore::executeQuerySync(sql_ga_events))
+            // the segment files and their journal get a directory next to the database
+            if (store.backend == EGAStoreBackend::SegmentLog)
             {
-                logging::GALogger::d("ensureDatabase failed: %s", sql_ga_events);
-                return false;
+                const std::string logPath = (std::filesystem::path(store.dbPath).parent_path() / "ga_events").string();
+                store.tableReady = store.segmentStore.open(logPath, dropDatabase);
+                return store.tableReady;
             }
 
-            if (!GAStore::executeQuerySync("SELECT status FROM ga_events LIMIT 0,1"))
-            {
-                logging::GALogger::d("ga_events corrupt, recreating.");
-                GAStore::executeQuerySync("DROP TABLE ga_events");
-                if (!GAStore::executeQuerySync(sql_ga_events))
-                {
-                    logging::GALogger::w("ga_events corrupt, could not recreate it.");
-                    return false;
-                }
-            }
+            store.tableReady = store.sqliteStore.open(store.dbPath, dropDatabase);
+            return store.tableReady;
+        }
+
+        void GAStore::setState(std::string const& key, std::string const& value)
+        {
+            getInstance().events().setState(key, value);
+        }
+
+        std::string GAStore::getState(std::string const& key)
+        {
+            return getInstance().events().getState(key);
+        }
+
+        StringVector GAStore::getStateKeys(std::string const& prefix)
+        {
+            return getInstance().events().getStateKeys(prefix);
+        }
+
+        void GAStore::setProgressionTries(std::string const& progression, int tries)
+        {
+            getInstance().events().setProgressionTries(progression, tries);
+        }
+
+        std::vector<std::pair<std::string, int>> GAStore::getProgressionTries()
+        {
+            return getInstance().events().getProgressionTries();
+        }
+
+        void GAStore::checkpointSession(SessionCheckpoint const& session)
+        {
+            getInstance().events().checkpointSession(session);
+        }
+
+        void GAStore::removeSession(std::string const& sessionId)
+        {
+            getInstance().events().removeSession(sessionId);
+        }
+
+        std::vector<SessionCheckpoint> GAStore::getSessions()
+        {
+            return getInstance().events().getSessions();
+        }
+
+        int64_t GAStore::getDbSizeBytes()
+        {
+            flushWrites();
+            return getInstance().events().getStats().sizeBytes;
+        }
 
-            if (!GAStore::executeQuerySync(sql_ga_session))
+        bool GAStore::getTableReady()
+        {
+            return getInstance().tableReady;
+        }
+
+        bool GAStore::isDbTooLargeForEvents()
+        {
+            return getInstance().events().isFull();
+        }
+
+        void GAStore::setBackend(EGAStoreBackend backend)
+        {
+            getInstance().backend = backend;
+        }
+
+        EGAStoreBackend GAStore::getBackend()
+        {
+            return getInstance().backend;
+        }
+
+        void GAStore::setMemoryCapacity(std::size_t capacity)
+        {
+            getInstance().memoryStore.setCapacity(capacity);
+        }
+
+        void GAStore::setSettings(GAStoreSettings const& settings)
+        {
+            getInstance().sqliteStore.setSettings(settings);
+            getInstance().segmentStore.setSettings(settings);
+            getInstance().writer.setLimits(settings.writeBatchEvents, settings.writeBatchBytes, std::chrono::milliseconds(settings.writeDelayMs));
+        }
+
+        void GAStore::beginGroupCommit()
+        {
+            getInstance().events().beginWrites();
+        }
+
+        void GAStore::endGroupCommit()
+        {
+            flushDueWrites();
+            getInstance().events().endWrites();
+        }
+
+        int64_t GAStore::getEvictedEventCount()
+        {
+            flushWrites();
+            return getInstance().events().getStats().evictedEvents;
+        }
+
+        EventStoreStats GAStore::getStats()
+        {
+            flushWrites();
+            return getInstance().events().getStats();
+        }
+
+        GAQueueStats GAStore::getQueueStats(int64_t now)
+        {
+            GAStore& store = getInstance();
+            const EventStoreStats stats = store.events().getStats();
+
+            GAQueueStats queue;
+            queue.queuedEvents   = stats.queuedEvents;
+            queue.inFlightEvents = stats.claimedEvents;
+            queue.pendingWrites  = static_cast<int64_t>(store.writer.pendingEvents());
+            queue.sizeBytes      = stats.sizeBytes;
+            queue.evictedEvents  = stats.evictedEvents;
+            queue.droppedEvents  = stats.droppedEvents + store.writer.droppedEvents() + store.blockedEvents.load(std::memory_order_relaxed);
+
+            // the writer only holds events built after the ones already stored
+            const int64_t oldest = stats.oldestClientTs > 0 ? stats.oldestClientTs : store.writer.oldestClientTs();
+            if (oldest > 0)
             {
-                return false;
+                queue.oldestEventAgeSeconds = std::max<int64_t>(now - oldest, 0);
             }
 
-            if (!GAStore::executeQuerySync("SELECT session_id FROM ga_session LIMIT 0,1"))
+            for (std::size_t i = 0; i < EventCategoryCount; ++i)
             {
-                logging::GALogger::d("ga_session corrupt, recreating.");
-                GAStore::executeQuerySync("DROP TABLE ga_session");
-                if (!GAStore::executeQuerySync(sql_ga_session))
+                if (stats.eventsByCategory[i] > 0)
                 {
-                    logging::GALogger::w("ga_session corrupt, could not recreate it.");
-                    return false;
+                    const std::string name = i > 0 ? std::string(EventCategories[i].name) : "other";
+                    queue.eventsByCategory[name] = stats.eventsByCategory[i];
+                    queue.bytesByCategory[name]  = stats.bytesByCategory[i];
                 }
             }
 
-            if (!GAStore::executeQuerySync(sql_ga_state))
-            {
-                return false;
-            }
+            return queue;
+        }
+
+        void GAStore::addBlockedEvent()
+        {
+            getInstance().blockedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
 
-            if (!GAStore::executeQuerySync("SELECT key FROM ga_state LIMIT 0,1"))
+        void GAStore::addEvent(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event)
+        {
+            GAStore& store = getInstance();
+
+            // stays behind the events the writer holds
+            flushWrites();
+
+            if (store.backend == EGAStoreBackend::Memory)
             {
-                logging::GALogger::d("ga_state corrupt, recreating.");
-                GAStore::executeQuerySync("DROP TABLE ga_state");
-                if (!GAStore::executeQuerySync(sql_ga_state))
-                {
-                    logging::GALogger::w("ga_state corrupt, could not recreate it.");
-                    return false;
-                }
+                store.memoryStore.add(category, sessionId, clientTs, event);
+                return;
             }
 
-            if (!GAStore::executeQuerySync(sql_ga_progression))
+            if (store.backend == EGAStoreBackend::SegmentLog)
             {
-                return false;
+                store.segmentStore.appendText(category, sessionId, clientTs, event);
+                return;
             }
 
-            if (!GAStore::executeQuerySync("SELECT progression FROM ga_progression LIMIT 0,1"))
+            store.sqliteStore.appendText(category, sessionId, clientTs, event);
+        }
+
+        void GAStore::addEvent(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event, PersistedCallback onPersisted)
+        {
+            GAStore& store = getInstance();
+
+            // the ring buffer takes an event for about what queuing it would cost
+            if (store.backend == EGAStoreBackend::Memory)
             {
-                logging::GALogger::d("ga_progression corrupt, recreating.");
-                GAStore::executeQuerySync("DROP TABLE ga_progression");
-                if (!GAStore::executeQuerySync(sql_ga_progression))
+                store.memoryStore.append(category, sessionId, clientTs, event);
+                if (onPersisted)
                 {
-                    logging::GALogger::w("ga_progression corrupt, could not recreate it.");
-                    return false;
+                    onPersisted(true);
                 }
+                return;
             }
 
-            getInstance().trimEventTable();
-            getInstance().tableReady = true;
-
-            logging::GALogger::d("Database tables ensured present");
+            if (store.writer.add({ category, sessionId, clientTs, event }, std::move(onPersisted)))
+            {
+                flushWrites();
+            }
+        }
 
-            return true;
+        void GAStore::flushWrites()
+        {
+            GAStore& store = getInstance();
+            store.writer.flush(store.events());
         }
 
-        void GAStore::setState(std::string const& key, std::string const& value)
+        void GAStore::flushDueWrites()
         {
-            if (value.empty())
+            GAStore& store = getInstance();
+            if (store.writer.isDue())
             {
-                StringVector parameterArray = {key};
-                executeQuerySync("DELETE FROM ga_state WHERE key = ?;", parameterArray);
-            }
-            else
-            {
-                StringVector parameterArray = {key, value};
-                executeQuerySync("INSERT OR REPLACE INTO ga_state (key, value) VALUES(?, ?);", parameterArray, true);
+                store.writer.flush(store.events());
             }
         }
 
-        int64_t GAStore::getDbSizeBytes()
+        bool GAStore::claimEvents(std::string const& requestId, std::string const& category, int limit, StringVector& out)
         {
-            std::ifstream in(getInstance().dbPath, std::ifstream::ate | std::ifstream::binary);
-            return in.tellg();
+            flushWrites();
+            return getInstance().events().claimBatch(requestId, category, limit, out);
         }
 
-        bool GAStore::getTableReady()
+        void GAStore::deleteEvents(std::string const& requestId)
         {
-            return getInstance().tableReady;
+            getInstance().events().ackBatch(requestId);
         }
 
-        bool GAStore::isDbTooLargeForEvents()
+        void GAStore::putBackEvents(std::string const& requestId)
+        {
+            getInstance().events().putBackBatch(requestId);
+        }
+
+        void GAStore::resetEventStatus()
         {
-            return getDbSizeBytes() > MaxDbSizeBytes;
+            flushWrites();
+            getInstance().events().putBackAll();
         }
 
-        bool GAStore::trimEventTable()
+        void GAStore::runMaintenance()
         {
-            if(getDbSizeBytes() > MaxDbSizeBytesBeforeTrim)
+            GAStore& store = getInstance();
+
+            if (!store.tableReady)
             {
-                try
-                {
-                    json resultSessionArray;
-                    executeQuerySync("SELECT session_id, Max(client_ts) FROM ga_events GROUP BY session_id ORDER BY client_ts LIMIT 3", resultSessionArray);
-
-                    if(!resultSessionArray.is_null() && resultSessionArray.size() > 0)
-                    {
-                        std::string sessionDeleteString;
-
-                        unsigned int i = 0;
-                        for (auto itr = resultSessionArray.begin(); itr != resultSessionArray.end(); ++itr)
-                        {
-                            std::string const session_id = itr->get<std::string>();
-
-                            if(i < resultSessionArray.size() - 1)
-                            {
-                                sessionDeleteString += session_id + ",";
-                            }
-                            else
-                            {
-                                sessionDeleteString += session_id;
-                            }
-                            ++i;
-                        }
-
-                        const std::string deleteOldSessionsSql = utilities::printString("DELETE FROM ga_events WHERE session_id IN (\"%s\");", sessionDeleteString.c_str());
-                        logging::GALogger::w("Database too large when initializing. Deleting the oldest 3 sessions.");
-                        executeQuerySync(deleteOldSessionsSql);
-                        executeQuerySync("VACUUM");
-
-                        return true;
-                    }
-                    else
-                    {
-                        return false;
-                    }
-                }
-                catch(std::exception& e)
-                {
-                    logging::GALogger::e("Exception thrown: %s", e.what());
-                    return false;
-                }
+                return;
             }
 
-            return true;
+            flushWrites();
+            store.events().trim();
         }
 
+        std::vector<GASqliteStore::RecoveryReport> GAStore::takeRecoveryReports()
+        {
+            return getInstance().sqliteStore.takeRecoveryReports();
+        }
     }
 }
@@ -5,28 +5,49 @@
 
 #pragma once
 
-#include <sqlite3.h>
 #include <vector>
-#include <mutex>
-#include <cstdlib>
+#include <string>
+#include <atomic>
 #include "GACommon.h"
+#include "GAEventStore.h"
+#include "GASqliteStore.h"
+#include "GAMemoryStore.h"
+#include "GASegmentStore.h"
+#include "GAStoreWriter.h"
 
 namespace gameanalytics
 {
     namespace store
     {
+        // the store of one SDK instance: forwards to the backend selected with EGAStoreBackend
         class GAStore
         {
             friend class state::GAState;
 
          public:
 
+            using Row         = GASqliteStore::Row;
+            using RowCallback = GASqliteStore::RowCallback;
+
             sqlite3* getDatabase();
 
             static bool ensureDatabase(bool dropDatabase, std::string const& key = "");
 
-            static void setState(std::string const& key, std::string const& value);
+            // persisted key/value state, an empty value removes the key
+            static void         setState(std::string const& key, std::string const& value);
+            static std::string  getState(std::string const& key);
+            static StringVector getStateKeys(std::string const& prefix);
+
+            // tries per progression, 0 removes it
+            static void setProgressionTries(std::string const& progression, int tries);
+            static std::vector<std::pair<std::string, int>> getProgressionTries();
+
+            // running sessions, see SessionCheckpoint
+            static void checkpointSession(SessionCheckpoint const& session);
+            static void removeSession(std::string const& sessionId);
+            static std::vector<SessionCheckpoint> getSessions();
 
+            // raw SQL against the sqlite backend (tests and diagnostics, the SDK itself goes through IEventStore)
             static bool executeQuerySync(std::string const& sql);
             static void executeQuerySync(std::string const& sql, json& out);
 
@@ -36,11 +57,60 @@ namespace gameanalytics
             static void executeQuerySync(std::string const& sql, StringVector const& parameters, bool useTransaction);
             static void executeQuerySync(std::string const& sql, StringVector const& parameters, bool useTransaction, json& out);
 
+            // see GASqliteStore::query
+            static bool executeQuery(std::string const& sql, StringVector const& parameters, RowCallback const& onRow);
+            static bool executeQuery(std::string const& sql, StringVector const& parameters, bool useTransaction, RowCallback const& onRow);
+
+            // bytes used by the queued events and the state of the backend, tracked in memory
             static int64_t getDbSizeBytes();
 
             static bool getTableReady();
             static bool isDbTooLargeForEvents();
 
+            // backend selection, must happen before ensureDatabase
+            static void setBackend(EGAStoreBackend backend);
+            static EGAStoreBackend getBackend();
+            static void setMemoryCapacity(std::size_t capacity);
+
+            // store tuning, must happen before ensureDatabase
+            static void setSettings(GAStoreSettings const& settings);
+
+            // the writes of one worker pass, see IEventStore::beginWrites
+            static void beginGroupCommit();
+            static void endGroupCommit();
+            static int64_t getEvictedEventCount();
+            static EventStoreStats getStats();
+
+            // the backend's stats and the events held by the writer, without flushing it; the age of the
+            // oldest event is taken at client_ts 'now'
+            static GAQueueStats getQueueStats(int64_t now);
+
+            // an event refused before it reached the store (see isDbTooLargeForEvents)
+            static void addBlockedEvent();
+
+            // event queue; the string overload stores the text as it is, the json one lets the backend
+            // share the session annotations of the event and goes through the writer (see GAStoreWriter):
+            // it is written with the next batch, 'onPersisted' is told once it was
+            static void addEvent(std::string const& category, std::string const& sessionId, int64_t clientTs, std::string const& event);
+            static void addEvent(std::string const& category, std::string const& sessionId, int64_t clientTs, json const& event, PersistedCallback onPersisted = nullptr);
+
+            // writes the events held by the writer now, or only once their delay is over
+            static void flushWrites();
+            static void flushDueWrites();
+            static bool claimEvents(std::string const& requestId, std::string const& category, int limit, StringVector& out);
+            static void deleteEvents(std::string const& requestId);
+            static void putBackEvents(std::string const& requestId);
+            static void resetEventStatus();
+
+            // housekeeping between sends: keeps the backend within its quota
+            static void runMaintenance();
+
+            // what the recovery of a damaged sqlite database did since the last call
+            static std::vector<GASqliteStore::RecoveryReport> takeRecoveryReports();
+
+            static constexpr int     SchemaVersion  = GASqliteStore::SchemaVersion;
+            static constexpr int64_t MinDbSizeBytes = GASqliteStore::MinDbSizeBytes;
+
         private:
 
             GAStore();
@@ -50,23 +120,27 @@ namespace gameanalytics
 
             static GAStore& getInstance();
 
-            bool fixOldDatabase();
-            bool trimEventTable();
-            
+            // the backend in use
+            IEventStore& events();
+
             bool initDatabaseLocation();
 
             // set when calling "ensureDatabase"
             // using a "writablePath" that needs to be set into the C++ component before
             std::string dbPath;
 
-            // local pointer to database
-            sqlite3* sqlDatabase = nullptr;
-
-            // ??
-            bool dbReady = false;
-            
             // bool to determine if tables are ensured ready
             bool tableReady = false;
+
+            EGAStoreBackend backend = EGAStoreBackend::Sqlite;
+            GASqliteStore   sqliteStore;
+            GAMemoryStore   memoryStore;
+            GASegmentStore  segmentStore;
+
+            // batches the events of the sqlite and segment log backends
+            GAStoreWriter   writer;
+
+            std::atomic<int64_t> blockedEvents{0};
         };
     }
 }
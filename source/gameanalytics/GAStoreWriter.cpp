@@ -0,0 +1,145 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAStoreWriter.h"
+#include "GALogger.h"
+#include <algorithm>
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        void GAStoreWriter::setLimits(int events, int64_t sizeBytes, std::chrono::milliseconds delay)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            maxEvents = std::max(events, 1);
+            maxBytes  = sizeBytes;
+            maxDelay  = delay;
+        }
+
+        bool GAStoreWriter::add(EventRecord&& record, PersistedCallback onPersisted)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            if (records.empty())
+            {
+                oldest = Clock::now();
+            }
+
+            bytes += estimateBytes(record.event);
+            records.push_back(std::move(record));
+            callbacks.push_back(std::move(onPersisted));
+
+            return static_cast<int>(records.size()) >= maxEvents || bytes >= maxBytes;
+        }
+
+        bool GAStoreWriter::isDue(Clock::time_point now) const
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            return !records.empty() && now - oldest >= maxDelay;
+        }
+
+        std::vector<PersistedCallback> GAStoreWriter::write(IEventStore& store, bool& persisted)
+        {
+            std::vector<EventRecord>       batch;
+            std::vector<PersistedCallback> told;
+
+            batch.swap(records);
+            told.swap(callbacks);
+            bytes = 0;
+
+            persisted = batch.empty() || store.appendBatch(batch);
+            if (!persisted)
+            {
+                logging::GALogger::w("Failed to store a batch of %d events.", static_cast<int>(batch.size()));
+                dropped += static_cast<int64_t>(batch.size());
+            }
+
+            return told;
+        }
+
+        void GAStoreWriter::flush(IEventStore& store)
+        {
+            bool persisted = false;
+            std::vector<PersistedCallback> told;
+            {
+                // held while writing, batches reach the store in the order they were queued
+                std::lock_guard<std::mutex> lock(writeMutex);
+                told = write(store, persisted);
+            }
+
+            for (PersistedCallback const& onPersisted : told)
+            {
+                if (onPersisted)
+                {
+                    onPersisted(persisted);
+                }
+            }
+        }
+
+        void GAStoreWriter::flushQuietly(IEventStore& store)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            bool persisted = false;
+            write(store, persisted);
+        }
+
+        std::size_t GAStoreWriter::pendingEvents() const
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            return records.size();
+        }
+
+        int64_t GAStoreWriter::pendingBytes() const
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            return bytes;
+        }
+
+        int64_t GAStoreWriter::oldestClientTs() const
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            return records.empty() ? 0 : records.front().clientTs;
+        }
+
+        int64_t GAStoreWriter::droppedEvents() const
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            return dropped;
+        }
+
+        int64_t GAStoreWriter::estimateBytes(json const& event)
+        {
+            switch (event.type())
+            {
+                case json::value_t::object:
+                {
+                    int64_t size = 2;
+                    for (auto it = event.begin(); it != event.end(); ++it)
+                    {
+                        size += static_cast<int64_t>(it.key().size()) + 4 + estimateBytes(it.value());
+                    }
+                    return size;
+                }
+                case json::value_t::array:
+                {
+                    int64_t size = 2;
+                    for (json const& value : event)
+                    {
+                        size += 1 + estimateBytes(value);
+                    }
+                    return size;
+                }
+                case json::value_t::string:
+                    return static_cast<int64_t>(event.get_ref<std::string const&>().size()) + 2;
+                default:
+                    return 8;
+            }
+        }
+    }
+}
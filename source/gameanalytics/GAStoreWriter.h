@@ -0,0 +1,79 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <functional>
+#include "GACommon.h"
+#include "GAEventStore.h"
+
+namespace gameanalytics
+{
+    namespace store
+    {
+        // told whether an event handed to the writer reached the store (false if it was dropped)
+        using PersistedCallback = std::function<void(bool persisted)>;
+
+        // the stage between the SDK and its event store: built events are held in memory and written
+        // as one batch (IEventStore::appendBatch) once the batch holds maxEvents events or maxBytes bytes,
+        // or its oldest event has waited maxDelay
+        class GAStoreWriter
+        {
+         public:
+
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr int                       DefaultMaxEvents = 100;
+            static constexpr int64_t                   DefaultMaxBytes  = 65536;
+            static constexpr std::chrono::milliseconds DefaultMaxDelay  = std::chrono::milliseconds(250);
+
+            void setLimits(int maxEvents, int64_t maxBytes, std::chrono::milliseconds maxDelay);
+
+            // queues 'record', true if the batch is full and should be written now
+            bool add(EventRecord&& record, PersistedCallback onPersisted = nullptr);
+
+            // true if the oldest queued event has waited past the delay
+            bool isDue(Clock::time_point now = Clock::now()) const;
+
+            // writes the queued events to 'store', then tells their callbacks the outcome;
+            // callbacks run after the writer is released and may use the store
+            void flush(IEventStore& store);
+
+            // writes the queued events without telling anyone (the callbacks' owner is going away)
+            void flushQuietly(IEventStore& store);
+
+            std::size_t pendingEvents() const;
+            int64_t     pendingBytes() const;
+
+            // client_ts of the oldest event held, 0 if there is none
+            int64_t oldestClientTs() const;
+
+            // events of batches the store failed to write
+            int64_t droppedEvents() const;
+
+            // rough size of 'event' as JSON text, counted against maxBytes without serializing it
+            static int64_t estimateBytes(json const& event);
+
+         private:
+
+            std::vector<PersistedCallback> write(IEventStore& store, bool& persisted);
+
+            mutable std::mutex writeMutex;
+
+            std::vector<EventRecord>       records;
+            std::vector<PersistedCallback> callbacks;
+            int64_t                        bytes = 0;
+            Clock::time_point              oldest;
+            int64_t                        dropped = 0;
+
+            int                       maxEvents = DefaultMaxEvents;
+            int64_t                   maxBytes  = DefaultMaxBytes;
+            std::chrono::milliseconds maxDelay  = DefaultMaxDelay;
+        };
+    }
+}
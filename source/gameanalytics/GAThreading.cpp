@@ -10,7 +10,9 @@
 #include "GALogger.h"
 #include <thread>
 #include <exception>
+#include <iterator>
 #include "GAState.h"
+#include "GAStore.h"
 
 namespace gameanalytics
 {
@@ -22,7 +24,8 @@ namespace gameanalytics
 
         GAThreading& GAThreading::getInstance()
         {
-            return state::GAState::getInstance()._gaThread;
+            static GAThreading instance;
+            return instance;
         }
     
         void GAThreading::flushTasks()
@@ -51,6 +54,7 @@ namespace gameanalytics
             {
                 _endThread = true;
                 _hasJoined = true;
+                wakeUp();
                 _thread.join();
                 
                 // if there are any other tasks queued, flush them
@@ -59,35 +63,128 @@ namespace gameanalytics
             }
         }
 
-        void GAThreading::runBlocks()
+        void GAThreading::releaseOwner(state::GAState* owner, Block&& lastBlock)
         {
-            while(!_blocks.empty())
+            // blocks run in order, so once this one is done nothing older from 'owner' is left
+            std::promise<void> done;
+            std::future<void> finished = done.get_future();
+
+            Block last = std::move(lastBlock);
             {
-                Block b = getNextBlock();
+                std::unique_lock<std::mutex> guard(_blockMutex);
+                _blocks.push_back({owner,
+                    [&done, &last]()
+                    {
+                        try
+                        {
+                            std::invoke(last);
+                        }
+                        catch(const std::exception& e)
+                        {
+                            logging::GALogger::e("Failed to run block on ga thread: %s", e.what());
+                        }
 
-                try
+                        // nothing of the owner may be touched after 'done', so its writes are committed here
+                        store::GAStore::endGroupCommit();
+                        done.set_value();
+                    },
+                    true
+                });
+            }
+
+            // if the worker is gone (or we are on it) the owner's leftovers run here
+            bool runHere = _endThread || std::this_thread::get_id() == _thread.get_id();
+            while (true)
+            {
+                if (runHere)
                 {
-                    std::invoke(b);
+                    runBlocksOf(owner);
                 }
-                catch(const std::exception& e)
+
+                if (finished.wait_for(THREAD_TASK_FREQUENCY) == std::future_status::ready)
                 {
-                    logging::GALogger::e("Failed to run block on ga thread: %s", e.what());
+                    break;
                 }
+
+                runHere = _endThread;
+            }
+
+            std::unique_lock<std::mutex> guard(_taskMutex);
+            _tasks.erase(
+                std::remove_if(_tasks.begin(), _tasks.end(), [owner](const ScheduledTask& t) { return t.owner == owner; }),
+                _tasks.end());
+        }
+
+        void GAThreading::runBlocksOf(state::GAState* owner)
+        {
+            std::deque<QueuedBlock> pending;
+            {
+                std::unique_lock<std::mutex> guard(_blockMutex);
+                auto it = std::stable_partition(_blocks.begin(), _blocks.end(),
+                    [owner](const QueuedBlock& b) { return b.owner != owner; });
+
+                std::move(it, _blocks.end(), std::back_inserter(pending));
+                _blocks.erase(it, _blocks.end());
+            }
+
+            for (std::size_t i = 0; i < pending.size(); ++i)
+            {
+                runBlock(pending[i], i + 1 == pending.size());
+            }
+        }
+
+        void GAThreading::runBlock(QueuedBlock& b, bool commitWrites)
+        {
+            state::GAState::Scope scope(b.owner);
+
+            store::GAStore::beginGroupCommit();
+
+            try
+            {
+                std::invoke(b.block);
+            }
+            catch(const std::exception& e)
+            {
+                logging::GALogger::e("Failed to run block on ga thread: %s", e.what());
+            }
+
+            if (commitWrites && !b.releasesOwner)
+            {
+                store::GAStore::endGroupCommit();
+            }
+        }
+
+        void GAThreading::runBlocks()
+        {
+            QueuedBlock b;
+            bool moreFromOwner = false;
+            while(getNextBlock(b, moreFromOwner))
+            {
+                runBlock(b, !moreFromOwner);
             }
         }
 
         void GAThreading::queueBlock(Block&& b)
         {
+            state::GAState* owner = &state::GAState::getInstance();
+
             std::unique_lock<std::mutex> guard(_blockMutex);
-            _blocks.push(std::forward<Block>(b));
+            _blocks.push_back({owner, std::forward<Block>(b)});
         }
 
-        GAThreading::Block GAThreading::getNextBlock()
+        bool GAThreading::getNextBlock(QueuedBlock& out, bool& moreFromOwner)
         {
             std::unique_lock<std::mutex> guard(_blockMutex);
-            Block b = _blocks.front();
-            _blocks.pop();
-            return b;
+            if (_blocks.empty())
+            {
+                return false;
+            }
+
+            out = std::move(_blocks.front());
+            _blocks.pop_front();
+
+            moreFromOwner = !_blocks.empty() && _blocks.front().owner == out.owner;
+            return true;
         }
 
         void GAThreading::updateTasks(bool force)
@@ -95,6 +192,7 @@ namespace gameanalytics
             std::unique_lock<std::mutex> guard(_taskMutex);
             for(auto& task : _tasks)
             {   
+                state::GAState::Scope scope(task.owner);
                 task.tick(force);
             }
         }
@@ -106,15 +204,33 @@ namespace gameanalytics
                 runBlocks();
                 updateTasks();
 
-                std::this_thread::sleep_for(THREAD_TASK_FREQUENCY);
+                std::unique_lock<std::mutex> guard(_wakeMutex);
+                _wake.wait_for(guard, THREAD_TASK_FREQUENCY, [this]() { return _wakeRequested || _endThread; });
+                _wakeRequested = false;
             }
         }
 
+        void GAThreading::wakeUp()
+        {
+            {
+                std::unique_lock<std::mutex> guard(_wakeMutex);
+                _wakeRequested = true;
+            }
+            _wake.notify_one();
+        }
+
         void GAThreading::performTaskOnGAThread(Block b)
         {
             getInstance().queueBlock(std::move(b));
         }
 
+        void GAThreading::performTaskOnGAThreadNow(Block b)
+        {
+            GAThreading& instance = getInstance();
+            instance.queueBlock(std::move(b));
+            instance.wakeUp();
+        }
+
         void GAThreading::endThread()
         {
             getInstance()._endThread = true;
@@ -125,7 +241,8 @@ namespace gameanalytics
             return getInstance()._endThread;
         }
 
-        GAThreading::ScheduledTask::ScheduledTask(std::chrono::milliseconds freq, Block&& task):
+        GAThreading::ScheduledTask::ScheduledTask(state::GAState* owner, std::chrono::milliseconds freq, Block&& task):
+            owner(owner),
             task(std::forward<Block>(task)),
             frequency(freq)
         {
@@ -134,8 +251,10 @@ namespace gameanalytics
 
         void GAThreading::scheduleTask(std::chrono::milliseconds freq, Block&& task)
         {
+            state::GAState* owner = &state::GAState::getInstance();
+
             std::unique_lock<std::mutex> guard(_taskMutex);
-            _tasks.push_back(ScheduledTask(freq, std::forward<Block>(task)));
+            _tasks.push_back(ScheduledTask(owner, freq, std::forward<Block>(task)));
         }
 
         void GAThreading::scheduleTimer(std::chrono::milliseconds freq, Block task)
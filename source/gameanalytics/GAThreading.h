@@ -13,18 +13,23 @@
 #include <memory>
 #include <future>
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 #include <algorithm>
 
 #include "GACommon.h"
 
 namespace gameanalytics
 {
+    class GameAnalyticsInstance;
+
     namespace threading
     {
         class GAThreading
         {
             friend class state::GAState;
+            friend class gameanalytics::GameAnalyticsInstance;
 
          public:
 
@@ -32,6 +37,10 @@ namespace gameanalytics
 
             static void performTaskOnGAThread(Block taskBlock);
 
+            // the same, without waiting for the next pass of the worker (blocks otherwise share a pass and
+            // its store transaction); for work that holds up the game, like initializing
+            static void performTaskOnGAThreadNow(Block taskBlock);
+
             static void endThread();
 
             static bool isThreadFinished();
@@ -42,38 +51,64 @@ namespace gameanalytics
 
          private:
 
+            // every block and task remembers the SDK instance that queued it,
+            // the worker binds that instance while running it
+            struct QueuedBlock
+            {
+                state::GAState* owner = nullptr;
+                Block block;
+
+                // the owner may be gone once this block has run
+                bool releasesOwner = false;
+            };
+
             struct ScheduledTask
             {
+                state::GAState* owner;
                 Block task;
                 std::chrono::milliseconds frequency;
 
-                ScheduledTask(std::chrono::milliseconds frequency, Block&& task);
+                ScheduledTask(state::GAState* owner, std::chrono::milliseconds frequency, Block&& task);
                 bool tick(bool force = false);
 
                 private:
                     std::chrono::high_resolution_clock::time_point _lastCall;
             };
 
+            // one worker is shared by all SDK instances in the process
             static GAThreading& getInstance();
             
             GAThreading();
             ~GAThreading();
 
             void work();
+            void wakeUp();
             void queueBlock(Block&& block);
             void scheduleTask(std::chrono::milliseconds freq, Block&& task);
             
             void flush();
 
-            Block getNextBlock();
-            void  runBlocks();
-            void  updateTasks(bool force = false);
+            // runs 'lastBlock' after everything already queued by 'owner', then drops the owner's timers
+            void releaseOwner(state::GAState* owner, Block&& lastBlock);
+
+            void runBlocksOf(state::GAState* owner);
+
+            // 'moreFromOwner' tells whether the block after 'out' belongs to the same instance
+            bool getNextBlock(QueuedBlock& out, bool& moreFromOwner);
+
+            // consecutive blocks of one instance share a store transaction, 'commitWrites' ends it
+            void runBlock(QueuedBlock& b, bool commitWrites);
+            void runBlocks();
+            void updateTasks(bool force = false);
             
             std::vector<ScheduledTask> _tasks;
-            std::queue<Block> _blocks;
+            std::deque<QueuedBlock> _blocks;
             std::thread       _thread;
             std::mutex        _blockMutex;
             std::mutex        _taskMutex;
+            std::mutex              _wakeMutex;
+            std::condition_variable _wake;
+            bool                    _wakeRequested = false;
             std::atomic<bool> _endThread = false;
             std::atomic<bool> _hasJoined = false;
         };
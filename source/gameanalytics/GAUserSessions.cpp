@@ -0,0 +1,355 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GAUserSessions.h"
+#include "GAStore.h"
+#include "GALogger.h"
+#include "GAUtilities.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace gameanalytics
+{
+    namespace state
+    {
+        json UserSession::toJson() const
+        {
+            json j;
+            j["session_id"]           = sessionId;
+            j["session_num"]          = sessionNum;
+            j["transaction_num"]      = transactionNum;
+            j["session_start"]        = sessionStart;
+            j["total_session_length"] = totalSessionLength;
+            j["last_seen"]            = lastSeen;
+
+            utilities::addIfNotEmpty(j, "dimension01", dimension01);
+            utilities::addIfNotEmpty(j, "dimension02", dimension02);
+            utilities::addIfNotEmpty(j, "dimension03", dimension03);
+
+            return j;
+        }
+
+        void UserSession::fromJson(const json& j)
+        {
+            json node = j;
+
+            sessionId          = utilities::getOptionalValue<std::string>(node, "session_id");
+            sessionNum         = utilities::getOptionalValue<int64_t>(node, "session_num", 0);
+            transactionNum     = utilities::getOptionalValue<int64_t>(node, "transaction_num", 0);
+            sessionStart       = utilities::getOptionalValue<int64_t>(node, "session_start", 0);
+            totalSessionLength = utilities::getOptionalValue<int64_t>(node, "total_session_length", 0);
+            lastSeen           = utilities::getOptionalValue<int64_t>(node, "last_seen", 0);
+            dimension01        = utilities::getOptionalValue<std::string>(node, "dimension01");
+            dimension02        = utilities::getOptionalValue<std::string>(node, "dimension02");
+            dimension03        = utilities::getOptionalValue<std::string>(node, "dimension03");
+
+            // an open session keeps its length across spills
+            startTimepoint = std::chrono::high_resolution_clock::now();
+            if (sessionStart > 0)
+            {
+                const int64_t elapsed = std::max<int64_t>(utilities::GAUtilities::timeIntervalSince1970() - sessionStart, 0);
+                startTimepoint -= std::chrono::seconds(elapsed);
+            }
+        }
+
+        void GAUserSessions::setMaxResident(std::size_t maxResident)
+        {
+            _maxResident = std::max<std::size_t>(maxResident, 1);
+            _maxStored   = std::max(_maxStored, _maxResident);
+
+            while (_lru.size() > _maxResident)
+            {
+                spill(_lru.back());
+                _index.erase(_lru.back().userId);
+                _lru.pop_back();
+            }
+        }
+
+        std::size_t GAUserSessions::getMaxResident() const
+        {
+            return _maxResident;
+        }
+
+        void GAUserSessions::setMaxStored(std::size_t maxStored)
+        {
+            _maxStored = std::max(maxStored, _maxResident);
+        }
+
+        std::size_t GAUserSessions::getMaxStored() const
+        {
+            return _maxStored;
+        }
+
+        UserSession& GAUserSessions::acquire(std::string const& userId)
+        {
+            auto it = _index.find(userId);
+            if (it != _index.end())
+            {
+                // most recently used sessions live at the front
+                if (it->second != _lru.begin())
+                {
+                    _lru.splice(_lru.begin(), _lru, it->second);
+                }
+
+                touch(_lru.front());
+                return _lru.front();
+            }
+
+            while (_lru.size() >= _maxResident)
+            {
+                spill(_lru.back());
+                _index.erase(_lru.back().userId);
+                _lru.pop_back();
+            }
+
+            _lru.emplace_front();
+            UserSession& session = _lru.front();
+            session.userId = userId;
+
+            if (load(userId, session))
+            {
+                ++_loads;
+            }
+
+            _index.emplace(userId, _lru.begin());
+            touch(session);
+            return session;
+        }
+
+        StringVector GAUserSessions::residentUserIds() const
+        {
+            StringVector ids;
+            ids.reserve(_lru.size());
+
+            for (UserSession const& s : _lru)
+            {
+                ids.push_back(s.userId);
+            }
+
+            return ids;
+        }
+
+        StringVector GAUserSessions::openUserIds() const
+        {
+            std::set<std::string> ids = _open;
+
+            // sessions a previous run left open
+            if (store::GAStore::getTableReady())
+            {
+                const std::string prefix = OpenKeyPrefix;
+                for (std::string const& key : store::GAStore::getStateKeys(prefix))
+                {
+                    ids.insert(key.substr(prefix.size()));
+                }
+            }
+
+            return StringVector(ids.begin(), ids.end());
+        }
+
+        void GAUserSessions::setOpen(std::string const& userId, bool open)
+        {
+            if (open)
+            {
+                _open.insert(userId);
+            }
+            else
+            {
+                _open.erase(userId);
+            }
+
+            if (store::GAStore::getTableReady())
+            {
+                store::GAStore::setState(OpenKeyPrefix + userId, open ? "1" : "");
+            }
+        }
+
+        void GAUserSessions::flush(UserSession& session)
+        {
+            if (!session.dirty || !store::GAStore::getTableReady())
+            {
+                return;
+            }
+
+            store::GAStore::setState(StateKeyPrefix + session.userId, session.toJson().dump());
+            session.dirty = false;
+
+            if (!session.stored)
+            {
+                session.stored = true;
+                ++_newRowsSinceTrim;
+            }
+
+            // a trim reads every stored row, it runs once the table may have grown by an eighth
+            if (!_trimmed || _newRowsSinceTrim >= std::max<std::size_t>(_maxStored / 8, 1))
+            {
+                trimStored();
+            }
+        }
+
+        void GAUserSessions::spillAll()
+        {
+            for (UserSession& s : _lru)
+            {
+                spill(s);
+            }
+
+            _lru.clear();
+            _index.clear();
+        }
+
+        std::size_t GAUserSessions::trimStored()
+        {
+            _trimmed = true;
+            _newRowsSinceTrim = 0;
+
+            if (!store::GAStore::getTableReady())
+            {
+                return 0;
+            }
+
+            const std::string prefix = StateKeyPrefix;
+            const std::set<std::string> open = [this]()
+            {
+                const StringVector ids = openUserIds();
+                return std::set<std::string>(ids.begin(), ids.end());
+            }();
+
+            const int64_t expiredBefore = utilities::GAUtilities::timeIntervalSince1970() - StoredTtlSeconds;
+
+            std::size_t rows = 0;
+            std::size_t deleted = 0;
+            std::vector<std::pair<int64_t, std::string>> candidates;
+
+            for (std::string const& key : store::GAStore::getStateKeys(prefix))
+            {
+                ++rows;
+
+                const std::string userId = key.substr(prefix.size());
+                if (_index.count(userId) || open.count(userId))
+                {
+                    continue;
+                }
+
+                int64_t lastSeen = 0;
+                try
+                {
+                    json node = json::parse(store::GAStore::getState(key));
+                    lastSeen = utilities::getOptionalValue<int64_t>(node, "last_seen", 0);
+                }
+                catch (json::exception const&)
+                {
+                    // unreadable, it could not be restored anyway
+                }
+
+                if (lastSeen < expiredBefore)
+                {
+                    store::GAStore::setState(key, "");
+                    ++deleted;
+                }
+                else
+                {
+                    candidates.emplace_back(lastSeen, key);
+                }
+            }
+
+            rows -= deleted;
+            if (rows > _maxStored && !candidates.empty())
+            {
+                const std::size_t excess = std::min(rows - _maxStored, candidates.size());
+                std::partial_sort(candidates.begin(), candidates.begin() + excess, candidates.end());
+
+                for (std::size_t i = 0; i < excess; ++i)
+                {
+                    store::GAStore::setState(candidates[i].second, "");
+                }
+
+                deleted += excess;
+            }
+
+            if (deleted > 0)
+            {
+                logging::GALogger::d("Dropped the stored sessions of %zu players not seen recently", deleted);
+            }
+
+            return deleted;
+        }
+
+        void GAUserSessions::clear()
+        {
+            _lru.clear();
+            _index.clear();
+            _open.clear();
+        }
+
+        std::size_t GAUserSessions::residentCount() const
+        {
+            return _lru.size();
+        }
+
+        int64_t GAUserSessions::spillCount() const
+        {
+            return _spills;
+        }
+
+        int64_t GAUserSessions::loadCount() const
+        {
+            return _loads;
+        }
+
+        void GAUserSessions::spill(UserSession& session)
+        {
+            flush(session);
+            ++_spills;
+        }
+
+        void GAUserSessions::touch(UserSession& session)
+        {
+            const int64_t now = utilities::GAUtilities::timeIntervalSince1970();
+            if (now - session.lastSeen >= LastSeenResolutionSeconds)
+            {
+                session.lastSeen = now;
+                session.dirty = true;
+            }
+        }
+
+        bool GAUserSessions::load(std::string const& userId, UserSession& session)
+        {
+            if (!store::GAStore::getTableReady())
+            {
+                return false;
+            }
+
+            const std::string key = StateKeyPrefix + userId;
+            const std::string value = store::GAStore::getState(key);
+
+            if (value.empty())
+            {
+                return false;
+            }
+
+            try
+            {
+                session.fromJson(json::parse(value));
+            }
+            catch (json::exception const& e)
+            {
+                logging::GALogger::w("Could not restore session of user %s: %s", userId.c_str(), e.what());
+                return false;
+            }
+
+            session.stored = true;
+
+            // left open by a run that did not get to end it
+            if (session.sessionStart != 0)
+            {
+                _open.insert(userId);
+            }
+
+            // the stored row stays, flush() keeps it up to date
+            return true;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#pragma once
+
+#include <list>
+#include <set>
+#include <string>
+#include <chrono>
+#include <unordered_map>
+#include "GACommon.h"
+
+namespace gameanalytics
+{
+    namespace state
+    {
+        // session and counter state of one player in server mode
+        struct UserSession
+        {
+            std::string userId;
+            std::string sessionId;
+            int64_t     sessionNum              = 0;
+            int64_t     transactionNum          = 0;
+            int64_t     sessionStart            = 0;
+            int64_t     totalSessionLength      = 0;
+            int64_t     lastSeen                = 0;
+            std::string dimension01;
+            std::string dimension02;
+            std::string dimension03;
+
+            std::chrono::high_resolution_clock::time_point startTimepoint;
+
+            // changed since it was last written to the store
+            bool dirty = false;
+
+            // has a row in the store
+            bool stored = false;
+
+            json toJson() const;
+            void fromJson(const json& j);
+        };
+
+        // resident user sessions backed by the ga_state table: changes are written through by flush(),
+        // the least recently used sessions are dropped from memory. Stored rows count against the
+        // database quota like events do, so the players not seen for a while are dropped from the table
+        class GAUserSessions
+        {
+         public:
+
+            static constexpr std::size_t DefaultMaxResident = 10000;
+            static constexpr std::size_t DefaultMaxStored   = 10000;
+            static constexpr int64_t     StoredTtlSeconds   = 30 * 24 * 3600;
+            static constexpr const char* StateKeyPrefix     = "user_session:";
+            static constexpr const char* OpenKeyPrefix      = "user_open:";
+
+            // last_seen is only rewritten once it is this much behind
+            static constexpr int64_t LastSeenResolutionSeconds = 3600;
+
+            // also raises the stored limit to 'maxResident', every resident player may need its row
+            void setMaxResident(std::size_t maxResident);
+            std::size_t getMaxResident() const;
+
+            void setMaxStored(std::size_t maxStored);
+            std::size_t getMaxStored() const;
+
+            // returns the session of 'userId', loading it from the store or creating it if needed;
+            // the returned reference is valid until the next call to acquire()
+            UserSession& acquire(std::string const& userId);
+
+            // user ids of the resident sessions
+            StringVector residentUserIds() const;
+
+            // user ids of the players with a session open, resident or spilled
+            StringVector openUserIds() const;
+
+            // keeps track of which players have a session open, see openUserIds(); the store keeps
+            // a marker per open session so a run that did not get to end it can end it later
+            void setOpen(std::string const& userId, bool open);
+
+            // writes 'session' to the store if it changed since it was last written
+            void flush(UserSession& session);
+
+            // writes every changed resident session to the store and drops them all from memory
+            void spillAll();
+
+            // deletes the stored rows of players not seen for StoredTtlSeconds, then those seen least
+            // recently until at most getMaxStored() rows are left; resident players and players with
+            // a session open keep theirs. Runs by itself as new rows are written, returns the rows deleted
+            std::size_t trimStored();
+
+            void clear();
+
+            std::size_t residentCount() const;
+            int64_t     spillCount() const;
+            int64_t     loadCount() const;
+
+         private:
+
+            void spill(UserSession& session);
+            void touch(UserSession& session);
+            bool load(std::string const& userId, UserSession& session);
+
+            using LruList = std::list<UserSession>;
+
+            LruList _lru;
+            std::unordered_map<std::string, LruList::iterator> _index;
+            std::set<std::string> _open;
+            std::size_t _maxResident = DefaultMaxResident;
+            std::size_t _maxStored   = DefaultMaxStored;
+
+            // rows written for players that had none since the last trim, the first row written trims too
+            std::size_t _newRowsSinceTrim = 0;
+            bool        _trimmed          = false;
+
+            int64_t _spills = 0;
+            int64_t _loads  = 0;
+        };
+    }
+}
@@ -10,6 +10,8 @@
 #include <sstream>
 #include <chrono>
 #include <regex>
+#include <random>
+#include <unordered_map>
 #include <climits>
 #include <cctype>
 
@@ -18,16 +20,10 @@
 
 #include "stacktrace/call_stack.hpp"
 
-// From crypto
-#define MINIZ_HEADER_FILE_ONLY
-#include "GA_Zip.cpp"
-
 namespace gameanalytics
 {
     namespace utilities
     {
-        using namespace zip;
-
         std::string printArray(StringVector const& v, std::string const& delim)
         {
             if(v.empty())
@@ -106,104 +102,6 @@ namespace gameanalytics
             return std::make_pair(function, line);
         }
 
-        // Compress a STL string using zlib with given compression level and return the binary data.
-        // Note: the zlib header is supressed
-        static std::vector<char> deflate_string(const char* str, int compressionlevel = Z_BEST_COMPRESSION)
-        {
-            // z_stream is zlib's control structure
-            z_stream zs;
-            memset(&zs, 0, sizeof(zs));
-
-            /* windowsize is negative to suppress Zlib header */
-            if (Z_OK != deflateInit2(&zs, compressionlevel, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 9, MZ_DEFAULT_STRATEGY))
-            {
-                throw(std::runtime_error("deflateInit failed while compressing."));
-            }
-
-            zs.next_in = (Bytef*)str;
-            //zs.next_in = reinterpret_cast<Bytef*>(str.data());
-
-            // set the z_stream's input
-            zs.avail_in = static_cast<unsigned int>(strlen(str));
-            int ret;
-            
-            constexpr size_t BUFFER_SIZE = 32768;
-            static char outbuffer[BUFFER_SIZE];
-            std::vector<char> outstring;
-
-            // retrieve the compressed bytes blockwise
-            do
-            {
-                zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-                zs.avail_out = sizeof(outbuffer);
-
-                ret = deflate(&zs, Z_FINISH);
-
-                if (outstring.size() < zs.total_out)
-                {
-                    size_t s = zs.total_out - outstring.size();
-                    // append the block to the output string
-                    for(size_t i = 0; i < s; ++i)
-                    {
-                        outstring.push_back(outbuffer[i]);
-                    }
-                }
-            } while (ret == Z_OK);
-
-            deflateEnd(&zs);
-
-            if (ret != Z_STREAM_END)
-            {
-                // an error occurred that was not EOF
-                logging::GALogger::e("Exception during zlib compression: (%d) %s", ret, zs.msg);
-                outstring.clear();
-            }
-
-            return outstring;
-        }
-
-        // TODO(nikolaj): explain template?
-        template <typename T>
-        T swap_endian(T u)
-        {
-            static_assert (CHAR_BIT == 8, "CHAR_BIT != 8");
-
-            union
-            {
-                T u;
-                unsigned char u8[sizeof(T)];
-            } source, dest;
-
-            source.u = u;
-
-            for (size_t k = 0; k < sizeof(T); k++)
-                dest.u8[k] = source.u8[sizeof(T) - k - 1];
-
-            return dest.u;
-        }
-
-        uint32 htonl2(uint32 v)
-        {
-            uint32 result = 0;
-            result |= (v & 0xFF000000) >> 24;
-            result |= (v & 0x00FF0000) >> 8;
-            result |= (v & 0x0000FF00) << 8;
-            result |= (v & 0x000000FF) << 24;
-
-            return result;
-        }
-
-        uint32 to_little_endian(uint32 v)
-        {
-            // convert to big endian
-            v = htonl2(v);
-
-            // and to little endian, because gzip wants it so.
-            v = swap_endian(v);
-
-            return v;
-        }
-
         constexpr char nb_base64_chars[] =
         "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
         "abcdefghijklmnopqrstuvwxyz"
@@ -278,59 +176,35 @@ namespace gameanalytics
             *buf++ = '\0';
         }
 
-        // gzip compresses a string
-        static std::vector<uint8> compress_string_gzip(const char* str, int compressionlevel = Z_BEST_COMPRESSION)
+        std::string GAUtilities::generateUUID()
         {
-            // https://tools.ietf.org/html/rfc1952
-            std::vector<char> deflated = deflate_string(str, compressionlevel);
-
-            constexpr char gzip_header[10] =
-            { '\037', '\213', Z_DEFLATED, 0,
-                0, 0, 0, 0, /* mtime */
-                0, 0x03 /* Unix OS_CODE */
-            };
-
-            // Note: apparently, the crc is never validated on ther server side. So I'm not sure, if I have to convert it to little endian.
-            uint32_t crc = to_little_endian(crc32(0, (unsigned char*)str, strlen(str)));
-            uint32 size  = to_little_endian(static_cast<unsigned int>(strlen(str)));
-
-            size_t totalSize = sizeof(gzip_header);
-            totalSize += deflated.size();
-            totalSize += 8;
-
-            std::unique_ptr<char[]> resultArray = std::make_unique<char[]>(totalSize);
-            
-            size_t current = 0;
-            for(size_t i = 0; i < sizeof(gzip_header); ++i)
-            {
-                resultArray[i] = gzip_header[i];
-            }
-            current += sizeof(gzip_header);
-            for(size_t i = 0; i < deflated.size(); ++i)
+#if defined(GUID_STDLIB)
+            // every event gets an id: reuse one seeded engine per thread instead of
+            // seeding a new one for each random byte like xg::newGuid does. A single
+            // 32 bit seed would allow only 2^32 id streams across all devices, so it
+            // is seeded with 256 bits
+            thread_local std::mt19937_64 engine = []()
             {
-                resultArray[i + current] = deflated[i];
-            }
-            current += deflated.size();
-            strncpy(resultArray.get() + current, (const char*)&crc, 4);
-            current += 4;
-            strncpy(resultArray.get() + current, (const char*)&size, 4);
+                std::random_device device;
+                std::seed_seq seed{device(), device(), device(), device(), device(), device(), device(), device()};
+                return std::mt19937_64(seed);
+            }();
 
-            std::vector<uint8_t> result;
-
-            for(size_t i = 0; i < totalSize; ++i)
-            {
-                result.push_back(resultArray[i]);
-            }
+            const uint64_t hi = (engine() & 0xFFFFFFFFFFFF0FFFull) | 0x0000000000004000ull; // version 4
+            const uint64_t lo = (engine() & 0x3FFFFFFFFFFFFFFFull) | 0x8000000000000000ull; // RFC 4122 variant
 
-            return result;
-        }
+            char buffer[37];
+            std::snprintf(buffer, sizeof(buffer), "%08x-%04x-%04x-%04x-%012" PRIx64,
+                static_cast<uint32_t>(hi >> 32), static_cast<uint32_t>((hi >> 16) & 0xFFFF), static_cast<uint32_t>(hi & 0xFFFF),
+                static_cast<uint32_t>(lo >> 48), static_cast<uint64_t>(lo & 0xFFFFFFFFFFFFull));
 
-        std::string GAUtilities::generateUUID()
-        {
+            return buffer;
+#else
             xg::Guid guid = xg::newGuid();
             std::stringstream stream;
             stream << guid;
             return stream.str();
+#endif
         }
 
         // TODO(nikolaj): explain function
@@ -377,8 +251,21 @@ namespace gameanalytics
         {
             try
             {
-                std::regex expression(pattern);
-                return std::regex_match(string, expression);
+                // the validators run on every event with a handful of fixed patterns, compile each once
+                thread_local std::unordered_map<std::string, std::regex> compiled;
+
+                auto it = compiled.find(pattern);
+                if (it == compiled.end())
+                {
+                    if (compiled.size() >= 64)
+                    {
+                        compiled.clear();
+                    }
+
+                    it = compiled.emplace(pattern, std::regex(pattern)).first;
+                }
+
+                return std::regex_match(string, it->second);
             }
             catch (const std::regex_error& e)
             {
@@ -394,7 +281,17 @@ namespace gameanalytics
 
         std::vector<uint8_t> GAUtilities::gzipCompress(const char* data)
         {
-            return compress_string_gzip(data);
+            std::vector<uint8_t> out;
+            gzipCompress(data, strlen(data), out);
+            return out;
+        }
+
+        bool GAUtilities::gzipCompress(const char* data, size_t size, std::vector<uint8_t>& out, int level)
+        {
+            GAGzipEncoder& encoder = GAGzipEncoder::forThisThread();
+            encoder.setLevel(level);
+
+            return encoder.encode(data, size, out);
         }
 
         // TODO(nikolaj): explain function
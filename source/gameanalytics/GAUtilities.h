@@ -6,6 +6,7 @@
 #pragma once
 
 #include "GACommon.h"
+#include "GAGzipEncoder.h"
 #include <vector>
 #include <string>
 #include <locale>
@@ -126,6 +127,8 @@ namespace gameanalytics
             static void hmacWithKey(const char* key, const std::vector<uint8_t>& data, std::vector<uint8_t>& out);
             static bool stringMatch(std::string const& string, std::string const& pattern);
             static std::vector<uint8_t> gzipCompress(const char* data);
+            // gzips 'size' bytes of 'data' into 'out' (cleared first, its capacity is kept)
+            static bool gzipCompress(const char* data, size_t size, std::vector<uint8_t>& out, int level = GAGzipEncoder::DefaultLevel);
 
             // added for C++ port
             static bool isStringNullOrEmpty(const char* s);
@@ -9,6 +9,7 @@
 #include "GAState.h"
 #include "GALogger.h"
 #include "GAHTTPApi.h"
+#include "GAStore.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -18,6 +19,45 @@ namespace gameanalytics
 {
     namespace validators
     {
+        namespace
+        {
+            // event ids are checked on every event, so the id patterns are matched by hand:
+            // up to 'maxParts' parts separated by ':', each 1-64 characters accepted by 'isValid'
+            template<typename Pred>
+            bool matchEventParts(std::string const& eventId, std::size_t maxParts, Pred isValid)
+            {
+                constexpr std::size_t MaxPartLength = 64;
+
+                std::size_t parts  = 1;
+                std::size_t length = 0;
+                for (const char c : eventId)
+                {
+                    if (c == ':')
+                    {
+                        if (length == 0 || ++parts > maxParts)
+                        {
+                            return false;
+                        }
+                        length = 0;
+                    }
+                    else if (!isValid(c) || ++length > MaxPartLength)
+                    {
+                        return false;
+                    }
+                }
+
+                return length > 0;
+            }
+
+            // [A-Za-z0-9\s\-_\.\(\)\!\?]
+            bool isEventPartCharacter(char c)
+            {
+                return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                    c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r' ||
+                    c == '-' || c == '_' || c == '.' || c == '(' || c == ')' || c == '!' || c == '?';
+            }
+        }
+
         void GAValidator::validateBusinessEvent(
             std::string const& currency,
             std::int64_t amount,
@@ -477,7 +517,7 @@ namespace gameanalytics
 
         bool GAValidator::validateEventPartCharacters(std::string const& eventPart)
         {
-            if (!utilities::GAUtilities::stringMatch(eventPart, "^[A-Za-z0-9\\s\\-_\\.\\(\\)\\!\\?]{1,64}$"))
+            if (!matchEventParts(eventPart, 1, isEventPartCharacter))
             {
                 return false;
             }
@@ -491,7 +531,7 @@ namespace gameanalytics
                 return false;
             }
 
-            if (!utilities::GAUtilities::stringMatch(eventId, "^[^:]{1,64}(?::[^:]{1,64}){0,4}$"))
+            if (!matchEventParts(eventId, 5, [](char) { return true; }))
             {
                 return false;
             }
@@ -505,7 +545,7 @@ namespace gameanalytics
                 return false;
             }
 
-            if (!utilities::GAUtilities::stringMatch(eventId, "^[A-Za-z0-9\\s\\-_\\.\\(\\)\\!\\?]{1,64}(:[A-Za-z0-9\\s\\-_\\.\\(\\)\\!\\?]{1,64}){0,4}$"))
+            if (!matchEventParts(eventId, 5, isEventPartCharacter))
             {
                 return false;
             }
@@ -733,6 +773,64 @@ namespace gameanalytics
             return true;
         }
 
+        bool GAValidator::validateEndpoints(GAEndpointSettings const& endpoints)
+        {
+            if (!utilities::GAUtilities::stringMatch(endpoints.baseUrl, "^https?://[^/?#\\s]+$"))
+            {
+                logging::GALogger::w("Validation fail - endpoints: baseUrl must be scheme and host only, e.g. https://collector.example.com:8443. String: %s", endpoints.baseUrl.c_str());
+                return false;
+            }
+
+            if (endpoints.initPath.empty() || endpoints.initPath[0] != '/' || endpoints.eventsPath.empty() || endpoints.eventsPath[0] != '/')
+            {
+                logging::GALogger::w("Validation fail - endpoints: initPath and eventsPath must start with '/'.");
+                return false;
+            }
+
+            return true;
+        }
+
+        bool GAValidator::validateGzipLevel(int level)
+        {
+            return level >= 1 && level <= 9;
+        }
+
+        bool GAValidator::validateStoreSettings(GAStoreSettings const& settings)
+        {
+            if (settings.cacheSizeKiB < 0 || settings.mmapSizeBytes < 0)
+            {
+                logging::GALogger::w("Validation fail - store settings: sizes must not be negative.");
+                return false;
+            }
+
+            if (settings.tempStore < EGAStoreTempStore::Default || settings.tempStore > EGAStoreTempStore::Memory)
+            {
+                logging::GALogger::w("Validation fail - store settings: unknown tempStore %d.", static_cast<int>(settings.tempStore));
+                return false;
+            }
+
+            if (settings.maxSizeBytes < store::GAStore::MinDbSizeBytes)
+            {
+                logging::GALogger::w("Validation fail - store settings: maxSizeBytes must be at least %d.", static_cast<int>(store::GAStore::MinDbSizeBytes));
+                return false;
+            }
+
+            if (settings.segmentSizeBytes < store::GASegmentStore::MinSegmentSizeBytes || settings.segmentSizeBytes > store::GASegmentStore::MaxSegmentSizeBytes)
+            {
+                logging::GALogger::w("Validation fail - store settings: segmentSizeBytes must be between %d and %d.",
+                    static_cast<int>(store::GASegmentStore::MinSegmentSizeBytes), static_cast<int>(store::GASegmentStore::MaxSegmentSizeBytes));
+                return false;
+            }
+
+            if (settings.writeBatchEvents < 1 || settings.writeBatchBytes < 0 || settings.writeDelayMs < 0)
+            {
+                logging::GALogger::w("Validation fail - store settings: writeBatchEvents must be at least 1, writeBatchBytes and writeDelayMs must not be negative.");
+                return false;
+            }
+
+            return true;
+        }
+
         void GAValidator::validateAndCleanInitRequestResponse(const json& initResponse, json& out, bool configsCreated)
         {
             // make sure we have a valid dict
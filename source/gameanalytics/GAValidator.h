@@ -117,6 +117,12 @@ namespace gameanalytics
             static bool validateClientTs(int64_t clientTs);
 
             static bool validateUserId(std::string const& uId);
+
+            static bool validateEndpoints(GAEndpointSettings const& endpoints);
+
+            static bool validateGzipLevel(int level);
+
+            static bool validateStoreSettings(GAStoreSettings const& settings);
         };
     }
 }
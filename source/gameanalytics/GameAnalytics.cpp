@@ -158,6 +158,165 @@ namespace gameanalytics
 
     }
 
+    void GameAnalytics::configureStoreBackend(EGAStoreBackend backend)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([backend]()
+        {
+            if (isSdkReady(true, false))
+            {
+                logging::GALogger::w("Store backend must be set before SDK is initialized.");
+                return;
+            }
+            store::GAStore::setBackend(backend);
+        });
+    }
+
+    void GameAnalytics::configureMemoryStoreCapacity(std::size_t maxEvents)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([maxEvents]()
+        {
+            if (maxEvents == 0)
+            {
+                logging::GALogger::i("Validation fail - configure memory store capacity: Must be above 0.");
+                return;
+            }
+            store::GAStore::setMemoryCapacity(maxEvents);
+        });
+    }
+
+    void GameAnalytics::configureStoreSettings(GAStoreSettings const& settings)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([settings]()
+        {
+            if (isSdkReady(true, false))
+            {
+                logging::GALogger::w("Store settings must be set before SDK is initialized.");
+                return;
+            }
+
+            if (!validators::GAValidator::validateStoreSettings(settings))
+            {
+                logging::GALogger::i("Validation fail - configure store settings: the settings are kept as they were.");
+                return;
+            }
+
+            store::GAStore::setSettings(settings);
+        });
+    }
+
+    void GameAnalytics::configureEndpoints(GAEndpointSettings const& endpoints)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([endpoints]()
+        {
+            if (isSdkReady(true, false))
+            {
+                logging::GALogger::w("Endpoints must be set before SDK is initialized.");
+                return;
+            }
+
+            if (!validators::GAValidator::validateEndpoints(endpoints))
+            {
+                logging::GALogger::i("Validation fail - configure endpoints: baseUrl must start with http:// or https://, the paths must start with '/'.");
+                return;
+            }
+
+            http::GAHTTPApi::getInstance().setEndpoints(endpoints);
+        });
+    }
+
+    void GameAnalytics::configureTransport(std::shared_ptr<ITransport> transport)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([transport]()
+        {
+            if (isSdkReady(true, false))
+            {
+                logging::GALogger::w("Transport must be set before SDK is initialized.");
+                return;
+            }
+
+            http::GAHTTPApi::getInstance().setTransport(transport);
+        });
+    }
+
+    void GameAnalytics::configureGzipLevel(int level)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([level]()
+        {
+            if (!validators::GAValidator::validateGzipLevel(level))
+            {
+                logging::GALogger::i("Validation fail - configure gzip level: Must be between 1 and 9.");
+                return;
+            }
+            http::GAHTTPApi::getInstance().setGzipLevel(level);
+        });
+    }
+
+    void GameAnalytics::configureServerMode(bool enabled)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([enabled]()
+        {
+            if (isSdkReady(true, false))
+            {
+                logging::GALogger::w("Server mode must be set before SDK is initialized.");
+                return;
+            }
+            state::GAState::setServerMode(enabled);
+        });
+    }
+
+    void GameAnalytics::configureMaxResidentUsers(std::size_t maxUsers)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([maxUsers]()
+        {
+            if (maxUsers == 0)
+            {
+                logging::GALogger::i("Validation fail - configure max resident users: Must be above 0.");
+                return;
+            }
+            state::GAState::setMaxResidentUsers(maxUsers);
+        });
+    }
+
     void GameAnalytics::configureBuildPlatform(std::string const& platform)
     {
         if(_endThread)
@@ -357,7 +516,8 @@ namespace gameanalytics
             return;
         }
         
-        threading::GAThreading::performTaskOnGAThread([gameKey, gameSecret]()
+        // events added right after are only accepted once this has run, it does not wait for the next pass
+        threading::GAThreading::performTaskOnGAThreadNow([gameKey, gameSecret]()
         {
             if (isSdkReady(true, false))
             {
@@ -572,6 +732,330 @@ namespace gameanalytics
         });
     }
 
+    // ----------------------- SERVER MODE ---------------------- //
+
+    void GameAnalytics::startUserSession(GAUser const& user)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([user]()
+        {
+            if (!isUserReady(user, "Could not start user session") || !isSdkReady(true, true, "Could not start user session"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            state::GAState::startUserSession();
+        });
+    }
+
+    void GameAnalytics::endUserSession(GAUser const& user)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([user]()
+        {
+            if (!isUserReady(user, "Could not end user session"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            state::GAState::endUserSession();
+        });
+    }
+
+    void GameAnalytics::setUserCustomDimension01(GAUser const& user, std::string const& dimension_)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        std::string dimension = utilities::trimString(dimension_, maxDimensionSize);
+
+        threading::GAThreading::performTaskOnGAThread([user, dimension]()
+        {
+            if (!isUserReady(user, "Could not set custom01 dimension"))
+            {
+                return;
+            }
+
+            if (!validators::GAValidator::validateDimension01(dimension))
+            {
+                logging::GALogger::w("Could not set custom01 dimension value to '%s'. Value not found in available custom01 dimension values", dimension.c_str());
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            state::GAState::setCustomDimension01(dimension);
+        });
+    }
+
+    void GameAnalytics::setUserCustomDimension02(GAUser const& user, std::string const& dimension_)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        std::string dimension = utilities::trimString(dimension_, maxDimensionSize);
+
+        threading::GAThreading::performTaskOnGAThread([user, dimension]()
+        {
+            if (!isUserReady(user, "Could not set custom02 dimension"))
+            {
+                return;
+            }
+
+            if (!validators::GAValidator::validateDimension02(dimension))
+            {
+                logging::GALogger::w("Could not set custom02 dimension value to '%s'. Value not found in available custom02 dimension values", dimension.c_str());
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            state::GAState::setCustomDimension02(dimension);
+        });
+    }
+
+    void GameAnalytics::setUserCustomDimension03(GAUser const& user, std::string const& dimension_)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        std::string dimension = utilities::trimString(dimension_, maxDimensionSize);
+
+        threading::GAThreading::performTaskOnGAThread([user, dimension]()
+        {
+            if (!isUserReady(user, "Could not set custom03 dimension"))
+            {
+                return;
+            }
+
+            if (!validators::GAValidator::validateDimension03(dimension))
+            {
+                logging::GALogger::w("Could not set custom03 dimension value to '%s'. Value not found in available custom03 dimension values", dimension.c_str());
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            state::GAState::setCustomDimension03(dimension);
+        });
+    }
+
+    void GameAnalytics::addBusinessEvent(
+        GAUser const& user,
+        std::string const& currency,
+        int amount,
+        std::string const& itemType,
+        std::string const& itemId,
+        std::string const& cartType,
+        std::string const& fields,
+        bool mergeFields)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([=]()
+        {
+            if (!isUserReady(user, "Could not add business event"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            if (!isSdkReady(true, true, "Could not add business event"))
+            {
+                return;
+            }
+
+            try
+            {
+                json fieldsJson = utilities::parseFields(fields);
+                events::GAEvents::addBusinessEvent(currency, amount, itemType, itemId, cartType, fieldsJson, mergeFields);
+            }
+            catch(std::exception const& e)
+            {
+                logging::GALogger::e("addBusinessEvent - Exception thrown: %s", e.what());
+            }
+        });
+    }
+
+    void GameAnalytics::addResourceEvent(GAUser const& user, EGAResourceFlowType flowType, std::string const& currency, float amount, std::string const& itemType, std::string const& itemId, std::string const& fields, bool mergeFields)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([=]()
+        {
+            if (!isUserReady(user, "Could not add resource event"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            if (!isSdkReady(true, true, "Could not add resource event"))
+            {
+                return;
+            }
+
+            try
+            {
+                json fieldsJson = utilities::parseFields(fields);
+                events::GAEvents::addResourceEvent(flowType, currency, amount, itemType, itemId, fieldsJson, mergeFields);
+            }
+            catch (std::exception& e)
+            {
+                logging::GALogger::e(e.what());
+            }
+        });
+    }
+
+    void GameAnalytics::addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, int score, std::string const& progression01, std::string const& progression02, std::string const& progression03, std::string const& fields, bool mergeFields)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        if(fields.size() > maxFieldsSize)
+        {
+            logging::GALogger::w("Custom fields length exceeded, maximum allowed is %d, fields' size was %d", maxFieldsSize, fields.size());
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([=]()
+        {
+            if (!isUserReady(user, "Could not add progression event"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            if (!isSdkReady(true, true, "Could not add progression event"))
+            {
+                return;
+            }
+
+            try
+            {
+                json fieldsJson = utilities::parseFields(fields);
+                events::GAEvents::addProgressionEvent(progressionStatus, progression01, progression02, progression03, score, true, fieldsJson, mergeFields);
+            }
+            catch(std::exception const& e)
+            {
+                logging::GALogger::e("Exception thrown: %s", e.what());
+            }
+        });
+    }
+
+    void GameAnalytics::addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, std::string const& progression01, std::string const& progression02, std::string const& progression03, std::string const& fields, bool mergeFields)
+    {
+        return addProgressionEvent(user, progressionStatus, 0, progression01, progression02, progression03, fields, mergeFields);
+    }
+
+    void GameAnalytics::addDesignEvent(GAUser const& user, std::string const& eventId, double value, std::string const& fields, bool mergeFields)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        if(fields.size() > maxFieldsSize)
+        {
+            logging::GALogger::w("Custom fields length exceeded, maximum allowed is %d, fields size was %d", maxFieldsSize, fields.size());
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([=]()
+        {
+            if (!isUserReady(user, "Could not add design event"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            if (!isSdkReady(true, true, "Could not add design event"))
+            {
+                return;
+            }
+
+            try
+            {
+                json fieldsJson = utilities::parseFields(fields);
+                events::GAEvents::addDesignEvent(eventId, value, true, fieldsJson, mergeFields);
+            }
+            catch(json::exception const& e)
+            {
+                logging::GALogger::e("addDesignEvent - Failed to parse fields: %s", e.what());
+            }
+        });
+    }
+
+    void GameAnalytics::addDesignEvent(GAUser const& user, std::string const& eventId, std::string const& fields, bool mergeFields)
+    {
+        return addDesignEvent(user, eventId, 0.0, fields, mergeFields);
+    }
+
+    void GameAnalytics::addErrorEvent(GAUser const& user, EGAErrorSeverity severity, std::string const& message_, std::string const& fields, bool mergeFields)
+    {
+        if(_endThread)
+        {
+            return;
+        }
+
+        const std::string message = utilities::trimString(message_, maxErrMsgSize);
+
+        std::pair<std::string, int32_t> inFunction = utilities::getRelevantFunctionFromCallStack();
+
+        const std::string function = inFunction.first;
+        const int32_t     line     = inFunction.second;
+
+        if(fields.size() > maxFieldsSize)
+        {
+            logging::GALogger::w("Custom fields length exceeded, maximum allowed is %d, fields' size was %d", maxFieldsSize, fields.size());
+            return;
+        }
+
+        threading::GAThreading::performTaskOnGAThread([=]()
+        {
+            if (!isUserReady(user, "Could not add error event"))
+            {
+                return;
+            }
+
+            state::GAState::UserScope scope(user.id);
+            if (!isSdkReady(true, true, "Could not add error event"))
+            {
+                return;
+            }
+
+            try
+            {
+                json fieldsJson = utilities::parseFields(fields);
+                events::GAEvents::addErrorEvent(severity, message, function, line, fieldsJson, mergeFields);
+            }
+            catch(std::exception& e)
+            {
+                logging::GALogger::e("Failed to parse custom fields: %s", e.what());
+            }
+        });
+    }
+
     // ------------- SET STATE CHANGES WHILE RUNNING ----------------- //
 
     void GameAnalytics::setEnabledInfoLog(bool flag)
@@ -941,6 +1425,23 @@ namespace gameanalytics
         return true;
     }
 
+    bool GameAnalytics::isUserReady(GAUser const& user, std::string const& message)
+    {
+        if (!state::GAState::isServerMode())
+        {
+            logging::GALogger::w("%s; Server mode is not enabled", message.c_str());
+            return false;
+        }
+
+        if (user.id.empty())
+        {
+            logging::GALogger::w("%s; User id is empty", message.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
     void GameAnalytics::enableSDKInitEvent(bool value)
     {
         GAHealth* healthTracker = device::GADevice::getHealthTracker();
@@ -988,6 +1489,15 @@ namespace gameanalytics
         }
     }
 
+    void GameAnalytics::enableQueueStatsInHealthEvent(bool value)
+    {
+        events::GAEvents::getInstance().enableQueueStatsInHealthEvent = value;
+        if(value)
+        {
+            events::GAEvents::getInstance().enableHealthEvent = true;
+        }
+    }
+
     int64_t GameAnalytics::getElapsedTimeFromAllSessions()
     {
         return state::GAState::getInstance().getTotalSessionLength();
@@ -1003,4 +1513,9 @@ namespace gameanalytics
         return state::GAState::getInstance().getLastSessionLength();
     }
 
+    GAQueueStats GameAnalytics::getQueueStats()
+    {
+        return store::GAStore::getQueueStats(state::GAState::getClientTsAdjusted());
+    }
+
 } // namespace gameanalytics
@@ -293,6 +293,24 @@ long long gameAnalytics_getElapsedTimeForPreviousSession()
     return gameanalytics::GameAnalytics::getElapsedTimeForPreviousSession();
 }
 
+const char* gameAnalytics_getQueueStats()
+{
+    const gameanalytics::GAQueueStats stats = gameanalytics::GameAnalytics::getQueueStats();
+
+    gameanalytics::json out;
+    out["queued_events"]            = stats.queuedEvents;
+    out["in_flight_events"]         = stats.inFlightEvents;
+    out["pending_writes"]           = stats.pendingWrites;
+    out["size_bytes"]               = stats.sizeBytes;
+    out["oldest_event_age_seconds"] = stats.oldestEventAgeSeconds;
+    out["evicted_events"]           = stats.evictedEvents;
+    out["dropped_events"]           = stats.droppedEvents;
+    out["events_by_category"]       = stats.eventsByCategory;
+    out["bytes_by_category"]        = stats.bytesByCategory;
+
+    return gameAnalytics_allocString(out.dump());
+}
+
 void gameAnalytics_enableSDKInitEvent(GAStatus status)
 {
     return gameanalytics::GameAnalytics::enableSDKInitEvent(status);
@@ -319,4 +337,9 @@ void gameAnalytics_enableHardwareTracking(GAStatus status)
     return gameanalytics::GameAnalytics::enableHardwareTracking(status);
 }
 
+void gameAnalytics_enableQueueStatsInHealthEvent(GAStatus status)
+{
+    return gameanalytics::GameAnalytics::enableQueueStatsInHealthEvent(status);
+}
+
 #endif
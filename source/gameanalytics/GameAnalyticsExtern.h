@@ -132,10 +132,14 @@ GA_API long long gameAnalytics_getElapsedSessionTime();
 GA_API long long gameAnalytics_getElapsedTimeFromAllSessions();
 GA_API long long gameAnalytics_getElapsedTimeForPreviousSession();
 
+// GameAnalytics::getQueueStats as a JSON object
+GA_API const char* gameAnalytics_getQueueStats();
+
 GA_API void gameAnalytics_enableSDKInitEvent(GAStatus status);
 GA_API void gameAnalytics_enableMemoryHistogram(GAStatus status);
 GA_API void gameAnalytics_enableFPSHistogram(GAFpsTracker tracker, GAStatus status);
 GA_API void gameAnalytics_enableHardwareTracking(GAStatus status);
+GA_API void gameAnalytics_enableQueueStatsInHealthEvent(GAStatus status);
 
 #ifdef __cplusplus
 }
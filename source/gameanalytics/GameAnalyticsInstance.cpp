@@ -0,0 +1,500 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include "GameAnalytics/GameAnalyticsInstance.h"
+#include "GameAnalytics/GameAnalytics.h"
+
+#include "GAState.h"
+#include "GAThreading.h"
+
+namespace gameanalytics
+{
+    // every call binds this instance to the calling thread and forwards to the static API,
+    // work queued from there stays bound to it on the shared GA thread
+
+    GameAnalyticsInstance::GameAnalyticsInstance(std::string const& name):
+        _name(name),
+        _state(new state::GAState(name))
+    {
+    }
+
+    GameAnalyticsInstance::~GameAnalyticsInstance()
+    {
+        delete _state;
+    }
+
+    std::string const& GameAnalyticsInstance::getName() const
+    {
+        return _name;
+    }
+
+    void GameAnalyticsInstance::configureAvailableCustomDimensions01(const StringVector &customDimensions)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureAvailableCustomDimensions01(customDimensions);
+    }
+
+    void GameAnalyticsInstance::configureAvailableCustomDimensions02(const StringVector &customDimensions)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureAvailableCustomDimensions02(customDimensions);
+    }
+
+    void GameAnalyticsInstance::configureAvailableCustomDimensions03(const StringVector &customDimensions)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureAvailableCustomDimensions03(customDimensions);
+    }
+
+    void GameAnalyticsInstance::configureAvailableResourceCurrencies(const StringVector &resourceCurrencies)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureAvailableResourceCurrencies(resourceCurrencies);
+    }
+
+    void GameAnalyticsInstance::configureAvailableResourceItemTypes(const StringVector &resourceItemTypes)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureAvailableResourceItemTypes(resourceItemTypes);
+    }
+
+    void GameAnalyticsInstance::configureBuild(std::string const& build)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureBuild(build);
+    }
+
+    void GameAnalyticsInstance::configureWritablePath(std::string const& writablePath)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureWritablePath(writablePath);
+    }
+
+    void GameAnalyticsInstance::configureStoreBackend(EGAStoreBackend backend)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureStoreBackend(backend);
+    }
+
+    void GameAnalyticsInstance::configureMemoryStoreCapacity(std::size_t maxEvents)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureMemoryStoreCapacity(maxEvents);
+    }
+
+    void GameAnalyticsInstance::configureStoreSettings(GAStoreSettings const& settings)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureStoreSettings(settings);
+    }
+
+    void GameAnalyticsInstance::configureEndpoints(GAEndpointSettings const& endpoints)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureEndpoints(endpoints);
+    }
+
+    void GameAnalyticsInstance::configureTransport(std::shared_ptr<ITransport> transport)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureTransport(std::move(transport));
+    }
+
+    void GameAnalyticsInstance::configureGzipLevel(int level)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureGzipLevel(level);
+    }
+
+    void GameAnalyticsInstance::configureServerMode(bool enabled)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureServerMode(enabled);
+    }
+
+    void GameAnalyticsInstance::configureMaxResidentUsers(std::size_t maxUsers)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureMaxResidentUsers(maxUsers);
+    }
+
+    void GameAnalyticsInstance::configureBuildPlatform(std::string const& platform)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureBuildPlatform(platform);
+    }
+
+    void GameAnalyticsInstance::configureCustomLogHandler(const LogHandler &logHandler)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureCustomLogHandler(logHandler);
+    }
+
+    void GameAnalyticsInstance::disableDeviceInfo()
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::disableDeviceInfo();
+    }
+
+    void GameAnalyticsInstance::configureDeviceModel(std::string const& deviceModel)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureDeviceModel(deviceModel);
+    }
+
+    void GameAnalyticsInstance::configureDeviceManufacturer(std::string const& deviceManufacturer)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureDeviceManufacturer(deviceManufacturer);
+    }
+
+    void GameAnalyticsInstance::configureSdkGameEngineVersion(std::string const& sdkGameEngineVersion)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureSdkGameEngineVersion(sdkGameEngineVersion);
+    }
+
+    void GameAnalyticsInstance::configureGameEngineVersion(std::string const& engineVersion)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureGameEngineVersion(engineVersion);
+    }
+
+    void GameAnalyticsInstance::configureUserId(std::string const& uId)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureUserId(uId);
+    }
+
+    void GameAnalyticsInstance::configureExternalUserId(std::string const& extId)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::configureExternalUserId(extId);
+    }
+
+    void GameAnalyticsInstance::initialize(std::string const& gameKey, std::string const& gameSecret)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::initialize(gameKey, gameSecret);
+    }
+
+    void GameAnalyticsInstance::addBusinessEvent(std::string const& currency, int amount, std::string const& itemType, std::string const& itemId, std::string const& cartType, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addBusinessEvent(currency, amount, itemType, itemId, cartType, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addResourceEvent(EGAResourceFlowType flowType, std::string const& currency, float amount, std::string const& itemType, std::string const& itemId, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addResourceEvent(flowType, currency, amount, itemType, itemId, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addProgressionEvent(EGAProgressionStatus progressionStatus, std::string const& progression01, std::string const& progression02, std::string const& progression03, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addProgressionEvent(progressionStatus, progression01, progression02, progression03, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addProgressionEvent(EGAProgressionStatus progressionStatus, int score, std::string const& progression01, std::string const& progression02, std::string const& progression03, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addProgressionEvent(progressionStatus, score, progression01, progression02, progression03, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addDesignEvent(std::string const& eventId, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addDesignEvent(eventId, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addDesignEvent(std::string const& eventId, double value, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addDesignEvent(eventId, value, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addErrorEvent(EGAErrorSeverity severity, std::string const& message, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addErrorEvent(severity, message, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::startUserSession(GAUser const& user)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::startUserSession(user);
+    }
+
+    void GameAnalyticsInstance::endUserSession(GAUser const& user)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::endUserSession(user);
+    }
+
+    void GameAnalyticsInstance::setUserCustomDimension01(GAUser const& user, std::string const& dimension01)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setUserCustomDimension01(user, dimension01);
+    }
+
+    void GameAnalyticsInstance::setUserCustomDimension02(GAUser const& user, std::string const& dimension02)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setUserCustomDimension02(user, dimension02);
+    }
+
+    void GameAnalyticsInstance::setUserCustomDimension03(GAUser const& user, std::string const& dimension03)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setUserCustomDimension03(user, dimension03);
+    }
+
+    void GameAnalyticsInstance::addBusinessEvent(GAUser const& user, std::string const& currency, int amount, std::string const& itemType, std::string const& itemId, std::string const& cartType, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addBusinessEvent(user, currency, amount, itemType, itemId, cartType, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addResourceEvent(GAUser const& user, EGAResourceFlowType flowType, std::string const& currency, float amount, std::string const& itemType, std::string const& itemId, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addResourceEvent(user, flowType, currency, amount, itemType, itemId, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, std::string const& progression01, std::string const& progression02, std::string const& progression03, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addProgressionEvent(user, progressionStatus, progression01, progression02, progression03, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addProgressionEvent(GAUser const& user, EGAProgressionStatus progressionStatus, int score, std::string const& progression01, std::string const& progression02, std::string const& progression03, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addProgressionEvent(user, progressionStatus, score, progression01, progression02, progression03, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addDesignEvent(GAUser const& user, std::string const& eventId, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addDesignEvent(user, eventId, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addDesignEvent(GAUser const& user, std::string const& eventId, double value, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addDesignEvent(user, eventId, value, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::addErrorEvent(GAUser const& user, EGAErrorSeverity severity, std::string const& message, std::string const& customFields, bool mergeFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addErrorEvent(user, severity, message, customFields, mergeFields);
+    }
+
+    void GameAnalyticsInstance::setEnabledInfoLog(bool flag)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setEnabledInfoLog(flag);
+    }
+
+    void GameAnalyticsInstance::setEnabledVerboseLog(bool flag)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setEnabledVerboseLog(flag);
+    }
+
+    void GameAnalyticsInstance::setEnabledManualSessionHandling(bool flag)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setEnabledManualSessionHandling(flag);
+    }
+
+    void GameAnalyticsInstance::setEnabledErrorReporting(bool flag)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setEnabledErrorReporting(flag);
+    }
+
+    void GameAnalyticsInstance::setEnabledEventSubmission(bool flag)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setEnabledEventSubmission(flag);
+    }
+
+    void GameAnalyticsInstance::setCustomDimension01(std::string const& dimension01)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setCustomDimension01(dimension01);
+    }
+
+    void GameAnalyticsInstance::setCustomDimension02(std::string const& dimension02)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setCustomDimension02(dimension02);
+    }
+
+    void GameAnalyticsInstance::setCustomDimension03(std::string const& dimension03)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setCustomDimension03(dimension03);
+    }
+
+    void GameAnalyticsInstance::setGlobalCustomEventFields(std::string const& customFields)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::setGlobalCustomEventFields(customFields);
+    }
+
+    void GameAnalyticsInstance::enableSDKInitEvent(bool value)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::enableSDKInitEvent(value);
+    }
+
+    void GameAnalyticsInstance::enableMemoryHistogram(bool value)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::enableMemoryHistogram(value);
+    }
+
+    void GameAnalyticsInstance::enableFPSHistogram(FPSTracker fpsTracker, bool value)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::enableFPSHistogram(fpsTracker, value);
+    }
+
+    void GameAnalyticsInstance::enableHardwareTracking(bool value)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::enableHardwareTracking(value);
+    }
+
+    void GameAnalyticsInstance::enableQueueStatsInHealthEvent(bool value)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::enableQueueStatsInHealthEvent(value);
+    }
+
+    void GameAnalyticsInstance::startSession()
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::startSession();
+    }
+
+    void GameAnalyticsInstance::endSession()
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::endSession();
+    }
+
+    std::string GameAnalyticsInstance::getRemoteConfigsValueAsString(std::string const& key, std::string const& defaultValue)
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getRemoteConfigsValueAsString(key, defaultValue);
+    }
+
+    std::string GameAnalyticsInstance::getRemoteConfigsValueAsJson(std::string const& key)
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getRemoteConfigsValueAsJson(key);
+    }
+
+    bool GameAnalyticsInstance::isRemoteConfigsReady()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::isRemoteConfigsReady();
+    }
+
+    void GameAnalyticsInstance::addRemoteConfigsListener(const std::shared_ptr<IRemoteConfigsListener> &listener)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::addRemoteConfigsListener(listener);
+    }
+
+    void GameAnalyticsInstance::removeRemoteConfigsListener(const std::shared_ptr<IRemoteConfigsListener> &listener)
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::removeRemoteConfigsListener(listener);
+    }
+
+    std::string GameAnalyticsInstance::getRemoteConfigsContentAsString()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getRemoteConfigsContentAsString();
+    }
+
+    std::string GameAnalyticsInstance::getUserId()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getUserId();
+    }
+
+    std::string GameAnalyticsInstance::getExternalUserId()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getExternalUserId();
+    }
+
+    std::string GameAnalyticsInstance::getABTestingId()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getABTestingId();
+    }
+
+    std::string GameAnalyticsInstance::getABTestingVariantId()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getABTestingVariantId();
+    }
+
+    int64_t GameAnalyticsInstance::getElapsedSessionTime()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getElapsedSessionTime();
+    }
+
+    int64_t GameAnalyticsInstance::getElapsedTimeFromAllSessions()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getElapsedTimeFromAllSessions();
+    }
+
+    int64_t GameAnalyticsInstance::getElapsedTimeForPreviousSession()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getElapsedTimeForPreviousSession();
+    }
+
+    GAQueueStats GameAnalyticsInstance::getQueueStats()
+    {
+        state::GAState::Scope scope(_state);
+        return GameAnalytics::getQueueStats();
+    }
+
+    void GameAnalyticsInstance::onResume()
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::onResume();
+    }
+
+    void GameAnalyticsInstance::onSuspend()
+    {
+        state::GAState::Scope scope(_state);
+        GameAnalytics::onSuspend();
+    }
+
+    void GameAnalyticsInstance::onQuit()
+    {
+        state::GAState::Scope scope(_state);
+
+        threading::GAThreading::getInstance().releaseOwner(_state,
+            []()
+            {
+                state::GAState::endSessionAndStopQueue(false);
+            }
+        );
+    }
+}
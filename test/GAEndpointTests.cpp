@@ -0,0 +1,126 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "GameAnalytics/GameAnalyticsInstance.h"
+#include "GAUtilities.h"
+#include "helpers/GATestHelpers.h"
+
+#if !defined(_WIN32)
+
+#include <GAMockCollector.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using gameanalytics::GameAnalyticsInstance;
+using gameanalytics::mock::GAMockCollector;
+
+namespace
+{
+    constexpr const char* GameKey   = "bd624ee6f8e6efb32a054f8d7ba11618";
+    constexpr const char* SecretKey = "7f5c3f682cbd217841efba92e92ffb1b3b6612bc";
+
+    gameanalytics::GAEndpointSettings endpointsOf(GAMockCollector const& collector)
+    {
+        gameanalytics::GAEndpointSettings endpoints;
+        endpoints.baseUrl = collector.baseUrl();
+        return endpoints;
+    }
+}
+
+TEST(GAEndpoint, testSendsToConfiguredCollector)
+{
+    GAMockCollector::Settings settings;
+    settings.keys[GameKey] = SecretKey;
+    GAMockCollector collector(settings);
+    ASSERT_TRUE(collector.start());
+
+    GameAnalyticsInstance instance("endpoint_collector");
+    instance.configureEndpoints(endpointsOf(collector));
+    instance.configureBuild("endpoint 1.0");
+    instance.initialize(GameKey, SecretKey);
+
+    // the init call, then the session start that goes out right after it
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return collector.stats().initRequests >= 1; }));
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return collector.stats().eventsByCategory["user"] >= 1; }));
+
+    const GAMockCollector::Stats stats = collector.stats();
+    ASSERT_EQ(0, stats.unauthorized);
+    ASSERT_EQ(0, stats.badRequests);
+}
+
+TEST(GAEndpoint, testCollectorChecksSignature)
+{
+    GAMockCollector::Settings settings;
+    settings.keys[GameKey] = "0000000000000000000000000000000000000000";
+    GAMockCollector collector(settings);
+    ASSERT_TRUE(collector.start());
+
+    GameAnalyticsInstance instance("endpoint_signature");
+    instance.configureEndpoints(endpointsOf(collector));
+    instance.configureBuild("endpoint 1.0");
+    instance.initialize(GameKey, SecretKey);
+
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return collector.stats().unauthorized >= 1; }));
+    ASSERT_EQ(0, collector.stats().initRequests);
+}
+
+TEST(GAEndpoint, testDestroyDoesNotWaitForInitCall)
+{
+    // accepts connections (in the backlog) and never answers
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    ASSERT_EQ(0, listen(listener, 16));
+    socklen_t length = sizeof(addr);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &length);
+
+    gameanalytics::GAEndpointSettings endpoints;
+    endpoints.baseUrl = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+
+    auto instance = std::make_shared<GameAnalyticsInstance>("endpoint_silent");
+    instance->configureEndpoints(endpoints);
+    instance->configureBuild("endpoint 1.0");
+    instance->initialize(GameKey, SecretKey);
+
+    // the init call is out and will get no answer
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // a hang fails the test instead of blocking it
+    auto destroyed = std::make_shared<std::promise<void>>();
+    std::thread([instance = std::move(instance), destroyed]() mutable
+    {
+        instance.reset();
+        destroyed->set_value();
+    }).detach();
+
+    ASSERT_EQ(std::future_status::ready, destroyed->get_future().wait_for(std::chrono::seconds(10)));
+    close(listener);
+}
+
+TEST(GAEndpoint, testGunzipsPayload)
+{
+    const std::string text = "[{\"category\":\"design\",\"event_id\":\"level:start\"}]";
+    const std::vector<uint8_t> compressed = gameanalytics::utilities::GAUtilities::gzipCompress(text.c_str());
+
+    std::string inflated;
+    bool trailerMatches = false;
+    ASSERT_TRUE(GAMockCollector::gunzip(compressed, inflated, trailerMatches));
+    ASSERT_TRUE(trailerMatches);
+    ASSERT_EQ(text, inflated);
+
+    ASSERT_FALSE(GAMockCollector::gunzip(std::vector<uint8_t>(text.begin(), text.end()), inflated, trailerMatches));
+}
+
+#endif
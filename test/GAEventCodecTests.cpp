@@ -0,0 +1,77 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <GAEventCodec.h>
+
+using gameanalytics::store::GAEventCodec;
+
+namespace
+{
+    const std::string DesignEvent = R"({"category":"design","client_ts":1792357418,"connection_type":"wifi","current_session_length":36,"device":"unknown","event_id":"combat:kill:goblin","event_uuid":"aa2127a7-cb0a-4ff4-a9e1-063e33784068","lifetime_session_length":1346,"manufacturer":"unknown","os_version":"linux 6.18.44","platform":"linux","sdk_version":"cpp 5.1.0","session_id":"1292b594-ee05-4df2-ba52-22ae45cc9a00","session_num":15,"user_id":"62376336-6335-3938-2d61-3463622d3638","v":2,"value":12.5})";
+}
+
+TEST(GAEventCodec, testRoundTrip)
+{
+    const std::string stored = GAEventCodec::encode(DesignEvent);
+    ASSERT_EQ(GAEventCodec::FormatDeflateV1, static_cast<uint8_t>(stored[0]));
+
+    // the dictionary covers everything but the ids and numbers
+    ASSERT_LT(stored.size() * 3, DesignEvent.size());
+
+    std::string decoded;
+    ASSERT_TRUE(GAEventCodec::decode(stored, decoded));
+    ASSERT_EQ(DesignEvent, decoded);
+
+    // the compressor is reused between events
+    ASSERT_EQ(stored, GAEventCodec::encode(DesignEvent));
+}
+
+TEST(GAEventCodec, testRawAndLegacyRows)
+{
+    // too short to gain anything
+    const std::string stored = GAEventCodec::encode("{}");
+    ASSERT_EQ(GAEventCodec::FormatRaw, static_cast<uint8_t>(stored[0]));
+
+    std::string decoded;
+    ASSERT_TRUE(GAEventCodec::decode(stored, decoded));
+    ASSERT_EQ("{}", decoded);
+
+    // rows written before the format byte existed
+    ASSERT_TRUE(GAEventCodec::decode(DesignEvent, decoded));
+    ASSERT_EQ(DesignEvent, decoded);
+}
+
+TEST(GAEventCodec, testDamagedRows)
+{
+    std::string decoded;
+    ASSERT_FALSE(GAEventCodec::decode("", decoded));
+    ASSERT_FALSE(GAEventCodec::decode("\x7f" "abc", decoded));
+
+    std::string stored = GAEventCodec::encode(DesignEvent);
+    stored.resize(stored.size() / 2);
+    ASSERT_FALSE(GAEventCodec::decode(stored, decoded));
+}
+
+TEST(GAEventCodec, testBatchMatchesSingleEvents)
+{
+    std::string other = DesignEvent;
+    other.replace(other.find("goblin"), 6, "dragon");
+
+    const std::vector<std::string> events = { DesignEvent, "{}", other, DesignEvent };
+    const std::vector<std::string> stored = GAEventCodec::encode(events);
+
+    // every event starts from the same primed state, whatever was compressed before it
+    ASSERT_EQ(events.size(), stored.size());
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        ASSERT_EQ(GAEventCodec::encode(events[i]), stored[i]);
+
+        std::string decoded;
+        ASSERT_TRUE(GAEventCodec::decode(stored[i], decoded));
+        ASSERT_EQ(events[i], decoded);
+    }
+}
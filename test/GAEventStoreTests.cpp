@@ -0,0 +1,426 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <filesystem>
+
+#include <GASqliteStore.h>
+#include <GAMemoryStore.h>
+#include <GASegmentStore.h>
+
+#include "helpers/GAEventStoreConformance.h"
+
+using gameanalytics::json;
+using gameanalytics::StringVector;
+using gameanalytics::store::IEventStore;
+using gameanalytics::store::EventRecord;
+using gameanalytics::store::SessionCheckpoint;
+using gameanalytics::store::GASqliteStore;
+using gameanalytics::store::GAMemoryStore;
+using gameanalytics::store::GASegmentStore;
+
+namespace
+{
+    // a design event with the annotations a store may keep once per session
+    json makeEvent(int n, std::string const& category = "design")
+    {
+        json ev;
+        ev["category"]   = category;
+        ev["event_id"]   = "level:" + std::to_string(n);
+        ev["client_ts"]  = 1700000000 + n;
+        ev["session_id"] = "s1";
+        ev["user_id"]    = "u1";
+        ev["v"]          = 2;
+        return ev;
+    }
+
+    void append(IEventStore& store, json const& ev)
+    {
+        store.append(ev["category"].get<std::string>(), ev["session_id"].get<std::string>(), ev["client_ts"].get<int64_t>(), ev);
+    }
+
+    // a makeEvent with 1 KB that does not compress, so every backend's quota counts it in full
+    json makePaddedEvent(int n)
+    {
+        std::string padding(1024, ' ');
+        uint32_t seed = static_cast<uint32_t>(n) * 2654435761u + 1;
+        for (char& c : padding)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            c = static_cast<char>('a' + (seed >> 24) % 26);
+        }
+
+        json ev = makeEvent(n);
+        ev["padding"] = padding;
+        return ev;
+    }
+
+    std::vector<json> parse(StringVector const& events)
+    {
+        std::vector<json> parsed;
+        for (std::string const& event : events)
+        {
+            parsed.push_back(json::parse(event));
+        }
+
+        return parsed;
+    }
+
+    std::unique_ptr<IEventStore> openSqlite(gameanalytics::GAStoreSettings const& settings)
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "ga_event_store_tests.sqlite3").string();
+
+        std::unique_ptr<GASqliteStore> store(new GASqliteStore());
+        store->setSettings(settings);
+        if (!store->open(path, true))
+        {
+            return nullptr;
+        }
+        return store;
+    }
+
+    std::unique_ptr<IEventStore> openSegmentLog(gameanalytics::GAStoreSettings const& settings)
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "ga_event_store_tests_log").string();
+
+        std::unique_ptr<GASegmentStore> store(new GASegmentStore());
+        store->setSettings(settings);
+        if (!store->open(path, true))
+        {
+            return nullptr;
+        }
+        return store;
+    }
+}
+
+TEST_P(GAEventStoreConformance, testClaimsOldestFirst)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        append(*store, makeEvent(i));
+    }
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "", 2, out));
+    ASSERT_THAT(parse(out), ::testing::ElementsAre(makeEvent(0), makeEvent(1)));
+
+    // claimed events are not handed out twice
+    StringVector again;
+    ASSERT_TRUE(store->claimBatch("req2", "", 10, again));
+    ASSERT_THAT(parse(again), ::testing::ElementsAre(makeEvent(2)));
+
+    StringVector none;
+    ASSERT_FALSE(store->claimBatch("req3", "", 10, none));
+    ASSERT_TRUE(none.empty());
+}
+
+TEST_P(GAEventStoreConformance, testClaimFiltersCategory)
+{
+    append(*store, makeEvent(0, "design"));
+    append(*store, makeEvent(1, "business"));
+    append(*store, makeEvent(2, "design"));
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "business", 10, out));
+    ASSERT_THAT(parse(out), ::testing::ElementsAre(makeEvent(1, "business")));
+
+    StringVector none;
+    ASSERT_FALSE(store->claimBatch("req2", "user", 10, none));
+}
+
+TEST_P(GAEventStoreConformance, testAckRemovesBatch)
+{
+    append(*store, makeEvent(0));
+    append(*store, makeEvent(1));
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "", 1, out));
+    store->ackBatch("req1");
+
+    // acked events stay gone, putting everything back only restores the other one
+    store->putBackAll();
+
+    StringVector rest;
+    ASSERT_TRUE(store->claimBatch("req2", "", 10, rest));
+    ASSERT_THAT(parse(rest), ::testing::ElementsAre(makeEvent(1)));
+
+    // acking an unknown request is harmless
+    store->ackBatch("unknown");
+}
+
+TEST_P(GAEventStoreConformance, testPutBackBatch)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        append(*store, makeEvent(i));
+    }
+
+    StringVector first;
+    ASSERT_TRUE(store->claimBatch("req1", "", 2, first));
+    store->putBackBatch("req1");
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req2", "", 10, out));
+    ASSERT_THAT(parse(out), ::testing::ElementsAre(makeEvent(0), makeEvent(1), makeEvent(2)));
+
+    store->putBackAll();
+
+    StringVector all;
+    ASSERT_TRUE(store->claimBatch("req3", "", 10, all));
+    ASSERT_EQ(3u, all.size());
+}
+
+TEST_P(GAEventStoreConformance, testState)
+{
+    ASSERT_EQ("", store->getState("session_num"));
+
+    store->setState("session_num", "1");
+    store->setState("session_num", "2");
+    ASSERT_EQ("2", store->getState("session_num"));
+
+    store->setState("session_num", "");
+    ASSERT_EQ("", store->getState("session_num"));
+}
+
+TEST_P(GAEventStoreConformance, testStateKeysByPrefix)
+{
+    store->setState("user_b", "2");
+    store->setState("user_a", "1");
+    store->setState("userX", "3");
+    store->setState("other", "4");
+    store->setState("user`", "5");
+    store->setState("user_\xff", "6");
+
+    // the prefix is matched literally ('_' is no wildcard), up to the key right above its range
+    ASSERT_THAT(store->getStateKeys("user_"), ::testing::ElementsAre("user_a", "user_b", "user_\xff"));
+    ASSERT_THAT(store->getStateKeys("user_\xff"), ::testing::ElementsAre("user_\xff"));
+    ASSERT_TRUE(store->getStateKeys("missing").empty());
+}
+
+TEST_P(GAEventStoreConformance, testProgressionTries)
+{
+    store->setProgressionTries("Start:world1", 1);
+    store->setProgressionTries("Start:world2", 3);
+    store->setProgressionTries("Start:world1", 2);
+    store->setProgressionTries("Start:world2", 0);
+
+    std::vector<std::pair<std::string, int>> tries = store->getProgressionTries();
+    ASSERT_THAT(tries, ::testing::ElementsAre(std::make_pair(std::string("Start:world1"), 2)));
+}
+
+TEST_P(GAEventStoreConformance, testSessions)
+{
+    store->checkpointSession({ "s1", 100, "{\"client_ts\":110}" });
+    store->checkpointSession({ "s2", 200, "{\"client_ts\":210}" });
+    store->checkpointSession({ "s1", 100, "{\"client_ts\":120}" });
+
+    ASSERT_EQ(2u, store->getSessions().size());
+
+    store->removeSession("s1");
+
+    std::vector<SessionCheckpoint> sessions = store->getSessions();
+    ASSERT_EQ(1u, sessions.size());
+    ASSERT_EQ("s2", sessions[0].sessionId);
+    ASSERT_EQ(200, sessions[0].startTs);
+    ASSERT_EQ("{\"client_ts\":210}", sessions[0].event);
+}
+
+TEST_P(GAEventStoreConformance, testStats)
+{
+    ASSERT_FALSE(store->isFull());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        append(*store, makeEvent(i));
+    }
+
+    ASSERT_EQ(3, store->getStats().queuedEvents);
+    ASSERT_GT(store->getStats().sizeBytes, 0);
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "", 2, out));
+    ASSERT_EQ(1, store->getStats().queuedEvents);
+    ASSERT_EQ(2, store->getStats().claimedEvents);
+
+    store->putBackBatch("req1");
+    ASSERT_EQ(3, store->getStats().queuedEvents);
+    ASSERT_EQ(0, store->getStats().claimedEvents);
+
+    out.clear();
+    ASSERT_TRUE(store->claimBatch("req2", "", 2, out));
+    store->ackBatch("req2");
+    ASSERT_EQ(1, store->getStats().queuedEvents);
+    ASSERT_EQ(0, store->getStats().claimedEvents);
+    ASSERT_EQ(0, store->getStats().evictedEvents);
+
+    // trimming a store within its quota keeps every event
+    store->trim();
+    ASSERT_EQ(1, store->getStats().queuedEvents);
+}
+
+TEST_P(GAEventStoreConformance, testStatsByCategory)
+{
+    using gameanalytics::store::eventCategoryId;
+
+    const std::size_t design   = static_cast<std::size_t>(eventCategoryId("design"));
+    const std::size_t business = static_cast<std::size_t>(eventCategoryId("business"));
+
+    ASSERT_EQ(0, store->getStats().oldestClientTs);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        append(*store, makeEvent(i));
+    }
+    append(*store, makeEvent(3, "business"));
+
+    auto stats = store->getStats();
+    ASSERT_EQ(3, stats.eventsByCategory[design]);
+    ASSERT_EQ(1, stats.eventsByCategory[business]);
+    ASSERT_GT(stats.bytesByCategory[design], stats.bytesByCategory[business]);
+    ASSERT_EQ(1700000000, stats.oldestClientTs);
+
+    // claimed events are still held, acked ones are gone
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "design", 2, out));
+    ASSERT_EQ(3, store->getStats().eventsByCategory[design]);
+    ASSERT_EQ(1700000000, store->getStats().oldestClientTs);
+
+    store->ackBatch("req1");
+    stats = store->getStats();
+    ASSERT_EQ(1, stats.eventsByCategory[design]);
+    ASSERT_EQ(1, stats.eventsByCategory[business]);
+    ASSERT_EQ(1700000002, stats.oldestClientTs);
+
+    out.clear();
+    ASSERT_TRUE(store->claimBatch("req2", "", 10, out));
+    store->ackBatch("req2");
+    stats = store->getStats();
+    ASSERT_EQ(0, stats.eventsByCategory[design]);
+    ASSERT_EQ(0, stats.bytesByCategory[business]);
+    ASSERT_EQ(0, stats.oldestClientTs);
+}
+
+TEST_P(GAEventStoreConformance, testNeverEvictsClaimedEvents)
+{
+    // the files of the store from SetUp are dropped and opened again
+    store.reset();
+    store = GetParam().createBounded();
+    ASSERT_TRUE(store != nullptr);
+
+    constexpr int Claimed = 10;
+    constexpr int Overfill = 1000;
+
+    for (int i = 0; i < Claimed; ++i)
+    {
+        append(*store, makePaddedEvent(i));
+    }
+
+    StringVector inFlight;
+    ASSERT_TRUE(store->claimBatch("req1", "", Claimed, inFlight));
+    ASSERT_EQ(static_cast<std::size_t>(Claimed), inFlight.size());
+
+    for (int i = Claimed; i < Claimed + Overfill; ++i)
+    {
+        append(*store, makePaddedEvent(i));
+    }
+
+    // every event that came in is still queued or was evicted (or refused), none of the claimed ones
+    auto stats = store->getStats();
+    ASSERT_EQ(Claimed, stats.claimedEvents);
+    ASSERT_EQ(Overfill, stats.queuedEvents + stats.evictedEvents + stats.droppedEvents);
+
+    // the batch can still go back and comes out again as it was
+    store->putBackBatch("req1");
+    StringVector again;
+    ASSERT_TRUE(store->claimBatch("req2", "", Claimed, again));
+    ASSERT_EQ(inFlight, again);
+
+    // once the batch is done the store gets back within its quota
+    store->ackBatch("req2");
+    for (int i = 0; i < Overfill; ++i)
+    {
+        append(*store, makePaddedEvent(Claimed + Overfill + i));
+    }
+
+    stats = store->getStats();
+    ASSERT_GT(stats.evictedEvents, 0);
+    ASSERT_LT(stats.queuedEvents, 2 * Overfill);
+    ASSERT_EQ(0, stats.claimedEvents);
+}
+
+TEST_P(GAEventStoreConformance, testGroupedWrites)
+{
+    store->beginWrites();
+    for (int i = 0; i < 5; ++i)
+    {
+        append(*store, makeEvent(i));
+    }
+    store->setState("transaction_num", "5");
+    store->endWrites();
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "", 10, out));
+    ASSERT_EQ(5u, out.size());
+    ASSERT_EQ("5", store->getState("transaction_num"));
+}
+
+TEST_P(GAEventStoreConformance, testAppendBatch)
+{
+    // more rows than one statement of the sqlite store takes, and an odd rest
+    std::vector<EventRecord> records;
+    for (int i = 0; i < 150; ++i)
+    {
+        json ev = makeEvent(i, i % 3 == 0 ? "business" : "design");
+        records.push_back({ ev["category"].get<std::string>(), ev["session_id"].get<std::string>(), ev["client_ts"].get<int64_t>(), ev });
+    }
+
+    append(*store, makeEvent(1000));
+    ASSERT_TRUE(store->appendBatch(records));
+    ASSERT_TRUE(store->appendBatch({}));
+    ASSERT_EQ(151, store->getStats().queuedEvents);
+
+    StringVector out;
+    ASSERT_TRUE(store->claimBatch("req1", "", 200, out));
+    ASSERT_EQ(151u, out.size());
+    ASSERT_EQ(makeEvent(1000), json::parse(out[0]));
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        ASSERT_EQ(records[i].event, json::parse(out[i + 1]));
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, GAEventStoreConformance, ::testing::Values(
+    GAEventStoreBackend{ "Sqlite", []() -> std::unique_ptr<IEventStore>
+        {
+            return openSqlite(gameanalytics::GAStoreSettings());
+        },
+        []() -> std::unique_ptr<IEventStore>
+        {
+            gameanalytics::GAStoreSettings settings;
+            settings.maxSizeBytes = 256 * 1024;
+            return openSqlite(settings);
+        } },
+    GAEventStoreBackend{ "Memory", []() -> std::unique_ptr<IEventStore>
+        {
+            return std::unique_ptr<IEventStore>(new GAMemoryStore(1000));
+        },
+        []() -> std::unique_ptr<IEventStore>
+        {
+            return std::unique_ptr<IEventStore>(new GAMemoryStore(200));
+        } },
+    GAEventStoreBackend{ "SegmentLog", []() -> std::unique_ptr<IEventStore>
+        {
+            return openSegmentLog(gameanalytics::GAStoreSettings());
+        },
+        []() -> std::unique_ptr<IEventStore>
+        {
+            gameanalytics::GAStoreSettings settings;
+            settings.segmentSizeBytes = 64 * 1024;
+            settings.maxSizeBytes     = 256 * 1024;
+            return openSegmentLog(settings);
+        } }
+), eventStoreBackendName);
@@ -0,0 +1,99 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "GAGzipEncoder.h"
+#include "GAUtilities.h"
+#include <algorithm>
+
+#if !defined(_WIN32)
+
+#include <GAMockCollector.h>
+
+using gameanalytics::mock::GAMockCollector;
+using gameanalytics::utilities::GAGzipEncoder;
+using gameanalytics::utilities::GAUtilities;
+
+namespace
+{
+    std::string eventBatch(int events)
+    {
+        std::string batch = "[";
+        for (int i = 0; i < events; ++i)
+        {
+            batch += (i ? "," : "");
+            batch += R"({"category":"design","client_ts":17923574)" + std::to_string(10 + i % 90) + R"(,"event_id":"combat:kill:goblin","session_num":15,"v":2})";
+        }
+        batch += "]";
+        return batch;
+    }
+}
+
+TEST(GAGzipEncoder, testRoundTripsEveryLevel)
+{
+    const std::string text = eventBatch(200);
+
+    std::vector<uint8_t> compressed;
+    for (int level = 0; level <= 9; ++level)
+    {
+        ASSERT_TRUE(GAUtilities::gzipCompress(text.data(), text.size(), compressed, level));
+
+        std::string inflated;
+        bool trailerMatches = false;
+        ASSERT_TRUE(GAMockCollector::gunzip(compressed, inflated, trailerMatches)) << "level " << level;
+        ASSERT_TRUE(trailerMatches) << "level " << level;
+        ASSERT_EQ(text, inflated);
+
+        if (level > 0)
+        {
+            ASSERT_LT(compressed.size(), text.size() / 4);
+        }
+    }
+}
+
+TEST(GAGzipEncoder, testTrailerHoldsZeroBytes)
+{
+    // the CRC and the size of this input have zero bytes in them
+    std::string text(256, '\0');
+    for (size_t i = 0; i < text.size(); i += 7)
+    {
+        text[i] = static_cast<char>(i);
+    }
+
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE(GAUtilities::gzipCompress(text.data(), text.size(), compressed));
+    ASSERT_EQ(std::vector<uint8_t>({ 0x00, 0x01, 0x00, 0x00 }), std::vector<uint8_t>(compressed.end() - 4, compressed.end()));
+
+    std::string inflated;
+    bool trailerMatches = false;
+    ASSERT_TRUE(GAMockCollector::gunzip(compressed, inflated, trailerMatches));
+    ASSERT_TRUE(trailerMatches);
+    ASSERT_EQ(text, inflated);
+}
+
+TEST(GAGzipEncoder, testStreamsIntoReusedBuffer)
+{
+    const std::string text = eventBatch(50);
+
+    GAGzipEncoder encoder;
+    std::vector<uint8_t> whole;
+    ASSERT_TRUE(encoder.encode(text.data(), text.size(), whole));
+
+    // the same bytes whichever way the input is cut
+    std::vector<uint8_t> streamed(4096, 0xff);
+    const uint8_t* const buffer = streamed.data();
+    ASSERT_TRUE(encoder.begin(streamed));
+    for (size_t pos = 0; pos < text.size(); pos += 37)
+    {
+        ASSERT_TRUE(encoder.write(text.data() + pos, std::min<size_t>(37, text.size() - pos)));
+    }
+    ASSERT_TRUE(encoder.finish());
+
+    ASSERT_EQ(whole, streamed);
+    ASSERT_EQ(buffer, streamed.data());
+}
+
+#endif
@@ -0,0 +1,236 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <GAHTTPClient.h>
+#include <GAHTTPEngine.h>
+#include "helpers/GATestHelpers.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using gameanalytics::http::GAHTTPClient;
+using gameanalytics::http::GAHTTPEngine;
+using gameanalytics::http::HTTPRequest;
+using gameanalytics::http::HTTPResult;
+
+namespace
+{
+    // nothing listens there, every request fails to connect
+    constexpr const char* ClosedUrl = "http://127.0.0.1:1/v2/events";
+
+    HTTPRequest makeRequest(std::string const& url)
+    {
+        HTTPRequest request;
+        request.url     = url;
+        request.headers = { "Content-Type: application/json", "Authorization: abc" };
+        request.payload = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{ '[', ']' });
+        return request;
+    }
+}
+
+TEST(GAHTTPClient, testRunsRequestsSideBySide)
+{
+    GAHTTPEngine engine;
+
+    constexpr int Requests = 12;
+    std::atomic<int> failed{0};
+    for (int i = 0; i < Requests; ++i)
+    {
+        engine.submit(nullptr, makeRequest(ClosedUrl),
+            [&failed](HTTPResult&& result)
+            {
+                if (result.code == CURLE_COULDNT_CONNECT && result.statusCode == 0)
+                {
+                    ++failed;
+                }
+            });
+    }
+
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return engine.activeRequests() == 0; }));
+    ASSERT_EQ(Requests, failed.load());
+
+    // the handles are kept for the next requests, up to the limit
+    ASSERT_GE(engine.idleHandles(), 1u);
+    ASSERT_LE(engine.idleHandles(), GAHTTPEngine::MaxIdleHandles);
+}
+
+TEST(GAHTTPClient, testWaitsOrCallsBack)
+{
+    GAHTTPClient client;
+
+    // no answer: status code 0 and curl's reason
+    gameanalytics::GAHTTPResponse const result = client.post(ClosedUrl, {}, std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{ '[', ']' }));
+    ASSERT_EQ(0, result.statusCode);
+    ASSERT_EQ(curl_easy_strerror(CURLE_COULDNT_CONNECT), result.error);
+
+    std::future<gameanalytics::GAHTTPResponse> pending = client.postAsync(ClosedUrl, {}, {});
+    ASSERT_EQ(curl_easy_strerror(CURLE_COULDNT_CONNECT), pending.get().error);
+
+    std::promise<std::string> called;
+    client.postAsync(ClosedUrl, {}, {}, [&called](gameanalytics::GAHTTPResponse&& outcome) { called.set_value(outcome.error); });
+    ASSERT_EQ(curl_easy_strerror(CURLE_COULDNT_CONNECT), called.get_future().get());
+}
+
+#if !defined(_WIN32)
+
+namespace
+{
+    // answers one request with 'pieces', each sent on its own so they reach curl as separate chunks
+    class ScriptedServer
+    {
+     public:
+
+        explicit ScriptedServer(std::vector<std::string> pieces)
+        {
+            _listener = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr = {};
+            addr.sin_family      = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bind(_listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            listen(_listener, 1);
+            socklen_t length = sizeof(addr);
+            getsockname(_listener, reinterpret_cast<sockaddr*>(&addr), &length);
+            _url = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/v2/events";
+
+            _thread = std::thread([this, pieces = std::move(pieces)]()
+            {
+                const int fd = accept(_listener, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    return;
+                }
+
+                // the head and the two bytes of makeRequest()
+                std::string request;
+                char buffer[4096];
+                while (request.find("\r\n\r\n") == std::string::npos || request.size() < request.find("\r\n\r\n") + 6)
+                {
+                    const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                    if (n <= 0)
+                    {
+                        break;
+                    }
+                    request.append(buffer, static_cast<size_t>(n));
+                }
+
+                for (std::string const& piece : pieces)
+                {
+                    send(fd, piece.data(), piece.size(), MSG_NOSIGNAL);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+                close(fd);
+            });
+        }
+
+        ~ScriptedServer()
+        {
+            _thread.join();
+            close(_listener);
+        }
+
+        std::string const& url() const
+        {
+            return _url;
+        }
+
+     private:
+
+        int         _listener = -1;
+        std::string _url;
+        std::thread _thread;
+    };
+
+    HTTPResult postTo(GAHTTPEngine& engine, std::string const& url)
+    {
+        std::promise<HTTPResult> done;
+        engine.submit(nullptr, makeRequest(url), [&done](HTTPResult&& result) { done.set_value(std::move(result)); });
+        return done.get_future().get();
+    }
+}
+
+TEST(GAHTTPClient, testJoinsChunksOfAnswer)
+{
+    ScriptedServer server({
+        "HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n",
+        "10\r\n[{\"errors\":[\"a\",\r\n",
+        "11\r\n\"b\"],\"event\":{}}]\r\n",
+        "0\r\n\r\n" });
+
+    GAHTTPEngine engine;
+    const HTTPResult result = postTo(engine, server.url());
+    ASSERT_EQ(CURLE_OK, result.code);
+    ASSERT_EQ(400, result.statusCode);
+    ASSERT_EQ("[{\"errors\":[\"a\",\"b\"],\"event\":{}}]", result.body);
+    ASSERT_FALSE(result.truncated);
+}
+
+TEST(GAHTTPClient, testCapsLongAnswer)
+{
+    const std::string body(GAHTTPEngine::MaxResponseBytes + 1000, 'x');
+    ScriptedServer server({
+        "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n",
+        body });
+
+    // the rest is read and dropped, the request still succeeds
+    GAHTTPEngine engine;
+    const HTTPResult result = postTo(engine, server.url());
+    ASSERT_EQ(CURLE_OK, result.code);
+    ASSERT_EQ(200, result.statusCode);
+    ASSERT_EQ(GAHTTPEngine::MaxResponseBytes, result.body.size());
+    ASSERT_TRUE(result.truncated);
+}
+
+TEST(GAHTTPClient, testCancelsRequestsOfOwner)
+{
+    // accepts connections (in the backlog) and never answers
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    ASSERT_EQ(0, listen(listener, 16));
+    socklen_t length = sizeof(addr);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &length);
+    const std::string silentUrl = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/v2/events";
+
+    GAHTTPEngine engine;
+    int ownerA = 0;
+    int ownerB = 0;
+
+    std::atomic<int> abortedA{0};
+    std::atomic<int> abortedB{0};
+    for (int i = 0; i < 3; ++i)
+    {
+        engine.submit(&ownerA, makeRequest(silentUrl), [&abortedA](HTTPResult&& result) { abortedA += result.code == CURLE_ABORTED_BY_CALLBACK ? 1 : 0; });
+        engine.submit(&ownerB, makeRequest(silentUrl), [&abortedB](HTTPResult&& result) { abortedB += result.code == CURLE_ABORTED_BY_CALLBACK ? 1 : 0; });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(6u, engine.activeRequests());
+
+    // the callbacks have run once cancel returns, the other owner's requests go on
+    engine.cancel(&ownerA);
+    ASSERT_EQ(3, abortedA.load());
+    ASSERT_EQ(0, abortedB.load());
+    ASSERT_EQ(3u, engine.activeRequests());
+
+    engine.cancel(&ownerB);
+    ASSERT_EQ(3, abortedB.load());
+    ASSERT_EQ(0u, engine.activeRequests());
+
+    close(listener);
+}
+
+#endif
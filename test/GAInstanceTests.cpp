@@ -0,0 +1,45 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "GameAnalytics/GameAnalytics.h"
+#include "GameAnalytics/GameAnalyticsInstance.h"
+#include "helpers/GATestHelpers.h"
+
+using gameanalytics::GameAnalytics;
+using gameanalytics::GameAnalyticsInstance;
+
+TEST(GAInstance, testInstancesKeepSeparateState)
+{
+    GameAnalyticsInstance first("first");
+    GameAnalyticsInstance second("second");
+
+    first.configureUserId("user_first");
+    second.configureUserId("user_second");
+
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return first.getUserId() == "user_first"; }));
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return second.getUserId() == "user_second"; }));
+
+    ASSERT_NE("user_first", GameAnalytics::getUserId());
+    ASSERT_NE("user_second", GameAnalytics::getUserId());
+    ASSERT_EQ("first", first.getName());
+}
+
+TEST(GAInstance, testDestroyDrainsQueuedWork)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        GameAnalyticsInstance instance;
+        instance.configureUserId("short_lived");
+        instance.setCustomDimension01("dim");
+    }
+
+    // the shared worker keeps serving the default instance
+    GameAnalyticsInstance other;
+    other.configureUserId("still_running");
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return other.getUserId() == "still_running"; }));
+}
@@ -0,0 +1,140 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <GAMemoryStore.h>
+
+using gameanalytics::StringVector;
+using gameanalytics::store::GAMemoryStore;
+
+TEST(GAMemoryStore, testClaimAndRemove)
+{
+    GAMemoryStore store(8);
+
+    store.add("design", "s1", 1, "e1");
+    store.add("user", "s1", 2, "e2");
+    store.add("design", "s1", 3, "e3");
+
+    StringVector out;
+    ASSERT_EQ(2u, store.claim("req1", "design", 500, out));
+    ASSERT_THAT(out, ::testing::ElementsAre("e1", "e3"));
+    ASSERT_EQ(1u, store.pendingCount());
+
+    // claimed events are not handed out twice
+    StringVector again;
+    ASSERT_EQ(1u, store.claim("req2", "", 500, again));
+    ASSERT_THAT(again, ::testing::ElementsAre("e2"));
+
+    ASSERT_EQ(2u, store.remove("req1"));
+    ASSERT_EQ(1u, store.size());
+    ASSERT_EQ(0u, store.remove("unknown"));
+}
+
+TEST(GAMemoryStore, testPutBackAndReset)
+{
+    GAMemoryStore store(8);
+
+    store.add("design", "s1", 1, "e1");
+    store.add("design", "s1", 2, "e2");
+
+    StringVector out;
+    ASSERT_EQ(1u, store.claim("req1", "", 1, out));
+    ASSERT_EQ(1u, store.putBack("req1"));
+    ASSERT_EQ(2u, store.pendingCount());
+
+    out.clear();
+    ASSERT_EQ(2u, store.claim("req2", "", 500, out));
+    ASSERT_THAT(out, ::testing::ElementsAre("e1", "e2"));
+
+    store.resetStatus();
+    ASSERT_EQ(2u, store.pendingCount());
+    ASSERT_EQ(0u, store.remove("req2"));
+}
+
+TEST(GAMemoryStore, testEvictsOldestWhenFull)
+{
+    GAMemoryStore store(3);
+
+    store.add("design", "s1", 1, "e1");
+    store.add("design", "s1", 2, "e2");
+    store.add("design", "s1", 3, "e3");
+
+    StringVector inFlight;
+    ASSERT_EQ(1u, store.claim("req1", "", 1, inFlight));
+
+    // the claimed e1 stays, the oldest unclaimed events make room
+    store.add("design", "s1", 4, "e4");
+    store.add("design", "s1", 5, "e5");
+
+    ASSERT_EQ(3u, store.size());
+    ASSERT_EQ(2, store.evictedCount());
+    ASSERT_EQ(1u, store.remove("req1"));
+
+    StringVector out;
+    ASSERT_EQ(2u, store.claim("req2", "", 500, out));
+    ASSERT_THAT(out, ::testing::ElementsAre("e4", "e5"));
+}
+
+TEST(GAMemoryStore, testDropsWhenOnlyClaimedLeft)
+{
+    GAMemoryStore store(2);
+
+    store.add("design", "s1", 1, "e1");
+    store.add("design", "s1", 2, "e2");
+
+    StringVector inFlight;
+    ASSERT_EQ(2u, store.claim("req1", "", 500, inFlight));
+
+    store.add("design", "s1", 3, "e3");
+    ASSERT_EQ(0, store.evictedCount());
+    ASSERT_EQ(1, store.droppedCount());
+    ASSERT_EQ(1, store.getStats().droppedEvents);
+
+    ASSERT_EQ(2u, store.remove("req1"));
+    ASSERT_EQ(0u, store.size());
+}
+
+TEST(GAMemoryStore, testReusesHolesBeforeEvicting)
+{
+    GAMemoryStore store(3);
+
+    store.add("user", "s1", 1, "e1");
+    store.add("design", "s1", 2, "e2");
+    store.add("user", "s1", 3, "e3");
+
+    StringVector out;
+    ASSERT_EQ(1u, store.claim("req1", "design", 500, out));
+    ASSERT_EQ(1u, store.remove("req1"));
+
+    store.add("design", "s1", 4, "e4");
+    ASSERT_EQ(0, store.evictedCount());
+    ASSERT_EQ(3u, store.size());
+
+    out.clear();
+    ASSERT_EQ(3u, store.claim("req2", "", 500, out));
+    ASSERT_THAT(out, ::testing::ElementsAre("e1", "e3", "e4"));
+}
+
+TEST(GAMemoryStore, testShrinkCapacity)
+{
+    GAMemoryStore store(4);
+
+    store.add("design", "s1", 1, "aa");
+    store.add("design", "s1", 2, "bb");
+    store.add("design", "s1", 3, "cc");
+    ASSERT_EQ(6, store.sizeBytes());
+
+    store.setCapacity(2);
+    ASSERT_EQ(2u, store.getCapacity());
+    ASSERT_EQ(2u, store.size());
+    ASSERT_EQ(1, store.evictedCount());
+    ASSERT_EQ(4, store.sizeBytes());
+
+    StringVector out;
+    store.claim("req", "", 500, out);
+    ASSERT_THAT(out, ::testing::ElementsAre("bb", "cc"));
+}
@@ -0,0 +1,136 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "GAPayloadWriter.h"
+#include "GAUtilities.h"
+
+#if !defined(_WIN32)
+
+#include <GAMockCollector.h>
+
+using gameanalytics::json;
+using gameanalytics::http::GAPayload;
+using gameanalytics::http::GAPayloadWriter;
+using gameanalytics::mock::GAMockCollector;
+using gameanalytics::utilities::GAUtilities;
+
+namespace
+{
+    constexpr const char* SecretKey = "7f5c3f682cbd217841efba92e92ffb1b3b6612bc";
+
+    // what the SDK signed with before bodies were signed as they were written
+    std::string signature(std::vector<uint8_t> const& body)
+    {
+        std::vector<uint8_t> authorization;
+        GAUtilities::hmacWithKey(SecretKey, body, authorization);
+        return reinterpret_cast<const char*>(authorization.data());
+    }
+
+    json eventBatch(int events)
+    {
+        json batch = json::array();
+        for (int i = 0; i < events; ++i)
+        {
+            batch.push_back({ { "category", "design" }, { "client_ts", 1792357410 + i }, { "event_id", "combat:kill:goblin" }, { "session_num", 15 }, { "v", 2 } });
+        }
+        return batch;
+    }
+}
+
+TEST(GAPayloadWriter, testGzippedBodyIsSigned)
+{
+    const json batch = eventBatch(500);
+
+    GAPayloadWriter writer(true, SecretKey);
+    writer.write(batch);
+
+    GAPayload payload;
+    ASSERT_TRUE(writer.finish(payload));
+    ASSERT_TRUE(payload.gzip);
+    ASSERT_EQ(batch.dump().size(), payload.jsonBytes);
+
+    std::string inflated;
+    bool trailerMatches = false;
+    ASSERT_TRUE(GAMockCollector::gunzip(*payload.body, inflated, trailerMatches));
+    ASSERT_TRUE(trailerMatches);
+    ASSERT_EQ(batch.dump(), inflated);
+
+    ASSERT_EQ(signature(*payload.body), payload.authorization);
+}
+
+TEST(GAPayloadWriter, testGzipLevelApplies)
+{
+    const json batch = eventBatch(500);
+
+    std::vector<std::size_t> sizes;
+    for (const int level : { 1, 9 })
+    {
+        GAPayloadWriter writer(true, SecretKey, level);
+        writer.write(batch);
+
+        GAPayload payload;
+        ASSERT_TRUE(writer.finish(payload));
+
+        std::string inflated;
+        bool trailerMatches = false;
+        ASSERT_TRUE(GAMockCollector::gunzip(*payload.body, inflated, trailerMatches));
+        ASSERT_EQ(batch.dump(), inflated);
+
+        sizes.push_back(payload.body->size());
+    }
+
+    // the level is not overwritten with the default on the way to the encoder
+    ASSERT_GT(sizes[0], sizes[1]);
+}
+
+TEST(GAPayloadWriter, testPlainBodyIsTheText)
+{
+    const json batch = eventBatch(3);
+
+    GAPayloadWriter writer(false, SecretKey);
+    writer.write("[", 1);
+    writer.write(batch[0]);
+    writer.write(",", 1);
+    writer.write(batch[1]);
+    writer.write(",", 1);
+    writer.write(batch[2]);
+    writer.write("]", 1);
+
+    GAPayload payload;
+    ASSERT_TRUE(writer.finish(payload));
+    ASSERT_FALSE(payload.gzip);
+    ASSERT_EQ(batch.dump(), std::string(payload.body->begin(), payload.body->end()));
+    ASSERT_EQ(signature(*payload.body), payload.authorization);
+}
+
+TEST(GAPayloadWriter, testLongValuesPassThrough)
+{
+    // strings longer than the staging buffer, and escapes the serializer writes on its own
+    json event = { { "category", "error" }, { "message", std::string(20000, 'x') + "\"\n\t" + std::string(9000, 'y') } };
+
+    for (const bool gzip : { true, false })
+    {
+        GAPayloadWriter writer(gzip, SecretKey);
+        writer.write(event);
+
+        GAPayload payload;
+        ASSERT_TRUE(writer.finish(payload));
+
+        std::string text(payload.body->begin(), payload.body->end());
+        if (gzip)
+        {
+            bool trailerMatches = false;
+            ASSERT_TRUE(GAMockCollector::gunzip(*payload.body, text, trailerMatches));
+            ASSERT_TRUE(trailerMatches);
+        }
+
+        ASSERT_EQ(event.dump(), text);
+        ASSERT_EQ(signature(*payload.body), payload.authorization);
+    }
+}
+
+#endif
@@ -0,0 +1,140 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <GARetryPolicy.h>
+#include <algorithm>
+#include <vector>
+
+using gameanalytics::http::GARetryPolicy;
+using std::chrono::milliseconds;
+
+namespace
+{
+    GARetryPolicy::Settings testSettings()
+    {
+        GARetryPolicy::Settings settings;
+        settings.baseDelay        = milliseconds(1000);
+        settings.maxDelay         = milliseconds(30000);
+        settings.failureThreshold = 5;
+        settings.openDuration     = milliseconds(600000);
+        return settings;
+    }
+}
+
+TEST(GARetryPolicy, testBackoffDoublesUpToMaxDelay)
+{
+    GARetryPolicy policy(testSettings(), 42);
+
+    // full jitter: anywhere from nothing up to the doubled ceiling, which stops at maxDelay
+    const int64_t ceilings[] = { 1000, 2000, 4000, 8000, 16000, 30000, 30000, 30000 };
+    for (int failures = 1; failures <= 8; ++failures)
+    {
+        int64_t longest = 0;
+        for (int draw = 0; draw < 500; ++draw)
+        {
+            const int64_t delay = policy.backoffDelay(failures).count();
+            ASSERT_GE(delay, 0);
+            ASSERT_LE(delay, ceilings[failures - 1]);
+            longest = std::max(longest, delay);
+        }
+
+        // the draws spread over the whole range
+        ASSERT_GT(longest, ceilings[failures - 1] * 3 / 4);
+    }
+
+    ASSERT_LE(policy.backoffDelay(1000).count(), 30000);
+}
+
+TEST(GARetryPolicy, testWaitsAfterFailure)
+{
+    GARetryPolicy policy(testSettings(), 7);
+    const auto start = GARetryPolicy::Clock::now();
+
+    ASSERT_TRUE(policy.allowAttempt(start));
+    policy.onFailure(start);
+    ASSERT_EQ(GARetryPolicy::State::Closed, policy.getState());
+    ASSERT_EQ(1, policy.getConsecutiveFailures());
+    ASSERT_LE(policy.getNextAttempt(), start + milliseconds(1000));
+    ASSERT_TRUE(policy.allowAttempt(policy.getNextAttempt()));
+
+    policy.onSuccess();
+    ASSERT_EQ(0, policy.getConsecutiveFailures());
+    ASSERT_TRUE(policy.allowAttempt(start));
+}
+
+TEST(GARetryPolicy, testBreakerOpensAfterFailuresInARow)
+{
+    GARetryPolicy::Settings settings = testSettings();
+    GARetryPolicy policy(settings, 3);
+    auto now = GARetryPolicy::Clock::now();
+
+    for (int i = 0; i < settings.failureThreshold; ++i)
+    {
+        ASSERT_EQ(GARetryPolicy::State::Closed, policy.getState());
+        now = std::max(now, policy.getNextAttempt());
+        ASSERT_TRUE(policy.allowAttempt(now));
+        policy.onFailure(now);
+    }
+
+    // open: nothing goes out for at least half the open period
+    ASSERT_EQ(GARetryPolicy::State::Open, policy.getState());
+    ASSERT_GE(policy.getNextAttempt(), now + settings.openDuration / 2);
+    ASSERT_LE(policy.getNextAttempt(), now + settings.openDuration);
+    ASSERT_FALSE(policy.allowAttempt(now + settings.openDuration / 2 - milliseconds(1)));
+
+    // then a single probe: its failure reopens the breaker right away
+    now = policy.getNextAttempt();
+    ASSERT_TRUE(policy.allowAttempt(now));
+    ASSERT_EQ(GARetryPolicy::State::HalfOpen, policy.getState());
+    policy.onFailure(now);
+    ASSERT_EQ(GARetryPolicy::State::Open, policy.getState());
+
+    // its success closes it
+    now = policy.getNextAttempt();
+    ASSERT_TRUE(policy.allowAttempt(now));
+    policy.onSuccess();
+    ASSERT_EQ(GARetryPolicy::State::Closed, policy.getState());
+    ASSERT_EQ(0, policy.getConsecutiveFailures());
+}
+
+TEST(GARetryPolicy, testResetClosesBreaker)
+{
+    GARetryPolicy::Settings settings = testSettings();
+    GARetryPolicy policy(settings, 11);
+    const auto now = GARetryPolicy::Clock::now();
+
+    for (int i = 0; i < settings.failureThreshold; ++i)
+    {
+        policy.onFailure(now);
+    }
+    ASSERT_FALSE(policy.allowAttempt(now));
+
+    // e.g. the device went from offline to wifi
+    policy.reset();
+    ASSERT_EQ(GARetryPolicy::State::Closed, policy.getState());
+    ASSERT_TRUE(policy.allowAttempt(now));
+}
+
+TEST(GARetryPolicy, testSpreadsClientsOfOneOutage)
+{
+    // clients that failed at the same moment come back at different ones
+    const auto now = GARetryPolicy::Clock::now();
+
+    std::vector<GARetryPolicy::Clock::time_point> retries;
+    for (uint32_t seed = 0; seed < 50; ++seed)
+    {
+        GARetryPolicy policy(testSettings(), seed);
+        for (int i = 0; i < 4; ++i)
+        {
+            policy.onFailure(now);
+        }
+        retries.push_back(policy.getNextAttempt());
+    }
+
+    std::sort(retries.begin(), retries.end());
+    ASSERT_GT(std::unique(retries.begin(), retries.end()) - retries.begin(), 40);
+}
@@ -0,0 +1,183 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include <GASegmentStore.h>
+
+using gameanalytics::StringVector;
+using gameanalytics::GAStoreSettings;
+using gameanalytics::store::GASegmentStore;
+
+namespace
+{
+    std::string makeLogPath(std::string const& name)
+    {
+        std::filesystem::path p = std::filesystem::temp_directory_path() / "ga_segment_store_tests" / name;
+
+        std::error_code err;
+        std::filesystem::remove_all(p, err);
+        return p.string();
+    }
+
+    std::vector<std::filesystem::path> segmentFiles(std::string const& path)
+    {
+        std::vector<std::filesystem::path> files;
+        for (auto const& entry : std::filesystem::directory_iterator(path))
+        {
+            if (entry.path().extension() == ".seg")
+            {
+                files.push_back(entry.path());
+            }
+        }
+
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    // about 200 bytes, 20 of them fill a segment of the smallest size
+    std::string eventText(int n)
+    {
+        return "{\"n\":" + std::to_string(n) + ",\"p\":\"" + std::string(180, 'x') + "\"}";
+    }
+
+    void appendEvents(GASegmentStore& store, int from, int to)
+    {
+        for (int i = from; i < to; ++i)
+        {
+            store.appendText("design", "s1", i, eventText(i));
+        }
+    }
+
+    GAStoreSettings smallSegments(int64_t maxSizeBytes = 6291456)
+    {
+        GAStoreSettings settings;
+        settings.segmentSizeBytes = GASegmentStore::MinSegmentSizeBytes;
+        settings.maxSizeBytes     = maxSizeBytes;
+        return settings;
+    }
+}
+
+TEST(GASegmentStore, testReopenKeepsQueueAndState)
+{
+    const std::string path = makeLogPath("reopen");
+
+    {
+        GASegmentStore store;
+        ASSERT_TRUE(store.open(path));
+
+        appendEvents(store, 0, 5);
+
+        StringVector out;
+        ASSERT_TRUE(store.claimBatch("req1", "", 2, out));
+        store.ackBatch("req1");
+
+        store.setState("session_num", "7");
+        store.setProgressionTries("Start:world1", 2);
+        store.checkpointSession({ "s1", 100, "{\"client_ts\":110}" });
+    }
+
+    GASegmentStore store;
+    ASSERT_TRUE(store.open(path));
+
+    // the consumer offset survives, acked events are not sent again
+    ASSERT_EQ(3, store.getStats().queuedEvents);
+
+    StringVector out;
+    ASSERT_TRUE(store.claimBatch("req2", "", 10, out));
+    ASSERT_THAT(out, ::testing::ElementsAre(eventText(2), eventText(3), eventText(4)));
+
+    ASSERT_EQ("7", store.getState("session_num"));
+    ASSERT_THAT(store.getProgressionTries(), ::testing::ElementsAre(std::make_pair(std::string("Start:world1"), 2)));
+    ASSERT_EQ(1u, store.getSessions().size());
+}
+
+TEST(GASegmentStore, testTruncatesTornTail)
+{
+    const std::string path = makeLogPath("torn");
+
+    {
+        GASegmentStore store;
+        ASSERT_TRUE(store.open(path));
+        appendEvents(store, 0, 3);
+    }
+
+    // a crash in the middle of the last record: its body is only half there
+    const std::filesystem::path segment = segmentFiles(path).front();
+    {
+        std::fstream file(segment, std::ios::in | std::ios::out | std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        const std::size_t last = data.find(eventText(2));
+        ASSERT_NE(std::string::npos, last);
+        file.seekp(static_cast<std::streamoff>(last + 3));
+        file.write("\0\0\0\0", 4);
+    }
+
+    GASegmentStore store;
+    ASSERT_TRUE(store.open(path));
+    ASSERT_EQ(2, store.getStats().queuedEvents);
+
+    // new records go where the torn one was
+    appendEvents(store, 3, 4);
+
+    StringVector out;
+    ASSERT_TRUE(store.claimBatch("req1", "", 10, out));
+    ASSERT_THAT(out, ::testing::ElementsAre(eventText(0), eventText(1), eventText(3)));
+}
+
+TEST(GASegmentStore, testDeletesConsumedSegments)
+{
+    const std::string path = makeLogPath("consumed");
+
+    GASegmentStore store;
+    store.setSettings(smallSegments());
+    ASSERT_TRUE(store.open(path));
+
+    appendEvents(store, 0, 100);
+    const std::size_t written = segmentFiles(path).size();
+    ASSERT_GT(written, 3u);
+
+    StringVector out;
+    ASSERT_TRUE(store.claimBatch("req1", "", 60, out));
+    store.ackBatch("req1");
+
+    ASSERT_LT(segmentFiles(path).size(), written);
+
+    out.clear();
+    ASSERT_TRUE(store.claimBatch("req2", "", 100, out));
+    ASSERT_EQ(40u, out.size());
+    ASSERT_EQ(eventText(60), out.front());
+    store.ackBatch("req2");
+
+    // the segment being written stays
+    ASSERT_EQ(1u, segmentFiles(path).size());
+    ASSERT_EQ(0, store.getStats().queuedEvents);
+}
+
+TEST(GASegmentStore, testEvictsOldestSegmentsOverQuota)
+{
+    const std::string path = makeLogPath("quota");
+
+    GASegmentStore store;
+    store.setSettings(smallSegments(4 * GASegmentStore::MinSegmentSizeBytes));
+    ASSERT_TRUE(store.open(path));
+
+    appendEvents(store, 0, 500);
+
+    ASSERT_LE(segmentFiles(path).size(), 4u);
+    ASSERT_GT(store.getStats().evictedEvents, 0);
+    ASSERT_EQ(500, store.getStats().queuedEvents + store.getStats().evictedEvents);
+
+    // the newest events are kept
+    StringVector out;
+    ASSERT_TRUE(store.claimBatch("req1", "", 1000, out));
+    ASSERT_EQ(eventText(499), out.back());
+}
@@ -0,0 +1,164 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <GASqliteStore.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+using gameanalytics::StringVector;
+using gameanalytics::store::GASqliteStore;
+
+namespace
+{
+    std::string makeDbPath(std::string const& name)
+    {
+        std::filesystem::path p = std::filesystem::temp_directory_path() / "ga_sqlite_recovery_tests" / name;
+        std::error_code err;
+        std::filesystem::remove_all(p, err);
+        std::filesystem::create_directories(p, err);
+        return (p / "ga.sqlite3").string();
+    }
+
+    // fills the page of the file holding 'marker' with garbage, returns false if it is not there
+    bool damagePageOf(std::string const& path, std::string const& marker, int64_t pageSize)
+    {
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        const std::size_t at = bytes.find(marker);
+        if (at == std::string::npos || at < static_cast<std::size_t>(pageSize))
+        {
+            return false;
+        }
+
+        const std::size_t page = at / static_cast<std::size_t>(pageSize);
+        std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(page * pageSize));
+        const std::string garbage(static_cast<std::size_t>(pageSize), '\xff');
+        out.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+        return static_cast<bool>(out);
+    }
+
+    void fill(GASqliteStore& store, int events)
+    {
+        store.setState("transaction_num", "42");
+        store.setProgressionTries("world01", 3);
+
+        store.beginWrites();
+        for (int i = 0; i < events; ++i)
+        {
+            char session[32];
+            snprintf(session, sizeof(session), "session-%05d", i);
+            store.appendText("design", session, 1700000000 + i, "{\"event_id\":\"level:" + std::to_string(i) + "\"}");
+        }
+        store.endWrites();
+    }
+
+    std::vector<GASqliteStore::RecoveryReport::Kind> kinds(std::vector<GASqliteStore::RecoveryReport> const& reports)
+    {
+        std::vector<GASqliteStore::RecoveryReport::Kind> out;
+        for (auto const& report : reports)
+        {
+            out.push_back(report.kind);
+        }
+        return out;
+    }
+}
+
+TEST(GASqliteRecovery, testSalvagesDamagedPages)
+{
+    using Kind = GASqliteStore::RecoveryReport::Kind;
+
+    constexpr int Events = 2000;
+    const std::string path = makeDbPath("pages");
+
+    int64_t pageSize = 0;
+    {
+        GASqliteStore store;
+        ASSERT_TRUE(store.open(path));
+        fill(store, Events);
+        store.query("PRAGMA page_size;", {}, [&pageSize](GASqliteStore::Row const& row) { pageSize = row.getInt64(0); });
+    }
+
+    // a page in the middle of ga_events, the probes on opening read both ends and miss it
+    ASSERT_TRUE(damagePageOf(path, "session-01000", pageSize));
+
+    GASqliteStore store;
+    ASSERT_TRUE(store.open(path));
+    ASSERT_TRUE(store.takeRecoveryReports().empty());
+
+    // PRAGMA quick_check finds it in the background, the file is set aside and salvaged between sends
+    std::vector<GASqliteStore::RecoveryReport> reports;
+    bool appended = false;
+    for (int tick = 0; tick < 1000 && (reports.empty() || reports.back().kind == Kind::Damaged); ++tick)
+    {
+        store.trim();
+        for (auto& report : store.takeRecoveryReports())
+        {
+            reports.push_back(report);
+        }
+
+        // queued while the salvage runs, it ends up behind the salvaged events
+        if (!reports.empty() && !appended)
+        {
+            store.appendText("design", "session-after", 1800000000, "{\"event_id\":\"after\"}");
+            appended = true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_EQ(std::vector<Kind>({ Kind::Damaged, Kind::Salvaged }), kinds(reports));
+    ASSERT_NE(std::string::npos, reports.back().reason.find("events salvaged"));
+
+    ASSERT_EQ("42", store.getState("transaction_num"));
+    ASSERT_EQ(1u, store.getProgressionTries().size());
+
+    StringVector out;
+    ASSERT_TRUE(store.claimBatch("req1", "", Events + 1, out));
+    ASSERT_GT(out.size(), static_cast<std::size_t>(Events / 2));
+    ASSERT_LT(out.size(), static_cast<std::size_t>(Events + 1));
+    ASSERT_EQ("{\"event_id\":\"level:0\"}", out.front());
+    ASSERT_EQ("{\"event_id\":\"after\"}", out.back());
+    ASSERT_EQ(static_cast<int64_t>(out.size()), store.getStats().claimedEvents);
+    store.ackBatch("req1");
+
+    ASSERT_FALSE(std::filesystem::exists(path + ".damaged"));
+    ASSERT_FALSE(std::filesystem::exists(path + ".salvage"));
+}
+
+TEST(GASqliteRecovery, testSetsAsideUnreadableDatabase)
+{
+    using Kind = GASqliteStore::RecoveryReport::Kind;
+
+    const std::string path = makeDbPath("header");
+    {
+        GASqliteStore store;
+        ASSERT_TRUE(store.open(path));
+        fill(store, 10);
+    }
+
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write("not a database!!", 16);
+    }
+
+    // a new database takes its place right away, nothing is read from the old one
+    GASqliteStore store;
+    ASSERT_TRUE(store.open(path));
+    ASSERT_TRUE(store.isOpen());
+    ASSERT_EQ(std::vector<Kind>({ Kind::Damaged }), kinds(store.takeRecoveryReports()));
+    ASSERT_EQ("", store.getState("transaction_num"));
+
+    store.setState("transaction_num", "1");
+    ASSERT_EQ("1", store.getState("transaction_num"));
+}
@@ -0,0 +1,465 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <GAStore.h>
+#include <GASqliteStore.h>
+#include <GAState.h>
+#include <GAThreading.h>
+#include <GAValidator.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+using gameanalytics::store::GAStore;
+using gameanalytics::store::GASqliteStore;
+using gameanalytics::store::isWriteStatement;
+using gameanalytics::threading::GAThreading;
+using gameanalytics::validators::GAValidator;
+
+namespace
+{
+    // events are stored compressed, sizes are only predictable for payloads that do not compress
+    std::string randomPayload(std::size_t length)
+    {
+        static std::mt19937 random(42);
+        std::uniform_int_distribution<int> printable(' ', '~');
+
+        std::string payload(length, ' ');
+        for (char& c : payload)
+        {
+            c = static_cast<char>(printable(random));
+        }
+
+        return payload;
+    }
+
+    // the events in ga_events as another connection sees them, i.e. what is committed
+    int64_t committedEvents(sqlite3* reader)
+    {
+        int64_t count = -1;
+        sqlite3_stmt* statement = nullptr;
+        if (sqlite3_prepare_v2(reader, "SELECT COUNT(*) FROM ga_events;", -1, &statement, nullptr) == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW)
+        {
+            count = sqlite3_column_int64(statement, 0);
+        }
+        sqlite3_finalize(statement);
+        return count;
+    }
+}
+
+// the classifier is constexpr so statements known at compile time can be checked there
+static_assert(isWriteStatement("INSERT INTO ga_events (category) VALUES(?);"), "insert must be a write");
+static_assert(!isWriteStatement("SELECT event FROM ga_events WHERE batch = ?;"), "select must not be a write");
+static_assert(gameanalytics::store::eventCategoryId("design") != 0 && gameanalytics::store::eventCategoryId("unknown") == 0, "categories map at compile time");
+
+TEST(GAStore, testIsWriteStatement)
+{
+    ASSERT_TRUE(isWriteStatement("UPDATE ga_events SET batch = 0;"));
+    ASSERT_TRUE(isWriteStatement("insert or replace into ga_state (key, value) VALUES(?, ?);"));
+    ASSERT_TRUE(isWriteStatement("Delete FROM ga_session WHERE session_id = ?;"));
+
+    ASSERT_FALSE(isWriteStatement("SELECT key FROM ga_state LIMIT 0,1"));
+    ASSERT_FALSE(isWriteStatement("CREATE TABLE IF NOT EXISTS ga_state(key CHAR(255) PRIMARY KEY NOT NULL, value TEXT);"));
+    ASSERT_FALSE(isWriteStatement("VACUUM"));
+    ASSERT_FALSE(isWriteStatement("UPD"));
+    ASSERT_FALSE(isWriteStatement(""));
+}
+
+TEST(GAStore, testTypedRows)
+{
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+
+    GAStore::setState("typed_rows_test", "42");
+
+    std::string key;
+    int64_t value = 0;
+    int rows = 0;
+    ASSERT_TRUE(GAStore::executeQuery("SELECT key, value FROM ga_state WHERE key = ?;", { "typed_rows_test" },
+        [&](GAStore::Row const& row)
+        {
+            key   = row.getString(0);
+            value = row.getInt64(1);
+            ++rows;
+        }));
+
+    ASSERT_EQ(1, rows);
+    ASSERT_EQ("typed_rows_test", key);
+    ASSERT_EQ(42, value);
+
+    ASSERT_TRUE(GAStore::executeQuery("SELECT NULL, 1.5;", {},
+        [](GAStore::Row const& row)
+        {
+            ASSERT_TRUE(row.isNull(0));
+            ASSERT_EQ(7, row.getInt64(0, 7));
+            ASSERT_TRUE(row.getText(0).empty());
+            ASSERT_DOUBLE_EQ(1.5, row.getDouble(1));
+        }));
+
+    ASSERT_FALSE(GAStore::executeQuery("SELECT missing FROM ga_state;", {}, nullptr));
+
+    GAStore::setState("typed_rows_test", "");
+}
+
+TEST(GAStore, testMigratesEventTable)
+{
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+
+    // the layout written by earlier releases, one of its rows still claimed by a lost request
+    ASSERT_TRUE(GAStore::executeQuerySync("DROP TABLE ga_events"));
+    ASSERT_TRUE(GAStore::executeQuerySync("CREATE TABLE ga_events(status CHAR(50) NOT NULL, category CHAR(50) NOT NULL, session_id CHAR(50) NOT NULL, client_ts CHAR(50) NOT NULL, event TEXT NOT NULL);"));
+    ASSERT_TRUE(GAStore::executeQuerySync("PRAGMA user_version = 0;"));
+    GAStore::executeQuerySync("INSERT INTO ga_events VALUES('new', 'design', 's1', '1000000010', '{\"e\":2}');", {});
+    GAStore::executeQuerySync("INSERT INTO ga_events VALUES('a-request', 'user', 's1', '999999999', '{\"e\":1}');", {});
+    GAStore::executeQuerySync("INSERT INTO ga_events VALUES('new', 'custom', 's1', '1000000020', '{\"e\":3}');", {});
+
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+
+    int64_t version = 0;
+    GAStore::executeQuery("PRAGMA user_version;", {}, [&version](GAStore::Row const& row) { version = row.getInt64(0); });
+    ASSERT_EQ(GAStore::SchemaVersion, version);
+
+    // client_ts compares as a number now ('999999999' sorted after '1000000010' as text)
+    int64_t categories[3] = {};
+    int rows = 0;
+    GAStore::executeQuery("SELECT category, client_ts FROM ga_events ORDER BY client_ts;", {},
+        [&](GAStore::Row const& row)
+        {
+            ASSERT_EQ(SQLITE_INTEGER, row.columnType(1));
+            categories[rows++] = row.getInt64(0);
+        });
+    ASSERT_EQ(3, rows);
+    ASSERT_EQ(gameanalytics::store::eventCategoryId("user"), categories[0]);
+    ASSERT_EQ(gameanalytics::store::eventCategoryId("design"), categories[1]);
+    ASSERT_EQ(0, categories[2]);
+
+    gameanalytics::StringVector out;
+    ASSERT_TRUE(GAStore::claimEvents("req1", "design", 500, out));
+    ASSERT_EQ(gameanalytics::StringVector({ "{\"e\":2}" }), out);
+
+    out.clear();
+    ASSERT_TRUE(GAStore::claimEvents("req2", "", 1, out));
+    ASSERT_EQ(gameanalytics::StringVector({ "{\"e\":1}" }), out);
+
+    GAStore::putBackEvents("req2");
+    GAStore::deleteEvents("req1");
+
+    out.clear();
+    ASSERT_TRUE(GAStore::claimEvents("req3", "", 500, out));
+    ASSERT_EQ(gameanalytics::StringVector({ "{\"e\":1}", "{\"e\":3}" }), out);
+
+    GAStore::deleteEvents("req3");
+    out.clear();
+    ASSERT_FALSE(GAStore::claimEvents("req4", "", 500, out));
+
+    // version 2 rows hold whole events and gain the annotations column
+    ASSERT_TRUE(GAStore::executeQuerySync("DROP TABLE ga_events"));
+    ASSERT_TRUE(GAStore::executeQuerySync("CREATE TABLE ga_events(id INTEGER PRIMARY KEY, batch INTEGER NOT NULL DEFAULT 0, category INTEGER NOT NULL, session_id TEXT NOT NULL, client_ts INTEGER NOT NULL, event TEXT NOT NULL);"));
+    ASSERT_TRUE(GAStore::executeQuerySync("PRAGMA user_version = 2;"));
+    GAStore::executeQuerySync("INSERT INTO ga_events(category, session_id, client_ts, event) VALUES(3, 's1', 1000000030, '{\"e\":4}');", {});
+
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+    GAStore::executeQuery("PRAGMA user_version;", {}, [&version](GAStore::Row const& row) { version = row.getInt64(0); });
+    ASSERT_EQ(GAStore::SchemaVersion, version);
+
+    out.clear();
+    ASSERT_TRUE(GAStore::claimEvents("req5", "", 500, out));
+    ASSERT_EQ(gameanalytics::StringVector({ "{\"e\":4}" }), out);
+    GAStore::deleteEvents("req5");
+}
+
+TEST(GAStore, testSharesSessionAnnotations)
+{
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+    GAStore::executeQuerySync("DELETE FROM ga_events;", {});
+    GAStore::runMaintenance();
+
+    std::vector<gameanalytics::json> events;
+    for (int i = 0; i < 4; ++i)
+    {
+        gameanalytics::json ev;
+        ev["v"]           = 2;
+        ev["user_id"]     = "shared-user";
+        ev["session_id"]  = i < 3 ? "shared-session-1" : "shared-session-2";
+        ev["session_num"] = i < 3 ? 1 : 2;
+        ev["platform"]    = "linux";
+        ev["category"]    = "design";
+        ev["event_id"]    = "level:" + std::to_string(i);
+        ev["client_ts"]   = 1000 + i;
+        events.push_back(ev);
+
+        GAStore::addEvent("design", ev["session_id"].get<std::string>(), 1000 + i, ev);
+    }
+    GAStore::addEvent("design", "shared-session-1", 1004, std::string(R"({"category":"design","event_id":"whole"})"));
+
+    // one row per session, the events only keep their own fields
+    int64_t annotationRows = 0;
+    GAStore::executeQuery("SELECT COUNT(*) FROM ga_annotations;", {}, [&annotationRows](GAStore::Row const& row) { annotationRows = row.getInt64(0); });
+    ASSERT_EQ(2, annotationRows);
+
+    gameanalytics::StringVector out;
+    ASSERT_TRUE(GAStore::claimEvents("shared-request", "", 500, out));
+    ASSERT_EQ(5u, out.size());
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        ASSERT_EQ(events[i], gameanalytics::json::parse(out[i]));
+    }
+    ASSERT_EQ(R"({"category":"design","event_id":"whole"})", out[4]);
+    GAStore::deleteEvents("shared-request");
+
+    // rows of sent sessions go on the next maintenance tick
+    GAStore::runMaintenance();
+    GAStore::executeQuery("SELECT COUNT(*) FROM ga_annotations;", {}, [&annotationRows](GAStore::Row const& row) { annotationRows = row.getInt64(0); });
+    ASSERT_EQ(0, annotationRows);
+
+    GAStore::addEvent("design", "shared-session-2", 1005, events[3]);
+    out.clear();
+    ASSERT_TRUE(GAStore::claimEvents("shared-request", "", 500, out));
+    ASSERT_EQ(events[3], gameanalytics::json::parse(out[0]));
+    GAStore::deleteEvents("shared-request");
+}
+
+TEST(GAStore, testTracksDbSize)
+{
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+    GAStore::resetEventStatus();
+
+    const int64_t initial = GAStore::getDbSizeBytes();
+    ASSERT_GT(initial, 0);
+
+    const std::string event = randomPayload(1000);
+    for (int i = 0; i < 10; ++i)
+    {
+        GAStore::addEvent("design", "size-session", 1000 + i, event);
+    }
+
+    // the tracked size follows the rows without touching the file
+    const int64_t grown = GAStore::getDbSizeBytes();
+    ASSERT_GE(grown - initial, 10 * 800);
+    ASSERT_FALSE(GAStore::isDbTooLargeForEvents());
+
+    gameanalytics::StringVector out;
+    while (GAStore::claimEvents("size-request", "", 500, out))
+    {
+        GAStore::deleteEvents("size-request");
+    }
+
+    ASSERT_LE(GAStore::getDbSizeBytes(), grown - 10 * 800);
+}
+
+TEST(GAStore, testQueueStats)
+{
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+    GAStore::resetEventStatus();
+
+    gameanalytics::StringVector out;
+    while (GAStore::claimEvents("stats-request", "", 500, out))
+    {
+        GAStore::deleteEvents("stats-request");
+    }
+
+    gameanalytics::GAQueueStats stats = GAStore::getQueueStats(2000);
+    ASSERT_EQ(0, stats.queuedEvents);
+    ASSERT_EQ(0, stats.oldestEventAgeSeconds);
+    ASSERT_TRUE(stats.bytesByCategory.empty());
+
+    gameanalytics::json ev;
+    ev["category"]  = "design";
+    ev["event_id"]  = "level:1";
+    ev["client_ts"] = 1000;
+    GAStore::addEvent("design", "stats-session", 1000, ev);
+
+    // held by the writer, reading the stats does not flush it
+    stats = GAStore::getQueueStats(2000);
+    ASSERT_EQ(1, stats.pendingWrites);
+    ASSERT_EQ(0, stats.queuedEvents);
+    ASSERT_EQ(1000, stats.oldestEventAgeSeconds);
+
+    GAStore::flushWrites();
+    GAStore::addEvent("business", "stats-session", 1500, randomPayload(100));
+
+    stats = GAStore::getQueueStats(2000);
+    ASSERT_EQ(0, stats.pendingWrites);
+    ASSERT_EQ(2, stats.queuedEvents);
+    ASSERT_EQ(1000, stats.oldestEventAgeSeconds);
+    ASSERT_EQ(1, stats.eventsByCategory["design"]);
+    ASSERT_EQ(1, stats.eventsByCategory["business"]);
+    ASSERT_GT(stats.bytesByCategory["business"], 100);
+
+    ASSERT_TRUE(GAStore::claimEvents("stats-request", "design", 10, out));
+    ASSERT_EQ(1, GAStore::getQueueStats(2000).inFlightEvents);
+    GAStore::deleteEvents("stats-request");
+
+    stats = GAStore::getQueueStats(2000);
+    ASSERT_EQ(0, stats.inFlightEvents);
+    ASSERT_EQ(500, stats.oldestEventAgeSeconds);
+    ASSERT_EQ(0u, stats.eventsByCategory.count("design"));
+}
+
+TEST(GAStore, testEvictsToQuota)
+{
+    gameanalytics::GAStoreSettings settings;
+    settings.maxSizeBytes = 256 * 1024;
+    GAStore::setSettings(settings);
+
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+    GAStore::executeQuerySync("DELETE FROM ga_events;", {});
+    const int64_t evictedBefore = GAStore::getEvictedEventCount();
+
+    // the oldest rows are worth keeping, the design events behind them are not
+    const std::string event = randomPayload(1000);
+    for (int i = 0; i < 20; ++i)
+    {
+        GAStore::addEvent("business", "quota-session", i, "business-" + std::to_string(i) + event);
+    }
+    for (int i = 0; i < 600; ++i)
+    {
+        GAStore::addEvent("design", "quota-session", 100 + i, "design-" + std::to_string(i) + event);
+        ASSERT_LE(GAStore::getDbSizeBytes(), settings.maxSizeBytes);
+    }
+
+    ASSERT_GT(GAStore::getEvictedEventCount(), evictedBefore);
+    ASSERT_FALSE(GAStore::isDbTooLargeForEvents());
+
+    gameanalytics::StringVector out;
+    ASSERT_TRUE(GAStore::claimEvents("quota-request", "", 1000, out));
+    ASSERT_LT(out.size(), 620u);
+    ASSERT_EQ(0u, out[0].find("business-0"));
+    ASSERT_EQ(0u, out[19].find("business-19"));
+    ASSERT_EQ(0u, out.back().find("design-599"));
+    GAStore::deleteEvents("quota-request");
+
+    // the freed pages go back on maintenance ticks
+    GAStore::runMaintenance();
+
+    GAStore::setSettings(gameanalytics::GAStoreSettings());
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+}
+
+TEST(GAStore, testKeepsWalWithinQuota)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "ga_store_wal_tests.sqlite3").string();
+    auto fileSize = [](std::string const& file)
+    {
+        std::error_code err;
+        const auto size = std::filesystem::file_size(file, err);
+        return err ? int64_t(0) : static_cast<int64_t>(size);
+    };
+
+    std::error_code err;
+    for (std::string const& file : { path, path + "-wal", path + "-shm" })
+    {
+        std::filesystem::remove(file, err);
+    }
+
+    gameanalytics::GAStoreSettings settings;
+    settings.maxSizeBytes = 512 * 1024;
+
+    GASqliteStore store;
+    store.setSettings(settings);
+    ASSERT_TRUE(store.open(path));
+
+    const std::string event = randomPayload(1000);
+    for (int i = 0; i < 40; ++i)
+    {
+        store.beginWrites();
+        for (int j = 0; j < 50; ++j)
+        {
+            store.appendText("design", "wal-session", i * 50 + j, event);
+        }
+        store.endWrites();
+        // checkpointed and cut back after commits instead of growing to the default 1000 pages
+        // (an eviction's deletes make one larger transaction)
+        ASSERT_LE(fileSize(path + "-wal"), settings.maxSizeBytes / 2);
+    }
+
+    // back to a sixteenth of the quota plus the last transaction
+    ASSERT_LE(fileSize(path + "-wal"), settings.maxSizeBytes / 16 + 50 * 2048);
+
+    // the maintenance tick empties the log, what is on disk is then within the quota
+    store.trim();
+    ASSERT_EQ(0, fileSize(path + "-wal"));
+    ASSERT_LE(fileSize(path), settings.maxSizeBytes);
+    ASSERT_LE(store.getDbSizeBytes(), settings.maxSizeBytes);
+
+    store.close();
+}
+
+TEST(GAStore, testRejectsOutOfRangeSettings)
+{
+    ASSERT_TRUE(GAValidator::validateStoreSettings(gameanalytics::GAStoreSettings()));
+
+    auto rejects = [](void (*change)(gameanalytics::GAStoreSettings&))
+    {
+        gameanalytics::GAStoreSettings settings;
+        change(settings);
+        return !GAValidator::validateStoreSettings(settings);
+    };
+
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.cacheSizeKiB = -1; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.mmapSizeBytes = -1; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.tempStore = static_cast<gameanalytics::EGAStoreTempStore>(3); }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.maxSizeBytes = GAStore::MinDbSizeBytes - 1; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.segmentSizeBytes = gameanalytics::store::GASegmentStore::MinSegmentSizeBytes - 1; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.segmentSizeBytes = gameanalytics::store::GASegmentStore::MaxSegmentSizeBytes + 1; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.writeBatchEvents = 0; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.writeBatchBytes = -1; }));
+    ASSERT_TRUE(rejects([](gameanalytics::GAStoreSettings& s) { s.writeDelayMs = -1; }));
+
+    // the bounds themselves are fine
+    ASSERT_FALSE(rejects([](gameanalytics::GAStoreSettings& s) { s.cacheSizeKiB = 0; s.maxSizeBytes = GAStore::MinDbSizeBytes; s.writeBatchEvents = 1; }));
+}
+
+TEST(GAStore, testCommitsBlockWritesOnce)
+{
+    gameanalytics::state::GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+
+    std::string path;
+    GAStore::executeQuery("PRAGMA database_list;", {}, [&path](GAStore::Row const& row) { if (row.getString(1) == "main") path = row.getString(2); });
+    ASSERT_FALSE(path.empty());
+
+    sqlite3* reader = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open_v2(path.c_str(), &reader, SQLITE_OPEN_READONLY, nullptr));
+    sqlite3_busy_timeout(reader, 1000);
+    const int64_t before = committedEvents(reader);
+    ASSERT_GE(before, 0);
+
+    // the writes of a block are one transaction: none of them is committed while it runs
+    constexpr int Events = 50;
+    std::atomic<int64_t> seenInside{-1};
+    GAThreading::performTaskOnGAThreadNow([reader, &seenInside]()
+    {
+        for (int i = 0; i < Events; ++i)
+        {
+            GAStore::addEvent("design", "group-session", 1000 + i, "{\"group\":" + std::to_string(i) + "}");
+        }
+        seenInside = committedEvents(reader);
+    });
+
+    // and all of them are once it is over
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (committedEvents(reader) != before + Events && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_EQ(before, seenInside.load());
+    ASSERT_EQ(before + Events, committedEvents(reader));
+    sqlite3_close(reader);
+
+    gameanalytics::StringVector out;
+    ASSERT_TRUE(GAStore::claimEvents("group-request", "design", 1000, out));
+    GAStore::deleteEvents("group-request");
+}
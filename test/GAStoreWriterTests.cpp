@@ -0,0 +1,122 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <GAStoreWriter.h>
+#include <GAMemoryStore.h>
+#include <GASqliteStore.h>
+
+using gameanalytics::json;
+using gameanalytics::StringVector;
+using gameanalytics::store::EventRecord;
+using gameanalytics::store::GAStoreWriter;
+using gameanalytics::store::GAMemoryStore;
+using gameanalytics::store::GASqliteStore;
+
+namespace
+{
+    EventRecord makeRecord(int n, std::size_t padding = 0)
+    {
+        json ev;
+        ev["category"]  = "design";
+        ev["event_id"]  = "level:" + std::to_string(n);
+        ev["client_ts"] = 1700000000 + n;
+        ev["padding"]   = std::string(padding, 'x');
+        return { "design", "s1", 1700000000 + n, ev };
+    }
+}
+
+TEST(GAStoreWriter, testFlushesOnCount)
+{
+    GAStoreWriter writer;
+    writer.setLimits(3, 1 << 20, std::chrono::hours(1));
+
+    ASSERT_FALSE(writer.add(makeRecord(0)));
+    ASSERT_FALSE(writer.add(makeRecord(1)));
+    ASSERT_TRUE(writer.add(makeRecord(2)));
+
+    GAMemoryStore store;
+    ASSERT_EQ(0, store.getStats().queuedEvents);
+
+    writer.flush(store);
+    ASSERT_EQ(0u, writer.pendingEvents());
+    ASSERT_EQ(3, store.getStats().queuedEvents);
+}
+
+TEST(GAStoreWriter, testFlushesOnBytes)
+{
+    GAStoreWriter writer;
+    writer.setLimits(1000, 4096, std::chrono::hours(1));
+
+    ASSERT_FALSE(writer.add(makeRecord(0, 1000)));
+    ASSERT_GT(writer.pendingBytes(), 1000);
+    ASSERT_LT(writer.pendingBytes(), 2000);
+
+    bool full = false;
+    for (int i = 1; i < 10 && !full; ++i)
+    {
+        full = writer.add(makeRecord(i, 1000));
+    }
+
+    ASSERT_TRUE(full);
+    ASSERT_EQ(4u, writer.pendingEvents());
+}
+
+TEST(GAStoreWriter, testDueAfterDelay)
+{
+    GAStoreWriter writer;
+    writer.setLimits(1000, 1 << 20, std::chrono::milliseconds(50));
+
+    // nothing held, nothing due
+    ASSERT_FALSE(writer.isDue(GAStoreWriter::Clock::now() + std::chrono::hours(1)));
+
+    writer.add(makeRecord(0));
+    ASSERT_FALSE(writer.isDue(GAStoreWriter::Clock::now()));
+    ASSERT_TRUE(writer.isDue(GAStoreWriter::Clock::now() + std::chrono::milliseconds(50)));
+}
+
+TEST(GAStoreWriter, testTellsCallbacksAfterWrite)
+{
+    GAStoreWriter writer;
+    GASqliteStore store;
+    ASSERT_TRUE(store.open(":memory:"));
+
+    std::vector<int> persisted;
+    for (int i = 0; i < 3; ++i)
+    {
+        writer.add(makeRecord(i),
+            [&persisted, &store, i](bool stored)
+            {
+                // the batch is in the store by the time it is told
+                ASSERT_TRUE(stored);
+                ASSERT_EQ(3, store.getStats().queuedEvents);
+                persisted.push_back(i);
+            });
+    }
+
+    ASSERT_TRUE(persisted.empty());
+    writer.flush(store);
+    ASSERT_EQ(std::vector<int>({ 0, 1, 2 }), persisted);
+
+    StringVector out;
+    ASSERT_TRUE(store.claimBatch("req1", "", 10, out));
+    ASSERT_EQ(makeRecord(0).event, json::parse(out[0]));
+}
+
+TEST(GAStoreWriter, testTellsCallbacksOfFailedWrite)
+{
+    GAStoreWriter writer;
+
+    // never opened, nothing can be written
+    GASqliteStore store;
+
+    int failed = 0;
+    writer.add(makeRecord(0), [&failed](bool stored) { failed += stored ? 0 : 1; });
+    writer.flush(store);
+
+    ASSERT_EQ(1, failed);
+    ASSERT_EQ(0u, writer.pendingEvents());
+}
@@ -0,0 +1,181 @@
+//
+// GA-SDK-CPP
+// Copyright 2018 GameAnalytics C++ SDK. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "GameAnalytics/GameAnalyticsInstance.h"
+#include <GAHTTPApi.h>
+#include <GAHTTPClient.h>
+#include <GALoopbackTransport.h>
+#include "helpers/GATestHelpers.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using gameanalytics::GAHTTPCompletion;
+using gameanalytics::GAHTTPRequest;
+using gameanalytics::GAHTTPResponse;
+using gameanalytics::GameAnalyticsInstance;
+using gameanalytics::json;
+using gameanalytics::http::GAHTTPApi;
+using gameanalytics::http::GAHTTPClient;
+using gameanalytics::http::GALoopbackTransport;
+
+namespace
+{
+    constexpr const char* GameKey   = "bd624ee6f8e6efb32a054f8d7ba11618";
+    constexpr const char* SecretKey = "7f5c3f682cbd217841efba92e92ffb1b3b6612bc";
+
+    // keeps every request and answers none of them until told to
+    class HeldTransport : public gameanalytics::ITransport
+    {
+     public:
+
+        void send(GAHTTPRequest&&, GAHTTPCompletion&& onDone) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            held.push_back(std::move(onDone));
+        }
+
+        void answerAll(long statusCode)
+        {
+            std::vector<GAHTTPCompletion> answering;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                answering.swap(held);
+            }
+
+            for (GAHTTPCompletion& onDone : answering)
+            {
+                GAHTTPResponse response;
+                response.statusCode = statusCode;
+                response.body       = "{}";
+                onDone(std::move(response));
+            }
+        }
+
+        std::mutex                    mutex;
+        std::vector<GAHTTPCompletion> held;
+    };
+}
+
+TEST(GATransport, testLoopbackDrivesPipeline)
+{
+    std::mutex                 mutex;
+    std::vector<GAHTTPRequest> sent;
+    auto transport = std::make_shared<GALoopbackTransport>(
+        [&](GAHTTPRequest const& request)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sent.push_back(request);
+            return GALoopbackTransport::collectorAnswer(request);
+        });
+
+    GameAnalyticsInstance instance("transport_loopback");
+    instance.configureTransport(transport);
+    instance.configureBuild("transport 1.0");
+    instance.initialize(GameKey, SecretKey);
+
+    // the init call, then the session start
+    ASSERT_TRUE(GATestHelpers::waitFor([&]() { return transport->initRequests() >= 1 && transport->requests() >= 2; }));
+
+    // events stored by an earlier run may go out while the init call is made
+    std::lock_guard<std::mutex> lock(mutex);
+    auto sentTo = [&](std::string const& path)
+    {
+        return std::any_of(sent.begin(), sent.end(), [&](GAHTTPRequest const& request) { return request.url.find(path) != std::string::npos; });
+    };
+    ASSERT_TRUE(sentTo("/remote_configs/v1/init?game_key=" + std::string(GameKey)));
+    ASSERT_TRUE(sentTo(std::string("/v2/") + GameKey + "/events"));
+    for (GAHTTPRequest const& request : sent)
+    {
+        ASSERT_TRUE(request.body && !request.body->empty());
+        ASSERT_TRUE(std::any_of(request.headers.begin(), request.headers.end(),
+            [](std::string const& header) { return header.compare(0, 15, "Authorization: ") == 0; }));
+    }
+}
+
+TEST(GATransport, testClientUsesConfiguredTransport)
+{
+    GAHTTPClient client;
+    client.setTransport(std::make_shared<GALoopbackTransport>(
+        [](GAHTTPRequest const& request)
+        {
+            GAHTTPResponse response;
+            response.statusCode = 418;
+            response.body       = std::string(request.body->begin(), request.body->end());
+            return response;
+        }));
+
+    auto const payload = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{ '[', ']' });
+    GAHTTPResponse const response = client.post("http://loopback/v2/events", { "Content-Type: application/json" }, payload);
+    ASSERT_EQ(418, response.statusCode);
+    ASSERT_EQ("[]", response.body);
+
+    // back to curl, nothing listens there
+    client.setTransport(nullptr);
+    ASSERT_EQ(0, client.post("http://127.0.0.1:1/v2/events", {}, {}).statusCode);
+}
+
+TEST(GATransport, testErrorPageYieldsStatus)
+{
+    std::atomic<long> statusCode{400};
+    GAHTTPApi& api = GAHTTPApi::getInstance();
+    api.setTransport(std::make_shared<GALoopbackTransport>(
+        [&statusCode](GAHTTPRequest const&)
+        {
+            GAHTTPResponse response;
+            response.statusCode = statusCode;
+            response.body       = "<html><body><h1>400 Bad Request</h1></body></html>";
+            return response;
+        }));
+
+    // a proxy's error page is not JSON, the status is what the caller gets
+    json out;
+    ASSERT_EQ(gameanalytics::http::BadRequest, api.requestInitReturningDict(out, "", json::object()));
+    ASSERT_EQ(gameanalytics::http::BadRequest, api.sendEventsInArray(out, json::array({ { { "category", "design" } } })));
+    ASSERT_TRUE(out.is_null());
+
+    statusCode = 200;
+    ASSERT_EQ(gameanalytics::http::JsonDecodeFailed, api.requestInitReturningDict(out, "", json::object()));
+
+    api.setTransport(nullptr);
+}
+
+TEST(GATransport, testCancelCompletesPendingRequests)
+{
+    auto transport = std::make_shared<HeldTransport>();
+    std::atomic<int> cancelled{0};
+    std::atomic<int> answered{0};
+
+    {
+        GAHTTPClient client;
+        client.setTransport(transport);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            client.postAsync("http://held/v2/events", {}, {},
+                [&](GAHTTPResponse&& response)
+                {
+                    (response.statusCode == 0 ? cancelled : answered)++;
+                });
+        }
+
+        // the callbacks have run once cancel returns
+        client.cancel();
+        ASSERT_TRUE(client.isCancelled());
+        ASSERT_EQ(3, cancelled.load());
+
+        // later requests are cancelled right away
+        ASSERT_EQ(0, client.post("http://held/v2/events", {}, {}).statusCode);
+        ASSERT_EQ(3u, transport->held.size());
+    }
+
+    // what the transport reports after the client went is dropped
+    transport->answerAll(200);
+    ASSERT_EQ(0, answered.load());
+}
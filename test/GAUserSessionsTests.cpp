@@ -0,0 +1,164 @@
+//
+// GA-SDK-CPP
+// Copyright 2015 GameAnalytics. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <GAUserSessions.h>
+#include <GAState.h>
+#include <GAStore.h>
+#include <GAUtilities.h>
+
+using gameanalytics::state::GAState;
+using gameanalytics::state::GAUserSessions;
+using gameanalytics::state::UserSession;
+using gameanalytics::store::GAStore;
+namespace utilities = gameanalytics::utilities;
+
+TEST(GAUserSessions, testAcquireKeepsMostRecentlyUsedFirst)
+{
+    GAUserSessions sessions;
+    sessions.setMaxResident(3);
+
+    sessions.acquire("u1").sessionNum = 1;
+    sessions.acquire("u2");
+    sessions.acquire("u3");
+    ASSERT_THAT(sessions.residentUserIds(), ::testing::ElementsAre("u3", "u2", "u1"));
+
+    // touching a resident user keeps its state and moves it to the front
+    ASSERT_EQ(1, sessions.acquire("u1").sessionNum);
+    ASSERT_THAT(sessions.residentUserIds(), ::testing::ElementsAre("u1", "u3", "u2"));
+
+    // a new user drops the least recently used one
+    sessions.acquire("u4");
+    ASSERT_EQ(3u, sessions.residentCount());
+    ASSERT_THAT(sessions.residentUserIds(), ::testing::ElementsAre("u4", "u1", "u3"));
+
+    sessions.setMaxResident(1);
+    ASSERT_THAT(sessions.residentUserIds(), ::testing::ElementsAre("u4"));
+}
+
+TEST(GAUserSessions, testSessionJsonRoundTrip)
+{
+    UserSession session;
+    session.sessionId          = "c79e3d9a-0d5a-4e1a-9c6a-6c3c3ab0b1e2";
+    session.sessionNum         = 4;
+    session.transactionNum     = 2;
+    session.totalSessionLength = 120;
+    session.dimension02        = "whale";
+
+    UserSession restored;
+    restored.fromJson(session.toJson());
+
+    ASSERT_EQ(session.sessionId, restored.sessionId);
+    ASSERT_EQ(4, restored.sessionNum);
+    ASSERT_EQ(2, restored.transactionNum);
+    ASSERT_EQ(0, restored.sessionStart);
+    ASSERT_EQ(120, restored.totalSessionLength);
+    ASSERT_TRUE(restored.dimension01.empty());
+    ASSERT_EQ("whale", restored.dimension02);
+}
+
+TEST(GAUserSessions, testTracksOpenSessionsOnly)
+{
+    GAUserSessions sessions;
+    sessions.setMaxResident(1);
+
+    sessions.acquire("u1");
+    sessions.acquire("u2");
+    sessions.acquire("u3");
+    ASSERT_TRUE(sessions.openUserIds().empty());
+
+    // an open session stays listed when its player is no longer resident
+    sessions.setOpen("u1", true);
+    sessions.setOpen("u3", true);
+    sessions.acquire("u4");
+    ASSERT_THAT(sessions.openUserIds(), ::testing::ElementsAre("u1", "u3"));
+
+    sessions.setOpen("u1", false);
+    ASSERT_THAT(sessions.openUserIds(), ::testing::ElementsAre("u3"));
+
+    sessions.setOpen("u3", false);
+    ASSERT_TRUE(sessions.openUserIds().empty());
+}
+
+TEST(GAUserSessions, testWritesThroughToTheStore)
+{
+    GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+
+    {
+        GAUserSessions sessions;
+        UserSession& session = sessions.acquire("write_through");
+        session.sessionNum     = 3;
+        session.transactionNum = 1;
+        session.sessionStart   = utilities::GAUtilities::timeIntervalSince1970();
+        session.dirty          = true;
+        sessions.setOpen("write_through", true);
+        sessions.flush(session);
+
+        // gone without spilling, like a killed process
+    }
+
+    GAUserSessions restarted;
+    ASSERT_THAT(restarted.openUserIds(), ::testing::Contains("write_through"));
+
+    UserSession& session = restarted.acquire("write_through");
+    ASSERT_EQ(1, restarted.loadCount());
+    ASSERT_EQ(3, session.sessionNum);
+    ASSERT_EQ(1, session.transactionNum);
+    ASSERT_NE(0, session.sessionStart);
+
+    // a resident player keeps its stored row
+    ASSERT_FALSE(GAStore::getState(std::string(GAUserSessions::StateKeyPrefix) + "write_through").empty());
+
+    restarted.setOpen("write_through", false);
+    ASSERT_THAT(restarted.openUserIds(), ::testing::Not(::testing::Contains("write_through")));
+
+    GAStore::setState(std::string(GAUserSessions::StateKeyPrefix) + "write_through", "");
+}
+
+TEST(GAUserSessions, testTrimsStoredPlayers)
+{
+    GAState::setKeys("bd624ee6f8e6efb32a054f8d7ba11618", "7f5c3f682cbd217841efba92e92ffb1b3b6612bc");
+    ASSERT_TRUE(GAStore::ensureDatabase(false, "bd624ee6f8e6efb32a054f8d7ba11618"));
+
+    const std::string prefix = GAUserSessions::StateKeyPrefix;
+    for (std::string const& key : GAStore::getStateKeys(prefix))
+    {
+        GAStore::setState(key, "");
+    }
+
+    auto storeLastSeen = [&prefix](std::string const& userId, int64_t lastSeen)
+    {
+        gameanalytics::json row;
+        row["last_seen"] = lastSeen;
+        GAStore::setState(prefix + userId, row.dump());
+    };
+
+    const int64_t now = utilities::GAUtilities::timeIntervalSince1970();
+    storeLastSeen("trim_expired", now - GAUserSessions::StoredTtlSeconds - 60);
+    storeLastSeen("trim_open", now - GAUserSessions::StoredTtlSeconds - 60);
+    storeLastSeen("trim_old", now - 7200);
+    storeLastSeen("trim_recent", now - 60);
+
+    GAUserSessions sessions;
+    sessions.setMaxResident(1);
+    sessions.setMaxStored(3);
+    sessions.setOpen("trim_open", true);
+
+    // the first row written trims: the expired player goes, then the least recently seen one
+    // until three rows are left; the open and the resident player are kept
+    sessions.flush(sessions.acquire("trim_resident"));
+
+    ASSERT_THAT(GAStore::getStateKeys(prefix), ::testing::ElementsAre(prefix + "trim_open", prefix + "trim_recent", prefix + "trim_resident"));
+    ASSERT_EQ(0u, sessions.trimStored());
+
+    sessions.setOpen("trim_open", false);
+    for (std::string const& key : GAStore::getStateKeys(prefix))
+    {
+        GAStore::setState(key, "");
+    }
+}
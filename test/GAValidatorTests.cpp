@@ -705,3 +705,36 @@ TEST(GAValidator, testValidateUserId)
 
     ASSERT_FALSE(gameanalytics::validators::GAValidator::validateUserId(""));
 }
+
+TEST(GAValidator, testValidateEndpoints)
+{
+    gameanalytics::GAEndpointSettings endpoints;
+    ASSERT_TRUE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+
+    endpoints.baseUrl = "http://127.0.0.1:8080";
+    ASSERT_TRUE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+
+    endpoints.baseUrl = "http://127.0.0.1:8080/";
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+    endpoints.baseUrl = "ftp://collector.example.com";
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+    endpoints.baseUrl = "collector.example.com";
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+
+    endpoints.baseUrl    = "https://collector.example.com";
+    endpoints.eventsPath = "v2/events";
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+    endpoints.eventsPath = "/v2/{game_key}/events";
+    endpoints.initPath   = "";
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateEndpoints(endpoints));
+}
+
+TEST(GAValidator, testValidateGzipLevel)
+{
+    ASSERT_TRUE(gameanalytics::validators::GAValidator::validateGzipLevel(1));
+    ASSERT_TRUE(gameanalytics::validators::GAValidator::validateGzipLevel(9));
+
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateGzipLevel(0));
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateGzipLevel(10));
+    ASSERT_FALSE(gameanalytics::validators::GAValidator::validateGzipLevel(-1));
+}
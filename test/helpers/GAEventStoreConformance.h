@@ -0,0 +1,43 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <GAEventStore.h>
+
+// one IEventStore implementation under test: its name in the test output, a factory returning an empty store
+// and one returning an empty store whose quota a few hundred events of 1 KB overfill
+struct GAEventStoreBackend
+{
+    std::string name;
+    std::function<std::unique_ptr<gameanalytics::store::IEventStore>()> create;
+    std::function<std::unique_ptr<gameanalytics::store::IEventStore>()> createBounded;
+};
+
+// the behaviour every backend has to share (test/GAEventStoreTests.cpp), a new backend adds itself
+// to the instantiation at the end of that file
+class GAEventStoreConformance : public ::testing::TestWithParam<GAEventStoreBackend>
+{
+    protected:
+
+        void SetUp() override
+        {
+            store = GetParam().create();
+            ASSERT_TRUE(store != nullptr);
+        }
+
+        void TearDown() override
+        {
+            store.reset();
+        }
+
+        std::unique_ptr<gameanalytics::store::IEventStore> store;
+};
+
+inline std::string eventStoreBackendName(::testing::TestParamInfo<GAEventStoreBackend> const& info)
+{
+    return info.param.name;
+}
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <random>
+#include <chrono>
+#include <thread>
 
 class GATestHelpers
 {
@@ -10,4 +12,22 @@ class GATestHelpers
         static std::string get80CharsString();
         static std::string get40CharsString();
         static std::string get32CharsString();
+
+        // polls 'pred' every 10 ms until it holds or 'timeout' is over, returns whether it held
+        template<typename Pred>
+        static bool waitFor(Pred pred, std::chrono::milliseconds timeout = std::chrono::seconds(10))
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (!pred())
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    return false;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            return true;
+        }
 };